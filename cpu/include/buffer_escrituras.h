@@ -0,0 +1,41 @@
+#ifndef BUFFER_ESCRITURAS_H_
+#define BUFFER_ESCRITURAS_H_
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <utils/utils.h>
+#include "mmu.h"
+
+/* BUFFER DE ESCRITURAS (sin caché) */
+// Los WRITE se retiran apenas entran acá; las escrituras contiguas o solapadas en el mismo marco
+// se juntan en una y viajan a memoria recién al vaciar el buffer, sin esperar la confirmación.
+// Los READ toman de acá los bytes que todavía no se confirmaron.
+#define MAX_ESCRITURAS_PENDIENTES 16
+
+typedef enum {
+    ESCRITURA_PENDIENTE,   // en el buffer, se le pueden juntar otras escrituras
+    ESCRITURA_EN_VUELO     // enviada a memoria, esperando la confirmación
+} t_estado_escritura;
+
+typedef struct {
+    t_segmento_fisico segmento;
+    char* datos;                 // tam_pagina + 1 bytes indexados por desplazamiento (el \0 del WRITE puede caer al final); valen los del segmento
+    t_estado_escritura estado;
+    uint32_t id_pedido;          // pedido que la lleva, si está en vuelo (en la tabla del fragmento de su marco)
+} t_escritura;
+
+typedef struct {
+    t_escritura escrituras[MAX_ESCRITURAS_PENDIENTES]; // de la más vieja a la más nueva
+    int cantidad;
+} t_buffer_escrituras;
+
+t_buffer_escrituras* crear_buffer_escrituras(void);
+void destruir_buffer_escrituras(t_buffer_escrituras* buffer);
+bool encolar_escritura(t_segmento_fisico* segmento, char* datos);
+bool vaciar_buffer_escrituras(void);
+bool retirar_escrituras_confirmadas(void);
+bool barrera_escrituras(void);
+bool escrituras_cubren(t_segmento_fisico* segmentos, int cantidad);
+void aplicar_escrituras_pendientes(t_segmento_fisico* segmentos, int cantidad, char* destino);
+
+#endif
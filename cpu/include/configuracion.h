@@ -0,0 +1,107 @@
+#ifndef CONFIGURACION_H_
+#define CONFIGURACION_H_
+
+#include <stdbool.h>
+#include <stdatomic.h>
+#include <pthread.h>
+#include <commons/log.h>
+#include <commons/config.h>
+
+/* CONFIGURACION */
+// cpu.config se lee y se valida una sola vez en un t_config_cpu que no se modifica y se publica con un
+// puntero atómico: el camino caliente lee campos con configuracion()->campo, sin diccionario ni strings.
+// Cuando cpu.config cambia (inotify) se arma otra foto con los valores recargables nuevos y se publica;
+// las anteriores se liberan recién al cerrar porque otro hilo puede estar leyéndolas.
+// Se recargan LOG_LEVEL, RETARDO_CACHE, PROFUNDIDAD_PREFETCH, PERIODO_IMAGEN_CALIENTE y PERIODO_ESTADISTICAS; los demás cambios piden reiniciar la CPU.
+#define ARCHIVO_CONFIG_CPU "cpu.config"
+
+typedef enum {
+    TLB_FIFO,
+    TLB_LRU
+} t_reemplazo_tlb;
+
+typedef enum {
+    CACHE_CLOCK,
+    CACHE_CLOCK_M
+} t_reemplazo_cache;
+
+typedef struct t_config_cpu {
+    // Conexiones
+    char* ip_memoria;
+    char* puerto_memoria;
+    char* ip_kernel;
+    char* puerto_kernel_dispatch;
+    char* puerto_kernel_interrupt;
+    char* direccion_memoria;           // unix:/ruta o tcp:host:puerto?opciones, NULL sin la clave
+    char* direccion_kernel_dispatch;
+    char* direccion_kernel_interrupt;
+    char** fragmentos_memoria;         // direcciones de cada fragmento de memoria, NULL sin la clave (una sola memoria)
+    int plazo_conexion;                // milisegundos para conectarse a memoria y kernel al arrancar
+    int reintento_conexion;            // primera espera entre intentos (ms), se duplica en cada fallo
+    int reintento_conexion_max;        // tope de la espera entre intentos (ms)
+
+    // TLB y caché
+    int entradas_tlb;
+    t_reemplazo_tlb reemplazo_tlb;
+    int entradas_cache;                // 0: sin caché
+    t_reemplazo_cache reemplazo_cache;
+    int retardo_cache;                 // milisegundos (recargable)
+    int huellas_procesos;              // procesos cuya huella en TLB y caché se recuerda, 0: ninguno
+    char* imagen_caliente;             // prefijo del archivo donde persisten las huellas, NULL sin imagen
+    int periodo_imagen_caliente;       // milisegundos entre escrituras de la imagen, 0: solo al cerrar (recargable)
+
+    // Ejecución y memoria
+    int cpus_virtuales;                // CPUs del proceso, una por hilo
+    bool fijar_nucleos;                // cada CPU virtual en su propio núcleo
+    int hilos_hardware;                // contextos por CPU virtual
+    bool modo_eventos;                 // MODO_EJECUCION=EVENTOS
+    bool interrupcion_eventfd;
+    bool pedidos_multiplexados;
+    bool memoria_compartida;           // TRANSPORTE_MEMORIA=MEMORIA_COMPARTIDA
+    int tamanio_anillo_memoria;
+    bool codec_paginas;
+    bool mensajes_fijos;
+    bool accesos_vectorizados;
+    bool buffer_escrituras;
+    int profundidad_prefetch;          // instrucciones pedidas antes de ejecutar la actual: 0 o 1 (recargable)
+
+    // Logs y traza
+    t_log_level nivel_log;             // recargable, lo leen los cpu_log_* (cpu_logger queda con el del arranque)
+    bool log_asincronico;
+    char* traza_binaria;               // NULL sin traza
+    char* estadisticas;                // archivo de contadores, NULL: se vuelcan al log
+    int periodo_estadisticas;          // milisegundos entre volcados, 0: solo con SIGUSR1 y al cerrar (recargable)
+
+    struct t_config_cpu* anterior;     // foto que reemplazó una recarga; comparten los strings de la primera
+} t_config_cpu;
+
+extern t_config_cpu* _Atomic configuracion_cpu;
+extern pthread_t hilo_recarga_config;
+extern int fin_recarga_config;
+
+/**
+* @fn     const t_config_cpu* configuracion(void)
+* @brief  Devuelve la configuración vigente. El puntero sigue siendo válido hasta cerrar la CPU, aunque se recargue.
+* @param  Ninguno
+* @return Foto de la configuración.
+*/
+static inline const t_config_cpu* configuracion(void) {
+    return atomic_load_explicit(&configuracion_cpu, memory_order_acquire);
+}
+
+char* string_de_config(t_config* config, char* clave, bool obligatoria, bool* valida);
+int int_de_config(t_config* config, char* clave, int por_defecto, int minimo, bool* valida);
+bool bool_de_config(t_config* config, char* clave, bool* valida);
+int opcion_de_config(t_config* config, char* clave, char* opciones[], int cantidad, int por_defecto, bool* valida);
+t_config_cpu* leer_configuracion(char* archivo);
+void destruir_foto_configuracion(t_config_cpu* foto, bool con_strings);
+bool mismo_string(const char* a, const char* b);
+bool mismas_listas(char** a, char** b);
+bool mismos_valores_fijos(const t_config_cpu* a, const t_config_cpu* b);
+void recargar_configuracion(void);
+void* vigilar_configuracion(void* arg);
+void iniciar_recarga_configuracion(void);
+void detener_recarga_configuracion(void);
+void destruir_configuracion(void);
+
+#endif
@@ -4,6 +4,8 @@
 #include <stdio.h>
 #include <stdlib.h>
 #include <utils/utils.h>
+#include <utils/mensajes.h>
+#include <utils/log_diferido.h>
 #include <pthread.h>
 #include "kernel_cpu.h"
 #include "memoria_cpu.h"
@@ -11,68 +13,154 @@
 #include <commons/log.h>
 #include <commons/config.h>
 #include "mmu.h"
+#include "interrupciones.h"
+#include "hilos_hardware.h"
+#include "buffer_escrituras.h"
+#include "huellas.h"
+#include "imagen_caliente.h"
+#include "traza.h"
+#include "estadisticas.h"
+#include "configuracion.h"
+#include "cpus_virtuales.h"
 
 /* VARIABLES GLOBALES */
 extern t_log* cpu_logger;
-extern t_config* cpu_config;
+extern t_log_diferido* cpu_log_diferido;
 
 // File Descriptors
-extern int socket_cpu;
-extern int socket_memoria;
-extern int socket_kernel_dispatch;
-extern int socket_kernel_interrupt;
-
-/* CONFIG */
-// Conexiones
-char* puerto_memoria();
-char* ip_memoria();
-char* puerto_kernel_dispatch();
-char* puerto_kernel_interrupt();
-char* ip_kernel();
-
-int entradas_tlb();
-char* reemplazo_tlb();
-char* entradas_cache();
-char* reemplazo_cache();
-char* retardo_cache();
-char* log_level();
+extern __thread int socket_cpu;
+extern __thread int socket_memoria;
+extern __thread t_lector_socket* lector_memoria;
+extern __thread t_tabla_pedidos* pedidos_memoria;
+extern __thread t_canal_compartido* canal_memoria;
+extern __thread t_fragmento_memoria* fragmentos_memoria;
+extern __thread int cantidad_fragmentos;
+extern __thread bool paginas_codificadas;
+extern __thread bool mensajes_con_esquema;
+extern __thread bool accesos_en_lote;
+extern __thread t_buffer_escrituras* escrituras_pendientes;
+extern __thread t_calentamiento* calentamiento;
+extern __thread t_huellas huellas_procesos;
+extern t_imagen_caliente imagen_caliente;
+extern __thread t_region_imagen* region_imagen;
+extern __thread int64_t imagen_escrita_ns;
+extern __thread t_estadisticas_cpu estadisticas_cpu;
+extern t_volcado_estadisticas volcado_estadisticas;
+extern t_traza traza;
+extern __thread t_registro_traza registro_traza;
+extern __thread uint32_t pedido_instruccion;
+extern __thread int pc_pedido;
+extern __thread int socket_kernel_dispatch;
+extern __thread int socket_kernel_interrupt;
+
+/* LOG DEL CAMINO CALIENTE */
+// Con LOG_ASINCRONICO=true el hilo solo copia los argumentos y un hilo de fondo formatea y escribe.
+// Los errores siguen usando log_error directo.
+// El nivel sale de la foto vigente de la configuración (configuracion()->nivel_log), así una recarga de
+// LOG_LEVEL no toca cpu_logger; los log_* directos de commons quedan con el nivel del arranque.
+// NIVEL_LOG_MINIMO (0 TRACE, 1 DEBUG, 2 INFO; lo define el target release en settings.mk) saca en
+// compilación las llamadas de menor nivel: no se evalúan los argumentos, pero se sigue chequeando el formato.
+#ifndef NIVEL_LOG_MINIMO
+#define NIVEL_LOG_MINIMO 0
+#endif
+
+#define cpu_log_compilado_afuera(logger, ...) do { if (0) { (void)(logger); printf(__VA_ARGS__); } } while (0)
+
+#if NIVEL_LOG_MINIMO <= 0
+#define cpu_log_trace(logger, ...) log_diferido(cpu_log_diferido, logger, configuracion()->nivel_log, LOG_LEVEL_TRACE, __VA_ARGS__)
+#else
+#define cpu_log_trace(logger, ...) cpu_log_compilado_afuera(logger, __VA_ARGS__)
+#endif
+#if NIVEL_LOG_MINIMO <= 1
+#define cpu_log_debug(logger, ...) log_diferido(cpu_log_diferido, logger, configuracion()->nivel_log, LOG_LEVEL_DEBUG, __VA_ARGS__)
+#else
+#define cpu_log_debug(logger, ...) cpu_log_compilado_afuera(logger, __VA_ARGS__)
+#endif
+#if NIVEL_LOG_MINIMO <= 2
+#define cpu_log_info(logger, ...) log_diferido(cpu_log_diferido, logger, configuracion()->nivel_log, LOG_LEVEL_INFO, __VA_ARGS__)
+#else
+#define cpu_log_info(logger, ...) cpu_log_compilado_afuera(logger, __VA_ARGS__)
+#endif
+
+/* CONEXIONES */
+// Al arrancar, memoria (todos sus fragmentos), kernel dispatch y kernel interrupt se conectan a la vez (ver establecer_conexiones())
+typedef struct {
+    char* nombre;                  // para los logs
+    char* direccion;               // unix:/ruta o tcp:host:puerto?opciones
+    int socket;                    // -1 mientras se espera para reintentar
+    bool conectado;
+    int intentos;
+    int espera_ms;                 // espera después del próximo fallo
+    int64_t proximo_intento_ns;
+    int64_t conectado_ns;          // cuánto tardó en conectar desde el inicio del arranque
+} t_intento_conexion;
 
 /* FUNCIONES */
 void leer_config();
 void inicializar_configCPU();
 t_log* inicializar_logger(char* nombre);
+void cerrar_cpu_virtual(t_log* cpu_logger);
 void cerrar_cpu(t_log* cpu_logger);
 void conexiones(char* cpu_id,t_log* cpu_logger);
 void atender_memoria(t_log* cpu_logger);
 void atender_kernel(t_log* cpu_logger);
-void conectar_memoria(t_log* cpu_logger);
-void conectar_kernel(char* cpu_id, t_log* cpu_logger); 
+char* direccion_de_modulo(char* direccion, char* ip, char* puerto);
+void establecer_conexiones(char* cpu_id, t_log* cpu_logger);
+void iniciar_intento_conexion(t_intento_conexion* intento, char* nombre, char* direccion);
+bool conectar_en_paralelo(t_intento_conexion* intentos, int cantidad, int64_t inicio, t_log* cpu_logger);
+void programar_reintento(t_intento_conexion* intento, int error, int64_t ahora, t_log* cpu_logger);
+void enviar_handshake_kernel(int socket_kernel, int tipo_handshake, char* cpu_id);
+int enviar_handshake_memoria(t_fragmento_memoria* fragmento, t_canal_compartido** canal, t_log* cpu_logger);
+void recibir_handshake_memoria(t_fragmento_memoria* fragmento, int capacidades, t_canal_compartido* canal, t_log* cpu_logger);
 
 /* CICLO de INSTRUCCIONES */
+// decode() deja la instrucción en el decodificador de la CPU virtual, sin reservar memoria: el mensaje se copia
+// a su texto (que crece del pool solo si llega una instrucción más larga que todas las anteriores) y los
+// parámetros apuntan ahí. La instrucción vale hasta el próximo decode() del mismo hilo.
+#define MAX_PARAMETROS_INSTRUCCION 4
+
+typedef struct {
+    t_instruccion instruccion;
+    char* parametros[MAX_PARAMETROS_INSTRUCCION];
+    char* texto;       // copia del mensaje de la instrucción (del pool)
+    int capacidad;
+} t_decodificador;
+
+extern __thread t_decodificador decodificador;
+
 void fetch(t_log* cpu_logger);
+void pedir_instruccion(t_log* cpu_logger);
+void solicitar_instruccion(int pc_solicitado);
+void abandonar_instruccion_pedida(void);
+uint64_t controlar_reservas_del_ciclo(uint64_t reservas_antes, t_log* cpu_logger);
+bool ejecutar_instruccion_pedida(t_log* cpu_logger);
 //bool decode(t_instruccion* instruccion);
 void execute (t_instruccion* instruccion, t_log* cpu_logger);
 void comenzar_ciclo_instruccion(t_log* cpu_logger);
 t_instruccion* solicitar_instruccion_a_memoria();
 t_instruccion* decode(t_buffer* buffer);
-void check_interrupt(t_instruccion* instruccion, t_log* cpu_logger);
+void liberar_decodificador(void);
+bool check_interrupt(t_instruccion* instruccion, t_log* cpu_logger);
+bool atender_interrupcion(t_log* cpu_logger);
+bool esperar_instruccion_o_interrupcion(t_log* cpu_logger);
 
 bool es_syscall(t_instruccion* instruccion);
 
-void enviar_instruccion_a_kernel(t_instruccion* instruccion, t_log* cpu_logger);
+int enviar_instruccion_a_kernel(t_instruccion* instruccion, t_log* cpu_logger);
 bool hay_alguna_interrupcion(void);
 
-extern bool interrupt;
-extern int pid;
-extern int pc;
+extern __thread t_buzon_interrupcion buzon_principal;
+extern __thread t_buzon_interrupcion* buzon_interrupcion;
+extern __thread int pid;
+extern __thread int pc;
 
-extern int tam_pagina;
-extern int tam_memoria;
-extern int entradas_tabla;
-extern int cantidad_niveles;
+extern __thread int tam_pagina;
+extern __thread int tam_memoria;
+extern __thread int entradas_tabla;
+extern __thread int cantidad_niveles;
 
-extern int frame;
-extern int desplazamiento;
+extern __thread int desplazamiento;
 
-extern t_list* lista_tlb;
+extern __thread t_list* lista_tlb;
+extern __thread int accesos_cache;
 #endif
\ No newline at end of file
@@ -0,0 +1,27 @@
+#ifndef CPUS_VIRTUALES_H_
+#define CPUS_VIRTUALES_H_
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <pthread.h>
+#include <commons/log.h>
+
+/* CPUS VIRTUALES */
+// Un proceso puede correr CPUS_VIRTUALES CPUs, cada una en su hilo (y con FIJAR_NUCLEOS, en su núcleo).
+// El estado del ciclo de instrucción (PID, PC, sockets, TLB, caché, buzón...) es __thread en cpu_global.c,
+// así que cada CPU virtual tiene el suyo sin pasarlo por parámetro; lo compartido es la configuración,
+// los logs y la traza. Cada una se conecta por su cuenta a memoria y al kernel como <cpu_id>_<n>.
+typedef struct {
+    int id;
+    char* id_kernel;     // identificador con el que se anuncia al kernel
+    int nucleo;          // núcleo al que se fija el hilo, -1 si no se fija
+    t_log* logger;
+    pthread_t hilo;
+} t_cpu_virtual;
+
+void ejecutar_cpus_virtuales(char* cpu_id, t_log* cpu_logger);
+void* correr_cpu_virtual(void* arg);
+int nucleo_para_cpu_virtual(int indice);
+void fijar_a_nucleo(t_cpu_virtual* cpu);
+
+#endif
@@ -0,0 +1,87 @@
+#ifndef ESTADISTICAS_H_
+#define ESTADISTICAS_H_
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdint.h>
+#include <stdbool.h>
+#include <pthread.h>
+#include <commons/log.h>
+#include <commons/collections/list.h>
+#include <utils/contadores.h>
+
+/* ESTADISTICAS DEL CAMINO CALIENTE */
+// Cada CPU virtual cuenta en su t_estadisticas_cpu (__thread) los hits, misses y reemplazos de la TLB y la caché,
+// las instrucciones por PID y las interrupciones. Solo su hilo escribe sus contadores: sumar es un load y un store
+// relajados, sin lock ni instrucción atómica. Los bytes y mensajes por op_code los cuenta utils (contadores.h).
+// Un hilo aparte suma todo cuando llega SIGUSR1, cada PERIODO_ESTADISTICAS ms y al cerrar, y lo escribe como
+// líneas CLAVE=valor en <ESTADISTICAS>.<cpu_id> (reemplazando el archivo entero) o, sin la clave, en el log.
+#define PIDS_CONTADOS 256 // por CPU virtual; los PIDs de más se suman en INSTRUCCIONES_OTROS_PIDS
+
+typedef struct {
+    _Atomic int pid_mas_uno;     // 0: lugar libre
+    t_contador instrucciones;
+} t_instrucciones_pid;
+
+typedef struct {
+    t_contador tlb_hits;
+    t_contador tlb_misses;
+    t_contador tlb_reemplazos;
+    t_contador cache_hits;
+    t_contador cache_misses;
+    t_contador cache_reemplazos;
+    t_contador cache_reemplazos_modificadas;  // los que escribieron la página en memoria
+    t_contador instrucciones;
+    t_contador instrucciones_otros_pids;
+    t_contador interrupciones_atendidas;
+    t_contador interrupciones_descartadas;  // dirigidas a otro PID
+    t_instrucciones_pid por_pid[PIDS_CONTADOS];
+    int ultimo_pid;                         // índice del último PID contado, solo lo usa el hilo dueño
+} t_estadisticas_cpu;
+
+typedef struct {
+    uint64_t tlb_hits;
+    uint64_t tlb_misses;
+    uint64_t tlb_reemplazos;
+    uint64_t cache_hits;
+    uint64_t cache_misses;
+    uint64_t cache_reemplazos;
+    uint64_t cache_reemplazos_modificadas;
+    uint64_t instrucciones;
+    uint64_t instrucciones_otros_pids;
+    uint64_t interrupciones_atendidas;
+    uint64_t interrupciones_descartadas;
+    int pids[PIDS_CONTADOS];
+    uint64_t instrucciones_pid[PIDS_CONTADOS];
+    int cantidad_pids;
+} t_totales_cpu;
+
+typedef struct {
+    pthread_mutex_t mutex;                  // protege hilos y terminados
+    t_list* hilos;                          // t_estadisticas_cpu* de las CPU virtuales que están corriendo
+    t_totales_cpu terminados;               // lo que contaron las CPU virtuales que ya cerraron
+    char* archivo;                          // NULL: al log
+    int senal;                              // signalfd de SIGUSR1
+    int despertar;                          // eventfd para terminar o tomar un PERIODO_ESTADISTICAS nuevo
+    _Atomic bool fin;
+    pthread_t hilo;
+    t_log* logger;
+} t_volcado_estadisticas;
+
+#define CONTAR(campo) SUMAR_CONTADOR(estadisticas_cpu.campo, 1)
+
+void contar_instruccion(void);
+void anotar_estadisticas_del_hilo(void);
+void retirar_estadisticas_del_hilo(void);
+void sumar_estadisticas(t_totales_cpu* totales, t_estadisticas_cpu* estadisticas);
+void acumular_totales(t_totales_cpu* totales, const t_totales_cpu* otros);
+void sumar_instrucciones_pid(t_totales_cpu* totales, int pid, uint64_t instrucciones);
+char* armar_volcado_estadisticas(void);
+void volcar_estadisticas(void);
+void bloquear_senal_estadisticas(void);
+void* esperar_volcado_estadisticas(void* arg);
+void iniciar_estadisticas(char* cpu_id, t_log* cpu_logger);
+void avisar_periodo_estadisticas(void);
+void detener_estadisticas(void);
+
+#endif
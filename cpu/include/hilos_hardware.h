@@ -0,0 +1,58 @@
+#ifndef HILOS_HARDWARE_H_
+#define HILOS_HARDWARE_H_
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <utils/utils.h>
+#include <utils/eventos.h>
+#include "interrupciones.h"
+#include "buffer_escrituras.h"
+#include "memoria_cpu.h"
+#include "huellas.h"
+
+/* HILOS DE HARDWARE (SMT) sobre el bucle de eventos */
+typedef enum {
+    CONTEXTO_LIBRE,              // esperando que el kernel despache un proceso
+    CONTEXTO_ESPERANDO_MEMORIA,  // con un FETCH pendiente de respuesta
+    CONTEXTO_EN_RETARDO,         // esperando que venza el RETARDO_CACHE de la ultima instruccion
+    CONTEXTO_TERMINADO           // el kernel o memoria cerraron la conexion
+} t_estado_contexto;
+
+typedef struct {
+    int id;
+    int pid;
+    int pc;
+    t_buzon_interrupcion buzon;
+    t_fragmento_memoria* fragmentos_memoria;
+    int socket_memoria;                 // el del fragmento del proceso
+    t_lector_socket* lector_memoria;
+    t_tabla_pedidos* pedidos_memoria;
+    t_buffer_escrituras* escrituras_pendientes;
+    t_calentamiento* calentamiento;
+    uint32_t pedido_instruccion;
+    int pc_pedido;
+    int socket_kernel_dispatch;
+    int socket_kernel_interrupt;
+    t_estado_contexto estado;
+
+    t_log* logger;
+    t_bucle_eventos* bucle;
+    t_conexion_eventos* dispatch;
+    t_conexion_eventos* interrupt;
+    t_registro_evento* memoria;         // socket del fragmento de memoria del proceso
+    t_registro_evento* temporizador;
+    int* contextos_activos;
+} t_contexto_hardware; // un proceso despachado dentro de la CPU
+
+void ejecutar_hilos_hardware(char* cpu_id, t_log* cpu_logger);
+void cargar_contexto(t_contexto_hardware* contexto);
+void guardar_contexto(t_contexto_hardware* contexto);
+void atender_dispatch_contexto(void* dato, int cod_op, t_buffer* buffer);
+void atender_interrupt_contexto(void* dato, int cod_op, t_buffer* buffer);
+void avanzar_contexto(void* dato);
+void vencer_retardo_contexto(void* dato);
+void esperar_memoria_contexto(t_contexto_hardware* contexto);
+void liberar_contexto(t_contexto_hardware* contexto);
+void terminar_contexto(t_contexto_hardware* contexto);
+
+#endif
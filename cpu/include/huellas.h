@@ -0,0 +1,74 @@
+#ifndef HUELLAS_H_
+#define HUELLAS_H_
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdint.h>
+#include <stdbool.h>
+#include <commons/log.h>
+#include "memoria_cpu.h"
+
+/* HUELLAS DE LOS PROCESOS EN TLB Y CACHÉ */
+// Las entradas de la TLB y de la caché llevan el PID. Cuando un proceso deja la CPU (IO o desalojo) se anotan
+// las páginas que tenía en la TLB y en la caché (su huella) y se liberan sus entradas. Cuando el kernel lo vuelve
+// a despachar, detrás del primer FETCH se piden de fondo sus traducciones y el contenido de sus páginas de caché:
+// no se reusan los marcos viejos porque memoria pudo moverlo mientras estaba suspendido. Las respuestas se cargan
+// a medida que llegan, o en el momento si una traducción o un acceso las necesita antes.
+// Cada CPU virtual recuerda HUELLAS_PROCESOS procesos (0 no guarda huellas) y olvida el que dejó la CPU hace más
+// tiempo. Pedir de fondo necesita PEDIDOS_MULTIPLEXADOS: sin ids las respuestas llegan en orden y se mezclarían con el FETCH.
+typedef struct {
+    int pagina;
+    int marco;                   // el que tenía al dejar la CPU; al volver se traduce de nuevo
+    bool en_tlb;
+    bool en_cache;
+} t_pagina_huella;
+
+typedef struct {
+    int pid;                     // -1 si el lugar está libre
+    t_pagina_huella* paginas;    // ENTRADAS_TLB + ENTRADAS_CACHE lugares; de la usada hace más tiempo a la más reciente
+    int cantidad;
+    uint64_t salida;             // orden en que el proceso dejó la CPU, para olvidar el más viejo
+} t_huella_proceso;
+
+typedef struct {
+    t_huella_proceso* huellas;   // HUELLAS_PROCESOS lugares, memoria fija desde que arranca la CPU virtual
+    int cantidad;
+    uint64_t salidas;
+} t_huellas;
+
+typedef enum {
+    CALENTANDO_MARCO,            // falta la traducción
+    CALENTANDO_CONTENIDO         // ya se sabe el marco, falta el contenido para la caché
+} t_etapa_calentamiento;
+
+typedef struct {
+    t_pagina_huella pagina;
+    t_etapa_calentamiento etapa;
+    int marco;                   // global, en CALENTANDO_CONTENIDO
+    t_fragmento_memoria* fragmento; // al que se le hizo el pedido en vuelo
+    uint32_t id_pedido;
+} t_pedido_calentamiento;
+
+typedef struct {
+    t_pedido_calentamiento* pedidos; // ENTRADAS_TLB + ENTRADAS_CACHE lugares
+    int cantidad;
+    bool enviado;                // false mientras espera que salga el primer FETCH
+} t_calentamiento; // pedidos de fondo del proceso cargado, uno por contexto
+
+int capacidad_huella(void);
+void iniciar_huellas(void);
+void destruir_huellas(void);
+t_calentamiento* crear_calentamiento(void);
+void destruir_calentamiento(t_calentamiento* pendiente);
+void dejar_tlb_y_cache_del_proceso(bool puede_volver);
+t_huella_proceso* lugar_para_huella(int pid_proceso);
+int juntar_huella(int pid_proceso, t_pagina_huella* paginas);
+void guardar_huella_del_proceso(void);
+void preparar_calentamiento(t_log* cpu_logger);
+void enviar_calentamiento(void);
+void avanzar_calentamiento(t_log* cpu_logger);
+void abandonar_calentamiento(void);
+bool tomar_marco_calentado(int nro_pagina, int* marco);
+bool tomar_contenido_calentado(int nro_pagina, char* destino, t_log* cpu_logger);
+
+#endif
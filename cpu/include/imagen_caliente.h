@@ -0,0 +1,69 @@
+#ifndef IMAGEN_CALIENTE_H_
+#define IMAGEN_CALIENTE_H_
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdint.h>
+#include <stdbool.h>
+#include <stdatomic.h>
+#include <commons/log.h>
+
+/* IMAGEN CALIENTE DE TLB Y CACHÉ */
+// Con IMAGEN_CALIENTE en cpu.config, cada CPU guarda en <IMAGEN_CALIENTE>.<cpu_id> (un archivo mapeado con mmap)
+// las huellas de sus procesos: PID, página, marco, si estaba en TLB o en caché y el orden de uso. Cada CPU virtual
+// escribe su región desde su hilo al cambiar de proceso (cada PERIODO_IMAGEN_CALIENTE ms como mucho) y al cerrar.
+// Al arrancar, cada CPU virtual carga su región como huellas; después del handshake se descarta si memoria no es la
+// misma (tamaño de página, niveles, marcos). Un proceso que vuelve se calienta como cualquier huella (ver huellas.h):
+// se traduce de nuevo, el marco guardado no se usa. Los enteros quedan en el endianness de la CPU que lo escribió.
+#define MAGIA_IMAGEN "CPUIMAGN"
+#define VERSION_IMAGEN 1
+
+typedef struct {
+    char magia[8];
+    uint32_t version;
+    uint32_t cpus_virtuales;
+    uint32_t huellas_por_region;   // HUELLAS_PROCESOS + HILOS_HARDWARE (los procesos cargados al escribir)
+    uint32_t paginas_por_huella;   // ENTRADAS_TLB + ENTRADAS_CACHE
+} t_cabecera_imagen;
+
+typedef struct {
+    _Atomic uint32_t secuencia;    // impar mientras la CPU virtual la escribe: si quedó así, la CPU se cayó a la mitad
+    int32_t tam_pagina;            // memoria con la que se armó
+    int32_t entradas_tabla;
+    int32_t cantidad_niveles;
+    int32_t tam_memoria;
+    int32_t cantidad;              // huellas escritas
+} t_region_imagen; // una por CPU virtual, seguida de huellas_por_region t_huella_imagen
+
+typedef struct {
+    int32_t pid;
+    int32_t cantidad;
+    uint64_t salida;               // orden en que el proceso dejó la CPU; los cargados al escribir van últimos
+} t_huella_imagen; // seguida de paginas_por_huella t_pagina_imagen
+
+typedef struct {
+    int32_t pagina;
+    int32_t marco;
+    uint8_t en_tlb;
+    uint8_t en_cache;
+    uint16_t relleno;
+} t_pagina_imagen; // de la usada hace más tiempo a la más reciente
+
+typedef struct {
+    int archivo;                   // -1 sin imagen
+    void* datos;
+    size_t tamanio;
+    size_t tamanio_region;
+    size_t tamanio_huella;         // con sus páginas
+    t_cabecera_imagen cabecera;
+} t_imagen_caliente;
+
+void abrir_imagen_caliente(char* ruta, char* cpu_id, t_log* cpu_logger);
+t_huella_imagen* huella_de_imagen(t_region_imagen* region, int indice);
+void cargar_imagen_caliente(int cpu_virtual, t_log* cpu_logger);
+void validar_imagen_con_memoria(t_log* cpu_logger);
+void escribir_imagen_caliente(void);
+void actualizar_imagen_caliente(void);
+void cerrar_imagen_caliente(void);
+
+#endif
@@ -0,0 +1,46 @@
+#ifndef INTERRUPCIONES_H_
+#define INTERRUPCIONES_H_
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdint.h>
+#include <stdatomic.h>
+#include <utils/utils.h>
+
+#define PID_CUALQUIERA -1
+#define CANTIDAD_BUCKETS_LATENCIA 40
+
+typedef enum {
+    INTERRUPCION_DESALOJO       // el planificador del kernel desaloja al proceso
+} t_motivo_interrupcion;
+
+/* BUZON DE INTERRUPCIONES */
+// Lo escribe el hilo que escucha interrupt y lo consume el ciclo de instruccion.
+// PID y motivo viajan en una sola palabra atomica para que nunca se lean mezclados.
+typedef struct {
+    _Atomic uint64_t carta;        // 0 = vacio
+    _Atomic int64_t llegada_ns;    // momento en que llego la interrupcion
+    int eventfd;                   // -1 si no se usa INTERRUPCION_EVENTFD
+} t_buzon_interrupcion;
+
+typedef struct {
+    int pid;
+    t_motivo_interrupcion motivo;
+    int64_t llegada_ns;
+} t_interrupcion;
+
+extern _Atomic uint64_t latencias_interrupcion[CANTIDAD_BUCKETS_LATENCIA];
+
+void iniciar_buzon_interrupcion(t_buzon_interrupcion* buzon, bool usar_eventfd);
+void destruir_buzon_interrupcion(t_buzon_interrupcion* buzon);
+void publicar_interrupcion(t_buzon_interrupcion* buzon, int pid_objetivo, t_motivo_interrupcion motivo);
+void dejar_en_buzon(t_buzon_interrupcion* buzon, int pid_objetivo, t_motivo_interrupcion motivo, int64_t llegada_ns);
+bool tomar_interrupcion(t_buzon_interrupcion* buzon, t_interrupcion* interrupcion);
+void vaciar_buzon_al_despachar(t_buzon_interrupcion* buzon, int pid_despachado);
+bool hay_interrupcion_pendiente(t_buzon_interrupcion* buzon);
+
+int64_t tiempo_actual_ns(void);
+void registrar_latencia_interrupcion(int64_t latencia_ns);
+void loguear_latencias_interrupcion(t_log* cpu_logger);
+
+#endif
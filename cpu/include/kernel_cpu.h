@@ -4,8 +4,21 @@
 #include <stdio.h>
 #include <stdlib.h>
 #include <utils/utils.h>
+#include "interrupciones.h"
 
+typedef struct {
+    int socket_kernel_interrupt;
+    t_buzon_interrupcion* buzon;
+    t_log* logger;
+} t_escucha_interrupt; // lo que necesita el hilo de interrupt de su CPU virtual
 
 void atender_kernel_cpu_interrupt(t_log* cpu_logger);
+void* escuchar_kernel_interrupt(void* arg);
 void atender_kernel_cpu_dispatch(t_log* cpu_logger);
+void recibir_handshake_kernel(int socket_kernel, t_log* cpu_logger);
+void procesar_handshake_kernel(t_buffer* b_handshake_recv, t_log* cpu_logger);
+void recibir_proceso_a_ejecutar(t_log* cpu_logger);
+void cargar_proceso_a_ejecutar(t_buffer* buffer, t_log* cpu_logger);
+void recibir_interrupcion(int socket_kernel, t_buzon_interrupcion* buzon);
+void cargar_interrupcion(t_buffer* buffer, t_buzon_interrupcion* buzon);
 #endif
\ No newline at end of file
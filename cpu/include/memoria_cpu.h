@@ -4,7 +4,56 @@
 #include <stdio.h>
 #include <stdlib.h>
 #include <utils/utils.h>
+#include "mmu.h"
 
+/* FRAGMENTOS DE MEMORIA */
+// Con FRAGMENTOS_MEMORIA la CPU se conecta a varias memorias. Las tablas de páginas y las instrucciones
+// de un proceso están en un solo fragmento, elegido por PID con hash consistente (agregar un fragmento
+// mueve solo la parte de los procesos que le toca al nuevo). Los marcos se reparten en rangos fijos: cada
+// fragmento informa en el handshake su primer marco, o se toman consecutivos en el orden de la config.
+// La tabla de páginas devuelve marcos globales y a cada fragmento se le mandan relativos a su primer
+// marco, así una memoria sola es el caso de un fragmento. socket_memoria, lector_memoria y
+// pedidos_memoria son siempre los del fragmento del proceso actual.
+typedef struct {
+    char* direccion;
+    int socket;
+    t_lector_socket* lector;
+    t_tabla_pedidos* pedidos;
+    int primer_marco;        // primer marco global que guarda
+    int cantidad_marcos;
+} t_fragmento_memoria;
+
+typedef struct {
+    t_fragmento_memoria* fragmento;
+    int primero;             // primer segmento del tramo
+    int cantidad;
+    int posicion;            // byte de los datos del acceso donde empieza el tramo
+    uint32_t id_pedido;
+} t_tramo_memoria; // segmentos consecutivos de un READ o WRITE que viajan en un mismo pedido
 
 void atender_memoria_cpu(t_log* cpu_logger);
-#endif
\ No newline at end of file
+t_canal_compartido* crear_canal_memoria(t_log* cpu_logger);
+int enviar_a_memoria(t_constructor_paquete* paquete);
+uint32_t iniciar_pedido_a_memoria(t_constructor_paquete* paquete, op_code_t cod_op, void* almacenamiento, int capacidad);
+int recibir_de_memoria(uint32_t id, t_buffer* respuesta);
+bool respuesta_de_memoria_disponible(uint32_t id);
+void descartar_respuesta_de_memoria(uint32_t id);
+int fragmento_de_pid(int pid_proceso);
+t_fragmento_memoria* fragmento_de_marco(int marco);
+void usar_fragmento_del_proceso(void);
+void cerrar_fragmentos_memoria(t_fragmento_memoria* fragmentos);
+int enviar_a_fragmento(t_fragmento_memoria* fragmento, t_constructor_paquete* paquete);
+int enviar_lote_a_fragmento(t_fragmento_memoria* fragmento, t_constructor_paquete* paquetes, int cantidad);
+uint32_t iniciar_pedido_a_fragmento(t_fragmento_memoria* fragmento, t_constructor_paquete* paquete, op_code_t cod_op, void* almacenamiento, int capacidad);
+int recibir_de_fragmento(t_fragmento_memoria* fragmento, uint32_t id, t_buffer* respuesta);
+bool respuesta_de_fragmento_disponible(t_fragmento_memoria* fragmento, uint32_t id);
+void descartar_respuesta_de_fragmento(t_fragmento_memoria* fragmento, uint32_t id);
+void cargar_segmento_al_pedido(t_constructor_paquete* paquete, t_fragmento_memoria* fragmento, t_segmento_fisico* segmento, bool con_tamanio);
+int armar_tramos(t_segmento_fisico* segmentos, int cantidad, t_tramo_memoria* tramos);
+void enviar_lectura(t_tramo_memoria* tramo, t_segmento_fisico* segmentos);
+bool recibir_lectura(t_tramo_memoria* tramo, t_segmento_fisico* segmentos, char* destino, t_log* cpu_logger);
+void enviar_escritura(t_tramo_memoria* tramo, t_segmento_fisico* segmentos, char* datos, bool termina);
+bool recibir_confirmacion_de_escritura(t_tramo_memoria* tramo, t_log* cpu_logger);
+bool leer_de_memoria(int direccion_logica, int tamanio, char* destino, t_log* cpu_logger);
+bool escribir_en_memoria(int direccion_logica, char* datos, t_log* cpu_logger);
+#endif
@@ -8,20 +8,76 @@
 
 /* TLB y MEMORIA*/
 typedef struct {
+    int pid;           // proceso de la página, -1 si la entrada está libre
     int numero_pagina;
     int marco;
-    time_t tstamp_creado;
-    time_t tstamp_ultima_vez_usado;
+    time_t time_creado;
+    time_t time_usado;
 } t_entrada_TLB; //cada cuadradito
 
+/* ACCESOS QUE CRUZAN PAGINAS */
+typedef struct {
+    int marco;
+    int desplazamiento;
+    int tamanio;
+} t_segmento_fisico; // parte de un rango lógico que cae dentro de una sola página
+
+#define MAXIMO_SEGMENTOS(tamanio) ((tamanio) / tam_pagina + 2) // segmentos que puede necesitar un rango de ese tamaño
+
+/* CACHE DE PAGINAS */
+#define ESTA_LLENA -1 // encontrar_vacio(): no quedan entradas libres
+
+typedef struct {
+    int pid;           // proceso de la página, -1 si la entrada está libre
+    int numero_pagina;
+    int marco;
+    char* contenido;
+    bool bit_uso;
+    bool bit_modificado;
+    bool presente;
+} t_entrada_cache;
+
+extern __thread t_list* lista_cache;
+extern __thread t_entrada_cache* entrada_cache_libre;
+
 void iniciar_TLB(void);
 t_entrada_TLB* buscar_en_TLB(int numero_pagina);
 int traducir_dir_logica(int direccion_logica, t_log* logger);
+int traducir_pagina(int nro_pagina);
+void calcular_indices_tabla(int nro_pagina, int vec[]);
+int segmentar_rango_logico(int direccion_logica, int tamanio, t_segmento_fisico* segmentos);
 void actualizar_TLB(t_entrada_TLB* registro_tlb_nuevo);
+void escribir_entrada_TLB(int indice, t_entrada_TLB* registro_tlb_nuevo);
 void reemplazar_TLB_LRU(t_entrada_TLB* registro_tlb_nuevo);
 int verificar_reemplazo_TLB(void);
 int existe_entrada_con_marco(t_entrada_TLB* registro_tlb_nuevo);
 int solicitar_direcciones_memoria(int vec[], int cantidad_niveles, t_log* cpu_logger, int nro_pagina);
 void reemplazar_TLB_FIFO(t_entrada_TLB* registro_tlb_nuevo);
+int obtener_marco(int nro_pagina, int vec[]);
+void cargar_en_TLB(int nro_pagina, int marco);
+int buscar_marco_en_memoria(int vec[], t_log* cpu_logger, int nro_pagina);
+uint32_t pedir_marco_a_memoria(int vec[], int nro_pagina);
+uint32_t armar_pedido_de_marco(t_constructor_paquete* paquete, int vec[], int nro_pagina, void* almacenamiento, int capacidad);
+int recibir_marco_de_memoria(uint32_t id_pedido, t_log* cpu_logger);
+
+void inicializar_cache(void);
+bool cache_habilitada(void);
+bool obtener_contenido_memoria(int marco, int nro_pagina, char* destino, t_log* cpu_logger);
+uint32_t pedir_contenido_a_memoria(int marco, int nro_pagina);
+bool recibir_contenido_de_memoria(uint32_t id_pedido, int marco, int nro_pagina, char* destino, t_log* cpu_logger);
+void cargar_contenido_cache(t_log* cpu_logger, int direccion_logica, int operacion, char* origen);
+t_entrada_cache* buscar_en_cache(int nro_pagina);
+t_entrada_cache* crear_entrada_cache(int nro_pagina, int marco);
+void devolver_entrada_cache(t_entrada_cache* entrada);
+void actualizar_entrada_cache(t_entrada_cache* entrada_cache_aux);
+int encontrar_vacio(void);
+void avanzar_puntero(void);
+void escribir_pagina_en_memoria(t_entrada_cache* entrada);
+uint32_t armar_escritura_de_pagina(t_constructor_paquete* paquete, t_entrada_cache* entrada, void* almacenamiento, int capacidad);
+void escribir_paginas_modificadas_del_proceso(void);
+void reemplazar_cache_CLOCK(t_entrada_cache* nueva_entrada);
+void reemplazar_cache_CLOCK_M(t_entrada_cache* nueva_entrada);
+void destruir_entrada_cache(t_entrada_cache* entrada);
+void liberar_tlb_y_cache_del_proceso(void);
 
 #endif
\ No newline at end of file
@@ -0,0 +1,58 @@
+#ifndef TRAZA_H_
+#define TRAZA_H_
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <pthread.h>
+
+/* TRAZA BINARIA */
+// Un registro fijo por instrucción ejecutada (TRAZA_BINARIA en cpu.config), en el orden en que se ejecutaron.
+// El archivo empieza con una t_cabecera_traza; los enteros quedan en el endianness de la CPU que lo escribió.
+// Se lee con bin/decodificar_traza (make decodificador). No incluye nada de commons para que la herramienta compile sola.
+#define MAGIA_TRAZA "CPUTRAZA"
+#define VERSION_TRAZA 1
+#define REGISTROS_POR_TANDA_TRAZA 128 // se escriben de a 4 KiB
+
+typedef enum {
+    TRAZA_SIN_ACCESO,   // la instrucción no pasó por la TLB / la caché
+    TRAZA_HIT,
+    TRAZA_MISS          // si un acceso que cruza páginas tuvo algún miss, queda miss
+} t_resultado_traza;
+
+typedef struct {
+    char magia[8];
+    uint32_t version;
+    uint32_t tamanio_registro;
+} t_cabecera_traza;
+
+typedef struct {
+    uint64_t tiempo_ns;          // CLOCK_MONOTONIC al terminar el execute
+    int32_t pid;
+    int32_t pc;
+    int32_t operacion;           // t_operacion
+    int32_t direccion_logica;    // -1 si la instrucción no accede a memoria
+    int32_t direccion_fisica;    // del primer byte accedido, -1 si no accede
+    uint8_t tlb;                 // t_resultado_traza
+    uint8_t cache;               // t_resultado_traza
+    uint16_t reservado;
+} t_registro_traza;
+
+_Static_assert(sizeof(t_registro_traza) == 32, "t_registro_traza tiene que ocupar 32 bytes");
+
+typedef struct {
+    int archivo;                 // -1 sin TRAZA_BINARIA
+    pthread_mutex_t mutex;
+    t_registro_traza tanda[REGISTROS_POR_TANDA_TRAZA];
+    int registros_en_tanda;
+} t_traza;
+
+void abrir_traza(char* archivo);
+void iniciar_registro_traza(int operacion);
+void anotar_acceso_traza(int direccion_logica, int direccion_fisica);
+void anotar_tlb_traza(bool hit);
+void anotar_cache_traza(bool hit);
+void registrar_traza(void);
+void escribir_tanda_traza(void);
+void cerrar_traza(void);
+
+#endif
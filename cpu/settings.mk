@@ -6,8 +6,9 @@ SHARED_LIBPATHS=
 STATIC_LIBPATHS=../utils
 
 # Compiler flags
+# NIVEL_LOG_MINIMO: los cpu_log_* de menor nivel no se compilan (0 TRACE, 1 DEBUG, 2 INFO)
 CDEBUG=-g -Wall -DDEBUG -fdiagnostics-color=always
-CRELEASE=-O3 -Wall -DNDEBUG
+CRELEASE=-O3 -Wall -DNDEBUG -DNIVEL_LOG_MINIMO=2
 
 # Source files (*.c) to be excluded from tests compilation
 TEST_EXCLUDE=src/main.c
@@ -0,0 +1,303 @@
+#include "../include/cpu.h"
+
+/**
+* @fn     t_buffer_escrituras* crear_buffer_escrituras(void)
+* @brief  Crea un buffer de escrituras vacío para una CPU. Sus escrituras pueden ir a distintos fragmentos de memoria, según el marco.
+* @param  Ninguno
+* @return Buffer creado.
+*/
+t_buffer_escrituras* crear_buffer_escrituras(void) {
+    t_buffer_escrituras* buffer = malloc(sizeof(t_buffer_escrituras));
+    buffer->cantidad = 0;
+    return buffer;
+}
+
+/**
+* @fn     void destruir_buffer_escrituras(t_buffer_escrituras* buffer)
+* @brief  Libera el buffer de escrituras y lo que tenga adentro, sin mandarlo a memoria. Acepta NULL.
+* @param  buffer Buffer a destruir.
+* @return Ninguno
+*/
+void destruir_buffer_escrituras(t_buffer_escrituras* buffer) {
+    if (buffer == NULL) {
+        return;
+    }
+    for (int i = 0; i < buffer->cantidad; i++) {
+        devolver_al_pool(buffer->escrituras[i].datos);
+    }
+    free(buffer);
+}
+
+/**
+* @fn     void quitar_escritura(int indice)
+* @brief  Saca una escritura del buffer actual manteniendo el orden de las demás.
+* @param  indice Posición de la escritura a sacar.
+* @return Ninguno
+*/
+void quitar_escritura(int indice) {
+    t_buffer_escrituras* buffer = escrituras_pendientes;
+    devolver_al_pool(buffer->escrituras[indice].datos);
+    memmove(&buffer->escrituras[indice], &buffer->escrituras[indice + 1], (buffer->cantidad - indice - 1) * sizeof(t_escritura));
+    buffer->cantidad--;
+}
+
+/**
+* @fn     bool segmentos_se_tocan(t_segmento_fisico* a, t_segmento_fisico* b)
+* @brief  Indica si dos segmentos están en el mismo marco y se solapan o quedan uno pegado al otro.
+* @param  a Primer segmento.
+* @param  b Segundo segmento.
+* @return true si se pueden juntar en una sola escritura.
+*/
+bool segmentos_se_tocan(t_segmento_fisico* a, t_segmento_fisico* b) {
+    return a->marco == b->marco
+        && b->desplazamiento <= a->desplazamiento + a->tamanio
+        && a->desplazamiento <= b->desplazamiento + b->tamanio;
+}
+
+/**
+* @fn     bool recibir_confirmacion_escritura(t_fragmento_memoria* fragmento, uint32_t id_pedido, t_segmento_fisico* segmento)
+* @brief  Espera la confirmación de un pedido de escritura. Si memoria no la confirma, lo loguea como error con el PID y la dirección: el WRITE ya se había retirado.
+* @param  fragmento Fragmento de memoria al que se mandó el pedido.
+* @param  id_pedido Pedido a esperar.
+* @param  segmento Primer segmento del pedido, para el log.
+* @return true si memoria confirmó la escritura.
+*/
+bool recibir_confirmacion_escritura(t_fragmento_memoria* fragmento, uint32_t id_pedido, t_segmento_fisico* segmento) {
+    t_buffer respuesta;
+    if (recibir_de_fragmento(fragmento, id_pedido, &respuesta) != M_CPU_CONFIRMACION_ESCRITURA) {
+        log_error(cpu_logger, "## PID: %d - Memoria no confirmó la escritura en la dirección física %d", pid, segmento->marco * tam_pagina + segmento->desplazamiento);
+        return false;
+    }
+    return true;
+}
+
+/**
+* @fn     bool esperar_confirmacion_escritura(t_escritura* escritura)
+* @brief  Espera la confirmación del pedido multiplexado que lleva una escritura en vuelo y saca del buffer todas las escrituras de ese pedido. Los ids son de la tabla de cada fragmento: el pedido se identifica por id y fragmento.
+* @param  escritura Escritura en vuelo del buffer actual.
+* @return true si memoria confirmó el pedido.
+*/
+bool esperar_confirmacion_escritura(t_escritura* escritura) {
+    t_fragmento_memoria* fragmento = fragmento_de_marco(escritura->segmento.marco);
+    uint32_t id_pedido = escritura->id_pedido;
+    bool ok = recibir_confirmacion_escritura(fragmento, id_pedido, &escritura->segmento);
+
+    t_buffer_escrituras* buffer = escrituras_pendientes;
+    for (int i = buffer->cantidad - 1; i >= 0; i--) {
+        t_escritura* actual = &buffer->escrituras[i];
+        if (actual->estado == ESCRITURA_EN_VUELO && actual->id_pedido == id_pedido && fragmento_de_marco(actual->segmento.marco) == fragmento) {
+            quitar_escritura(i);
+        }
+    }
+    return ok;
+}
+
+/**
+* @fn     bool encolar_escritura(t_segmento_fisico* segmento, char* datos)
+* @brief  Retira un WRITE dejándolo en el buffer. Si toca a una escritura pendiente del mismo marco se junta con la más nueva de ellas; si no, ocupa una entrada nueva, vaciando el buffer si estaba lleno.
+* @param  segmento Segmento a escribir. El último de un WRITE lleva además el \0, que puede quedar un byte después del final de la página, como en enviar_escritura().
+* @param  datos Bytes a escribir (segmento->tamanio).
+* @return false si para hacer lugar hubo que esperar confirmaciones y memoria no confirmó alguna.
+*/
+bool encolar_escritura(t_segmento_fisico* segmento, char* datos) {
+    t_buffer_escrituras* buffer = escrituras_pendientes;
+    if (segmento->tamanio == 0) {
+        return true;
+    }
+
+    for (int i = buffer->cantidad - 1; i >= 0 && buffer->escrituras[i].estado == ESCRITURA_PENDIENTE; i--) { //las en vuelo son siempre las más viejas
+        t_escritura* escritura = &buffer->escrituras[i];
+        if (segmentos_se_tocan(&escritura->segmento, segmento)) {
+            int inicio = escritura->segmento.desplazamiento < segmento->desplazamiento ? escritura->segmento.desplazamiento : segmento->desplazamiento;
+            int fin_actual = escritura->segmento.desplazamiento + escritura->segmento.tamanio;
+            int fin_nuevo = segmento->desplazamiento + segmento->tamanio;
+            memcpy(escritura->datos + segmento->desplazamiento, datos, segmento->tamanio);
+            escritura->segmento.desplazamiento = inicio;
+            escritura->segmento.tamanio = (fin_actual > fin_nuevo ? fin_actual : fin_nuevo) - inicio;
+            return true;
+        }
+    }
+
+    bool ok = true;
+    if (buffer->cantidad == MAX_ESCRITURAS_PENDIENTES) {
+        ok = vaciar_buffer_escrituras();
+        ok = retirar_escrituras_confirmadas() && ok;
+        if (buffer->cantidad == MAX_ESCRITURAS_PENDIENTES) {
+            ok = esperar_confirmacion_escritura(&buffer->escrituras[0]) && ok;
+        }
+    }
+
+    t_escritura* escritura = &buffer->escrituras[buffer->cantidad++];
+    escritura->segmento = *segmento;
+    escritura->datos = reservar_del_pool(tam_pagina + 1, NULL);
+    memcpy(escritura->datos + segmento->desplazamiento, datos, segmento->tamanio);
+    escritura->estado = ESCRITURA_PENDIENTE;
+    return ok;
+}
+
+/**
+* @fn     int enviar_escrituras(t_fragmento_memoria* fragmento, int desde, int hasta)
+* @brief  Manda al fragmento las escrituras del buffer en [desde, hasta) que caen en él y las deja en vuelo. Si memoria aceptó accesos vectorizados van todas en un CPU_M_ESCRIBIR_MEMORIA; si no, una por pedido, y los pedidos salen juntos en un mismo envío.
+* @param  fragmento Fragmento de memoria destino.
+* @param  desde Primera escritura a considerar.
+* @param  hasta Una después de la última.
+* @return Cantidad de pedidos enviados.
+*/
+int enviar_escrituras(t_fragmento_memoria* fragmento, int desde, int hasta) {
+    t_buffer_escrituras* buffer = escrituras_pendientes;
+    char almacenamiento[CAPACIDAD_CONSTRUCTOR_PILA];
+    t_constructor_paquete paquetes[MAX_ESCRITURAS_PENDIENTES];
+    uint32_t id_pedido = 0;
+    int cantidad = 0;
+
+    for (int i = desde; i < hasta; i++) {
+        t_escritura* escritura = &buffer->escrituras[i];
+        if (fragmento_de_marco(escritura->segmento.marco) != fragmento) {
+            continue;
+        }
+        if (cantidad == 0 || !accesos_en_lote) { //el primero usa la pila, los demás el pool
+            id_pedido = iniciar_pedido_a_fragmento(fragmento, &paquetes[cantidad], CPU_M_ESCRIBIR_MEMORIA, cantidad == 0 ? almacenamiento : NULL, sizeof(almacenamiento));
+            cantidad++;
+        }
+        t_constructor_paquete* paquete = &paquetes[cantidad - 1];
+        cargar_segmento_al_pedido(paquete, fragmento, &escritura->segmento, false);
+        agregar_al_constructor(paquete, escritura->datos + escritura->segmento.desplazamiento, escritura->segmento.tamanio);
+        escritura->estado = ESCRITURA_EN_VUELO;
+        escritura->id_pedido = id_pedido;
+    }
+    if (cantidad > 0) {
+        enviar_lote_a_fragmento(fragmento, paquetes, cantidad);
+    }
+    return cantidad;
+}
+
+/**
+* @fn     bool vaciar_buffer_escrituras(void)
+* @brief  Manda a memoria las escrituras pendientes (ver enviar_escrituras()). Los pedidos a fragmentos distintos viajan a la vez. Con pedidos multiplexados no espera las confirmaciones; sin ids las espera, porque si no la próxima respuesta que se lea sería una confirmación.
+* @param  Ninguno
+* @return false si se esperaron confirmaciones y memoria no confirmó alguna.
+*/
+bool vaciar_buffer_escrituras(void) {
+    t_buffer_escrituras* buffer = escrituras_pendientes;
+    int primera = 0;
+    while (primera < buffer->cantidad && buffer->escrituras[primera].estado == ESCRITURA_EN_VUELO) {
+        primera++;
+    }
+    if (primera == buffer->cantidad) {
+        return true;
+    }
+
+    int pedidos[cantidad_fragmentos];
+    for (int f = 0; f < cantidad_fragmentos; f++) {
+        pedidos[f] = enviar_escrituras(&fragmentos_memoria[f], primera, buffer->cantidad);
+    }
+
+    bool ok = true;
+    if (!pedidos_memoria->habilitada) { //sin ids todos los pedidos son el 0 y las confirmaciones de cada fragmento llegan en orden
+        for (int f = 0; f < cantidad_fragmentos; f++) {
+            int recibidas = 0;
+            for (int i = primera; i < buffer->cantidad && recibidas < pedidos[f]; i++) { //cada pedido empieza en la escritura que lo abrió
+                t_escritura* escritura = &buffer->escrituras[i];
+                if (fragmento_de_marco(escritura->segmento.marco) == &fragmentos_memoria[f]) {
+                    ok = recibir_confirmacion_escritura(&fragmentos_memoria[f], 0, &escritura->segmento) && ok;
+                    recibidas++;
+                }
+            }
+        }
+        while (buffer->cantidad > 0) {
+            quitar_escritura(buffer->cantidad - 1);
+        }
+    }
+    return ok;
+}
+
+/**
+* @fn     bool retirar_escrituras_confirmadas(void)
+* @brief  Saca del buffer las escrituras en vuelo cuya confirmación ya llegó, sin bloquear.
+* @param  Ninguno
+* @return false si memoria no confirmó alguna de las que se sacaron.
+*/
+bool retirar_escrituras_confirmadas(void) {
+    t_buffer_escrituras* buffer = escrituras_pendientes;
+    bool ok = true;
+    int i = 0;
+    while (i < buffer->cantidad && buffer->escrituras[i].estado == ESCRITURA_EN_VUELO) {
+        t_escritura* escritura = &buffer->escrituras[i];
+        if (respuesta_de_fragmento_disponible(fragmento_de_marco(escritura->segmento.marco), escritura->id_pedido)) {
+            ok = esperar_confirmacion_escritura(escritura) && ok; //ya llegó: no bloquea
+        }
+        else {
+            i++;
+        }
+    }
+    return ok;
+}
+
+/**
+* @fn     bool barrera_escrituras(void)
+* @brief  Manda las escrituras pendientes y espera todas las confirmaciones, de todos los fragmentos. Se usa antes de una syscall, al atender una interrupción y al cambiar de proceso, para que el kernel y el próximo proceso vean memoria al día.
+* @param  Ninguno
+* @return false si memoria no confirmó alguna escritura (cada una ya se logueó con su PID y dirección).
+*/
+bool barrera_escrituras(void) {
+    if (escrituras_pendientes == NULL) {
+        return true;
+    }
+    bool ok = vaciar_buffer_escrituras();
+    while (escrituras_pendientes->cantidad > 0) {
+        ok = esperar_confirmacion_escritura(&escrituras_pendientes->escrituras[0]) && ok;
+    }
+    return ok;
+}
+
+/**
+* @fn     bool escrituras_cubren(t_segmento_fisico* segmentos, int cantidad)
+* @brief  Indica si cada segmento está entero dentro de una escritura del buffer, así un READ se resuelve sin ir a memoria.
+* @param  segmentos Segmentos del READ.
+* @param  cantidad Cantidad de segmentos.
+* @return true si todos los segmentos están cubiertos.
+*/
+bool escrituras_cubren(t_segmento_fisico* segmentos, int cantidad) {
+    t_buffer_escrituras* buffer = escrituras_pendientes;
+    for (int s = 0; s < cantidad; s++) {
+        bool cubierto = segmentos[s].tamanio == 0;
+        for (int i = 0; i < buffer->cantidad && !cubierto; i++) {
+            t_segmento_fisico* escrito = &buffer->escrituras[i].segmento;
+            cubierto = escrito->marco == segmentos[s].marco
+                && escrito->desplazamiento <= segmentos[s].desplazamiento
+                && segmentos[s].desplazamiento + segmentos[s].tamanio <= escrito->desplazamiento + escrito->tamanio;
+        }
+        if (!cubierto) {
+            return false;
+        }
+    }
+    return true;
+}
+
+/**
+* @fn     void aplicar_escrituras_pendientes(t_segmento_fisico* segmentos, int cantidad, char* destino)
+* @brief  Pisa lo leído con los bytes del buffer que caen en los segmentos del READ, de la escritura más vieja a la más nueva. Así el READ ve sus propios WRITE aunque memoria todavía no los tenga.
+* @param  segmentos Segmentos del READ.
+* @param  cantidad Cantidad de segmentos.
+* @param  destino Bytes leídos, uno detrás del otro según los segmentos.
+* @return Ninguno
+*/
+void aplicar_escrituras_pendientes(t_segmento_fisico* segmentos, int cantidad, char* destino) {
+    t_buffer_escrituras* buffer = escrituras_pendientes;
+    for (int i = 0; i < buffer->cantidad; i++) {
+        t_escritura* escritura = &buffer->escrituras[i];
+        int posicion = 0;
+        for (int s = 0; s < cantidad; s++) {
+            if (escritura->segmento.marco == segmentos[s].marco) {
+                int inicio = escritura->segmento.desplazamiento > segmentos[s].desplazamiento ? escritura->segmento.desplazamiento : segmentos[s].desplazamiento;
+                int fin_escrito = escritura->segmento.desplazamiento + escritura->segmento.tamanio;
+                int fin_leido = segmentos[s].desplazamiento + segmentos[s].tamanio;
+                int fin = fin_escrito < fin_leido ? fin_escrito : fin_leido;
+                if (inicio < fin) {
+                    memcpy(destino + posicion + (inicio - segmentos[s].desplazamiento), escritura->datos + inicio, fin - inicio);
+                }
+            }
+            posicion += segmentos[s].tamanio;
+        }
+    }
+}
@@ -1,4 +1,6 @@
 #include "../include/cpu.h"
+#include <poll.h>
+#include <errno.h>
 
 int cant_interrupciones;
 
@@ -9,56 +11,142 @@ int cant_interrupciones;
 * @return Ninguno
 */
 void fetch(t_log* cpu_logger) {
+    bool continuar = true;
+
+    while (continuar) {
+        uint64_t reservas_antes = contadores_pool_del_hilo().reservas_sistema;
+        pedir_instruccion(cpu_logger);
+        continuar = ejecutar_instruccion_pedida(cpu_logger);
+        controlar_reservas_del_ciclo(reservas_antes, cpu_logger);
+        actualizar_imagen_caliente();
+    }
+}
 
-    log_info(cpu_logger, "## PID: %d - FETCH - Program Counter: %d", pid, pc);
-    
+/**
+* @fn     uint64_t controlar_reservas_del_ciclo(uint64_t reservas_antes, t_log* cpu_logger)
+* @brief  Controla que el último ciclo de instrucción no haya pedido memoria al sistema. En régimen no debería pasar: la instrucción se decodifica en el decodificador del hilo, la TLB y la caché reusan sus entradas y lo demás (paquetes, segmentos, lecturas) vuelve al pool del hilo. Los primeros ciclos sí piden, mientras el pool se llena.
+* @param  reservas_antes Reservas al sistema del hilo antes del ciclo, según contadores_pool_del_hilo().
+* @param  cpu_logger Logger para imprimir información de depuración.
+* @return Bloques que el ciclo pidió al sistema.
+*/
+uint64_t controlar_reservas_del_ciclo(uint64_t reservas_antes, t_log* cpu_logger) {
+    uint64_t reservas = contadores_pool_del_hilo().reservas_sistema - reservas_antes;
+    if (reservas > 0) {
+        cpu_log_debug(cpu_logger, "## PID: %d - El ciclo pidio %llu bloques al sistema", pid, (unsigned long long)reservas);
+    }
+    return reservas;
+}
+
+/**
+* @fn     void pedir_instruccion(t_log* cpu_logger)
+* @brief  Envía a memoria el pedido de la instrucción apuntada por el PC del proceso actual, sin esperar la respuesta. Permite que el modo de hilos de hardware ejecute otro contexto mientras memoria responde.
+* @param  cpu_logger Logger para imprimir información de depuración y control.
+* @return Ninguno
+*/
+void pedir_instruccion(t_log* cpu_logger) {
+
+    cpu_log_info(cpu_logger, "## PID: %d - FETCH - Program Counter: %d", pid, pc);
+
+    if (pc_pedido == pc) { //ya se pidio por adelantado mientras se ejecutaba la anterior
+        return;
+    }
+    abandonar_instruccion_pedida();
+    solicitar_instruccion(pc);
+    enviar_calentamiento(); //recien despachado: la huella viaja detras del primer FETCH
+}
+
+/**
+* @fn     void solicitar_instruccion(int pc_solicitado)
+* @brief  Envía a memoria el pedido de una instrucción del proceso actual y lo deja registrado como el FETCH pendiente.
+* @param  pc_solicitado Program Counter de la instrucción a pedir.
+* @return Ninguno
+*/
+void solicitar_instruccion(int pc_solicitado) {
     /*  Le mando el PID y PC a memoria para que me devuelva la instruccion*/
-    t_buffer* buffer = crear_buffer();
-    cargar_int_al_buffer(buffer, pc);
-    cargar_int_al_buffer(buffer, pid);
+    char almacenamiento[CAPACIDAD_CONSTRUCTOR_PILA];
+    t_constructor_paquete paquete;
+    pedido_instruccion = iniciar_pedido_a_memoria(&paquete, CPU_M_SOLICITAR_INSTRUCCION, almacenamiento, sizeof(almacenamiento));
+    if (mensajes_con_esquema) {
+        t_mensaje_solicitar_instruccion pedido = { .pc = pc_solicitado, .pid = pid };
+        empaquetar_solicitar_instruccion(&paquete, &pedido);
+    }
+    else {
+        cargar_int_al_constructor(&paquete, pc_solicitado);
+        cargar_int_al_constructor(&paquete, pid);
+    }
     
-    t_paquete* paquete = crear_paquete(CPU_M_SOLICITAR_INSTRUCCION, buffer);
-    enviar_paquete(paquete, socket_memoria);
-
-    int cod_op = recibir_operacion(socket_memoria);
-
-    if (cod_op == M_CPU_RESPUESTA_INSTRUCCION) {
-		
-        t_buffer* buffer_respuesta = recibir_buffer(socket_memoria); //Instruccion recibida
-        
-        /*   ETAPA DECODE   */
-        t_instruccion* instruccion = decode(buffer_respuesta);  
-        t_operacion operacion = instruccion -> operacion;
-        
-        eliminar_buffer(buffer_respuesta);
-        
-        if (operacion == READ || operacion == WRITE) { //necesito traduccion de memoria (es READ o WRITE)
-            execute (instruccion, cpu_logger);
-            check_interrupt(instruccion, cpu_logger);
-            destruir_instruccion(instruccion);
-            fetch(cpu_logger);
-        }
+    enviar_a_memoria(&paquete);
+    pc_pedido = pc_solicitado;
+}
 
-        else if (!es_syscall(instruccion)) { // es GOTO o NOOP
-            execute (instruccion, cpu_logger);
-            check_interrupt(instruccion, cpu_logger);
-            destruir_instruccion(instruccion);
-            fetch(cpu_logger);
-        }
+/**
+* @fn     void abandonar_instruccion_pedida(void)
+* @brief  Si quedó un FETCH adelantado sin usar (el proceso dejó la CPU o saltó con GOTO), descarta su respuesta.
+* @param  Ninguno
+* @return Ninguno
+*/
+void abandonar_instruccion_pedida(void) {
+    if (pc_pedido == -1) {
+        return;
+    }
+    descartar_respuesta_de_memoria(pedido_instruccion);
+    pc_pedido = -1;
+}
 
-        else { // es una SYSCALL
-            int fin_del_archivo = enviar_instruccion_a_kernel(instruccion, cpu_logger);
-            check_interrupt(instruccion, cpu_logger);
-            destruir_instruccion(instruccion);
-            if(!fin_del_archivo) { //si la instruccion envaida no es EXIT
-                fetch(cpu_logger);
-            }
-            else {
-                log_debug(cpu_logger, "Instruccion recibida EXIT, no quedan mas instrucciones en el archivo\n");
-            }
+/**
+* @fn     bool ejecutar_instruccion_pedida(t_log* cpu_logger)
+* @brief  Recibe de memoria la instrucción pedida con pedir_instruccion(), la decodifica, carga lo que ya llegó de los pedidos de fondo de la huella del proceso, ejecuta la instrucción y chequea interrupciones. Antes de un IO o un EXIT libera las entradas de TLB y caché del proceso.
+* @param  cpu_logger Logger para imprimir información de depuración y control.
+* @return true si el proceso sigue en la CPU y hay que pedir la siguiente instrucción, false en caso contrario.
+*/
+bool ejecutar_instruccion_pedida(t_log* cpu_logger) {
+    bool desalojado = esperar_instruccion_o_interrupcion(cpu_logger);
+    t_buffer buffer_respuesta; //Instruccion recibida, apunta al buffer de lectura de memoria
+    int cod_op = recibir_de_memoria(pedido_instruccion, &buffer_respuesta);
+    pc_pedido = -1;
+
+    if (cod_op != M_CPU_RESPUESTA_INSTRUCCION) {
+        log_debug(cpu_logger, "Memoria me contestó otra cosa");
+        return false;
+    }
+
+    if (desalojado || atender_interrupcion(cpu_logger)) { //se desaloja antes de ejecutarla: el PC sigue apuntando a esta instruccion
+        return false;
+    }
+    
+    /*   ETAPA DECODE   */
+    t_instruccion* instruccion = decode(&buffer_respuesta);  
+    avanzar_calentamiento(cpu_logger); //despues del decode: recibir otras respuestas puede pisar la de la instruccion
+    contar_instruccion();
+    
+    if (!es_syscall(instruccion)) { // es READ, WRITE, GOTO o NOOP
+        if (pedidos_memoria->habilitada && configuracion()->profundidad_prefetch > 0 && instruccion->operacion != GOTO) {
+            solicitar_instruccion(pc + 1); //la siguiente viaja mientras esta hace sus accesos a memoria
+        }
+        execute (instruccion, cpu_logger);
+        bool desalojado_al_final = check_interrupt(instruccion, cpu_logger);
+        if (desalojado_al_final) {
+            abandonar_instruccion_pedida();
         }
+        return !desalojado_al_final;
+    }
 
+    // es una SYSCALL: el kernel (y lo que le pida a memoria) tiene que ver todos los WRITE anteriores
+    barrera_escrituras();
+    if (instruccion->operacion == IO || instruccion->operacion == EXIT) {
+        dejar_tlb_y_cache_del_proceso(instruccion->operacion == IO);
+    }
+    int resultado = enviar_instruccion_a_kernel(instruccion, cpu_logger);
+    if (resultado == -1) { //el kernel no recibio la syscall: no se puede seguir ejecutando el proceso
+        log_error(cpu_logger, "## PID: %d - No se pudo enviar al kernel la syscall de la instruccion %d", pid, instruccion->operacion);
+        return false;
+    }
+    bool desalojado_al_final = check_interrupt(instruccion, cpu_logger);
+    if(resultado == 1 || desalojado_al_final) { //EXIT, IO o desalojo: el kernel decide que se ejecuta despues
+        cpu_log_debug(cpu_logger, "## PID: %d - El proceso deja la CPU\n", pid);
+        return false;
     }
+    return true;
 }
 
 
@@ -81,10 +169,11 @@ bool es_syscall(t_instruccion* instruccion) {
 * @return Ninguno
 */
 void execute (t_instruccion* instruccion, t_log* cpu_logger){
-    int direccion_fisica;
+    iniciar_registro_traza(instruccion->operacion);
+
     switch (instruccion->operacion) {
         case NOOP:  //solo consume el tiempo del ciclo de instruccion
-            log_info(cpu_logger, "## PID: %d - Ejecutando: NOOP", pid);
+            cpu_log_info(cpu_logger, "## PID: %d - Ejecutando: NOOP", pid);
         break;
 
         case READ:
@@ -93,35 +182,19 @@ void execute (t_instruccion* instruccion, t_log* cpu_logger){
             int tamanio = atoi(instruccion->parametros[1]); //atoi convierte un string a int
 
             // Lectura/Escritura Memoria: “PID: <PID> - Acción: <LEER / ESCRIBIR> - Dirección Física: <DIRECCION_FISICA> - Valor: <VALOR LEIDO / ESCRITO>”.
-            log_info(cpu_logger, "## PID: %d - Ejecutando: READ - %s - %d", pid, direccion_logica, tamanio);
+            cpu_log_info(cpu_logger, "## PID: %d - Ejecutando: READ - %s - %d", pid, direccion_logica, tamanio);
 
             if(cache_habilitada()) {
                 // intentar leer desde la cahce directamente
                 cargar_contenido_cache(cpu_logger, atoi(direccion_logica), READ, NULL); // Carga el contenido de la cache   
             }
             else {
-                direccion_fisica = traducir_dir_logica(atoi(direccion_logica), cpu_logger); //Traduce dirección lógica a física
-                
-                log_info(cpu_logger, "Dir logica: %s, Dir fisica: %d", direccion_logica, direccion_fisica);
-
-                t_buffer* buffer_rta = crear_buffer();
-                cargar_int_al_buffer(buffer_rta, frame);      // número de marco
-                cargar_int_al_buffer(buffer_rta, desplazamiento);     // offset dentro de la página
-                cargar_int_al_buffer(buffer_rta, tamanio);       // cantidad de bytes a leer
-                t_paquete* paquete = crear_paquete(CPU_M_LEER_MEMORIA, buffer_rta);
-                enviar_paquete(paquete, socket_memoria);
-    
-                // Recibo respuesta de Memoria
-                if(recibir_operacion(socket_memoria) == M_CPU_VALOR_LEIDO){
-
-                    t_buffer* buffer = recibir_buffer(socket_memoria);
-                    char* valor_leido = extraer_string_del_buffer(buffer);
-                    log_debug(cpu_logger, "%s", valor_leido);    
-                    eliminar_buffer(buffer);
-
-                } else {
-                    log_debug(cpu_logger, "Memoria me contestó otra cosa");
+                // La MMU parte el rango por páginas: si cruza una, igual se lee completo
+                char* valor_leido = reservar_del_pool(tamanio + 1, NULL);
+                if (leer_de_memoria(atoi(direccion_logica), tamanio, valor_leido, cpu_logger)) {
+                    cpu_log_debug(cpu_logger, "%s", valor_leido);
                 }
+                devolver_al_pool(valor_leido);
             }
         }
         break;
@@ -132,33 +205,15 @@ void execute (t_instruccion* instruccion, t_log* cpu_logger){
             char* direccion = instruccion->parametros[0];
             char* datos = instruccion->parametros[1];
 
-            log_info(cpu_logger, "## PID: %d - Ejecutando: WRITE - %s - %s", pid, direccion, datos);
+            cpu_log_info(cpu_logger, "## PID: %d - Ejecutando: WRITE - %s - %s", pid, direccion, datos);
             if(cache_habilitada()) {
                 cargar_contenido_cache(cpu_logger, atoi(direccion), WRITE, datos); // Carga el contenido de la cache   
 
                 // Escribir en la cache
             }
             else {
-                direccion_fisica = traducir_dir_logica(atoi(direccion), cpu_logger); // Traduzco la dirección lógica a física
-                // Envio a Memoria lo que necesito escribir
-                t_buffer* buffer_rta = crear_buffer();
-                cargar_int_al_buffer(buffer_rta, frame);      // número de marco
-                cargar_int_al_buffer(buffer_rta, desplazamiento);     // offset dentro de la página
-                cargar_string_al_buffer(buffer_rta, datos);   // datos a escribir
-                t_paquete* paquete = crear_paquete(CPU_M_ESCRIBIR_MEMORIA, buffer_rta);
-                enviar_paquete(paquete, socket_memoria);
-                
-                // Recibo respuesta de Memoria
-                if(recibir_operacion(socket_memoria) == M_CPU_CONFIRMACION_ESCRITURA){
-
-                    t_buffer* buffer = recibir_buffer(socket_memoria);
-                    char* valor_leido = extraer_string_del_buffer(buffer); 
-                    log_debug(cpu_logger, "%s", valor_leido);     
-                    eliminar_buffer(buffer);
-
-                } else {
-                    log_debug(cpu_logger, "Memoria me contestó otra cosa");
-                }
+                // Envio a Memoria lo que necesito escribir, partido por páginas si cruza alguna
+                escribir_en_memoria(atoi(direccion), datos, cpu_logger);
             }
         }
 
@@ -168,7 +223,7 @@ void execute (t_instruccion* instruccion, t_log* cpu_logger){
             int valor = atoi(instruccion->parametros[0]);
             pc = valor; //se actualiza el pc por direccion de memoria
             
-            log_info(cpu_logger, "## PID: %d - Ejecutando: GOTO - %d", pid, valor);
+            cpu_log_info(cpu_logger, "## PID: %d - Ejecutando: GOTO - %d", pid, valor);
             }
         break;
 
@@ -176,71 +231,157 @@ void execute (t_instruccion* instruccion, t_log* cpu_logger){
         break;
     }
 
+    registrar_traza();
 }
 
 /**
-* @fn     void check_interrupt(t_instruccion* instruccion, t_log* cpu_logger)
-* @brief  Verifica si ocurrió una interrupción. Si es así, envía el PID y el PC actualizado al kernel por el canal de interrupciones. Además, incrementa el PC si la instrucción no es GOTO.
+* @fn     bool check_interrupt(t_instruccion* instruccion, t_log* cpu_logger)
+* @brief  Incrementa el PC si la instrucción no es GOTO y luego atiende la interrupción pendiente, si la hay, enviando al kernel el PC ya actualizado.
 * @param  instruccion Puntero a la instrucción actual.
 * @param  cpu_logger Logger para imprimir información de control.
-* @return Ninguno
+* @return true si el proceso fue desalojado, false en caso contrario.
 */
-void check_interrupt(t_instruccion* instruccion, t_log* cpu_logger){ //TODO: evaluar si el incremento de pc se puede hacer por fuera, asi me evito pasarle la instruccion por parametro
-    if (hay_alguna_interrupcion()){
-        log_info(cpu_logger, "## LLega interrupcion al puerto interrupt");
-        //mandar pid y pc actualizado
-        t_buffer* buffer_interrupt = crear_buffer();
-        cargar_int_al_buffer(buffer_interrupt, pc);
-        cargar_int_al_buffer(buffer_interrupt, pid);
+bool check_interrupt(t_instruccion* instruccion, t_log* cpu_logger){
+    if (instruccion->operacion != GOTO){
+        pc++;
+    }
 
-        t_paquete* paquete = crear_paquete(K_CPU_INTERRUPT_PROCESO, buffer_interrupt);
+    return atender_interrupcion(cpu_logger);
+}
 
-        enviar_paquete(paquete, socket_kernel_interrupt);
+/**
+* @fn     bool atender_interrupcion(t_log* cpu_logger)
+* @brief  Consume la interrupción del buzón. Si está dirigida al proceso actual, libera sus entradas de TLB y caché guardando su huella, envía el PID y el PC al kernel por el canal de interrupciones y registra la latencia desde que llegó. Las interrupciones para otro PID se descartan.
+* @param  cpu_logger Logger para imprimir información de control.
+* @return true si el proceso actual fue desalojado, false en caso contrario.
+*/
+bool atender_interrupcion(t_log* cpu_logger) {
+    t_interrupcion interrupcion;
+    if (!tomar_interrupcion(buzon_interrupcion, &interrupcion)) {
+        return false;
     }
 
-    if (instruccion->operacion != GOTO){
-        pc++;
+    if (interrupcion.pid != PID_CUALQUIERA && interrupcion.pid != pid) {
+        CONTAR(interrupciones_descartadas);
+        cpu_log_debug(cpu_logger, "## Interrupcion para PID %d descartada, ejecutando PID %d", interrupcion.pid, pid);
+        return false;
+    }
+
+    CONTAR(interrupciones_atendidas);
+    log_info(cpu_logger, "## LLega interrupcion al puerto interrupt");
+    barrera_escrituras(); //el proceso sale de la CPU con sus WRITE ya en memoria
+    dejar_tlb_y_cache_del_proceso(true);
+    //mandar pid y pc actualizado
+    char almacenamiento[CAPACIDAD_CONSTRUCTOR_PILA];
+    t_constructor_paquete paquete;
+    iniciar_constructor(&paquete, K_CPU_INTERRUPT_PROCESO, almacenamiento, sizeof(almacenamiento));
+    cargar_int_al_constructor(&paquete, pc);
+    cargar_int_al_constructor(&paquete, pid);
+
+    enviar_constructor(&paquete, socket_kernel_interrupt);
+
+    registrar_latencia_interrupcion(tiempo_actual_ns() - interrupcion.llegada_ns);
+    return true;
+}
+
+/**
+* @fn     bool esperar_instruccion_o_interrupcion(t_log* cpu_logger)
+* @brief  Espera la respuesta de un FETCH. Si el buzón tiene eventfd y llega una interrupción para el proceso antes que la instrucción, la atiende en el momento sin esperar a memoria; la respuesta se lee y descarta después.
+* @param  cpu_logger Logger para imprimir información de control.
+* @return true si el proceso fue desalojado mientras esperaba, false en caso contrario.
+*/
+bool esperar_instruccion_o_interrupcion(t_log* cpu_logger) {
+    if (buzon_interrupcion->eventfd == -1 || canal_memoria != NULL || respuesta_de_memoria_disponible(pedido_instruccion)) { //el anillo no tiene fd para poll
+        return false;
     }
 
+    struct pollfd fds[2] = {
+        { .fd = socket_memoria, .events = POLLIN },
+        { .fd = buzon_interrupcion->eventfd, .events = POLLIN }
+    };
+
+    while (true) {
+        if (poll(fds, 2, -1) == -1) {
+            if (errno == EINTR) continue;
+            return false;
+        }
+        if (fds[0].revents != 0) {
+            return false;
+        }
+        if (fds[1].revents != 0 && atender_interrupcion(cpu_logger)) {
+            return true;
+        }
+    }
 }
 
 
 /**
 * @fn     bool hay_alguna_interrupcion(void)
-* @brief  Indica si hay una interrupción pendiente en el sistema.
+* @brief  Indica si hay una interrupción pendiente en el buzón, sin consumirla.
 * @param  Ninguno
 * @return true si hay interrupción, false en caso contrario.
 */
 bool hay_alguna_interrupcion(){
-    return interrupt;
+    return hay_interrupcion_pendiente(buzon_interrupcion);
 }
 
 /**
 * @fn     t_instruccion* decode(t_buffer* buffer)
-* @brief  Deserializa y decodifica una instrucción recibida en un buffer, extrayendo la operación y sus parámetros.
+* @brief  Deserializa y decodifica una instrucción recibida en un buffer, extrayendo la operación y sus parámetros. El mensaje se copia al decodificador del hilo, porque el buffer es una vista del lector de memoria que la próxima respuesta puede pisar, y los parámetros apuntan a esa copia.
 * @param  buffer Puntero al buffer que contiene la instrucción serializada.
-* @return Puntero a la instrucción deserializada.
+* @return Puntero a la instrucción del decodificador; vale hasta el próximo decode() del hilo y no se libera.
 */
 t_instruccion* decode(t_buffer* buffer) {
-    t_instruccion* instruccion_deserializada = malloc(sizeof(t_instruccion));
+    if (buffer->size > decodificador.capacidad) {
+        decodificador.texto = agrandar_del_pool(decodificador.texto, 0, buffer->size, &decodificador.capacidad);
+    }
+    memcpy(decodificador.texto, buffer->stream, buffer->size);
+    t_buffer copia = { .size = buffer->size, .capacidad = decodificador.capacidad, .stream = decodificador.texto };
 
-    instruccion_deserializada->operacion = extraer_int_del_buffer(buffer);
-    instruccion_deserializada->cantidad_parametros = extraer_int_del_buffer(buffer);
+    t_instruccion* instruccion_deserializada = &decodificador.instruccion;
+    t_lector_buffer lector = crear_lector(&copia);
+
+    if (mensajes_con_esquema) {
+        t_mensaje_respuesta_instruccion cabecera;
+        desempaquetar_respuesta_instruccion(&lector, &cabecera);
+        instruccion_deserializada->operacion = cabecera.operacion;
+        instruccion_deserializada->cantidad_parametros = cabecera.cantidad_parametros;
+    }
+    else {
+        instruccion_deserializada->operacion = leer_int_del_buffer(&lector);
+        instruccion_deserializada->cantidad_parametros = leer_int_del_buffer(&lector);
+    }
 
-    instruccion_deserializada->parametros = malloc(instruccion_deserializada->cantidad_parametros * sizeof(char*));
+    if (instruccion_deserializada->cantidad_parametros > MAX_PARAMETROS_INSTRUCCION) {
+        log_error(cpu_logger, "## PID: %d - Instruccion con %d parametros, se usan los primeros %d", pid, instruccion_deserializada->cantidad_parametros, MAX_PARAMETROS_INSTRUCCION);
+        instruccion_deserializada->cantidad_parametros = MAX_PARAMETROS_INSTRUCCION;
+    }
+    instruccion_deserializada->parametros = decodificador.parametros;
     for (int i = 0; i < instruccion_deserializada->cantidad_parametros; i++) {
-        instruccion_deserializada->parametros[i] = extraer_string_del_buffer(buffer);
+        instruccion_deserializada->parametros[i] = leer_string_del_buffer(&lector);
     }
 
     return instruccion_deserializada;
 }
 
+/**
+* @fn     void liberar_decodificador(void)
+* @brief  Devuelve al pool el texto del decodificador del hilo. La llama cada CPU virtual al terminar.
+* @param  Ninguno
+* @return Ninguno
+*/
+void liberar_decodificador(void) {
+    devolver_al_pool(decodificador.texto);
+    decodificador.texto = NULL;
+    decodificador.capacidad = 0;
+}
+
 /**
 * @fn     int enviar_instruccion_a_kernel(t_instruccion* instruccion, t_log* cpu_logger)
-* @brief  Envía la instrucción correspondiente al kernel según el tipo de operación (INIT_PROC, DUMP_MEMORY, IO, EXIT). Serializa los parámetros necesarios y gestiona la comunicación con el kernel. Devuelve 1 si la instrucción es EXIT, 0 en otros casos, -1 en caso de error.
+* @brief  Envía la instrucción correspondiente al kernel según el tipo de operación (INIT_PROC, DUMP_MEMORY, IO, EXIT). Serializa los parámetros necesarios y gestiona la comunicación con el kernel. Devuelve 1 si el proceso deja la CPU (EXIT o IO), 0 en otros casos, -1 en caso de error.
 * @param  instruccion Puntero a la instrucción a enviar.
 * @param  cpu_logger Logger para imprimir información de control.
-* @return 1 si la instrucción es EXIT, 0 si no es EXIT, -1 en caso de error.
+* @return 1 si el proceso deja la CPU, 0 si sigue ejecutando, -1 en caso de error.
 */
 int enviar_instruccion_a_kernel(t_instruccion* instruccion, t_log* cpu_logger) {
 
@@ -255,8 +396,7 @@ int enviar_instruccion_a_kernel(t_instruccion* instruccion, t_log* cpu_logger) {
             cargar_string_al_buffer(buffer, instruccion -> parametros[1]); //tamaño
 
             t_paquete* paquete_init_proc = crear_paquete(CPU_K_INIT_PROC, buffer);
-            enviar_paquete(paquete_init_proc, socket_kernel_dispatch);
-            return 0;
+            return enviar_paquete(paquete_init_proc, socket_kernel_dispatch) == 0 ? 0 : -1;
             
         break;
             
@@ -264,8 +404,7 @@ int enviar_instruccion_a_kernel(t_instruccion* instruccion, t_log* cpu_logger) {
             // cargar_int_al_buffer(buffer, instruccion -> operacion);
             
             t_paquete* paquete_dump_memory = crear_paquete(CPU_K_DUMP_MEMORY, buffer);
-            enviar_paquete(paquete_dump_memory, socket_kernel_dispatch);
-            return 0;
+            return enviar_paquete(paquete_dump_memory, socket_kernel_dispatch) == 0 ? 0 : -1;
         break;
             
         case IO:
@@ -275,17 +414,20 @@ int enviar_instruccion_a_kernel(t_instruccion* instruccion, t_log* cpu_logger) {
             cargar_int_al_buffer(buffer, pc+1); //Para salvar contexto
            
             t_paquete* paquete_io = crear_paquete(CPU_K_SOLICITAR_IO, buffer);
-            enviar_paquete(paquete_io, socket_kernel_dispatch);
+            if (enviar_paquete(paquete_io, socket_kernel_dispatch) != 0) {
+                return -1;
+            }
             
-            // Dejar de ejecutar ese proceso y empezar a ejecutar otro
-            atender_kernel_cpu_dispatch(cpu_logger);
-            return 0;
+            // Dejar de ejecutar ese proceso: el proximo K_CPU_EXEC_PROCESO lo atiende quien escucha dispatch
+            return 1;
         break;
             
         case EXIT:
             // cargar_int_al_buffer(buffer, instruccion -> operacion);    
             t_paquete* paquete_exit = crear_paquete(CPU_K_EXIT, buffer);
-            enviar_paquete(paquete_exit, socket_kernel_dispatch);
+            if (enviar_paquete(paquete_exit, socket_kernel_dispatch) != 0) {
+                return -1;
+            }
             return 1;
         break;
 
@@ -1,138 +1,443 @@
 #include "../include/cpu.h"
+#include <poll.h>
+#include <errno.h>
 
 /**
 * @fn     void conexiones(char* cpu_id, t_log* cpu_logger)
-* @brief  Establece las conexiones con memoria y kernel, y comienza a atender sus mensajes. Realiza el proceso de handshake con ambos módulos y deja la CPU lista para recibir instrucciones y atender interrupciones.
+* @brief  Establece las conexiones con memoria y kernel, y comienza a atender sus mensajes. Realiza el proceso de handshake con ambos módulos y deja la CPU lista para recibir instrucciones y atender interrupciones. Con MODO_EJECUCION=EVENTOS o HILOS_HARDWARE mayor a 1 delega en el bucle de eventos de ejecutar_hilos_hardware().
 * @param  cpu_id Identificador de la CPU que se enviará en el handshake con el kernel.
 * @param  cpu_logger Logger para imprimir información de control y errores.
 * @return Ninguno
 */
 void conexiones(char* cpu_id, t_log* cpu_logger) {
-    conectar_memoria(cpu_logger);
-    conectar_kernel(cpu_id, cpu_logger);
+    if (configuracion()->hilos_hardware > 1 || configuracion()->modo_eventos) {
+        ejecutar_hilos_hardware(cpu_id, cpu_logger);
+        return;
+    }
+
+    establecer_conexiones(cpu_id, cpu_logger);
     atender_kernel(cpu_logger);
     //atender_memoria(cpu_logger);
 }
 
 /**
-* @fn     void conectar_kernel(char* cpu_id, t_log* cpu_logger)
-* @brief  Establece las conexiones con los sockets de kernel (dispatch e interrupt) y realiza el handshake correspondiente con ambos canales. Si alguna conexión falla, termina la ejecución.
-* @param  cpu_id Identificador de la CPU que se enviará en el handshake.
+* @fn     char* direccion_de_modulo(char* direccion, char* ip, char* puerto)
+* @brief  Arma la dirección de transporte de otro módulo: la configurada (unix: o tcp: con sus opciones) o, si no hay, TCP con su IP y PUERTO.
+* @param  direccion Dirección de transporte, o NULL si no está configurada.
+* @param  ip IP del módulo, para cuando no hay dirección.
+* @param  puerto Puerto del módulo, para cuando no hay dirección.
+* @return Dirección a liberar con free().
+*/
+char* direccion_de_modulo(char* direccion, char* ip, char* puerto) {
+    return direccion != NULL ? string_duplicate(direccion) : string_from_format("tcp:%s:%s", ip, puerto);
+}
+
+/**
+* @fn     void establecer_conexiones(char* cpu_id, t_log* cpu_logger)
+* @brief  Se conecta a memoria (a cada uno de sus fragmentos), kernel dispatch y kernel interrupt a la vez, reintentando con espera exponencial a los que todavía no levantaron, y hace los handshakes: los de kernel salen mientras se esperan las respuestas de memoria. Informa cuánto tardó la CPU en quedar lista. Si en PLAZO_CONEXION no se pudo conectar con alguno, termina la ejecución.
+* @param  cpu_id Identificador de la CPU que se enviará en el handshake con el kernel.
 * @param  cpu_logger Logger para imprimir información de control y errores.
 * @return Ninguno
 */
-void conectar_kernel(char* cpu_id, t_log* cpu_logger) {
-    //DISPATCH
-    socket_kernel_dispatch = crear_conexion(ip_kernel(), puerto_kernel_dispatch());
-    
-    if(socket_kernel_dispatch == -1) {
-        log_error(cpu_logger, "ERROR al conectarse con kernel dispatch");
+void establecer_conexiones(char* cpu_id, t_log* cpu_logger) {
+    int64_t inicio = tiempo_actual_ns();
+    char** direcciones_fragmentos = configuracion()->fragmentos_memoria;
+    cantidad_fragmentos = direcciones_fragmentos != NULL ? string_array_size(direcciones_fragmentos) : 1;
+    int cantidad = cantidad_fragmentos + 2;
+    t_intento_conexion intentos[cantidad]; // los fragmentos de memoria, kernel dispatch y kernel interrupt
+    for (int i = 0; i < cantidad_fragmentos; i++) {
+        char* nombre = cantidad_fragmentos == 1 ? string_duplicate("MEMORIA") : string_from_format("MEMORIA %d", i);
+        char* direccion = direcciones_fragmentos != NULL ? string_duplicate(direcciones_fragmentos[i]) : direccion_de_modulo(configuracion()->direccion_memoria, configuracion()->ip_memoria, configuracion()->puerto_memoria);
+        iniciar_intento_conexion(&intentos[i], nombre, direccion);
+    }
+    t_intento_conexion* dispatch = &intentos[cantidad_fragmentos];
+    t_intento_conexion* interrupt = &intentos[cantidad_fragmentos + 1];
+    iniciar_intento_conexion(dispatch, "KERNEL DISPATCH", direccion_de_modulo(configuracion()->direccion_kernel_dispatch, configuracion()->ip_kernel, configuracion()->puerto_kernel_dispatch));
+    iniciar_intento_conexion(interrupt, "KERNEL INTERRUPT", direccion_de_modulo(configuracion()->direccion_kernel_interrupt, configuracion()->ip_kernel, configuracion()->puerto_kernel_interrupt));
+
+    if (!conectar_en_paralelo(intentos, cantidad, inicio, cpu_logger)) {
+        for (int i = 0; i < cantidad; i++) {
+            if (!intentos[i].conectado) {
+                log_error(cpu_logger, "ERROR al conectarse con %s (%s): sin respuesta despues de %d intentos", intentos[i].nombre, intentos[i].direccion, intentos[i].intentos);
+            }
+        }
         exit(-1);
     }
-    else { //HANDSHAKE
-        
-        log_info(cpu_logger, "Conectado a KERNEL DISPATCH");
+    fragmentos_memoria = calloc(cantidad_fragmentos, sizeof(t_fragmento_memoria));
+    for (int i = 0; i < cantidad_fragmentos; i++) {
+        fragmentos_memoria[i].direccion = intentos[i].direccion; // el fragmento se queda con la dirección
+        fragmentos_memoria[i].socket = intentos[i].socket;
+    }
+    socket_memoria = fragmentos_memoria[0].socket;
+    socket_kernel_dispatch = dispatch->socket;
+    socket_kernel_interrupt = interrupt->socket;
 
-        t_buffer* b_handshake_envio = crear_buffer();
-        cargar_int_al_buffer(b_handshake_envio, HAND_CPU_KERNEL_DIS);
-        cargar_string_al_buffer(b_handshake_envio, cpu_id);
+    t_canal_compartido* canal = NULL;
+    int capacidades[cantidad_fragmentos];
+    for (int i = 0; i < cantidad_fragmentos; i++) {
+        capacidades[i] = enviar_handshake_memoria(&fragmentos_memoria[i], i == 0 ? &canal : NULL, cpu_logger);
+    }
+    enviar_handshake_kernel(socket_kernel_dispatch, HAND_CPU_KERNEL_DIS, cpu_id); //la respuesta se espera en atender_kernel_cpu_dispatch()
+    enviar_handshake_kernel(socket_kernel_interrupt, HAND_CPU_KERNEL_INT, cpu_id);
+    for (int i = 0; i < cantidad_fragmentos; i++) {
+        recibir_handshake_memoria(&fragmentos_memoria[i], capacidades[i], i == 0 ? canal : NULL, cpu_logger);
+    }
+    escrituras_pendientes = configuracion()->buffer_escrituras ? crear_buffer_escrituras() : NULL;
+    calentamiento = crear_calentamiento();
+    usar_fragmento_del_proceso();
+    validar_imagen_con_memoria(cpu_logger);
 
-        t_paquete* paquete_disp = crear_paquete(HANDSHAKE, b_handshake_envio);
-        enviar_paquete(paquete_disp, socket_kernel_dispatch);
+    int reintentos = -cantidad;
+    int64_t memoria_ns = 0; // el fragmento que más tardó
+    for (int i = 0; i < cantidad; i++) {
+        reintentos += intentos[i].intentos;
+        if (i < cantidad_fragmentos && intentos[i].conectado_ns > memoria_ns) {
+            memoria_ns = intentos[i].conectado_ns;
+        }
+    }
+    log_info(cpu_logger, "CPU %s lista en %.1f ms (memoria %.1f ms, kernel dispatch %.1f ms, kernel interrupt %.1f ms, %d reintentos)",
+        cpu_id, (tiempo_actual_ns() - inicio) / 1e6, memoria_ns / 1e6, dispatch->conectado_ns / 1e6, interrupt->conectado_ns / 1e6, reintentos);
 
-        //espero la respuesta del handshake en atender_kernel_cpu_dispatch()        
+    for (int i = 0; i < cantidad_fragmentos; i++) {
+        free(intentos[i].nombre);
     }
+    free(dispatch->direccion);
+    free(interrupt->direccion);
+}
 
+/**
+* @fn     void iniciar_intento_conexion(t_intento_conexion* intento, char* nombre, char* direccion)
+* @brief  Prepara el intento de conexión con un módulo para intentarlo enseguida.
+* @param  intento Intento a preparar.
+* @param  nombre Nombre del módulo para los logs.
+* @param  direccion Dirección del módulo; el intento se queda con ella.
+* @return Ninguno
+*/
+void iniciar_intento_conexion(t_intento_conexion* intento, char* nombre, char* direccion) {
+    intento->nombre = nombre;
+    intento->direccion = direccion;
+    intento->socket = -1;
+    intento->conectado = false;
+    intento->intentos = 0;
+    intento->espera_ms = configuracion()->reintento_conexion;
+    intento->proximo_intento_ns = 0;
+    intento->conectado_ns = 0;
+}
 
-    //INTERRUPT
-    socket_kernel_interrupt = crear_conexion(ip_kernel(), puerto_kernel_interrupt());
-    if(socket_kernel_interrupt == -1) {
-        log_error(cpu_logger, "ERROR al conectarse con kernel interrupt");
-        exit(-1);
+/**
+* @fn     bool conectar_en_paralelo(t_intento_conexion* intentos, int cantidad, int64_t inicio, t_log* cpu_logger)
+* @brief  Lleva adelante varios connect no bloqueantes a la vez con un solo poll(). El que falla se reintenta después de su espera, que se duplica hasta REINTENTO_CONEXION_MAX; el que conecta queda bloqueante como el resto de los sockets de la CPU.
+* @param  intentos Conexiones a establecer.
+* @param  cantidad Cantidad de conexiones.
+* @param  inicio Momento en que empezó el arranque; el plazo PLAZO_CONEXION se cuenta desde acá.
+* @param  cpu_logger Logger para imprimir información de control y errores.
+* @return true si se conectaron todas, false si venció el plazo o una dirección es inválida.
+*/
+bool conectar_en_paralelo(t_intento_conexion* intentos, int cantidad, int64_t inicio, t_log* cpu_logger) {
+    int64_t limite = inicio + configuracion()->plazo_conexion * 1000000LL;
+    struct pollfd esperas[cantidad];
+    int indices[cantidad];
+    int pendientes = cantidad;
+
+    while (pendientes > 0) {
+        int64_t ahora = tiempo_actual_ns();
+        if (ahora >= limite) {
+            break;
+        }
+
+        // Se lanzan los intentos que ya cumplieron su espera y se calcula hasta cuándo dormir
+        int64_t despertar = limite;
+        int cantidad_esperas = 0;
+        for (int i = 0; i < cantidad; i++) {
+            t_intento_conexion* intento = &intentos[i];
+            if (intento->conectado) {
+                continue;
+            }
+            if (intento->socket == -1 && intento->proximo_intento_ns <= ahora) {
+                intento->intentos++;
+                intento->socket = iniciar_conexion_direccion(intento->direccion);
+                if (intento->socket == -1) {
+                    if (errno == EINVAL) {
+                        return false;
+                    }
+                    programar_reintento(intento, errno, ahora, cpu_logger);
+                }
+            }
+            if (intento->socket == -1) {
+                despertar = intento->proximo_intento_ns < despertar ? intento->proximo_intento_ns : despertar;
+                continue;
+            }
+            esperas[cantidad_esperas] = (struct pollfd){ .fd = intento->socket, .events = POLLOUT };
+            indices[cantidad_esperas++] = i;
+        }
+
+        int timeout_ms = (int)((despertar - ahora + 999999) / 1000000);
+        if (poll(esperas, cantidad_esperas, timeout_ms) == -1 && errno != EINTR) {
+            perror("poll de las conexiones");
+            return false;
+        }
+
+        for (int j = 0; j < cantidad_esperas; j++) {
+            if (esperas[j].revents == 0) {
+                continue;
+            }
+            t_intento_conexion* intento = &intentos[indices[j]];
+            int error = resultado_conexion(intento->socket);
+            if (error != 0) {
+                close(intento->socket);
+                intento->socket = -1;
+                programar_reintento(intento, error, tiempo_actual_ns(), cpu_logger);
+                continue;
+            }
+            dejar_bloqueante(intento->socket);
+            intento->conectado = true;
+            intento->conectado_ns = tiempo_actual_ns() - inicio;
+            pendientes--;
+            log_info(cpu_logger, "Conectado a %s (%d intentos, %.1f ms)", intento->nombre, intento->intentos, intento->conectado_ns / 1e6);
+        }
     }
-    else { //HANDSHAKE
-        log_info(cpu_logger, "Conectado a KERNEL INTERRUPT");
-        t_buffer* b_handshake_envio_int = crear_buffer();
-        cargar_int_al_buffer(b_handshake_envio_int, HAND_CPU_KERNEL_INT);
-        cargar_string_al_buffer(b_handshake_envio_int, cpu_id);
 
-        t_paquete* paquete = crear_paquete(HANDSHAKE, b_handshake_envio_int);
-        enviar_paquete(paquete, socket_kernel_interrupt);
+    if (pendientes > 0) { // los que quedaron a medio conectar
+        for (int i = 0; i < cantidad; i++) {
+            if (!intentos[i].conectado && intentos[i].socket != -1) {
+                close(intentos[i].socket);
+                intentos[i].socket = -1;
+            }
+        }
     }
+    return pendientes == 0;
 }
 
 /**
-* @fn     void conectar_memoria(t_log* cpu_logger)
-* @brief  Establece la conexión con el socket de memoria, realiza el handshake y recibe los parámetros de configuración de memoria (tamaño de página, tamaño de memoria, entradas por tabla y cantidad de niveles). Si la conexión falla, termina la ejecución.
+* @fn     void programar_reintento(t_intento_conexion* intento, int error, int64_t ahora, t_log* cpu_logger)
+* @brief  Agenda el próximo intento de conexión con un módulo que no respondió y duplica la espera siguiente, sin pasar de REINTENTO_CONEXION_MAX. A la espera se le suma hasta un 25% tomado del reloj para que una tanda de CPUs reiniciadas juntas no reintente al mismo tiempo.
+* @param  intento Intento que falló.
+* @param  error errno del connect.
+* @param  ahora Momento del fallo.
 * @param  cpu_logger Logger para imprimir información de control y errores.
 * @return Ninguno
 */
-void conectar_memoria(t_log* cpu_logger) {
-    socket_memoria = crear_conexion(ip_memoria(), puerto_memoria());
-    if(socket_memoria == -1) {
-        log_error(cpu_logger, "ERROR al conectarse con memoria");
-        exit(-1);
+void programar_reintento(t_intento_conexion* intento, int error, int64_t ahora, t_log* cpu_logger) {
+    int espera_ms = intento->espera_ms + (int)(ahora % (intento->espera_ms / 4 + 1));
+    intento->proximo_intento_ns = ahora + espera_ms * 1000000LL;
+    intento->espera_ms = intento->espera_ms * 2 < configuracion()->reintento_conexion_max ? intento->espera_ms * 2 : configuracion()->reintento_conexion_max;
+    log_debug(cpu_logger, "No se pudo conectar a %s (%s), reintento en %d ms", intento->nombre, strerror(error), espera_ms);
+}
+
+/**
+* @fn     void enviar_handshake_kernel(int socket_kernel, int tipo_handshake, char* cpu_id)
+* @brief  Envía el handshake a uno de los sockets de kernel (dispatch o interrupt). La respuesta la recibe recibir_handshake_kernel().
+* @param  socket_kernel Socket de kernel dispatch o interrupt.
+* @param  tipo_handshake HAND_CPU_KERNEL_DIS o HAND_CPU_KERNEL_INT.
+* @param  cpu_id Identificador de la CPU.
+* @return Ninguno
+*/
+void enviar_handshake_kernel(int socket_kernel, int tipo_handshake, char* cpu_id) {
+    t_buffer* b_handshake_envio = crear_buffer();
+    cargar_int_al_buffer(b_handshake_envio, tipo_handshake);
+    cargar_string_al_buffer(b_handshake_envio, cpu_id);
+
+    t_paquete* paquete = crear_paquete(HANDSHAKE, b_handshake_envio);
+    enviar_paquete(paquete, socket_kernel);
+}
+
+/**
+* @fn     int enviar_handshake_memoria(t_fragmento_memoria* fragmento, t_canal_compartido** canal, t_log* cpu_logger)
+* @brief  Prepara la lectura del socket de un fragmento de memoria y le envía el handshake con las capacidades que ofrece la CPU (y el canal de memoria compartida, si se configuró y se pidió).
+* @param  fragmento Fragmento de memoria recién conectado.
+* @param  canal Donde se devuelve el canal compartido ofrecido, NULL si no se ofreció. Con NULL no se ofrece.
+* @param  cpu_logger Logger para imprimir información de control y errores.
+* @return Capacidades ofrecidas, para recibir_handshake_memoria().
+*/
+int enviar_handshake_memoria(t_fragmento_memoria* fragmento, t_canal_compartido** canal, t_log* cpu_logger) {
+    fragmento->lector = crear_lector_socket(fragmento->socket, CAPACIDAD_LECTOR_SOCKET);
+    fragmento->pedidos = crear_tabla_pedidos(false); //el handshake viaja sin id
+    int capacidades = configuracion()->pedidos_multiplexados ? CAPACIDAD_IDS_DE_PEDIDO : 0;
+    if (configuracion()->codec_paginas) {
+        capacidades |= CAPACIDAD_CODEC_PAGINAS;
+    }
+    if (configuracion()->mensajes_fijos) {
+        capacidades |= CAPACIDAD_MENSAJES_FIJOS;
+    }
+    if (configuracion()->accesos_vectorizados) {
+        capacidades |= CAPACIDAD_ACCESOS_VECTORIZADOS;
+    }
+    t_canal_compartido* ofrecido = canal != NULL ? crear_canal_memoria(cpu_logger) : NULL;
+    if (canal != NULL) {
+        *canal = ofrecido;
     }
-    else {
-        log_info(cpu_logger, "Conectado a MEMORIA");
-        //Pedirle a memoria que nos envie los datos
-        t_buffer* pedir_datos = crear_buffer();
-        cargar_int_al_buffer(pedir_datos, RESULT_OK);
-        t_paquete *paquete = crear_paquete(CPU_M_HANDSHAKE, pedir_datos); 
-        enviar_paquete(paquete, socket_memoria);
-
-        // op code que se recibe M_CPU_HANDSHAKE
-        int op_code = recibir_operacion(socket_memoria);
-        if (op_code ==  M_CPU_HANDSHAKE){
-            t_buffer* buffer = recibir_buffer(socket_memoria);
-
-            tam_pagina = extraer_int_del_buffer(buffer); // recibo el tamaño de página
-            tam_memoria = extraer_int_del_buffer(buffer); // recibo el tamaño de memoria
-            entradas_tabla = extraer_int_del_buffer(buffer); // recibo las entradas por tabla
-            cantidad_niveles = extraer_int_del_buffer(buffer); // recibo la cantidad de niveles
+    if (ofrecido != NULL) {
+        capacidades |= CAPACIDAD_MEMORIA_COMPARTIDA;
+    }
+    //Pedirle a memoria que nos envie los datos
+    t_buffer* pedir_datos = crear_buffer();
+    cargar_int_al_buffer(pedir_datos, RESULT_OK);
+    cargar_int_al_buffer(pedir_datos, capacidades); // capacidades que ofrece la CPU; una memoria vieja lo ignora
+    if (ofrecido != NULL) { // memoria abre el canal por /proc/<pid>/fd/<memfd>
+        cargar_int_al_buffer(pedir_datos, getpid());
+        cargar_int_al_buffer(pedir_datos, ofrecido->memfd);
+        cargar_int_al_buffer(pedir_datos, (int)ofrecido->tamanio);
+    }
+    t_paquete *paquete = crear_paquete(CPU_M_HANDSHAKE, pedir_datos); 
+    enviar_paquete(paquete, fragmento->socket);
+    return capacidades;
+}
+
+/**
+* @fn     void recibir_handshake_memoria(t_fragmento_memoria* fragmento, int capacidades, t_canal_compartido* canal, t_log* cpu_logger)
+* @brief  Recibe la respuesta de un fragmento de memoria al handshake: los parámetros de memoria (tamaño de página, tamaño de memoria, entradas por tabla y cantidad de niveles), las capacidades que aceptó y, opcionalmente, el primer marco que guarda. Sin primer marco, los fragmentos se reparten los marcos consecutivos en el orden de FRAGMENTOS_MEMORIA. Todos los fragmentos tienen que acordar los mismos parámetros y capacidades que el primero: los pedidos se arman igual para cualquiera. Si no, termina la ejecución.
+* @param  fragmento Fragmento de memoria.
+* @param  capacidades Capacidades ofrecidas en enviar_handshake_memoria().
+* @param  canal Canal compartido ofrecido, o NULL. Si memoria no lo acepta se cierra.
+* @param  cpu_logger Logger para imprimir información de control y errores.
+* @return Ninguno
+*/
+void recibir_handshake_memoria(t_fragmento_memoria* fragmento, int capacidades, t_canal_compartido* canal, t_log* cpu_logger) {
+    // op code que se recibe M_CPU_HANDSHAKE
+    t_buffer buffer;
+    int op_code = recibir_de_fragmento(fragmento, 0, &buffer);
+    if (op_code ==  M_CPU_HANDSHAKE){
+        t_lector_buffer lector = crear_lector(&buffer);
+
+        int pagina = leer_int_del_buffer(&lector); // recibo el tamaño de página
+        int memoria = leer_int_del_buffer(&lector); // recibo el tamaño de memoria
+        int entradas = leer_int_del_buffer(&lector); // recibo las entradas por tabla
+        int niveles = leer_int_del_buffer(&lector); // recibo la cantidad de niveles
+        int aceptadas = quedan_datos_en_lector(&lector) ? leer_int_del_buffer(&lector) : 0; // capacidades que acepto memoria
+        int primer_marco = quedan_datos_en_lector(&lector) ? leer_int_del_buffer(&lector) : -1; // solo si memoria esta fragmentada
+        fragmento->pedidos->habilitada = (capacidades & aceptadas & CAPACIDAD_IDS_DE_PEDIDO) != 0;
+        bool codificadas = (capacidades & aceptadas & CAPACIDAD_CODEC_PAGINAS) != 0;
+        bool con_esquema = (capacidades & aceptadas & CAPACIDAD_MENSAJES_FIJOS) != 0;
+        bool en_lote = (capacidades & aceptadas & CAPACIDAD_ACCESOS_VECTORIZADOS) != 0;
+
+        if (fragmento == &fragmentos_memoria[0]) {
+            tam_pagina = pagina;
+            tam_memoria = 0;
+            entradas_tabla = entradas;
+            cantidad_niveles = niveles;
+            paginas_codificadas = codificadas;
+            mensajes_con_esquema = con_esquema;
+            accesos_en_lote = en_lote;
+            log_debug(cpu_logger, "Pedidos multiplexados con memoria: %s", fragmento->pedidos->habilitada ? "SI" : "NO");
+            log_debug(cpu_logger, "Paginas codificadas con memoria: %s", paginas_codificadas ? "SI" : "NO");
+            log_debug(cpu_logger, "Mensajes de tamanio fijo con memoria: %s", mensajes_con_esquema ? "SI" : "NO");
+            log_debug(cpu_logger, "Accesos vectorizados con memoria: %s", accesos_en_lote ? "SI" : "NO");
+        }
+        else if (pagina != tam_pagina || entradas != entradas_tabla || niveles != cantidad_niveles
+            || fragmento->pedidos->habilitada != fragmentos_memoria[0].pedidos->habilitada
+            || codificadas != paginas_codificadas || con_esquema != mensajes_con_esquema || en_lote != accesos_en_lote) {
+            log_error(cpu_logger, "ERROR: el fragmento de memoria %s no acordo los mismos parametros y capacidades que %s", fragmento->direccion, fragmentos_memoria[0].direccion);
+            exit(EXIT_FAILURE);
+        }
+        fragmento->primer_marco = primer_marco != -1 ? primer_marco : tam_memoria / tam_pagina;
+        fragmento->cantidad_marcos = memoria / pagina;
+        tam_memoria += memoria;
+        if (cantidad_fragmentos > 1) {
+            log_info(cpu_logger, "Fragmento de memoria %s: marcos %d a %d", fragmento->direccion, fragmento->primer_marco, fragmento->primer_marco + fragmento->cantidad_marcos - 1);
+        }
+
+        if (canal != NULL && (aceptadas & CAPACIDAD_MEMORIA_COMPARTIDA)) { // a partir de aca los mensajes van por los anillos
+            canal_memoria = canal;
+            fragmento->lector->anillo = canal->entrada;
+            canal = NULL;
+        }
+        if (fragmento == &fragmentos_memoria[0]) {
+            log_debug(cpu_logger, "Transporte con memoria: %s", canal_memoria != NULL ? "MEMORIA_COMPARTIDA" : "SOCKET");
         }
     }
+    cerrar_canal_compartido(canal); // memoria no lo acepto
 }
 
 /**
 * @fn     void atender_kernel(t_log* cpu_logger)
-* @brief  Crea hilos para atender los mensajes de kernel dispatch e interrupt. Se asegura de que ambos canales estén siendo escuchados y gestionados correctamente.
+* @brief  Atiende los mensajes de kernel dispatch en este hilo, que es el de la CPU virtual y tiene su estado, y crea un hilo que escucha kernel interrupt y deja las interrupciones en el buzón de esta CPU. Vuelve cuando el kernel cierra las dos conexiones.
 * @param  cpu_logger Logger para imprimir información de control y errores.
 * @return Ninguno
 */
 void atender_kernel(t_log* cpu_logger) { //Atiendo los mensajes de KERNEL DISPATCH (como cliente)
     pthread_t hilo_cpu_interrupt;
-    pthread_t hilo_cpu_dispatch;
 
-    if(pthread_create(&hilo_cpu_dispatch, NULL, (void*) atender_kernel_cpu_dispatch, cpu_logger) != 0){
-        log_error(cpu_logger, "ERROR al crear el hilo con para atender el kernel dispatch");
-    }
-    
-    if(pthread_create(&hilo_cpu_interrupt, NULL, (void*) atender_kernel_cpu_interrupt, cpu_logger) != 0){
+    // El hilo de interrupt no ve el estado de esta CPU virtual: se le pasa su socket y su buzón
+    t_escucha_interrupt* escucha = malloc(sizeof(t_escucha_interrupt));
+    escucha->socket_kernel_interrupt = socket_kernel_interrupt;
+    escucha->buzon = buzon_interrupcion;
+    escucha->logger = cpu_logger;
+    if(pthread_create(&hilo_cpu_interrupt, NULL, escuchar_kernel_interrupt, escucha) != 0){
         log_error(cpu_logger, "ERROR al crear el hilo con para atender el kernel interrupt");
+        free(escucha);
+        return;
     }
-    
-    pthread_detach(hilo_cpu_dispatch);
+
+    atender_kernel_cpu_dispatch(cpu_logger);
+    shutdown(socket_kernel_interrupt, SHUT_RD); //si el kernel solo cerró dispatch, que el hilo de interrupt no quede esperando
     pthread_join(hilo_cpu_interrupt, NULL);
 }
 
 
 /**
-* @fn     void cerrar_cpu(t_log* cpu_logger)
-* @brief  Libera las conexiones abiertas, destruye la configuración y los logs, y limpia recursos asociados a la CPU. Es llamada al finalizar la ejecución para evitar fugas de memoria y recursos.
+* @fn     void cerrar_cpu_virtual(t_log* cpu_logger)
+* @brief  Libera las conexiones, el buzón de interrupciones, las huellas de los procesos (escribiéndolas en la imagen caliente), sus estadísticas y el pool de buffers de la CPU virtual del hilo que la llama. La llama cada CPU virtual al terminar, antes de cerrar_cpu().
 * @param  cpu_logger Logger para imprimir información de control y errores.
 * @return Ninguno
 */
-void cerrar_cpu(t_log* cpu_logger) {
+void cerrar_cpu_virtual(t_log* cpu_logger) {
     //Conexiones
-    liberar_conexion(socket_memoria);
+    cerrar_canal_compartido(canal_memoria);
+    cerrar_fragmentos_memoria(fragmentos_memoria); // incluye socket_memoria, lector_memoria y pedidos_memoria
+    destruir_buffer_escrituras(escrituras_pendientes);
+    destruir_calentamiento(calentamiento);
     liberar_conexion(socket_kernel_dispatch);
     liberar_conexion(socket_kernel_interrupt);
 
-    //Config
-    config_destroy(cpu_config);
+    //Interrupciones
+    destruir_buzon_interrupcion(&buzon_principal);
+
+    //Huellas de los procesos en TLB y caché (antes, a la imagen caliente)
+    escribir_imagen_caliente();
+    region_imagen = NULL;
+    destruir_huellas();
+
+    //Estadisticas (quedan en los totales de las CPU virtuales que terminaron)
+    retirar_estadisticas_del_hilo();
+
+    //Decodificador de instrucciones y entrada de caché guardada para reusar
+    liberar_decodificador();
+    destruir_entrada_cache(entrada_cache_libre);
+    entrada_cache_libre = NULL;
+
+    //Pool de paquetes y buffers
+    t_contadores_pool contadores = contadores_pool_del_hilo();
+    log_info(cpu_logger, "Pool de buffers: %llu reservas, %llu al sistema, %llu devoluciones, %llu al sistema",
+        (unsigned long long)contadores.reservas, (unsigned long long)contadores.reservas_sistema,
+        (unsigned long long)contadores.liberaciones, (unsigned long long)contadores.liberaciones_sistema);
+    vaciar_pool_del_hilo();
+}
+
+/**
+* @fn     void cerrar_cpu(t_log* cpu_logger)
+* @brief  Libera lo que comparten todas las CPU virtuales del proceso: la traza, la imagen caliente, la configuración, las estadísticas y los logs. Es llamada al finalizar la ejecución, cuando ya terminaron todas las CPU virtuales, para evitar fugas de memoria y recursos.
+* @param  cpu_logger Logger para imprimir información de control y errores.
+* @return Ninguno
+*/
+void cerrar_cpu(t_log* cpu_logger) {
+    //Interrupciones
+    loguear_latencias_interrupcion(cpu_logger);
+
+    //Traza binaria
+    cerrar_traza();
+
+    //Imagen caliente
+    cerrar_imagen_caliente();
+
+    //Config y estadisticas (el último volcado, con todas las CPU virtuales ya cerradas)
+    detener_recarga_configuracion();
+    detener_estadisticas();
+    destruir_configuracion();
     
-    //Logs
+    //Logs (primero se vacía el diferido, que escribe con el mismo t_log)
+    destruir_log_diferido(cpu_log_diferido);
+    cpu_log_diferido = NULL;
+    log_debug(cpu_logger, "Recursos liberados y CPU cerrada.\n");
     log_destroy(cpu_logger);
 
     //Semaforos ... (proximamente)
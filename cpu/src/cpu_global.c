@@ -2,23 +2,50 @@
 #include "mmu.h"
 
 t_log* cpu_logger = NULL;
-t_config* cpu_config = NULL;
+t_log_diferido* cpu_log_diferido = NULL;
+t_config_cpu* _Atomic configuracion_cpu = NULL;
+pthread_t hilo_recarga_config;
+int fin_recarga_config = -1;
+t_traza traza = { .archivo = -1, .mutex = PTHREAD_MUTEX_INITIALIZER };
 
-int socket_cpu = -1;
-int socket_memoria = -1;
-int socket_kernel_dispatch = -1;
-int socket_kernel_interrupt = -1;
+// Estado de cada CPU virtual: cada una corre en su hilo (ver cpus_virtuales.c)
+__thread int socket_cpu = -1;
+__thread int socket_memoria = -1;
+__thread t_lector_socket* lector_memoria = NULL;
+__thread t_tabla_pedidos* pedidos_memoria = NULL;
+__thread t_canal_compartido* canal_memoria = NULL;
+__thread t_fragmento_memoria* fragmentos_memoria = NULL;
+__thread int cantidad_fragmentos = 0;
+__thread bool paginas_codificadas = false;
+__thread bool mensajes_con_esquema = false;
+__thread bool accesos_en_lote = false;
+__thread t_buffer_escrituras* escrituras_pendientes = NULL;
+__thread t_calentamiento* calentamiento = NULL;
+__thread t_huellas huellas_procesos;
+t_imagen_caliente imagen_caliente = { .archivo = -1 };
+__thread t_region_imagen* region_imagen = NULL; // la de esta CPU virtual en la imagen caliente
+__thread int64_t imagen_escrita_ns = 0;
+__thread t_estadisticas_cpu estadisticas_cpu; // la suma el hilo de estadísticas, sin lock
+t_volcado_estadisticas volcado_estadisticas = { .mutex = PTHREAD_MUTEX_INITIALIZER, .senal = -1, .despertar = -1 };
+__thread t_registro_traza registro_traza; // el de la instrucción que se está ejecutando en este hilo
+__thread uint32_t pedido_instruccion = 0;
+__thread int pc_pedido = -1;
+__thread int socket_kernel_dispatch = -1;
+__thread int socket_kernel_interrupt = -1;
+__thread t_decodificador decodificador; // instrucción de la CPU virtual, ver decode()
 
-bool interrupt = false;
-int pid = 0;
-int pc = 0;
+__thread t_buzon_interrupcion buzon_principal;
+__thread t_buzon_interrupcion* buzon_interrupcion = NULL; // &buzon_principal o el del contexto cargado
+__thread int pid = 0;
+__thread int pc = 0;
 
-int tam_pagina;
-int tam_memoria;
-int entradas_tabla;
-int cantidad_niveles;
+__thread int tam_pagina;
+__thread int tam_memoria;
+__thread int entradas_tabla;
+__thread int cantidad_niveles;
 
-t_list* lista_tlb;
-t_list* lista_cache;
-int desplazamiento;
-int frame;
+__thread t_list* lista_tlb;
+__thread t_list* lista_cache;
+__thread t_entrada_cache* entrada_cache_libre = NULL; // la última que salió de la caché, ver crear_entrada_cache()
+__thread int desplazamiento;
+__thread int accesos_cache = 0;
@@ -0,0 +1,110 @@
+#define _GNU_SOURCE // sched_getaffinity, pthread_setaffinity_np y CPU_SET
+#include "../include/cpu.h"
+#include <sched.h>
+
+/**
+* @fn     void ejecutar_cpus_virtuales(char* cpu_id, t_log* cpu_logger)
+* @brief  Corre las CPUS_VIRTUALES CPUs del proceso, cada una en su hilo, y espera a que terminen todas. Con una sola CPU virtual corre en el hilo que llama, como siempre.
+* @param  cpu_id Identificador de la CPU. Con más de una CPU virtual, cada una se anuncia al kernel como <cpu_id>_<n>.
+* @param  cpu_logger Logger para imprimir información de control y errores.
+* @return Ninguno
+*/
+void ejecutar_cpus_virtuales(char* cpu_id, t_log* cpu_logger) {
+    int cantidad = configuracion()->cpus_virtuales;
+    t_cpu_virtual* cpus = calloc(cantidad, sizeof(t_cpu_virtual));
+
+    for (int i = 0; i < cantidad; i++) {
+        cpus[i].id = i;
+        cpus[i].id_kernel = cantidad == 1 ? string_duplicate(cpu_id) : string_from_format("%s_%d", cpu_id, i);
+        cpus[i].nucleo = configuracion()->fijar_nucleos ? nucleo_para_cpu_virtual(i) : -1;
+        cpus[i].logger = cpu_logger;
+    }
+
+    if (cantidad == 1) {
+        correr_cpu_virtual(&cpus[0]);
+    }
+    else {
+        for (int i = 0; i < cantidad; i++) {
+            if (pthread_create(&cpus[i].hilo, NULL, correr_cpu_virtual, &cpus[i]) != 0) {
+                log_error(cpu_logger, "ERROR al crear el hilo de la CPU virtual %s", cpus[i].id_kernel);
+                exit(EXIT_FAILURE);
+            }
+        }
+        for (int i = 0; i < cantidad; i++) {
+            pthread_join(cpus[i].hilo, NULL);
+        }
+    }
+
+    for (int i = 0; i < cantidad; i++) {
+        free(cpus[i].id_kernel);
+    }
+    free(cpus);
+}
+
+/**
+* @fn     void* correr_cpu_virtual(void* arg)
+* @brief  Cuerpo de una CPU virtual: se fija a su núcleo, arma su buzón de interrupciones, su TLB, su caché y sus huellas de procesos (con las de la imagen caliente, si hay), se conecta a memoria y al kernel y ejecuta hasta que el kernel se desconecta. Todo el estado que toca es el __thread de su hilo.
+* @param  arg CPU virtual a correr (t_cpu_virtual*).
+* @return NULL
+*/
+void* correr_cpu_virtual(void* arg) {
+    t_cpu_virtual* cpu = arg;
+    if (cpu->nucleo != -1) {
+        fijar_a_nucleo(cpu);
+    }
+
+    anotar_estadisticas_del_hilo();
+    iniciar_buzon_interrupcion(&buzon_principal, configuracion()->interrupcion_eventfd);
+    buzon_interrupcion = &buzon_principal;
+    if (cache_habilitada()) {
+        inicializar_cache();
+    }
+    iniciar_TLB();
+    iniciar_huellas();
+    cargar_imagen_caliente(cpu->id, cpu->logger);
+
+    log_info(cpu->logger, "CPU virtual %s lista%s", cpu->id_kernel, cpu->nucleo != -1 ? " (fijada a un núcleo)" : "");
+    conexiones(cpu->id_kernel, cpu->logger);
+    cerrar_cpu_virtual(cpu->logger);
+    return NULL;
+}
+
+/**
+* @fn     int nucleo_para_cpu_virtual(int indice)
+* @brief  Elige el núcleo de una CPU virtual entre los que el proceso tiene permitidos (taskset, cgroups), repartiéndolas en orden.
+* @param  indice Número de CPU virtual.
+* @return Núcleo elegido, o -1 si no se pudo leer la afinidad del proceso.
+*/
+int nucleo_para_cpu_virtual(int indice) {
+    cpu_set_t permitidos;
+    if (sched_getaffinity(0, sizeof(permitidos), &permitidos) != 0 || CPU_COUNT(&permitidos) == 0) {
+        return -1;
+    }
+
+    int buscado = indice % CPU_COUNT(&permitidos);
+    for (int nucleo = 0; nucleo < CPU_SETSIZE; nucleo++) {
+        if (CPU_ISSET(nucleo, &permitidos) && buscado-- == 0) {
+            return nucleo;
+        }
+    }
+    return -1;
+}
+
+/**
+* @fn     void fijar_a_nucleo(t_cpu_virtual* cpu)
+* @brief  Fija el hilo que llama al núcleo de la CPU virtual. Si no se puede, la CPU sigue sin fijar.
+* @param  cpu CPU virtual que corre en este hilo.
+* @return Ninguno
+*/
+void fijar_a_nucleo(t_cpu_virtual* cpu) {
+    cpu_set_t nucleos;
+    CPU_ZERO(&nucleos);
+    CPU_SET(cpu->nucleo, &nucleos);
+    int error = pthread_setaffinity_np(pthread_self(), sizeof(nucleos), &nucleos);
+    if (error != 0) {
+        log_warning(cpu->logger, "No se pudo fijar la CPU virtual %s al núcleo %d: %s", cpu->id_kernel, cpu->nucleo, strerror(error));
+        cpu->nucleo = -1;
+        return;
+    }
+    log_debug(cpu->logger, "CPU virtual %s fijada al núcleo %d", cpu->id_kernel, cpu->nucleo);
+}
@@ -0,0 +1,389 @@
+#include "../include/cpu.h"
+#include <errno.h>
+#include <fcntl.h>
+#include <poll.h>
+#include <signal.h>
+#include <time.h>
+#include <unistd.h>
+#include <sys/eventfd.h>
+#include <sys/signalfd.h>
+
+/**
+* @fn     void contar_instruccion(void)
+* @brief  Suma una instrucción ejecutada a la CPU virtual y al PID actual. El lugar del PID se busca solo cuando cambia de proceso.
+* @param  Ninguno
+* @return Ninguno
+*/
+void contar_instruccion(void) {
+    CONTAR(instrucciones);
+
+    t_instrucciones_pid* lugar = &estadisticas_cpu.por_pid[estadisticas_cpu.ultimo_pid];
+    if (atomic_load_explicit(&lugar->pid_mas_uno, memory_order_relaxed) != pid + 1) {
+        lugar = NULL;
+        int inicio = (unsigned)pid % PIDS_CONTADOS;
+        for (int i = 0; i < PIDS_CONTADOS && lugar == NULL; i++) {
+            int indice = (inicio + i) % PIDS_CONTADOS;
+            int ocupado = atomic_load_explicit(&estadisticas_cpu.por_pid[indice].pid_mas_uno, memory_order_relaxed);
+            if (ocupado == 0) {
+                atomic_store_explicit(&estadisticas_cpu.por_pid[indice].pid_mas_uno, pid + 1, memory_order_release);
+            }
+            if (ocupado == 0 || ocupado == pid + 1) {
+                estadisticas_cpu.ultimo_pid = indice;
+                lugar = &estadisticas_cpu.por_pid[indice];
+            }
+        }
+        if (lugar == NULL) { // la tabla está llena
+            CONTAR(instrucciones_otros_pids);
+            return;
+        }
+    }
+    SUMAR_CONTADOR(lugar->instrucciones, 1);
+}
+
+/**
+* @fn     void anotar_estadisticas_del_hilo(void)
+* @brief  Pone en cero los contadores de la CPU virtual del hilo que llama y los anota para que el volcado los sume.
+* @param  Ninguno
+* @return Ninguno
+*/
+void anotar_estadisticas_del_hilo(void) {
+    memset(&estadisticas_cpu, 0, sizeof(estadisticas_cpu));
+    pthread_mutex_lock(&volcado_estadisticas.mutex);
+    if (volcado_estadisticas.hilos == NULL) {
+        volcado_estadisticas.hilos = list_create();
+    }
+    list_add(volcado_estadisticas.hilos, &estadisticas_cpu);
+    pthread_mutex_unlock(&volcado_estadisticas.mutex);
+}
+
+/**
+* @fn     void retirar_estadisticas_del_hilo(void)
+* @brief  Pasa lo que contó la CPU virtual del hilo que llama a los totales de las que terminaron y la saca del volcado: sus contadores se liberan con el hilo.
+* @param  Ninguno
+* @return Ninguno
+*/
+void retirar_estadisticas_del_hilo(void) {
+    pthread_mutex_lock(&volcado_estadisticas.mutex);
+    sumar_estadisticas(&volcado_estadisticas.terminados, &estadisticas_cpu);
+    for (int i = 0; volcado_estadisticas.hilos != NULL && i < list_size(volcado_estadisticas.hilos); i++) {
+        if (list_get(volcado_estadisticas.hilos, i) == &estadisticas_cpu) {
+            list_remove(volcado_estadisticas.hilos, i);
+            break;
+        }
+    }
+    pthread_mutex_unlock(&volcado_estadisticas.mutex);
+}
+
+/**
+* @fn     void sumar_estadisticas(t_totales_cpu* totales, t_estadisticas_cpu* estadisticas)
+* @brief  Suma a los totales los contadores de una CPU virtual. Se puede llamar mientras la CPU sigue contando: lo que sume en el medio queda para el próximo volcado.
+* @param  totales Totales donde sumar.
+* @param  estadisticas Contadores de la CPU virtual.
+* @return Ninguno
+*/
+void sumar_estadisticas(t_totales_cpu* totales, t_estadisticas_cpu* estadisticas) {
+    totales->tlb_hits += LEER_CONTADOR(estadisticas->tlb_hits);
+    totales->tlb_misses += LEER_CONTADOR(estadisticas->tlb_misses);
+    totales->tlb_reemplazos += LEER_CONTADOR(estadisticas->tlb_reemplazos);
+    totales->cache_hits += LEER_CONTADOR(estadisticas->cache_hits);
+    totales->cache_misses += LEER_CONTADOR(estadisticas->cache_misses);
+    totales->cache_reemplazos += LEER_CONTADOR(estadisticas->cache_reemplazos);
+    totales->cache_reemplazos_modificadas += LEER_CONTADOR(estadisticas->cache_reemplazos_modificadas);
+    totales->instrucciones += LEER_CONTADOR(estadisticas->instrucciones);
+    totales->instrucciones_otros_pids += LEER_CONTADOR(estadisticas->instrucciones_otros_pids);
+    totales->interrupciones_atendidas += LEER_CONTADOR(estadisticas->interrupciones_atendidas);
+    totales->interrupciones_descartadas += LEER_CONTADOR(estadisticas->interrupciones_descartadas);
+
+    for (int i = 0; i < PIDS_CONTADOS; i++) {
+        int pid_mas_uno = atomic_load_explicit(&estadisticas->por_pid[i].pid_mas_uno, memory_order_acquire);
+        if (pid_mas_uno != 0) {
+            sumar_instrucciones_pid(totales, pid_mas_uno - 1, LEER_CONTADOR(estadisticas->por_pid[i].instrucciones));
+        }
+    }
+}
+
+/**
+* @fn     void acumular_totales(t_totales_cpu* totales, const t_totales_cpu* otros)
+* @brief  Suma a unos totales los de otro grupo de CPU virtuales.
+* @param  totales Totales donde sumar.
+* @param  otros Totales a sumar.
+* @return Ninguno
+*/
+void acumular_totales(t_totales_cpu* totales, const t_totales_cpu* otros) {
+    totales->tlb_hits += otros->tlb_hits;
+    totales->tlb_misses += otros->tlb_misses;
+    totales->tlb_reemplazos += otros->tlb_reemplazos;
+    totales->cache_hits += otros->cache_hits;
+    totales->cache_misses += otros->cache_misses;
+    totales->cache_reemplazos += otros->cache_reemplazos;
+    totales->cache_reemplazos_modificadas += otros->cache_reemplazos_modificadas;
+    totales->instrucciones += otros->instrucciones;
+    totales->instrucciones_otros_pids += otros->instrucciones_otros_pids;
+    totales->interrupciones_atendidas += otros->interrupciones_atendidas;
+    totales->interrupciones_descartadas += otros->interrupciones_descartadas;
+
+    for (int i = 0; i < otros->cantidad_pids; i++) {
+        sumar_instrucciones_pid(totales, otros->pids[i], otros->instrucciones_pid[i]);
+    }
+}
+
+/**
+* @fn     void sumar_instrucciones_pid(t_totales_cpu* totales, int pid, uint64_t instrucciones)
+* @brief  Suma instrucciones de un PID a los totales. Si ya no entran más PIDs, van a las de otros PIDs.
+* @param  totales Totales donde sumar.
+* @param  pid PID del proceso.
+* @param  instrucciones Instrucciones a sumar.
+* @return Ninguno
+*/
+void sumar_instrucciones_pid(t_totales_cpu* totales, int pid, uint64_t instrucciones) {
+    for (int i = 0; i < totales->cantidad_pids; i++) {
+        if (totales->pids[i] == pid) {
+            totales->instrucciones_pid[i] += instrucciones;
+            return;
+        }
+    }
+    if (totales->cantidad_pids == PIDS_CONTADOS) {
+        totales->instrucciones_otros_pids += instrucciones;
+        return;
+    }
+    totales->pids[totales->cantidad_pids] = pid;
+    totales->instrucciones_pid[totales->cantidad_pids] = instrucciones;
+    totales->cantidad_pids++;
+}
+
+/**
+* @fn     char* armar_volcado_estadisticas(void)
+* @brief  Suma los contadores de todas las CPU virtuales (las que corren y las que terminaron), el histograma de latencias de interrupción y los contadores del protocolo, y los arma como líneas CLAVE=valor. Los contadores por PID, latencia y op_code que quedaron en cero no se escriben.
+* @param  Ninguno
+* @return String a liberar con free.
+*/
+char* armar_volcado_estadisticas(void) {
+    t_totales_cpu* totales = calloc(1, sizeof(t_totales_cpu));
+    pthread_mutex_lock(&volcado_estadisticas.mutex);
+    acumular_totales(totales, &volcado_estadisticas.terminados);
+    for (int i = 0; volcado_estadisticas.hilos != NULL && i < list_size(volcado_estadisticas.hilos); i++) {
+        sumar_estadisticas(totales, list_get(volcado_estadisticas.hilos, i));
+    }
+    pthread_mutex_unlock(&volcado_estadisticas.mutex);
+
+    t_totales_protocolo* protocolo = malloc(sizeof(t_totales_protocolo));
+    sumar_contadores_protocolo(protocolo);
+
+    char* volcado = string_from_format("TIEMPO=%lld\n", (long long)time(NULL));
+    string_append_with_format(&volcado, "TLB_HITS=%llu\n", (unsigned long long)totales->tlb_hits);
+    string_append_with_format(&volcado, "TLB_MISSES=%llu\n", (unsigned long long)totales->tlb_misses);
+    string_append_with_format(&volcado, "TLB_REEMPLAZOS=%llu\n", (unsigned long long)totales->tlb_reemplazos);
+    string_append_with_format(&volcado, "CACHE_HITS=%llu\n", (unsigned long long)totales->cache_hits);
+    string_append_with_format(&volcado, "CACHE_MISSES=%llu\n", (unsigned long long)totales->cache_misses);
+    string_append_with_format(&volcado, "CACHE_REEMPLAZOS=%llu\n", (unsigned long long)totales->cache_reemplazos);
+    string_append_with_format(&volcado, "CACHE_REEMPLAZOS_MODIFICADAS=%llu\n", (unsigned long long)totales->cache_reemplazos_modificadas);
+    string_append_with_format(&volcado, "INSTRUCCIONES=%llu\n", (unsigned long long)totales->instrucciones);
+    for (int i = 0; i < totales->cantidad_pids; i++) {
+        if (totales->instrucciones_pid[i] > 0) {
+            string_append_with_format(&volcado, "INSTRUCCIONES_PID_%d=%llu\n", totales->pids[i], (unsigned long long)totales->instrucciones_pid[i]);
+        }
+    }
+    string_append_with_format(&volcado, "INSTRUCCIONES_OTROS_PIDS=%llu\n", (unsigned long long)totales->instrucciones_otros_pids);
+    string_append_with_format(&volcado, "INTERRUPCIONES_ATENDIDAS=%llu\n", (unsigned long long)totales->interrupciones_atendidas);
+    string_append_with_format(&volcado, "INTERRUPCIONES_DESCARTADAS=%llu\n", (unsigned long long)totales->interrupciones_descartadas);
+    for (int i = 0; i < CANTIDAD_BUCKETS_LATENCIA; i++) {
+        uint64_t cantidad = atomic_load_explicit(&latencias_interrupcion[i], memory_order_relaxed);
+        if (cantidad > 0) {
+            string_append_with_format(&volcado, "LATENCIA_INTERRUPCION_NS_%llu=%llu\n", (unsigned long long)(1ULL << i), (unsigned long long)cantidad);
+        }
+    }
+    for (int i = 0; i < CODIGOS_CONTADOS; i++) {
+        char numero[12];
+        const char* codigo = nombre_del_mensaje(i);
+        if (codigo == NULL) { // fuera de las tablas de utils/mensajes.h va el número
+            snprintf(numero, sizeof(numero), "%d", i);
+            codigo = numero;
+        }
+        if (protocolo->mensajes_enviados[i] > 0) {
+            string_append_with_format(&volcado, "PROTOCOLO_MENSAJES_ENVIADOS_%s=%llu\n", codigo, (unsigned long long)protocolo->mensajes_enviados[i]);
+            string_append_with_format(&volcado, "PROTOCOLO_BYTES_ENVIADOS_%s=%llu\n", codigo, (unsigned long long)protocolo->bytes_enviados[i]);
+        }
+        if (protocolo->mensajes_recibidos[i] > 0) {
+            string_append_with_format(&volcado, "PROTOCOLO_MENSAJES_RECIBIDOS_%s=%llu\n", codigo, (unsigned long long)protocolo->mensajes_recibidos[i]);
+            string_append_with_format(&volcado, "PROTOCOLO_BYTES_RECIBIDOS_%s=%llu\n", codigo, (unsigned long long)protocolo->bytes_recibidos[i]);
+        }
+    }
+
+    free(protocolo);
+    free(totales);
+    return volcado;
+}
+
+/**
+* @fn     void volcar_estadisticas(void)
+* @brief  Escribe las estadísticas en el archivo de ESTADISTICAS, armándolo al lado y renombrándolo encima para que quien lo lea nunca vea uno a medias. Sin archivo, las escribe en el log.
+* @param  Ninguno
+* @return Ninguno
+*/
+void volcar_estadisticas(void) {
+    char* volcado = armar_volcado_estadisticas();
+    if (volcado_estadisticas.archivo == NULL) {
+        log_info(volcado_estadisticas.logger, "Estadisticas:\n%s", volcado);
+        free(volcado);
+        return;
+    }
+
+    char* temporal = string_from_format("%s.tmp", volcado_estadisticas.archivo);
+    int archivo = open(temporal, O_WRONLY | O_CREAT | O_TRUNC | O_CLOEXEC, 0644);
+    size_t tamanio = strlen(volcado);
+    if (archivo == -1 || write(archivo, volcado, tamanio) != (ssize_t)tamanio) {
+        perror("No se pudieron escribir las estadisticas");
+    }
+    else if (rename(temporal, volcado_estadisticas.archivo) == -1) {
+        perror("No se pudo reemplazar el archivo de estadisticas");
+    }
+    if (archivo != -1) {
+        close(archivo);
+    }
+    free(temporal);
+    free(volcado);
+}
+
+/**
+* @fn     void bloquear_senal_estadisticas(void)
+* @brief  Bloquea SIGUSR1 en el hilo que llama; los hilos que cree después lo heredan, así la señal solo se lee por el signalfd del hilo de estadísticas. Se llama antes de crear cualquier hilo.
+* @param  Ninguno
+* @return Ninguno
+*/
+void bloquear_senal_estadisticas(void) {
+    sigset_t senales;
+    sigemptyset(&senales);
+    sigaddset(&senales, SIGUSR1);
+    if (pthread_sigmask(SIG_BLOCK, &senales, NULL) != 0) {
+        perror("No se pudo bloquear SIGUSR1");
+        exit(EXIT_FAILURE);
+    }
+}
+
+/**
+* @fn     void* esperar_volcado_estadisticas(void* arg)
+* @brief  Hilo que vuelca las estadísticas cuando llega SIGUSR1 y cada PERIODO_ESTADISTICAS ms, hasta que detener_estadisticas() lo despierta. El volcado periódico tiene un vencimiento absoluto: las señales y los avisos esperan solo lo que le falta, así no lo postergan. Cuando una recarga cambia el período, avisar_periodo_estadisticas() lo despierta y el próximo vence un período nuevo después.
+* @param  arg No se usa.
+* @return NULL
+*/
+void* esperar_volcado_estadisticas(void* arg) {
+    struct pollfd esperas[2] = {
+        { .fd = volcado_estadisticas.senal, .events = POLLIN },
+        { .fd = volcado_estadisticas.despertar, .events = POLLIN }
+    };
+    int periodo = configuracion()->periodo_estadisticas;
+    int64_t vencimiento_ns = tiempo_actual_ns() + (int64_t)periodo * 1000000;
+
+    while (!atomic_load(&volcado_estadisticas.fin)) {
+        int espera = -1;
+        if (periodo > 0) {
+            int64_t falta_ns = vencimiento_ns - tiempo_actual_ns();
+            espera = falta_ns > 0 ? (int)((falta_ns + 999999) / 1000000) : 0;
+        }
+        int listos = poll(esperas, 2, espera);
+        if (listos == -1) {
+            if (errno == EINTR) {
+                continue;
+            }
+            perror("Error esperando SIGUSR1");
+            break;
+        }
+        if (esperas[1].revents & POLLIN) {
+            uint64_t avisos;
+            if (read(volcado_estadisticas.despertar, &avisos, sizeof(avisos)) == -1) {
+                break;
+            }
+            int nuevo = configuracion()->periodo_estadisticas;
+            if (nuevo != periodo) {
+                periodo = nuevo;
+                vencimiento_ns = tiempo_actual_ns() + (int64_t)periodo * 1000000;
+            }
+            continue; // con el período nuevo, o a terminar
+        }
+        if (esperas[0].revents & POLLIN) {
+            struct signalfd_siginfo senal;
+            if (read(volcado_estadisticas.senal, &senal, sizeof(senal)) == sizeof(senal)) {
+                volcar_estadisticas();
+            }
+        }
+        if (periodo > 0 && tiempo_actual_ns() >= vencimiento_ns) {
+            volcar_estadisticas();
+            vencimiento_ns += (int64_t)periodo * 1000000;
+            if (vencimiento_ns <= tiempo_actual_ns()) { // el volcado tardó más que un período: no se acumulan atrasados
+                vencimiento_ns = tiempo_actual_ns() + (int64_t)periodo * 1000000;
+            }
+        }
+    }
+    return NULL;
+}
+
+/**
+* @fn     void iniciar_estadisticas(char* cpu_id, t_log* cpu_logger)
+* @brief  Lanza el hilo que vuelca las estadísticas. SIGUSR1 ya tiene que estar bloqueado (bloquear_senal_estadisticas()).
+* @param  cpu_id Identificador de la CPU; el archivo es <ESTADISTICAS>.<cpu_id>.
+* @param  cpu_logger Logger donde se vuelcan si no hay ESTADISTICAS.
+* @return Ninguno
+*/
+void iniciar_estadisticas(char* cpu_id, t_log* cpu_logger) {
+    sigset_t senales;
+    sigemptyset(&senales);
+    sigaddset(&senales, SIGUSR1);
+
+    volcado_estadisticas.logger = cpu_logger;
+    if (configuracion()->estadisticas != NULL) {
+        volcado_estadisticas.archivo = string_from_format("%s.%s", configuracion()->estadisticas, cpu_id);
+    }
+    pthread_mutex_lock(&volcado_estadisticas.mutex);
+    if (volcado_estadisticas.hilos == NULL) {
+        volcado_estadisticas.hilos = list_create();
+    }
+    pthread_mutex_unlock(&volcado_estadisticas.mutex);
+
+    volcado_estadisticas.senal = signalfd(-1, &senales, SFD_CLOEXEC);
+    volcado_estadisticas.despertar = eventfd(0, EFD_CLOEXEC);
+    if (volcado_estadisticas.senal == -1 || volcado_estadisticas.despertar == -1
+        || pthread_create(&volcado_estadisticas.hilo, NULL, esperar_volcado_estadisticas, NULL) != 0) {
+        perror("No se pudo iniciar el volcado de estadisticas");
+        exit(EXIT_FAILURE);
+    }
+}
+
+/**
+* @fn     void avisar_periodo_estadisticas(void)
+* @brief  Despierta al hilo de estadísticas para que tome el PERIODO_ESTADISTICAS recargado.
+* @param  Ninguno
+* @return Ninguno
+*/
+void avisar_periodo_estadisticas(void) {
+    uint64_t uno = 1;
+    if (volcado_estadisticas.despertar != -1 && write(volcado_estadisticas.despertar, &uno, sizeof(uno)) != sizeof(uno)) {
+        perror("No se pudo avisar el período de estadisticas");
+    }
+}
+
+/**
+* @fn     void detener_estadisticas(void)
+* @brief  Termina el hilo de estadísticas, hace el último volcado (ya con todas las CPU virtuales cerradas) y libera lo que queda, incluidos los contadores del protocolo.
+* @param  Ninguno
+* @return Ninguno
+*/
+void detener_estadisticas(void) {
+    if (volcado_estadisticas.despertar == -1) {
+        return;
+    }
+    atomic_store(&volcado_estadisticas.fin, true);
+    avisar_periodo_estadisticas();
+    pthread_join(volcado_estadisticas.hilo, NULL);
+    close(volcado_estadisticas.despertar);
+    close(volcado_estadisticas.senal);
+    volcado_estadisticas.despertar = -1;
+    volcado_estadisticas.senal = -1;
+
+    volcar_estadisticas();
+
+    free(volcado_estadisticas.archivo);
+    volcado_estadisticas.archivo = NULL;
+    list_destroy(volcado_estadisticas.hilos);
+    volcado_estadisticas.hilos = NULL;
+    destruir_contadores_protocolo();
+}
@@ -0,0 +1,290 @@
+#include "../include/cpu.h"
+
+/**
+* @fn     void ejecutar_hilos_hardware(char* cpu_id, t_log* cpu_logger)
+* @brief  Ejecuta la CPU sobre un bucle de eventos (epoll) de un solo hilo. Mantiene HILOS_HARDWARE contextos (PID, PC y buzón de interrupciones), cada uno con sus propias conexiones a memoria y kernel, de modo que el kernel ve una CPU lógica por contexto. Mientras un contexto espera la respuesta de un FETCH o su retardo de caché, la CPU ejecuta las instrucciones de otro contexto listo.
+* @param  cpu_id Identificador base de la CPU. Con más de un contexto, cada CPU lógica se anuncia al kernel como <cpu_id>_<n>.
+* @param  cpu_logger Logger para imprimir información de control y errores.
+* @return Ninguno
+*/
+void ejecutar_hilos_hardware(char* cpu_id, t_log* cpu_logger) {
+    int cantidad = configuracion()->hilos_hardware;
+    int activos = cantidad;
+    t_bucle_eventos* bucle = crear_bucle_eventos();
+    t_contexto_hardware* contextos = calloc(cantidad, sizeof(t_contexto_hardware));
+
+    for (int i = 0; i < cantidad; i++) {
+        t_contexto_hardware* contexto = &contextos[i];
+        char* id_logico = cantidad == 1 ? string_duplicate(cpu_id) : string_from_format("%s_%d", cpu_id, i);
+        establecer_conexiones(id_logico, cpu_logger);
+
+        contexto->id = i;
+        contexto->estado = CONTEXTO_LIBRE;
+        contexto->logger = cpu_logger;
+        contexto->bucle = bucle;
+        contexto->contextos_activos = &activos;
+        iniciar_buzon_interrupcion(&contexto->buzon, configuracion()->interrupcion_eventfd);
+        guardar_contexto(contexto);
+
+        // Dispatch e interrupt se leen sin bloquear; memoria solo se escucha con un FETCH pendiente
+        contexto->dispatch = crear_conexion_eventos(bucle, contexto->socket_kernel_dispatch, atender_dispatch_contexto, contexto);
+        contexto->interrupt = crear_conexion_eventos(bucle, contexto->socket_kernel_interrupt, atender_interrupt_contexto, contexto);
+        contexto->memoria = registrar_en_bucle(bucle, contexto->socket_memoria, 0, avanzar_contexto, contexto);
+        contexto->temporizador = crear_temporizador(bucle, vencer_retardo_contexto, contexto);
+        if (contexto->dispatch == NULL || contexto->interrupt == NULL || contexto->memoria == NULL || contexto->temporizador == NULL) {
+            log_error(cpu_logger, "No se pudo registrar el hilo de hardware %d en el bucle de eventos", i);
+            exit(EXIT_FAILURE);
+        }
+
+        log_info(cpu_logger, "Hilo de hardware %d listo como CPU %s", i, id_logico);
+        free(id_logico);
+    }
+
+    correr_bucle_eventos(bucle);
+
+    for (int i = 0; i < cantidad; i++) {
+        destruir_conexion_eventos(contextos[i].dispatch);
+        destruir_conexion_eventos(contextos[i].interrupt);
+        destruir_buzon_interrupcion(&contextos[i].buzon);
+        cerrar_fragmentos_memoria(contextos[i].fragmentos_memoria);
+        destruir_buffer_escrituras(contextos[i].escrituras_pendientes);
+        destruir_calentamiento(contextos[i].calentamiento);
+    }
+    destruir_bucle_eventos(bucle);
+    free(contextos);
+
+    // Los sockets ya se cerraron, que cerrar_cpu() no los vuelva a cerrar
+    fragmentos_memoria = NULL;
+    socket_memoria = -1;
+    lector_memoria = NULL;
+    pedidos_memoria = NULL;
+    escrituras_pendientes = NULL;
+    calentamiento = NULL;
+    socket_kernel_dispatch = -1;
+    socket_kernel_interrupt = -1;
+}
+
+/**
+* @fn     void cargar_contexto(t_contexto_hardware* contexto)
+* @brief  Carga el contexto en las variables globales que usa el ciclo de instrucción.
+* @param  contexto Contexto a cargar.
+* @return Ninguno
+*/
+void cargar_contexto(t_contexto_hardware* contexto) {
+    pid = contexto->pid;
+    pc = contexto->pc;
+    buzon_interrupcion = &contexto->buzon;
+    fragmentos_memoria = contexto->fragmentos_memoria;
+    socket_memoria = contexto->socket_memoria;
+    lector_memoria = contexto->lector_memoria;
+    pedidos_memoria = contexto->pedidos_memoria;
+    escrituras_pendientes = contexto->escrituras_pendientes;
+    calentamiento = contexto->calentamiento;
+    pedido_instruccion = contexto->pedido_instruccion;
+    pc_pedido = contexto->pc_pedido;
+    socket_kernel_dispatch = contexto->socket_kernel_dispatch;
+    socket_kernel_interrupt = contexto->socket_kernel_interrupt;
+}
+
+/**
+* @fn     void guardar_contexto(t_contexto_hardware* contexto)
+* @brief  Guarda en el contexto el estado de las variables globales del ciclo de instrucción.
+* @param  contexto Contexto donde guardar el estado.
+* @return Ninguno
+*/
+void guardar_contexto(t_contexto_hardware* contexto) {
+    contexto->pid = pid;
+    contexto->pc = pc;
+    contexto->fragmentos_memoria = fragmentos_memoria;
+    contexto->socket_memoria = socket_memoria;
+    contexto->lector_memoria = lector_memoria;
+    contexto->pedidos_memoria = pedidos_memoria;
+    contexto->escrituras_pendientes = escrituras_pendientes;
+    contexto->calentamiento = calentamiento;
+    contexto->pedido_instruccion = pedido_instruccion;
+    contexto->pc_pedido = pc_pedido;
+    contexto->socket_kernel_dispatch = socket_kernel_dispatch;
+    contexto->socket_kernel_interrupt = socket_kernel_interrupt;
+}
+
+/**
+* @fn     void atender_dispatch_contexto(void* dato, int cod_op, t_buffer* buffer)
+* @brief  Atiende un mensaje completo del socket dispatch de un contexto libre. Si el kernel despacha un proceso, envía el primer FETCH y deja el contexto esperando a memoria.
+* @param  dato Contexto dueño de la conexión.
+* @param  cod_op Código de operación recibido, -1 si el kernel se desconectó.
+* @param  buffer Contenido del mensaje, NULL si el kernel se desconectó.
+* @return Ninguno
+*/
+void atender_dispatch_contexto(void* dato, int cod_op, t_buffer* buffer) {
+    t_contexto_hardware* contexto = dato;
+    cargar_contexto(contexto);
+
+    switch (cod_op) {
+        case HANDSHAKE:
+        procesar_handshake_kernel(buffer, contexto->logger);
+        break;
+
+        case K_CPU_EXEC_PROCESO:
+        cargar_proceso_a_ejecutar(buffer, contexto->logger);
+        pedir_instruccion(contexto->logger);
+        esperar_memoria_contexto(contexto);
+        break;
+
+        case -1:
+        log_error(contexto->logger, "El kernel (%d) se desconecto del hilo de hardware %d", socket_kernel_dispatch, contexto->id);
+        terminar_contexto(contexto);
+        break;
+
+        default:
+        log_warning(contexto->logger, "Operacion desconocida de kernel (%d).", socket_kernel_dispatch);
+        break;
+    }
+
+    eliminar_buffer(buffer);
+    guardar_contexto(contexto);
+}
+
+/**
+* @fn     void atender_interrupt_contexto(void* dato, int cod_op, t_buffer* buffer)
+* @brief  Atiende un mensaje completo del socket interrupt de un contexto, dejando la interrupción en su buzón para que la atienda el contexto cuando vuelva a ejecutar.
+* @param  dato Contexto dueño de la conexión.
+* @param  cod_op Código de operación recibido, -1 si el kernel se desconectó.
+* @param  buffer Contenido del mensaje, NULL si el kernel se desconectó.
+* @return Ninguno
+*/
+void atender_interrupt_contexto(void* dato, int cod_op, t_buffer* buffer) {
+    t_contexto_hardware* contexto = dato;
+
+    switch (cod_op) {
+        case HANDSHAKE:
+        procesar_handshake_kernel(buffer, contexto->logger);
+        break;
+
+        case K_CPU_INTERRUPT_PROCESO:
+        cargar_interrupcion(buffer, &contexto->buzon);
+        break;
+
+        case -1:
+        log_error(contexto->logger, "El kernel (%d) se desconecto del hilo de hardware %d", contexto->socket_kernel_interrupt, contexto->id);
+        terminar_contexto(contexto);
+        break;
+
+        default:
+        log_warning(contexto->logger, "Operacion desconocida de kernel (%d).", contexto->socket_kernel_interrupt);
+        break;
+    }
+
+    eliminar_buffer(buffer);
+}
+
+/**
+* @fn     void avanzar_contexto(void* dato)
+* @brief  Ejecuta la instrucción que memoria devolvió para el contexto. Si el proceso sigue en la CPU, envía el FETCH de la siguiente sin esperar la respuesta o, si la instrucción usó la caché, lo difiere RETARDO_CACHE milisegundos sin bloquear a los demás contextos. Si la respuesta del FETCH ya se recibió (adelantado con pedidos multiplexados), la ejecuta en el momento: el socket no va a volver a avisar.
+* @param  dato Contexto cuya respuesta de memoria ya está disponible.
+* @return Ninguno
+*/
+void avanzar_contexto(void* dato) {
+    t_contexto_hardware* contexto = dato;
+    cargar_contexto(contexto);
+
+    int retardo = configuracion()->retardo_cache;
+    bool seguir = true;
+
+    while (seguir) {
+        int accesos_cache_antes = accesos_cache;
+        uint64_t reservas_antes = contadores_pool_del_hilo().reservas_sistema;
+        seguir = false;
+
+        if (!ejecutar_instruccion_pedida(contexto->logger)) {
+            liberar_contexto(contexto);
+        }
+        else if (accesos_cache != accesos_cache_antes && retardo > 0) {
+            contexto->estado = CONTEXTO_EN_RETARDO;
+            cambiar_eventos(contexto->bucle, contexto->memoria, 0);
+            armar_temporizador(contexto->temporizador, retardo);
+        }
+        else {
+            pedir_instruccion(contexto->logger);
+            seguir = respuesta_de_memoria_disponible(pedido_instruccion);
+        }
+
+        controlar_reservas_del_ciclo(reservas_antes, contexto->logger);
+        actualizar_imagen_caliente();
+    }
+
+    guardar_contexto(contexto);
+}
+
+/**
+* @fn     void vencer_retardo_contexto(void* dato)
+* @brief  Al vencer el retardo de caché del contexto, envía el FETCH de la siguiente instrucción.
+* @param  dato Contexto cuyo temporizador venció.
+* @return Ninguno
+*/
+void vencer_retardo_contexto(void* dato) {
+    t_contexto_hardware* contexto = dato;
+    if (contexto->estado != CONTEXTO_EN_RETARDO) return;
+
+    cargar_contexto(contexto);
+    pedir_instruccion(contexto->logger);
+    esperar_memoria_contexto(contexto);
+    bool ya_recibida = respuesta_de_memoria_disponible(pedido_instruccion);
+    guardar_contexto(contexto);
+
+    if (ya_recibida) {
+        avanzar_contexto(contexto);
+    }
+}
+
+/**
+* @fn     void esperar_memoria_contexto(t_contexto_hardware* contexto)
+* @brief  Deja el contexto esperando la respuesta de su FETCH: escucha el socket del fragmento de memoria del proceso y deja de leer dispatch hasta que el proceso salga de la CPU.
+* @param  contexto Contexto con un FETCH recién enviado.
+* @return Ninguno
+*/
+void esperar_memoria_contexto(t_contexto_hardware* contexto) {
+    if (contexto->memoria->fd != socket_memoria) { // el proceso despachado está en otro fragmento de memoria
+        descartar_del_bucle(contexto->bucle, contexto->memoria);
+        contexto->memoria = registrar_en_bucle(contexto->bucle, socket_memoria, 0, avanzar_contexto, contexto);
+        if (contexto->memoria == NULL) {
+            log_error(contexto->logger, "No se pudo registrar en el bucle de eventos la memoria del hilo de hardware %d", contexto->id);
+            exit(EXIT_FAILURE);
+        }
+    }
+    contexto->estado = CONTEXTO_ESPERANDO_MEMORIA;
+    pausar_conexion_eventos(contexto->dispatch);
+    cambiar_eventos(contexto->bucle, contexto->memoria, EPOLLIN);
+}
+
+/**
+* @fn     void liberar_contexto(t_contexto_hardware* contexto)
+* @brief  Deja el contexto libre para que el kernel le despache otro proceso.
+* @param  contexto Contexto cuyo proceso dejó la CPU.
+* @return Ninguno
+*/
+void liberar_contexto(t_contexto_hardware* contexto) {
+    contexto->estado = CONTEXTO_LIBRE;
+    cambiar_eventos(contexto->bucle, contexto->memoria, 0);
+    reanudar_conexion_eventos(contexto->dispatch);
+}
+
+/**
+* @fn     void terminar_contexto(t_contexto_hardware* contexto)
+* @brief  Saca al contexto del bucle de eventos. Cuando no queda ningún contexto activo, detiene el bucle.
+* @param  contexto Contexto cuyo kernel se desconectó.
+* @return Ninguno
+*/
+void terminar_contexto(t_contexto_hardware* contexto) {
+    if (contexto->estado == CONTEXTO_TERMINADO) return;
+
+    contexto->estado = CONTEXTO_TERMINADO;
+    pausar_conexion_eventos(contexto->dispatch);
+    pausar_conexion_eventos(contexto->interrupt);
+    quitar_del_bucle(contexto->bucle, contexto->memoria);
+    quitar_del_bucle(contexto->bucle, contexto->temporizador);
+
+    (*contexto->contextos_activos)--;
+    if (*contexto->contextos_activos == 0) {
+        detener_bucle_eventos(contexto->bucle);
+    }
+}
@@ -0,0 +1,413 @@
+#include "../include/cpu.h"
+
+/**
+* @fn     int capacidad_huella(void)
+* @brief  Máximo de páginas que puede tener una huella: todas las entradas de la TLB y de la caché.
+* @param  Ninguno
+* @return Cantidad de páginas.
+*/
+int capacidad_huella(void) {
+    return configuracion()->entradas_tlb + configuracion()->entradas_cache;
+}
+
+/**
+* @fn     void iniciar_huellas(void)
+* @brief  Reserva los HUELLAS_PROCESOS lugares de huella de la CPU virtual, todos libres. Lo que ocupan no crece después: al llenarse se olvida la huella más vieja.
+* @param  Ninguno
+* @return Ninguno
+*/
+void iniciar_huellas(void) {
+    huellas_procesos.cantidad = capacidad_huella() > 0 ? configuracion()->huellas_procesos : 0;
+    huellas_procesos.salidas = 0;
+    huellas_procesos.huellas = calloc(huellas_procesos.cantidad, sizeof(t_huella_proceso));
+    for (int i = 0; i < huellas_procesos.cantidad; i++) {
+        huellas_procesos.huellas[i].pid = -1;
+        huellas_procesos.huellas[i].paginas = malloc(capacidad_huella() * sizeof(t_pagina_huella));
+    }
+}
+
+/**
+* @fn     void destruir_huellas(void)
+* @brief  Libera las huellas de la CPU virtual.
+* @param  Ninguno
+* @return Ninguno
+*/
+void destruir_huellas(void) {
+    for (int i = 0; i < huellas_procesos.cantidad; i++) {
+        free(huellas_procesos.huellas[i].paginas);
+    }
+    free(huellas_procesos.huellas);
+    huellas_procesos.huellas = NULL;
+    huellas_procesos.cantidad = 0;
+}
+
+/**
+* @fn     t_calentamiento* crear_calentamiento(void)
+* @brief  Crea la lista de pedidos de fondo de un contexto, vacía. Devuelve NULL si la CPU no guarda huellas.
+* @param  Ninguno
+* @return Lista creada o NULL.
+*/
+t_calentamiento* crear_calentamiento(void) {
+    if (configuracion()->huellas_procesos == 0 || capacidad_huella() == 0) {
+        return NULL;
+    }
+    t_calentamiento* pendiente = malloc(sizeof(t_calentamiento));
+    pendiente->pedidos = malloc(capacidad_huella() * sizeof(t_pedido_calentamiento));
+    pendiente->cantidad = 0;
+    pendiente->enviado = true;
+    return pendiente;
+}
+
+/**
+* @fn     void destruir_calentamiento(t_calentamiento* pendiente)
+* @brief  Libera la lista de pedidos de fondo de un contexto, sin esperar las respuestas. Acepta NULL.
+* @param  pendiente Lista a liberar.
+* @return Ninguno
+*/
+void destruir_calentamiento(t_calentamiento* pendiente) {
+    if (pendiente == NULL) {
+        return;
+    }
+    free(pendiente->pedidos);
+    free(pendiente);
+}
+
+/**
+* @fn     void dejar_tlb_y_cache_del_proceso(bool puede_volver)
+* @brief  El proceso actual deja la CPU: abandona lo que se estaba pidiendo de fondo, guarda su huella si el kernel lo puede volver a despachar, libera sus entradas de TLB y caché y, si toca, actualiza la imagen caliente. Llamarla de nuevo sin que el proceso haya vuelto no pisa la huella.
+* @param  puede_volver false si el proceso terminó (EXIT).
+* @return Ninguno
+*/
+void dejar_tlb_y_cache_del_proceso(bool puede_volver) {
+    abandonar_calentamiento();
+    if (puede_volver) {
+        guardar_huella_del_proceso();
+    }
+    liberar_tlb_y_cache_del_proceso();
+    actualizar_imagen_caliente();
+}
+
+/**
+* @fn     t_huella_proceso* lugar_para_huella(int pid_proceso)
+* @brief  Elige dónde guardar la huella de un proceso: la suya si ya tenía, un lugar libre, o el de la huella más vieja.
+* @param  pid_proceso PID del proceso.
+* @return Lugar de huella.
+*/
+t_huella_proceso* lugar_para_huella(int pid_proceso) {
+    t_huella_proceso* elegida = &huellas_procesos.huellas[0];
+    for (int i = 0; i < huellas_procesos.cantidad; i++) {
+        t_huella_proceso* huella = &huellas_procesos.huellas[i];
+        if (huella->pid == pid_proceso) {
+            return huella;
+        }
+        if (elegida->pid != -1 && (huella->pid == -1 || huella->salida < elegida->salida)) {
+            elegida = huella;
+        }
+    }
+    return elegida;
+}
+
+/**
+* @fn     int buscar_pagina_en_huella(t_pagina_huella* paginas, int cantidad, int nro_pagina)
+* @brief  Busca una página entre las que se van juntando para una huella.
+* @param  paginas Páginas juntadas.
+* @param  cantidad Cantidad de páginas juntadas.
+* @param  nro_pagina Página buscada.
+* @return Posición de la página o -1 si no está.
+*/
+int buscar_pagina_en_huella(t_pagina_huella* paginas, int cantidad, int nro_pagina) {
+    for (int i = 0; i < cantidad; i++) {
+        if (paginas[i].pagina == nro_pagina) {
+            return i;
+        }
+    }
+    return -1;
+}
+
+/**
+* @fn     int juntar_huella(int pid_proceso, t_pagina_huella* paginas)
+* @brief  Junta las páginas que un proceso tiene en la caché y en la TLB. Van primero las de la caché y después las de la TLB, de la usada hace más tiempo a la más reciente: al calentarlas en ese orden, si no entran todas quedan las más recientes.
+* @param  pid_proceso PID del proceso.
+* @param  paginas Donde se dejan las páginas, con lugar para capacidad_huella().
+* @return Cantidad de páginas juntadas.
+*/
+int juntar_huella(int pid_proceso, t_pagina_huella* paginas) {
+    int cantidad = 0;
+
+    if (cache_habilitada()) {
+        for (int i = 0; i < list_size(lista_cache); i++) {
+            t_entrada_cache* entrada = list_get(lista_cache, i);
+            if (entrada->pid == pid_proceso && entrada->presente) {
+                paginas[cantidad++] = (t_pagina_huella){ .pagina = entrada->numero_pagina, .marco = entrada->marco, .en_tlb = false, .en_cache = true };
+            }
+        }
+    }
+
+    t_entrada_TLB* entradas_tlb[list_size(lista_tlb) + 1];
+    int cantidad_tlb = 0;
+    for (int i = 0; i < list_size(lista_tlb); i++) {
+        t_entrada_TLB* entrada = list_get(lista_tlb, i);
+        if (entrada->pid != pid_proceso) {
+            continue;
+        }
+        int j = cantidad_tlb++;
+        while (j > 0 && difftime(entradas_tlb[j - 1]->time_usado, entrada->time_usado) > 0) { // por inserción, son pocas
+            entradas_tlb[j] = entradas_tlb[j - 1];
+            j--;
+        }
+        entradas_tlb[j] = entrada;
+    }
+    for (int i = 0; i < cantidad_tlb; i++) {
+        int posicion = buscar_pagina_en_huella(paginas, cantidad, entradas_tlb[i]->numero_pagina);
+        if (posicion != -1) {
+            paginas[posicion].en_tlb = true;
+        }
+        else {
+            paginas[cantidad++] = (t_pagina_huella){ .pagina = entradas_tlb[i]->numero_pagina, .marco = entradas_tlb[i]->marco, .en_tlb = true, .en_cache = false };
+        }
+    }
+    return cantidad;
+}
+
+/**
+* @fn     void guardar_huella_del_proceso(void)
+* @brief  Guarda la huella del proceso actual (ver juntar_huella()). Un proceso sin páginas no pisa la huella que tenía.
+* @param  Ninguno
+* @return Ninguno
+*/
+void guardar_huella_del_proceso(void) {
+    if (huellas_procesos.cantidad == 0) {
+        return;
+    }
+    t_pagina_huella paginas[capacidad_huella()];
+    int cantidad = juntar_huella(pid, paginas);
+    if (cantidad == 0) {
+        return;
+    }
+    t_huella_proceso* huella = lugar_para_huella(pid);
+    huella->pid = pid;
+    memcpy(huella->paginas, paginas, cantidad * sizeof(t_pagina_huella));
+    huella->cantidad = cantidad;
+    huella->salida = ++huellas_procesos.salidas;
+}
+
+/**
+* @fn     void preparar_calentamiento(t_log* cpu_logger)
+* @brief  Al despachar un proceso, si la CPU tiene su huella la pasa a la lista de pedidos de fondo del contexto, que se envían detrás del primer FETCH (ver enviar_calentamiento()). La huella se usa una sola vez.
+* @param  cpu_logger Logger para imprimir información de depuración.
+* @return Ninguno
+*/
+void preparar_calentamiento(t_log* cpu_logger) {
+    if (calentamiento == NULL) {
+        return;
+    }
+    abandonar_calentamiento();
+
+    t_huella_proceso* huella = NULL;
+    for (int i = 0; i < huellas_procesos.cantidad && huella == NULL; i++) {
+        if (huellas_procesos.huellas[i].pid == pid) {
+            huella = &huellas_procesos.huellas[i];
+        }
+    }
+    if (huella == NULL) {
+        return;
+    }
+    huella->pid = -1;
+    if (!pedidos_memoria->habilitada) {
+        return;
+    }
+
+    for (int i = 0; i < huella->cantidad; i++) {
+        calentamiento->pedidos[i] = (t_pedido_calentamiento){ .pagina = huella->paginas[i], .etapa = CALENTANDO_MARCO, .marco = -1 };
+    }
+    calentamiento->cantidad = huella->cantidad;
+    calentamiento->enviado = false;
+    cpu_log_debug(cpu_logger, "## PID: %d - Se piden de fondo las %d páginas de su huella en TLB y caché", pid, huella->cantidad);
+}
+
+/**
+* @fn     void enviar_calentamiento(void)
+* @brief  Envía los accesos a la tabla de páginas de la huella preparada, todos juntos y sin esperar las respuestas. Se llama después de pedir la primera instrucción para que el FETCH no espere detrás de ellos.
+* @param  Ninguno
+* @return Ninguno
+*/
+void enviar_calentamiento(void) {
+    if (calentamiento == NULL || calentamiento->enviado) {
+        return;
+    }
+    t_fragmento_memoria* fragmento = &fragmentos_memoria[fragmento_de_pid(pid)];
+    t_constructor_paquete paquetes[calentamiento->cantidad];
+    for (int i = 0; i < calentamiento->cantidad; i++) {
+        t_pedido_calentamiento* pedido = &calentamiento->pedidos[i];
+        int vec[cantidad_niveles];
+        calcular_indices_tabla(pedido->pagina.pagina, vec);
+        pedido->id_pedido = armar_pedido_de_marco(&paquetes[i], vec, pedido->pagina.pagina, NULL, 0);
+        pedido->fragmento = fragmento;
+    }
+    if (calentamiento->cantidad > 0) {
+        enviar_lote_a_fragmento(fragmento, paquetes, calentamiento->cantidad);
+    }
+    calentamiento->enviado = true;
+}
+
+/**
+* @fn     void quitar_pedido_calentamiento(int indice)
+* @brief  Saca un pedido terminado de la lista de fondo manteniendo el orden de los demás.
+* @param  indice Posición del pedido.
+* @return Ninguno
+*/
+void quitar_pedido_calentamiento(int indice) {
+    memmove(&calentamiento->pedidos[indice], &calentamiento->pedidos[indice + 1], (calentamiento->cantidad - indice - 1) * sizeof(t_pedido_calentamiento));
+    calentamiento->cantidad--;
+}
+
+/**
+* @fn     int buscar_pedido_calentamiento(int nro_pagina)
+* @brief  Busca el pedido de fondo en vuelo de una página del proceso actual.
+* @param  nro_pagina Número de página.
+* @return Posición del pedido o -1 si no hay.
+*/
+int buscar_pedido_calentamiento(int nro_pagina) {
+    if (calentamiento == NULL || !calentamiento->enviado) {
+        return -1;
+    }
+    for (int i = 0; i < calentamiento->cantidad; i++) {
+        if (calentamiento->pedidos[i].pagina.pagina == nro_pagina) {
+            return i;
+        }
+    }
+    return -1;
+}
+
+/**
+* @fn     int recibir_marco_calentado(t_pedido_calentamiento* pedido, t_log* cpu_logger)
+* @brief  Recibe la traducción de un pedido de fondo. Si la página estaba en la caché y todavía no volvió a entrar, pide su contenido y el pedido pasa a CALENTANDO_CONTENIDO.
+* @param  pedido Pedido en CALENTANDO_MARCO.
+* @param  cpu_logger Logger para imprimir información.
+* @return Marco global de la página, -1 si memoria no lo devolvió.
+*/
+int recibir_marco_calentado(t_pedido_calentamiento* pedido, t_log* cpu_logger) {
+    int marco = recibir_marco_de_memoria(pedido->id_pedido, cpu_logger);
+    if (marco != -1 && pedido->pagina.en_cache && cache_habilitada() && buscar_en_cache(pedido->pagina.pagina) == NULL) {
+        pedido->marco = marco;
+        pedido->fragmento = fragmento_de_marco(marco);
+        pedido->id_pedido = pedir_contenido_a_memoria(marco, pedido->pagina.pagina);
+        pedido->etapa = CALENTANDO_CONTENIDO;
+    }
+    return marco;
+}
+
+/**
+* @fn     bool recibir_contenido_calentado(t_pedido_calentamiento* pedido, char* destino, t_log* cpu_logger)
+* @brief  Recibe el contenido de página de un pedido de fondo.
+* @param  pedido Pedido en CALENTANDO_CONTENIDO.
+* @param  destino Donde se deja la página (lugar para tam_pagina + 1).
+* @param  cpu_logger Logger para imprimir información.
+* @return true si memoria devolvió la página.
+*/
+bool recibir_contenido_calentado(t_pedido_calentamiento* pedido, char* destino, t_log* cpu_logger) {
+    return recibir_contenido_de_memoria(pedido->id_pedido, pedido->marco, pedido->pagina.pagina, destino, cpu_logger);
+}
+
+/**
+* @fn     void avanzar_calentamiento(t_log* cpu_logger)
+* @brief  Carga en la TLB y en la caché las respuestas de fondo que ya llegaron, sin esperar las demás. Una página que el proceso volvió a cargar mientras tanto no se pisa.
+* @param  cpu_logger Logger para imprimir información.
+* @return Ninguno
+*/
+void avanzar_calentamiento(t_log* cpu_logger) {
+    if (calentamiento == NULL || !calentamiento->enviado) {
+        return;
+    }
+    int i = 0;
+    while (i < calentamiento->cantidad) {
+        t_pedido_calentamiento* pedido = &calentamiento->pedidos[i];
+        int nro_pagina = pedido->pagina.pagina;
+        if (!respuesta_de_fragmento_disponible(pedido->fragmento, pedido->id_pedido)) {
+            i++;
+            continue;
+        }
+
+        if (pedido->etapa == CALENTANDO_MARCO) {
+            int marco = recibir_marco_calentado(pedido, cpu_logger);
+            if (marco != -1 && pedido->pagina.en_tlb && buscar_en_TLB(nro_pagina) == NULL) {
+                cargar_en_TLB(nro_pagina, marco);
+            }
+            if (pedido->etapa == CALENTANDO_CONTENIDO) {
+                i++;
+                continue;
+            }
+        }
+        else {
+            t_entrada_cache* entrada = crear_entrada_cache(nro_pagina, pedido->marco);
+            if (recibir_contenido_calentado(pedido, entrada->contenido, cpu_logger) && buscar_en_cache(nro_pagina) == NULL) {
+                actualizar_entrada_cache(entrada);
+            }
+            else {
+                devolver_entrada_cache(entrada);
+            }
+        }
+        quitar_pedido_calentamiento(i);
+    }
+}
+
+/**
+* @fn     void abandonar_calentamiento(void)
+* @brief  Se desentiende de los pedidos de fondo que quedan, que son del proceso que deja la CPU.
+* @param  Ninguno
+* @return Ninguno
+*/
+void abandonar_calentamiento(void) {
+    if (calentamiento == NULL) {
+        return;
+    }
+    if (calentamiento->enviado) {
+        for (int i = 0; i < calentamiento->cantidad; i++) {
+            descartar_respuesta_de_fragmento(calentamiento->pedidos[i].fragmento, calentamiento->pedidos[i].id_pedido);
+        }
+    }
+    calentamiento->cantidad = 0;
+    calentamiento->enviado = true;
+}
+
+/**
+* @fn     bool tomar_marco_calentado(int nro_pagina, int* marco)
+* @brief  Ante un miss de TLB, usa la traducción pedida de fondo para la página si la hay, esperándola si todavía no llegó.
+* @param  nro_pagina Número de página.
+* @param  marco Donde se deja el marco global.
+* @return true si había una traducción de fondo para la página, false si hay que pedirla.
+*/
+bool tomar_marco_calentado(int nro_pagina, int* marco) {
+    int indice = buscar_pedido_calentamiento(nro_pagina);
+    if (indice == -1) {
+        return false;
+    }
+    t_pedido_calentamiento* pedido = &calentamiento->pedidos[indice];
+    if (pedido->etapa == CALENTANDO_CONTENIDO) {
+        *marco = pedido->marco;
+        return true;
+    }
+    *marco = recibir_marco_calentado(pedido, cpu_logger);
+    if (pedido->etapa == CALENTANDO_MARCO) {
+        quitar_pedido_calentamiento(indice);
+    }
+    return *marco != -1;
+}
+
+/**
+* @fn     bool tomar_contenido_calentado(int nro_pagina, char* destino, t_log* cpu_logger)
+* @brief  Ante un miss de caché, usa el contenido pedido de fondo para la página si lo hay, esperándolo si todavía no llegó.
+* @param  nro_pagina Número de página.
+* @param  destino Donde se deja la página (lugar para tam_pagina + 1).
+* @param  cpu_logger Logger para imprimir información.
+* @return true si había un pedido de fondo y memoria devolvió la página, false si hay que pedirla.
+*/
+bool tomar_contenido_calentado(int nro_pagina, char* destino, t_log* cpu_logger) {
+    int indice = buscar_pedido_calentamiento(nro_pagina);
+    if (indice == -1 || calentamiento->pedidos[indice].etapa != CALENTANDO_CONTENIDO) {
+        return false;
+    }
+    bool recibido = recibir_contenido_calentado(&calentamiento->pedidos[indice], destino, cpu_logger);
+    quitar_pedido_calentamiento(indice);
+    return recibido;
+}
@@ -0,0 +1,286 @@
+#include "../include/cpu.h"
+#include <fcntl.h>
+#include <limits.h>
+#include <unistd.h>
+#include <sys/file.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+
+/**
+* @fn     void abrir_imagen_caliente(char* ruta, char* cpu_id, t_log* cpu_logger)
+* @brief  Abre (o crea) la imagen caliente de la CPU y la mapea en memoria. Si el archivo es de una ejecución con otra cantidad de CPUs virtuales, huellas o entradas, se vacía y la CPU arranca en frío. Otra CPU con el mismo identificador no puede usarla a la vez.
+* @param  ruta Valor de IMAGEN_CALIENTE; el archivo es <ruta>.<cpu_id>.
+* @param  cpu_id Identificador de la CPU.
+* @param  cpu_logger Logger para imprimir información.
+* @return Ninguno
+*/
+void abrir_imagen_caliente(char* ruta, char* cpu_id, t_log* cpu_logger) {
+    char* archivo = string_from_format("%s.%s", ruta, cpu_id);
+    imagen_caliente.archivo = open(archivo, O_RDWR | O_CREAT | O_CLOEXEC, 0644);
+    if (imagen_caliente.archivo == -1) {
+        perror("No se pudo abrir la imagen caliente");
+        exit(EXIT_FAILURE);
+    }
+    if (flock(imagen_caliente.archivo, LOCK_EX | LOCK_NB) == -1) {
+        printf("\n[ERROR] %s la está usando otra CPU con el identificador %s\n", archivo, cpu_id);
+        exit(EXIT_FAILURE);
+    }
+
+    t_cabecera_imagen* cabecera = &imagen_caliente.cabecera;
+    memcpy(cabecera->magia, MAGIA_IMAGEN, sizeof(cabecera->magia));
+    cabecera->version = VERSION_IMAGEN;
+    cabecera->cpus_virtuales = configuracion()->cpus_virtuales;
+    cabecera->huellas_por_region = configuracion()->huellas_procesos + configuracion()->hilos_hardware;
+    cabecera->paginas_por_huella = capacidad_huella();
+    imagen_caliente.tamanio_huella = (sizeof(t_huella_imagen) + cabecera->paginas_por_huella * sizeof(t_pagina_imagen) + 7) & ~(size_t)7; // salida alineado
+    imagen_caliente.tamanio_region = sizeof(t_region_imagen) + cabecera->huellas_por_region * imagen_caliente.tamanio_huella;
+    imagen_caliente.tamanio = sizeof(t_cabecera_imagen) + cabecera->cpus_virtuales * imagen_caliente.tamanio_region;
+
+    struct stat estado;
+    if (fstat(imagen_caliente.archivo, &estado) == -1) {
+        perror("No se pudo leer el tamaño de la imagen caliente");
+        exit(EXIT_FAILURE);
+    }
+    t_cabecera_imagen anterior;
+    bool reusable = (size_t)estado.st_size == imagen_caliente.tamanio
+        && pread(imagen_caliente.archivo, &anterior, sizeof(anterior), 0) == sizeof(anterior)
+        && memcmp(&anterior, cabecera, sizeof(anterior)) == 0;
+    if (!reusable) {
+        if (estado.st_size > 0) {
+            log_info(cpu_logger, "La imagen caliente %s es de otra configuración: la CPU arranca en frío", archivo);
+        }
+        // ftruncate deja todo en 0: las regiones quedan sin huellas
+        if (ftruncate(imagen_caliente.archivo, 0) == -1 || ftruncate(imagen_caliente.archivo, imagen_caliente.tamanio) == -1
+            || pwrite(imagen_caliente.archivo, cabecera, sizeof(t_cabecera_imagen), 0) != sizeof(t_cabecera_imagen)) {
+            perror("No se pudo preparar la imagen caliente");
+            exit(EXIT_FAILURE);
+        }
+    }
+
+    imagen_caliente.datos = mmap(NULL, imagen_caliente.tamanio, PROT_READ | PROT_WRITE, MAP_SHARED, imagen_caliente.archivo, 0);
+    if (imagen_caliente.datos == MAP_FAILED) {
+        perror("No se pudo mapear la imagen caliente");
+        exit(EXIT_FAILURE);
+    }
+    log_info(cpu_logger, "Imagen caliente en %s (%zu bytes)%s", archivo, imagen_caliente.tamanio, reusable ? ", con las huellas de la ejecución anterior" : "");
+    free(archivo);
+}
+
+/**
+* @fn     t_huella_imagen* huella_de_imagen(t_region_imagen* region, int indice)
+* @brief  Devuelve un lugar de huella de la región de una CPU virtual. Sus páginas siguen a la huella.
+* @param  region Región de la CPU virtual.
+* @param  indice Número de huella dentro de la región.
+* @return Huella en la imagen.
+*/
+t_huella_imagen* huella_de_imagen(t_region_imagen* region, int indice) {
+    return (t_huella_imagen*)((char*)(region + 1) + indice * imagen_caliente.tamanio_huella);
+}
+
+/**
+* @fn     void cargar_imagen_caliente(int cpu_virtual, t_log* cpu_logger)
+* @brief  Carga como huellas de procesos las que la CPU virtual dejó en la imagen, de la más vieja a la más reciente: si no entran todas, quedan las más recientes. Se llama después de iniciar_huellas(); hasta validar_imagen_con_memoria() no se sabe si sirven. Una región a medio escribir no se carga.
+* @param  cpu_virtual Número de la CPU virtual, que es el de su región.
+* @param  cpu_logger Logger para imprimir información.
+* @return Ninguno
+*/
+void cargar_imagen_caliente(int cpu_virtual, t_log* cpu_logger) {
+    if (imagen_caliente.archivo == -1 || huellas_procesos.cantidad == 0) {
+        return;
+    }
+    region_imagen = (t_region_imagen*)((char*)imagen_caliente.datos + sizeof(t_cabecera_imagen) + cpu_virtual * imagen_caliente.tamanio_region);
+    imagen_escrita_ns = tiempo_actual_ns();
+    if (atomic_load_explicit(&region_imagen->secuencia, memory_order_acquire) % 2 == 1) {
+        log_warning(cpu_logger, "La imagen caliente de la CPU virtual %d quedó a medio escribir: arranca en frío", cpu_virtual);
+        return;
+    }
+
+    int cantidad = region_imagen->cantidad;
+    if (cantidad < 0 || cantidad > (int)imagen_caliente.cabecera.huellas_por_region) {
+        cantidad = 0;
+    }
+    int orden[cantidad + 1];
+    for (int i = 0; i < cantidad; i++) { // por salida, por inserción
+        int j = i;
+        while (j > 0 && huella_de_imagen(region_imagen, orden[j - 1])->salida > huella_de_imagen(region_imagen, i)->salida) {
+            orden[j] = orden[j - 1];
+            j--;
+        }
+        orden[j] = i;
+    }
+
+    int cargadas = 0;
+    for (int i = 0; i < cantidad; i++) {
+        t_huella_imagen* guardada = huella_de_imagen(region_imagen, orden[i]);
+        if (guardada->pid < 0 || guardada->cantidad <= 0) {
+            continue;
+        }
+        t_pagina_imagen* paginas = (t_pagina_imagen*)(guardada + 1);
+        t_huella_proceso* huella = lugar_para_huella(guardada->pid);
+        huella->pid = guardada->pid;
+        huella->cantidad = guardada->cantidad < capacidad_huella() ? guardada->cantidad : capacidad_huella();
+        for (int j = 0; j < huella->cantidad; j++) {
+            huella->paginas[j] = (t_pagina_huella){ .pagina = paginas[j].pagina, .marco = paginas[j].marco, .en_tlb = paginas[j].en_tlb, .en_cache = paginas[j].en_cache };
+        }
+        huella->salida = ++huellas_procesos.salidas;
+        cargadas++;
+    }
+    if (cargadas > 0) {
+        log_info(cpu_logger, "CPU virtual %d: %d huellas de procesos cargadas de la imagen caliente", cpu_virtual, cargadas);
+    }
+}
+
+/**
+* @fn     void validar_imagen_con_memoria(t_log* cpu_logger)
+* @brief  Después del handshake con memoria, descarta las huellas cargadas de la imagen si memoria cambió (tamaño de página, tabla de páginas o marcos), y las páginas o marcos que no existen en esta memoria. Se llama antes de que el kernel despache el primer proceso, así que todas las huellas vienen de la imagen.
+* @param  cpu_logger Logger para imprimir información.
+* @return Ninguno
+*/
+void validar_imagen_con_memoria(t_log* cpu_logger) {
+    if (region_imagen == NULL) {
+        return;
+    }
+    bool misma_memoria = region_imagen->tam_pagina == tam_pagina && region_imagen->entradas_tabla == entradas_tabla
+        && region_imagen->cantidad_niveles == cantidad_niveles && region_imagen->tam_memoria == tam_memoria;
+    int marcos = tam_memoria / tam_pagina;
+    long long paginas_proceso = 1;
+    for (int i = 0; i < cantidad_niveles && paginas_proceso <= INT_MAX; i++) {
+        paginas_proceso *= entradas_tabla;
+    }
+
+    int descartadas = 0;
+    for (int i = 0; i < huellas_procesos.cantidad; i++) {
+        t_huella_proceso* huella = &huellas_procesos.huellas[i];
+        if (huella->pid == -1) {
+            continue;
+        }
+        int validas = 0;
+        for (int j = 0; misma_memoria && j < huella->cantidad; j++) {
+            t_pagina_huella* pagina = &huella->paginas[j];
+            if (pagina->pagina >= 0 && pagina->pagina < paginas_proceso && pagina->marco >= 0 && pagina->marco < marcos) {
+                huella->paginas[validas++] = *pagina;
+            }
+        }
+        huella->cantidad = validas;
+        if (validas == 0) {
+            huella->pid = -1;
+            descartadas++;
+        }
+    }
+    if (descartadas > 0) {
+        log_info(cpu_logger, "Imagen caliente: %d huellas descartadas%s", descartadas, misma_memoria ? "" : ", memoria no es la misma que cuando se escribió");
+    }
+}
+
+/**
+* @fn     void escribir_huella_en_imagen(t_huella_imagen* destino, int pid_proceso, t_pagina_huella* paginas, int cantidad, uint64_t salida)
+* @brief  Copia una huella a un lugar de la imagen.
+* @param  destino Lugar de la imagen.
+* @param  pid_proceso PID del proceso.
+* @param  paginas Páginas de la huella.
+* @param  cantidad Cantidad de páginas.
+* @param  salida Orden de uso de la huella.
+* @return Ninguno
+*/
+void escribir_huella_en_imagen(t_huella_imagen* destino, int pid_proceso, t_pagina_huella* paginas, int cantidad, uint64_t salida) {
+    t_pagina_imagen* paginas_imagen = (t_pagina_imagen*)(destino + 1);
+    destino->pid = pid_proceso;
+    destino->cantidad = cantidad;
+    destino->salida = salida;
+    for (int i = 0; i < cantidad; i++) {
+        paginas_imagen[i] = (t_pagina_imagen){ .pagina = paginas[i].pagina, .marco = paginas[i].marco, .en_tlb = paginas[i].en_tlb, .en_cache = paginas[i].en_cache };
+    }
+}
+
+/**
+* @fn     void agregar_proceso_cargado(t_region_imagen* region, int pid_proceso)
+* @brief  Agrega a la imagen la huella de un proceso que sigue cargado en la CPU virtual (en algún hilo de hardware), armada con sus entradas de TLB y caché. Queda como la más reciente.
+* @param  region Región que se está escribiendo.
+* @param  pid_proceso PID de una entrada de TLB o caché, -1 si está libre.
+* @return Ninguno
+*/
+void agregar_proceso_cargado(t_region_imagen* region, int pid_proceso) {
+    if (pid_proceso == -1 || region->cantidad == (int)imagen_caliente.cabecera.huellas_por_region) {
+        return;
+    }
+    for (int i = 0; i < region->cantidad; i++) {
+        t_huella_imagen* escrita = huella_de_imagen(region, i);
+        if (escrita->pid == pid_proceso && escrita->salida > huellas_procesos.salidas) {
+            return; // ya se agregó por otra entrada
+        }
+    }
+    t_pagina_huella paginas[capacidad_huella()];
+    int cantidad = juntar_huella(pid_proceso, paginas);
+    escribir_huella_en_imagen(huella_de_imagen(region, region->cantidad++), pid_proceso, paginas, cantidad, huellas_procesos.salidas + 1);
+}
+
+/**
+* @fn     void escribir_imagen_caliente(void)
+* @brief  Escribe en la región de la CPU virtual sus huellas guardadas y las de los procesos cargados, con la memoria con la que se armaron. Son escrituras en el mapeo, sin syscalls: si la CPU se cae, el sistema igual las tiene. Mientras escribe la secuencia queda impar.
+* @param  Ninguno
+* @return Ninguno
+*/
+void escribir_imagen_caliente(void) {
+    if (region_imagen == NULL) {
+        return;
+    }
+    uint32_t secuencia = atomic_load_explicit(&region_imagen->secuencia, memory_order_relaxed) | 1;
+    atomic_store_explicit(&region_imagen->secuencia, secuencia, memory_order_relaxed);
+    atomic_thread_fence(memory_order_release);
+
+    region_imagen->tam_pagina = tam_pagina;
+    region_imagen->entradas_tabla = entradas_tabla;
+    region_imagen->cantidad_niveles = cantidad_niveles;
+    region_imagen->tam_memoria = tam_memoria;
+    region_imagen->cantidad = 0;
+    for (int i = 0; i < huellas_procesos.cantidad; i++) {
+        t_huella_proceso* huella = &huellas_procesos.huellas[i];
+        if (huella->pid != -1) {
+            escribir_huella_en_imagen(huella_de_imagen(region_imagen, region_imagen->cantidad++), huella->pid, huella->paginas, huella->cantidad, huella->salida);
+        }
+    }
+    for (int i = 0; i < list_size(lista_tlb); i++) {
+        agregar_proceso_cargado(region_imagen, ((t_entrada_TLB*)list_get(lista_tlb, i))->pid);
+    }
+    if (cache_habilitada()) {
+        for (int i = 0; i < list_size(lista_cache); i++) {
+            agregar_proceso_cargado(region_imagen, ((t_entrada_cache*)list_get(lista_cache, i))->pid);
+        }
+    }
+
+    atomic_store_explicit(&region_imagen->secuencia, secuencia + 1, memory_order_release);
+    imagen_escrita_ns = tiempo_actual_ns();
+}
+
+/**
+* @fn     void actualizar_imagen_caliente(void)
+* @brief  Escribe la imagen de la CPU virtual si pasaron PERIODO_IMAGEN_CALIENTE ms desde la última vez. Se llama al cambiar de proceso, que es cuando cambian las huellas, y al final de cada ciclo de instrucción, para que un proceso que no deja la CPU no deje la imagen vieja.
+* @param  Ninguno
+* @return Ninguno
+*/
+void actualizar_imagen_caliente(void) {
+    int periodo = configuracion()->periodo_imagen_caliente;
+    if (region_imagen == NULL || periodo == 0 || tiempo_actual_ns() - imagen_escrita_ns < (int64_t)periodo * 1000000) {
+        return;
+    }
+    escribir_imagen_caliente();
+}
+
+/**
+* @fn     void cerrar_imagen_caliente(void)
+* @brief  Baja la imagen al disco y la cierra. Se llama cuando ya terminaron todas las CPUs virtuales, que escribieron su región al cerrar.
+* @param  Ninguno
+* @return Ninguno
+*/
+void cerrar_imagen_caliente(void) {
+    if (imagen_caliente.archivo == -1) {
+        return;
+    }
+    if (msync(imagen_caliente.datos, imagen_caliente.tamanio, MS_SYNC) == -1) {
+        perror("No se pudo bajar la imagen caliente al disco");
+    }
+    munmap(imagen_caliente.datos, imagen_caliente.tamanio);
+    close(imagen_caliente.archivo);
+    imagen_caliente.archivo = -1;
+    imagen_caliente.datos = NULL;
+}
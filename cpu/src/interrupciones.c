@@ -0,0 +1,165 @@
+#include "../include/cpu.h"
+#include <sys/eventfd.h>
+#include <time.h>
+
+// latencias_interrupcion[i] cuenta las interrupciones atendidas en [2^i, 2^(i+1)) ns
+_Atomic uint64_t latencias_interrupcion[CANTIDAD_BUCKETS_LATENCIA];
+
+/**
+* @fn     void iniciar_buzon_interrupcion(t_buzon_interrupcion* buzon, bool usar_eventfd)
+* @brief  Deja el buzón vacío. Si se pide, crea un eventfd que se señaliza en cada interrupción publicada para que quien espera a memoria se entere sin esperar la respuesta.
+* @param  buzon Buzón a inicializar.
+* @param  usar_eventfd true para crear el eventfd de aviso.
+* @return Ninguno
+*/
+void iniciar_buzon_interrupcion(t_buzon_interrupcion* buzon, bool usar_eventfd) {
+    atomic_init(&buzon->carta, 0);
+    atomic_init(&buzon->llegada_ns, 0);
+    buzon->eventfd = -1;
+
+    if (usar_eventfd) {
+        buzon->eventfd = eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC);
+        if (buzon->eventfd == -1) {
+            perror("No se pudo crear el eventfd de interrupciones");
+        }
+    }
+}
+
+/**
+* @fn     void destruir_buzon_interrupcion(t_buzon_interrupcion* buzon)
+* @brief  Libera el eventfd del buzón, si tiene.
+* @param  buzon Buzón a destruir.
+* @return Ninguno
+*/
+void destruir_buzon_interrupcion(t_buzon_interrupcion* buzon) {
+    if (buzon->eventfd != -1) {
+        close(buzon->eventfd);
+        buzon->eventfd = -1;
+    }
+}
+
+/**
+* @fn     void publicar_interrupcion(t_buzon_interrupcion* buzon, int pid_objetivo, t_motivo_interrupcion motivo)
+* @brief  Deja una interrupción en el buzón (release) y despierta al eventfd si existe. Una interrupción nueva pisa a la anterior no atendida.
+* @param  buzon Buzón destino.
+* @param  pid_objetivo PID a interrumpir, o PID_CUALQUIERA si el kernel no lo indicó.
+* @param  motivo Motivo de la interrupción.
+* @return Ninguno
+*/
+void publicar_interrupcion(t_buzon_interrupcion* buzon, int pid_objetivo, t_motivo_interrupcion motivo) {
+    dejar_en_buzon(buzon, pid_objetivo, motivo, tiempo_actual_ns());
+}
+
+/**
+* @fn     void dejar_en_buzon(t_buzon_interrupcion* buzon, int pid_objetivo, t_motivo_interrupcion motivo, int64_t llegada_ns)
+* @brief  Escribe la carta en el buzón (release) con el momento en que llegó la interrupción y despierta al eventfd si existe.
+* @param  buzon Buzón destino.
+* @param  pid_objetivo PID a interrumpir, o PID_CUALQUIERA.
+* @param  motivo Motivo de la interrupción.
+* @param  llegada_ns Momento en que llegó la interrupción, para medir la latencia.
+* @return Ninguno
+*/
+void dejar_en_buzon(t_buzon_interrupcion* buzon, int pid_objetivo, t_motivo_interrupcion motivo, int64_t llegada_ns) {
+    uint64_t carta = ((uint64_t)(uint32_t)pid_objetivo << 32) | ((uint64_t)(uint16_t)motivo << 1) | 1;
+
+    atomic_store_explicit(&buzon->llegada_ns, llegada_ns, memory_order_relaxed);
+    atomic_store_explicit(&buzon->carta, carta, memory_order_release);
+
+    if (buzon->eventfd != -1) {
+        uint64_t uno = 1;
+        if (write(buzon->eventfd, &uno, sizeof(uno)) == -1) {
+            perror("No se pudo avisar la interrupcion por eventfd");
+        }
+    }
+}
+
+/**
+* @fn     bool tomar_interrupcion(t_buzon_interrupcion* buzon, t_interrupcion* interrupcion)
+* @brief  Consume la interrupción pendiente (acquire), dejando el buzón vacío. El eventfd se vacía antes de tomar la carta: si se publica una entre los dos pasos, su aviso queda y a lo sumo despierta una vez de más, en vez de perderse.
+* @param  buzon Buzón a consultar.
+* @param  interrupcion Donde se copia la interrupción tomada.
+* @return true si había una interrupción pendiente, false si el buzón estaba vacío.
+*/
+bool tomar_interrupcion(t_buzon_interrupcion* buzon, t_interrupcion* interrupcion) {
+    if (buzon->eventfd != -1) {
+        uint64_t avisos;
+        while (read(buzon->eventfd, &avisos, sizeof(avisos)) > 0);
+    }
+
+    uint64_t carta = atomic_exchange_explicit(&buzon->carta, 0, memory_order_acq_rel);
+    if (carta == 0) {
+        return false;
+    }
+
+    interrupcion->pid = (int)(int32_t)(carta >> 32);
+    interrupcion->motivo = (t_motivo_interrupcion)((carta >> 1) & 0xFFFF);
+    interrupcion->llegada_ns = atomic_load_explicit(&buzon->llegada_ns, memory_order_relaxed);
+    return true;
+}
+
+/**
+* @fn     void vaciar_buzon_al_despachar(t_buzon_interrupcion* buzon, int pid_despachado)
+* @brief  Descarta la interrupción que quedó sin atender del proceso anterior (o sin PID) para que no desaloje al recién despachado en su primer ciclo. Si era para el PID despachado (llegó por interrupt antes que el despacho por dispatch) se vuelve a dejar, con su llegada original.
+* @param  buzon Buzón del contexto que recibe el proceso.
+* @param  pid_despachado PID del proceso que se empieza a ejecutar.
+* @return Ninguno
+*/
+void vaciar_buzon_al_despachar(t_buzon_interrupcion* buzon, int pid_despachado) {
+    t_interrupcion interrupcion;
+    if (tomar_interrupcion(buzon, &interrupcion) && interrupcion.pid == pid_despachado) {
+        dejar_en_buzon(buzon, interrupcion.pid, interrupcion.motivo, interrupcion.llegada_ns);
+    }
+}
+
+/**
+* @fn     bool hay_interrupcion_pendiente(t_buzon_interrupcion* buzon)
+* @brief  Indica si hay una interrupción sin consumir, sin tomarla.
+* @param  buzon Buzón a consultar.
+* @return true si hay interrupción pendiente, false en caso contrario.
+*/
+bool hay_interrupcion_pendiente(t_buzon_interrupcion* buzon) {
+    return atomic_load_explicit(&buzon->carta, memory_order_acquire) != 0;
+}
+
+/**
+* @fn     int64_t tiempo_actual_ns(void)
+* @brief  Devuelve el tiempo monotónico actual en nanosegundos.
+* @param  Ninguno
+* @return Tiempo actual en nanosegundos.
+*/
+int64_t tiempo_actual_ns(void) {
+    struct timespec ahora;
+    clock_gettime(CLOCK_MONOTONIC, &ahora);
+    return (int64_t)ahora.tv_sec * 1000000000LL + ahora.tv_nsec;
+}
+
+/**
+* @fn     void registrar_latencia_interrupcion(int64_t latencia_ns)
+* @brief  Suma una interrupción atendida al histograma de latencias (llegada hasta atendida), en buckets de potencias de 2.
+* @param  latencia_ns Latencia medida en nanosegundos.
+* @return Ninguno
+*/
+void registrar_latencia_interrupcion(int64_t latencia_ns) {
+    int bucket = 0;
+    while (latencia_ns > 1 && bucket < CANTIDAD_BUCKETS_LATENCIA - 1) {
+        latencia_ns >>= 1;
+        bucket++;
+    }
+    atomic_fetch_add_explicit(&latencias_interrupcion[bucket], 1, memory_order_relaxed);
+}
+
+/**
+* @fn     void loguear_latencias_interrupcion(t_log* cpu_logger)
+* @brief  Imprime en el logger los buckets no vacíos del histograma de latencias de interrupción.
+* @param  cpu_logger Logger donde imprimir.
+* @return Ninguno
+*/
+void loguear_latencias_interrupcion(t_log* cpu_logger) {
+    for (int i = 0; i < CANTIDAD_BUCKETS_LATENCIA; i++) {
+        uint64_t cantidad = atomic_load_explicit(&latencias_interrupcion[i], memory_order_relaxed);
+        if (cantidad > 0) {
+            log_info(cpu_logger, "Latencia de interrupcion [%llu, %llu) ns: %llu",
+                (unsigned long long)(1ULL << i), (unsigned long long)(1ULL << (i + 1)), (unsigned long long)cantidad);
+        }
+    }
+}
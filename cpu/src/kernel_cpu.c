@@ -16,28 +16,11 @@ void atender_kernel_cpu_dispatch(t_log* cpu_logger) {
 
         switch (cod_op) {
             case HANDSHAKE:
-
-            t_buffer* b_handshake_recv = recibir_buffer(socket_kernel_dispatch);
-            int respuesta = extraer_int_del_buffer(b_handshake_recv);
-            
-            if(respuesta == RESULT_OK) {
-                log_info(cpu_logger, "HANDSHAKE OK");
-            }
-            else {
-                log_error(cpu_logger, "FALLO en HANDSHAKE");
-                exit(-1);
-            }
+            recibir_handshake_kernel(socket_kernel_dispatch, cpu_logger);
             break;
            
             case K_CPU_EXEC_PROCESO: 
-
-                t_buffer* buffer = recibir_buffer(socket_kernel_dispatch);
-                pid = extraer_int_del_buffer(buffer);
-                pc = extraer_int_del_buffer(buffer);
-
-                log_trace(cpu_logger, "PID recibido: %d", pid);
-                log_trace(cpu_logger, "PC recibido: %d", pc);
-
+                recibir_proceso_a_ejecutar(cpu_logger);
                 fetch(cpu_logger); 
                             
             break;
@@ -64,23 +47,11 @@ void atender_kernel_cpu_interrupt(t_log* cpu_logger) {
         int cod_op = recibir_operacion(socket_kernel_interrupt);
         switch (cod_op) {
             case HANDSHAKE:
-
-            t_buffer* b_handshake_recv = recibir_buffer(socket_kernel_interrupt);
-            int respuesta = extraer_int_del_buffer(b_handshake_recv);
-            
-            if(respuesta == RESULT_OK) {
-                log_info(cpu_logger, "HANDSHAKE OK");
-            }
-            else {
-                log_error(cpu_logger, "FALLO en HANDSHAKE");
-                exit(-1);
-            }
+            recibir_handshake_kernel(socket_kernel_interrupt, cpu_logger);
             break;
 
             case K_CPU_INTERRUPT_PROCESO:
-            t_buffer* buffer = recibir_buffer(socket_kernel_interrupt);
-            interrupt = true;
-            eliminar_buffer(buffer);
+            recibir_interrupcion(socket_kernel_interrupt, buzon_interrupcion);
             break;
 
             case -1:
@@ -95,8 +66,101 @@ void atender_kernel_cpu_interrupt(t_log* cpu_logger) {
     }
 }
 
+/**
+ @fn escuchar_kernel_interrupt
+ @brief Punto de entrada del hilo de interrupt: toma el socket y el buzón de la CPU virtual que lo creó y atiende kernel interrupt.
+ */
+void* escuchar_kernel_interrupt(void* arg) {
+    t_escucha_interrupt* escucha = arg;
+    socket_kernel_interrupt = escucha->socket_kernel_interrupt;
+    buzon_interrupcion = escucha->buzon;
+    t_log* cpu_logger = escucha->logger;
+    free(escucha);
+
+    atender_kernel_cpu_interrupt(cpu_logger);
+    return NULL;
+}
 
+/**
+ @fn recibir_handshake_kernel
+ @brief Recibe la respuesta del kernel al handshake enviado por conectar_kernel(). Termina la ejecución si el kernel lo rechaza.
+ */
+void recibir_handshake_kernel(int socket_kernel, t_log* cpu_logger) {
+    t_buffer* b_handshake_recv = recibir_buffer(socket_kernel);
+    procesar_handshake_kernel(b_handshake_recv, cpu_logger);
+    eliminar_buffer(b_handshake_recv);
+}
 
+/**
+ @fn procesar_handshake_kernel
+ @brief Procesa el buffer de la respuesta del kernel al handshake. Termina la ejecución si el kernel lo rechaza.
+ */
+void procesar_handshake_kernel(t_buffer* b_handshake_recv, t_log* cpu_logger) {
+    t_lector_buffer lector = crear_lector(b_handshake_recv);
+    int respuesta = leer_int_del_buffer(&lector);
+    
+    if(respuesta == RESULT_OK) {
+        log_info(cpu_logger, "HANDSHAKE OK");
+    }
+    else {
+        log_error(cpu_logger, "FALLO en HANDSHAKE");
+        exit(-1);
+    }
+}
 
+/**
+ @fn recibir_proceso_a_ejecutar
+ @brief Recibe el PID y PC que envía el kernel con K_CPU_EXEC_PROCESO y los carga como proceso actual.
+ */
+void recibir_proceso_a_ejecutar(t_log* cpu_logger) {
+    t_buffer* buffer = recibir_buffer(socket_kernel_dispatch);
+    cargar_proceso_a_ejecutar(buffer, cpu_logger);
+    eliminar_buffer(buffer);
+}
 
+/**
+ @fn cargar_proceso_a_ejecutar
+ @brief Carga como proceso actual el PID y PC de un buffer de K_CPU_EXEC_PROCESO, descarta las interrupciones que no son para él y pasa a usar el fragmento de memoria del proceso. Si la CPU tiene su huella, prepara los pedidos de fondo que la recuperan.
+ */
+void cargar_proceso_a_ejecutar(t_buffer* buffer, t_log* cpu_logger) {
+    barrera_escrituras(); //cambio de proceso: no puede quedar nada del anterior sin confirmar
+    abandonar_instruccion_pedida(); //un FETCH adelantado es del proceso anterior y de su fragmento de memoria
+    t_lector_buffer lector = crear_lector(buffer);
+    pid = leer_int_del_buffer(&lector);
+    pc = leer_int_del_buffer(&lector);
+    vaciar_buzon_al_despachar(buzon_interrupcion, pid); //una interrupcion vieja no desaloja al proceso nuevo
+    usar_fragmento_del_proceso();
+    preparar_calentamiento(cpu_logger); //si ya estuvo en esta CPU, su huella en TLB y caché se pide de fondo
+
+    log_trace(cpu_logger, "PID recibido: %d", pid);
+    log_trace(cpu_logger, "PC recibido: %d", pc);
+}
 
+/**
+ @fn recibir_interrupcion
+ @brief Recibe un K_CPU_INTERRUPT_PROCESO y lo deja en el buzón.
+ */
+void recibir_interrupcion(int socket_kernel, t_buzon_interrupcion* buzon) {
+    t_buffer* buffer = recibir_buffer(socket_kernel);
+    cargar_interrupcion(buffer, buzon);
+    eliminar_buffer(buffer);
+}
+
+/**
+ @fn cargar_interrupcion
+ @brief Deja en el buzón la interrupción de un buffer de K_CPU_INTERRUPT_PROCESO. Si el kernel no manda PID o motivo se asume cualquier PID y desalojo.
+ */
+void cargar_interrupcion(t_buffer* buffer, t_buzon_interrupcion* buzon) {
+    int pid_objetivo = PID_CUALQUIERA;
+    t_motivo_interrupcion motivo = INTERRUPCION_DESALOJO;
+    t_lector_buffer lector = crear_lector(buffer);
+
+    if (quedan_datos_en_lector(&lector)) {
+        pid_objetivo = leer_int_del_buffer(&lector);
+    }
+    if (quedan_datos_en_lector(&lector)) {
+        motivo = leer_int_del_buffer(&lector);
+    }
+
+    publicar_interrupcion(buzon, pid_objetivo, motivo);
+}
@@ -1,42 +1,438 @@
 #include "../include/cpu.h"
+#include <limits.h>
+#include <poll.h>
+#include <unistd.h>
+#include <sys/inotify.h>
+#include <sys/eventfd.h>
 
-// Para las conexiones
-char* puerto_memoria() {
-    return config_get_string_value(cpu_config, "PUERTO_MEMORIA");
+// Valores de las claves con opciones, en el orden de sus enums
+char* opciones_reemplazo_tlb[] = { "FIFO", "LRU" };
+char* opciones_reemplazo_cache[] = { "CLOCK", "CLOCK-M" };
+char* opciones_modo_ejecucion[] = { "HILOS", "EVENTOS" };
+char* opciones_transporte_memoria[] = { "SOCKET", "MEMORIA_COMPARTIDA" };
+
+/**
+* @fn     char* string_de_config(t_config* config, char* clave, bool obligatoria, bool* valida)
+* @brief  Copia el valor de una clave de texto. Una clave vacía cuenta como ausente.
+* @param  config Config de commons recién leída.
+* @param  clave Clave a leer.
+* @param  obligatoria true si falta la clave es un error.
+* @param  valida Se pone en false si hay un error.
+* @return Copia del valor (hay que liberarla), o NULL si no está.
+*/
+char* string_de_config(t_config* config, char* clave, bool obligatoria, bool* valida) {
+    char* valor = config_has_property(config, clave) ? config_get_string_value(config, clave) : NULL;
+    if (valor == NULL || valor[0] == '\0') {
+        if (obligatoria) {
+            printf("\n[ERROR] %s: falta %s\n", ARCHIVO_CONFIG_CPU, clave);
+            *valida = false;
+        }
+        return NULL;
+    }
+    return strdup(valor);
+}
+
+/**
+* @fn     int int_de_config(t_config* config, char* clave, int por_defecto, int minimo, bool* valida)
+* @brief  Lee un entero de una clave, o el valor por defecto si no está. A diferencia de config_get_int_value, un valor que no es un número es un error.
+* @param  config Config de commons recién leída.
+* @param  clave Clave a leer.
+* @param  por_defecto Valor si falta la clave; INT_MIN si la clave es obligatoria.
+* @param  minimo Menor valor aceptado.
+* @param  valida Se pone en false si hay un error.
+* @return Valor leído.
+*/
+int int_de_config(t_config* config, char* clave, int por_defecto, int minimo, bool* valida) {
+    if (!config_has_property(config, clave)) {
+        if (por_defecto == INT_MIN) {
+            printf("\n[ERROR] %s: falta %s\n", ARCHIVO_CONFIG_CPU, clave);
+            *valida = false;
+        }
+        return por_defecto;
+    }
+    char* texto = config_get_string_value(config, clave);
+    char* fin;
+    long valor = strtol(texto, &fin, 10);
+    if (fin == texto || *fin != '\0' || valor < minimo || valor > INT_MAX) {
+        printf("\n[ERROR] %s: %s=%s tiene que ser un entero mayor o igual a %d\n", ARCHIVO_CONFIG_CPU, clave, texto, minimo);
+        *valida = false;
+        return por_defecto;
+    }
+    return valor;
 }
-char* ip_memoria() {
-    return config_get_string_value(cpu_config, "IP_MEMORIA");
+
+/**
+* @fn     bool bool_de_config(t_config* config, char* clave, bool* valida)
+* @brief  Lee una clave true/false. Si falta vale false.
+* @param  config Config de commons recién leída.
+* @param  clave Clave a leer.
+* @param  valida Se pone en false si el valor no es true ni false.
+* @return Valor leído.
+*/
+bool bool_de_config(t_config* config, char* clave, bool* valida) {
+    if (!config_has_property(config, clave)) {
+        return false;
+    }
+    char* texto = config_get_string_value(config, clave);
+    if (strcmp(texto, "true") != 0 && strcmp(texto, "false") != 0) {
+        printf("\n[ERROR] %s: %s=%s tiene que ser true o false\n", ARCHIVO_CONFIG_CPU, clave, texto);
+        *valida = false;
+    }
+    return strcmp(texto, "true") == 0;
+}
+
+/**
+* @fn     int opcion_de_config(t_config* config, char* clave, char* opciones[], int cantidad, int por_defecto, bool* valida)
+* @brief  Lee una clave que tiene que ser una de las opciones dadas.
+* @param  config Config de commons recién leída.
+* @param  clave Clave a leer.
+* @param  opciones Valores aceptados, en el orden del enum.
+* @param  cantidad Cantidad de opciones.
+* @param  por_defecto Índice si falta la clave; -1 si la clave es obligatoria.
+* @param  valida Se pone en false si hay un error.
+* @return Índice de la opción leída.
+*/
+int opcion_de_config(t_config* config, char* clave, char* opciones[], int cantidad, int por_defecto, bool* valida) {
+    if (!config_has_property(config, clave)) {
+        if (por_defecto == -1) {
+            printf("\n[ERROR] %s: falta %s\n", ARCHIVO_CONFIG_CPU, clave);
+            *valida = false;
+        }
+        return por_defecto;
+    }
+    char* texto = config_get_string_value(config, clave);
+    for (int i = 0; i < cantidad; i++) {
+        if (strcmp(texto, opciones[i]) == 0) {
+            return i;
+        }
+    }
+    printf("\n[ERROR] %s: %s=%s no es un valor válido\n", ARCHIVO_CONFIG_CPU, clave, texto);
+    *valida = false;
+    return por_defecto;
+}
+
+/**
+* @fn     t_config_cpu* leer_configuracion(char* archivo)
+* @brief  Lee y valida el archivo de configuración completo y arma una foto nueva, sin publicarla. Informa por consola cada clave inválida.
+* @param  archivo Ruta del archivo de configuración.
+* @return Foto de la configuración, o NULL si el archivo no se pudo leer o tiene errores.
+*/
+t_config_cpu* leer_configuracion(char* archivo) {
+    t_config* config = config_create(archivo);
+    if (config == NULL) {
+        printf("\n[ERROR] No se pudo leer %s\n", archivo);
+        return NULL;
+    }
+
+    bool valida = true;
+    t_config_cpu* foto = calloc(1, sizeof(t_config_cpu));
+
+    // Conexiones: con DIRECCION_* se usa el transporte indicado, si no IP y PUERTO
+    foto->ip_memoria = string_de_config(config, "IP_MEMORIA", true, &valida);
+    foto->puerto_memoria = string_de_config(config, "PUERTO_MEMORIA", true, &valida);
+    foto->ip_kernel = string_de_config(config, "IP_KERNEL", true, &valida);
+    foto->puerto_kernel_dispatch = string_de_config(config, "PUERTO_KERNEL_DISPATCH", true, &valida);
+    foto->puerto_kernel_interrupt = string_de_config(config, "PUERTO_KERNEL_INTERRUPT", true, &valida);
+    foto->direccion_memoria = string_de_config(config, "DIRECCION_MEMORIA", false, &valida);
+    foto->direccion_kernel_dispatch = string_de_config(config, "DIRECCION_KERNEL_DISPATCH", false, &valida);
+    foto->direccion_kernel_interrupt = string_de_config(config, "DIRECCION_KERNEL_INTERRUPT", false, &valida);
+    foto->fragmentos_memoria = config_has_property(config, "FRAGMENTOS_MEMORIA") ? config_get_array_value(config, "FRAGMENTOS_MEMORIA") : NULL;
+    if (foto->fragmentos_memoria != NULL && string_array_size(foto->fragmentos_memoria) == 0) { // FRAGMENTOS_MEMORIA=[] es una sola memoria
+        string_array_destroy(foto->fragmentos_memoria);
+        foto->fragmentos_memoria = NULL;
+    }
+    foto->plazo_conexion = int_de_config(config, "PLAZO_CONEXION", 30000, 1, &valida);
+    foto->reintento_conexion = int_de_config(config, "REINTENTO_CONEXION", 50, 1, &valida);
+    foto->reintento_conexion_max = int_de_config(config, "REINTENTO_CONEXION_MAX", 2000, 1, &valida);
+    if (foto->reintento_conexion_max < foto->reintento_conexion) {
+        printf("\n[ERROR] %s: REINTENTO_CONEXION_MAX=%d es menor que REINTENTO_CONEXION=%d\n", archivo, foto->reintento_conexion_max, foto->reintento_conexion);
+        valida = false;
+    }
+
+    // TLB y caché
+    foto->entradas_tlb = int_de_config(config, "ENTRADAS_TLB", INT_MIN, 0, &valida);
+    foto->reemplazo_tlb = opcion_de_config(config, "REEMPLAZO_TLB", opciones_reemplazo_tlb, 2, -1, &valida);
+    foto->entradas_cache = int_de_config(config, "ENTRADAS_CACHE", INT_MIN, 0, &valida);
+    foto->reemplazo_cache = opcion_de_config(config, "REEMPLAZO_CACHE", opciones_reemplazo_cache, 2, -1, &valida);
+    foto->retardo_cache = int_de_config(config, "RETARDO_CACHE", INT_MIN, 0, &valida);
+    foto->huellas_procesos = int_de_config(config, "HUELLAS_PROCESOS", 0, 0, &valida);
+    foto->imagen_caliente = string_de_config(config, "IMAGEN_CALIENTE", false, &valida);
+    foto->periodo_imagen_caliente = int_de_config(config, "PERIODO_IMAGEN_CALIENTE", 5000, 0, &valida);
+    if (foto->imagen_caliente != NULL && foto->huellas_procesos == 0) { // la imagen guarda huellas
+        printf("\n[ERROR] %s: IMAGEN_CALIENTE necesita HUELLAS_PROCESOS mayor a 0\n", archivo);
+        valida = false;
+    }
+
+    // Ejecución y memoria
+    foto->cpus_virtuales = int_de_config(config, "CPUS_VIRTUALES", 1, 1, &valida);
+    foto->fijar_nucleos = bool_de_config(config, "FIJAR_NUCLEOS", &valida);
+    foto->hilos_hardware = int_de_config(config, "HILOS_HARDWARE", 1, 1, &valida);
+    foto->modo_eventos = opcion_de_config(config, "MODO_EJECUCION", opciones_modo_ejecucion, 2, 0, &valida) == 1;
+    foto->interrupcion_eventfd = bool_de_config(config, "INTERRUPCION_EVENTFD", &valida);
+    foto->pedidos_multiplexados = bool_de_config(config, "PEDIDOS_MULTIPLEXADOS", &valida);
+    foto->memoria_compartida = opcion_de_config(config, "TRANSPORTE_MEMORIA", opciones_transporte_memoria, 2, 0, &valida) == 1;
+    foto->tamanio_anillo_memoria = int_de_config(config, "TAMANIO_ANILLO_MEMORIA", 262144, 4096, &valida);
+    foto->codec_paginas = bool_de_config(config, "CODEC_PAGINAS", &valida);
+    foto->mensajes_fijos = bool_de_config(config, "MENSAJES_FIJOS", &valida);
+    foto->accesos_vectorizados = bool_de_config(config, "ACCESOS_VECTORIZADOS", &valida);
+    foto->buffer_escrituras = bool_de_config(config, "BUFFER_ESCRITURAS", &valida);
+    foto->profundidad_prefetch = int_de_config(config, "PROFUNDIDAD_PREFETCH", 1, 0, &valida);
+    if (foto->profundidad_prefetch > 1) { // el FETCH lleva un solo pedido adelantado
+        printf("\n[ERROR] %s: PROFUNDIDAD_PREFETCH=%d, solo se admite 0 o 1\n", archivo, foto->profundidad_prefetch);
+        valida = false;
+    }
+
+    // Logs y traza
+    char* nivel_log = config_has_property(config, "LOG_LEVEL") ? config_get_string_value(config, "LOG_LEVEL") : NULL;
+    foto->nivel_log = nivel_log != NULL ? log_level_from_string(nivel_log) : -1;
+    if ((int)foto->nivel_log == -1) {
+        printf("\n[ERROR] %s: LOG_LEVEL falta o no es un nivel de log\n", archivo);
+        valida = false;
+    }
+    foto->log_asincronico = bool_de_config(config, "LOG_ASINCRONICO", &valida);
+    foto->traza_binaria = string_de_config(config, "TRAZA_BINARIA", false, &valida);
+    foto->estadisticas = string_de_config(config, "ESTADISTICAS", false, &valida);
+    foto->periodo_estadisticas = int_de_config(config, "PERIODO_ESTADISTICAS", 0, 0, &valida);
+
+    config_destroy(config);
+    if (!valida) {
+        destruir_foto_configuracion(foto, true);
+        return NULL;
+    }
+    return foto;
 }
-char* puerto_kernel_dispatch() {
-    return config_get_string_value(cpu_config, "PUERTO_KERNEL_DISPATCH");
+
+/**
+* @fn     void destruir_foto_configuracion(t_config_cpu* foto, bool con_strings)
+* @brief  Libera una foto de la configuración.
+* @param  foto Foto a liberar.
+* @param  con_strings true si la foto es dueña de sus strings (la primera, o una leída que no se publicó).
+* @return Ninguno
+*/
+void destruir_foto_configuracion(t_config_cpu* foto, bool con_strings) {
+    if (con_strings) {
+        free(foto->ip_memoria);
+        free(foto->puerto_memoria);
+        free(foto->ip_kernel);
+        free(foto->puerto_kernel_dispatch);
+        free(foto->puerto_kernel_interrupt);
+        free(foto->direccion_memoria);
+        free(foto->direccion_kernel_dispatch);
+        free(foto->direccion_kernel_interrupt);
+        if (foto->fragmentos_memoria != NULL) {
+            string_array_destroy(foto->fragmentos_memoria);
+        }
+        free(foto->traza_binaria);
+        free(foto->imagen_caliente);
+        free(foto->estadisticas);
+    }
+    free(foto);
 }
-char* puerto_kernel_interrupt() {
-    return config_get_string_value(cpu_config, "PUERTO_KERNEL_INTERRUPT");
-}   
-char* ip_kernel() {
-    return config_get_string_value(cpu_config, "IP_KERNEL");
+
+/**
+* @fn     bool mismo_string(const char* a, const char* b)
+* @brief  Compara dos strings de la configuración, que pueden ser NULL.
+* @param  a Primer string.
+* @param  b Segundo string.
+* @return true si los dos son NULL o tienen el mismo texto.
+*/
+bool mismo_string(const char* a, const char* b) {
+    return (a == NULL || b == NULL) ? a == b : strcmp(a, b) == 0;
 }
 
-// Para otras cositas 
-int entradas_tlb() {
-    return config_get_int_value(cpu_config, "ENTRADAS_TLB");
+/**
+* @fn     bool mismas_listas(char** a, char** b)
+* @brief  Compara dos listas de strings de la configuración, que pueden ser NULL.
+* @param  a Primera lista.
+* @param  b Segunda lista.
+* @return true si las dos son NULL o tienen los mismos strings en el mismo orden.
+*/
+bool mismas_listas(char** a, char** b) {
+    if (a == NULL || b == NULL) {
+        return a == b;
+    }
+    int i = 0;
+    while (a[i] != NULL && b[i] != NULL && strcmp(a[i], b[i]) == 0) {
+        i++;
+    }
+    return a[i] == NULL && b[i] == NULL;
 }
-char* reemplazo_tlb() {
-    return config_get_string_value(cpu_config, "REEMPLAZO_TLB");
+
+/**
+* @fn     bool mismos_valores_fijos(const t_config_cpu* a, const t_config_cpu* b)
+* @brief  Compara las claves que no se recargan en caliente.
+* @param  a Configuración vigente.
+* @param  b Configuración recién leída.
+* @return true si ninguna clave que necesita reiniciar cambió.
+*/
+bool mismos_valores_fijos(const t_config_cpu* a, const t_config_cpu* b) {
+    return mismo_string(a->ip_memoria, b->ip_memoria)
+        && mismo_string(a->puerto_memoria, b->puerto_memoria)
+        && mismo_string(a->ip_kernel, b->ip_kernel)
+        && mismo_string(a->puerto_kernel_dispatch, b->puerto_kernel_dispatch)
+        && mismo_string(a->puerto_kernel_interrupt, b->puerto_kernel_interrupt)
+        && mismo_string(a->direccion_memoria, b->direccion_memoria)
+        && mismo_string(a->direccion_kernel_dispatch, b->direccion_kernel_dispatch)
+        && mismo_string(a->direccion_kernel_interrupt, b->direccion_kernel_interrupt)
+        && mismas_listas(a->fragmentos_memoria, b->fragmentos_memoria)
+        && a->plazo_conexion == b->plazo_conexion
+        && a->reintento_conexion == b->reintento_conexion
+        && a->reintento_conexion_max == b->reintento_conexion_max
+        && mismo_string(a->traza_binaria, b->traza_binaria)
+        && mismo_string(a->estadisticas, b->estadisticas)
+        && a->entradas_tlb == b->entradas_tlb
+        && a->reemplazo_tlb == b->reemplazo_tlb
+        && a->entradas_cache == b->entradas_cache
+        && a->reemplazo_cache == b->reemplazo_cache
+        && a->huellas_procesos == b->huellas_procesos
+        && mismo_string(a->imagen_caliente, b->imagen_caliente)
+        && a->cpus_virtuales == b->cpus_virtuales
+        && a->fijar_nucleos == b->fijar_nucleos
+        && a->hilos_hardware == b->hilos_hardware
+        && a->modo_eventos == b->modo_eventos
+        && a->interrupcion_eventfd == b->interrupcion_eventfd
+        && a->pedidos_multiplexados == b->pedidos_multiplexados
+        && a->memoria_compartida == b->memoria_compartida
+        && a->tamanio_anillo_memoria == b->tamanio_anillo_memoria
+        && a->codec_paginas == b->codec_paginas
+        && a->mensajes_fijos == b->mensajes_fijos
+        && a->accesos_vectorizados == b->accesos_vectorizados
+        && a->buffer_escrituras == b->buffer_escrituras
+        && a->log_asincronico == b->log_asincronico;
 }
-int entradas_cache() {
-    return config_get_int_value(cpu_config, "ENTRADAS_CACHE");
+
+/**
+* @fn     void recargar_configuracion(void)
+* @brief  Vuelve a leer cpu.config y publica una foto nueva con los valores recargables (LOG_LEVEL, RETARDO_CACHE, PROFUNDIDAD_PREFETCH, PERIODO_IMAGEN_CALIENTE, PERIODO_ESTADISTICAS). Si el archivo tiene errores sigue la configuración vigente; si cambió una clave que no se recarga, avisa que hace falta reiniciar.
+* @param  Ninguno
+* @return Ninguno
+*/
+void recargar_configuracion(void) {
+    t_config_cpu* vigente = atomic_load(&configuracion_cpu);
+    t_config_cpu* leida = leer_configuracion(ARCHIVO_CONFIG_CPU);
+    if (leida == NULL) {
+        log_warning(cpu_logger, "%s tiene errores, sigo con la configuración anterior", ARCHIVO_CONFIG_CPU);
+        return;
+    }
+    if (!mismos_valores_fijos(vigente, leida)) {
+        log_warning(cpu_logger, "Cambiaron claves de %s que no se recargan en caliente: se aplican al reiniciar la CPU", ARCHIVO_CONFIG_CPU);
+    }
+
+    bool cambia = leida->nivel_log != vigente->nivel_log
+        || leida->retardo_cache != vigente->retardo_cache
+        || leida->profundidad_prefetch != vigente->profundidad_prefetch
+        || leida->periodo_imagen_caliente != vigente->periodo_imagen_caliente
+        || leida->periodo_estadisticas != vigente->periodo_estadisticas;
+    if (cambia) {
+        t_config_cpu* nueva = malloc(sizeof(t_config_cpu));
+        *nueva = *vigente; // comparte los strings de la vigente
+        nueva->nivel_log = leida->nivel_log;
+        nueva->retardo_cache = leida->retardo_cache;
+        nueva->profundidad_prefetch = leida->profundidad_prefetch;
+        nueva->periodo_imagen_caliente = leida->periodo_imagen_caliente;
+        nueva->periodo_estadisticas = leida->periodo_estadisticas;
+        nueva->anterior = vigente;
+        atomic_store_explicit(&configuracion_cpu, nueva, memory_order_release);
+
+        if (nueva->periodo_estadisticas != vigente->periodo_estadisticas) {
+            avisar_periodo_estadisticas();
+        }
+        log_info(cpu_logger, "Configuración recargada: LOG_LEVEL=%s RETARDO_CACHE=%d PROFUNDIDAD_PREFETCH=%d PERIODO_IMAGEN_CALIENTE=%d PERIODO_ESTADISTICAS=%d",
+            log_level_as_string(nueva->nivel_log), nueva->retardo_cache, nueva->profundidad_prefetch, nueva->periodo_imagen_caliente, nueva->periodo_estadisticas);
+    }
+    destruir_foto_configuracion(leida, true);
 }
-char* reemplazo_cache() {
-    return config_get_string_value(cpu_config, "REEMPLAZO_CACHE");
+
+/**
+* @fn     void* vigilar_configuracion(void* arg)
+* @brief  Hilo que espera con inotify que cpu.config se escriba o se reemplace (los editores suelen renombrar un archivo nuevo encima) y lo recarga, hasta que detener_recarga_configuracion() lo despierta.
+* @param  arg No se usa.
+* @return NULL
+*/
+void* vigilar_configuracion(void* arg) {
+    int inotify = inotify_init1(IN_CLOEXEC);
+    if (inotify == -1 || inotify_add_watch(inotify, ".", IN_CLOSE_WRITE | IN_MOVED_TO) == -1) {
+        log_warning(cpu_logger, "No se puede vigilar %s, no se va a recargar en caliente", ARCHIVO_CONFIG_CPU);
+        if (inotify != -1) {
+            close(inotify);
+        }
+        return NULL;
+    }
+
+    struct pollfd esperas[2] = {
+        { .fd = inotify, .events = POLLIN },
+        { .fd = fin_recarga_config, .events = POLLIN }
+    };
+    char eventos[4096] __attribute__((aligned(__alignof__(struct inotify_event))));
+
+    while (poll(esperas, 2, -1) >= 0 && !(esperas[1].revents & POLLIN)) {
+        if (!(esperas[0].revents & POLLIN)) {
+            continue;
+        }
+        ssize_t leidos = read(inotify, eventos, sizeof(eventos));
+        bool es_la_config = false;
+        for (char* p = eventos; p < eventos + leidos; ) {
+            struct inotify_event* evento = (struct inotify_event*)p;
+            if (evento->len > 0 && strcmp(evento->name, ARCHIVO_CONFIG_CPU) == 0) {
+                es_la_config = true;
+            }
+            p += sizeof(struct inotify_event) + evento->len;
+        }
+        if (es_la_config) {
+            recargar_configuracion();
+        }
+    }
+
+    close(inotify);
+    return NULL;
 }
-char* retardo_cache() {
-    return config_get_string_value(cpu_config, "RETARDO_CACHE");
+
+/**
+* @fn     void iniciar_recarga_configuracion(void)
+* @brief  Lanza el hilo que recarga cpu.config cuando cambia. Necesita el logger ya creado.
+* @param  Ninguno
+* @return Ninguno
+*/
+void iniciar_recarga_configuracion(void) {
+    fin_recarga_config = eventfd(0, EFD_CLOEXEC);
+    if (fin_recarga_config == -1 || pthread_create(&hilo_recarga_config, NULL, vigilar_configuracion, NULL) != 0) {
+        perror("No se pudo iniciar la recarga de la configuración");
+        exit(EXIT_FAILURE);
+    }
 }
-char* log_level() {
-    return config_get_string_value(cpu_config, "LOG_LEVEL");
+
+/**
+* @fn     void detener_recarga_configuracion(void)
+* @brief  Despierta al hilo de recarga para que termine y lo espera.
+* @param  Ninguno
+* @return Ninguno
+*/
+void detener_recarga_configuracion(void) {
+    if (fin_recarga_config == -1) {
+        return;
+    }
+    uint64_t uno = 1;
+    if (write(fin_recarga_config, &uno, sizeof(uno)) == sizeof(uno)) {
+        pthread_join(hilo_recarga_config, NULL);
+    }
+    close(fin_recarga_config);
+    fin_recarga_config = -1;
 }
 
+/**
+* @fn     void destruir_configuracion(void)
+* @brief  Libera la foto vigente y todas las que reemplazaron las recargas. Solo la primera es dueña de los strings.
+* @param  Ninguno
+* @return Ninguno
+*/
+void destruir_configuracion(void) {
+    t_config_cpu* foto = atomic_exchange(&configuracion_cpu, NULL);
+    while (foto != NULL) {
+        t_config_cpu* anterior = foto->anterior;
+        destruir_foto_configuracion(foto, anterior == NULL);
+        foto = anterior;
+    }
+}
 
 t_log* inicializar_logger(char *nombre) {
     // Hace el nombre de la CPU con el .log
@@ -50,32 +446,32 @@ t_log* inicializar_logger(char *nombre) {
     strcpy(nombre_con_extension, nombre);       // Copio el nombre base
     strcat(nombre_con_extension, ".log");       // Le agrego la extensión
 
-    // Obtengo el nivel de log
-    char* nivel_log = log_level();
-    if (nivel_log == NULL) {
-        printf("Error: LOG_LEVEL no definido en la configuración.\n");
-        free(nombre_con_extension);
-        exit(EXIT_FAILURE);
-    }
-
-    t_log* nuevo_logger = log_create(nombre_con_extension, "LOGGER CPU", 1, log_level_from_string(nivel_log));
+    // El nivel de log ya se validó al leer la configuración
+    t_log* nuevo_logger = log_create(nombre_con_extension, "LOGGER CPU", 1, configuracion()->nivel_log);
 
     if (nuevo_logger == NULL) {
         free(nombre_con_extension);
         exit(EXIT_FAILURE);
     }
 
+    // El log diferido escribe en el mismo archivo, con su propio descriptor
+    if (configuracion()->log_asincronico) {
+        cpu_log_diferido = crear_log_diferido(nuevo_logger, nombre_con_extension);
+    }
+
     free(nombre_con_extension); // Libero la memoria asignada
+    cpu_logger = nuevo_logger;
     return nuevo_logger;
 }
 
 void inicializar_configCPU() {
 
-    cpu_config = config_create("cpu.config");
+    t_config_cpu* foto = leer_configuracion(ARCHIVO_CONFIG_CPU);
 
-    if(cpu_config == NULL){
-        perror("Fallo en CPU config: no se pudo crear. ");
+    if(foto == NULL){
+        printf("Fallo en CPU config: %s no es válido.\n", ARCHIVO_CONFIG_CPU);
         exit(EXIT_FAILURE);
     }
+    atomic_store(&configuracion_cpu, foto);
 }
 
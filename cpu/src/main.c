@@ -2,7 +2,7 @@
 
 /**
 * @fn    main
-* @brief Punto de entrada del programa. Inicializa logs, configuración y conexiones, y luego cierra los recursos.
+* @brief Punto de entrada del programa. Inicializa logs y configuración, corre las CPUs virtuales y luego cierra los recursos.
 * @param argc Cantidad de argumentos pasados al programa.
 * @param argv Array de argumentos pasados al programa.
 * @return Código de salida del programa.
@@ -15,15 +15,19 @@ int main(int argc, char* argv[]) {
 
     char* cpu_id = argv[1];
     
+    bloquear_senal_estadisticas(); // antes de crear hilos: SIGUSR1 solo lo lee el de estadísticas
     inicializar_configCPU();
     t_log* logger = inicializar_logger(cpu_id);
-    if(cache_habilitada()) {
-        inicializar_cache();
+    iniciar_estadisticas(cpu_id, logger);
+    iniciar_recarga_configuracion();
+    if(configuracion()->traza_binaria != NULL) {
+        abrir_traza(configuracion()->traza_binaria);
     }
-	iniciar_TLB();
-    conexiones(cpu_id, logger);
+    if(configuracion()->imagen_caliente != NULL) {
+        abrir_imagen_caliente(configuracion()->imagen_caliente, cpu_id, logger);
+    }
+    ejecutar_cpus_virtuales(cpu_id, logger);
     cerrar_cpu(logger);
-    log_debug(cpu_logger, "Recursos liberados y CPU cerrada.\n");
 	
 	return EXIT_SUCCESS;
 }
@@ -0,0 +1,470 @@
+#include "../include/cpu.h"
+
+/**
+* @fn     t_canal_compartido* crear_canal_memoria(t_log* cpu_logger)
+* @brief  Si TRANSPORTE_MEMORIA es MEMORIA_COMPARTIDA, crea el canal de anillos en memoria compartida que se le ofrece a memoria en el handshake. El bucle de eventos espera a memoria con epoll sobre el socket, así que en ese modo se sigue usando el socket.
+* @param  cpu_logger Logger para imprimir información de control.
+* @return Canal creado, o NULL si no corresponde o no se pudo crear.
+*/
+t_canal_compartido* crear_canal_memoria(t_log* cpu_logger) {
+    if (!configuracion()->memoria_compartida) {
+        return NULL;
+    }
+    if (configuracion()->hilos_hardware > 1 || configuracion()->modo_eventos) {
+        log_warning(cpu_logger, "TRANSPORTE_MEMORIA=MEMORIA_COMPARTIDA no se usa con el bucle de eventos, sigo por socket");
+        return NULL;
+    }
+    if (cantidad_fragmentos > 1) {
+        log_warning(cpu_logger, "TRANSPORTE_MEMORIA=MEMORIA_COMPARTIDA no se usa con FRAGMENTOS_MEMORIA, sigo por socket");
+        return NULL;
+    }
+    return crear_canal_compartido(configuracion()->tamanio_anillo_memoria, socket_memoria);
+}
+
+/**
+* @fn     int enviar_a_memoria(t_constructor_paquete* paquete)
+* @brief  Envía un pedido armado a memoria por el transporte acordado en el handshake: el anillo de salida del canal compartido si memoria lo aceptó, o el socket.
+* @param  paquete Constructor con el pedido completo. Queda liberado.
+* @return 0 si se envió, -1 si memoria se desconectó.
+*/
+int enviar_a_memoria(t_constructor_paquete* paquete) {
+    if (canal_memoria != NULL) {
+        return enviar_constructor_por_anillo(paquete, canal_memoria);
+    }
+    return enviar_constructor(paquete, socket_memoria);
+}
+
+/**
+* @fn     uint32_t iniciar_pedido_a_memoria(t_constructor_paquete* paquete, op_code_t cod_op, void* almacenamiento, int capacidad)
+* @brief  Empieza a armar un pedido a memoria. Si en el handshake se acordaron pedidos multiplexados, le asigna un id en la tabla de pedidos de la conexión y lo carga como primer campo.
+* @param  paquete Constructor a inicializar.
+* @param  cod_op Código de operación del pedido.
+* @param  almacenamiento Almacenamiento inicial del constructor (normalmente un array en la pila).
+* @param  capacidad Tamaño de almacenamiento en bytes.
+* @return Id con el que se espera la respuesta, 0 si la conexión no usa ids.
+*/
+uint32_t iniciar_pedido_a_memoria(t_constructor_paquete* paquete, op_code_t cod_op, void* almacenamiento, int capacidad) {
+    return iniciar_pedido(paquete, cod_op, almacenamiento, capacidad, pedidos_memoria);
+}
+
+/**
+* @fn     int recibir_de_memoria(uint32_t id, t_buffer* respuesta)
+* @brief  Recibe la respuesta de memoria al pedido indicado a través del buffer de lectura de la conexión, que trae con un solo recv todas las respuestas que ya llegaron. Con pedidos multiplexados, las respuestas a otros pedidos que lleguen antes quedan guardadas en la tabla. Toda lectura del socket de memoria tiene que pasar por acá: un recv directo se salta lo que ya está en el buffer.
+* @param  id Id devuelto por iniciar_pedido_a_memoria() (0 para el handshake).
+* @param  respuesta Donde se deja el contenido del mensaje, sin el id. Es una vista: vale hasta la próxima respuesta recibida y no se elimina.
+* @return Código de operación recibido, o -1 si memoria se desconectó.
+*/
+int recibir_de_memoria(uint32_t id, t_buffer* respuesta) {
+    return esperar_respuesta(pedidos_memoria, lector_memoria, id, respuesta);
+}
+
+/**
+* @fn     bool respuesta_de_memoria_disponible(uint32_t id)
+* @brief  Indica si ya hay algo recibido para leer sin esperar al socket: una respuesta guardada en la tabla o un mensaje completo en el buffer de lectura.
+* @param  id Id del pedido.
+* @return true si recibir_de_memoria() no necesita esperar a que el socket tenga datos, false en caso contrario.
+*/
+bool respuesta_de_memoria_disponible(uint32_t id) {
+    return respuesta_disponible(pedidos_memoria, lector_memoria, id);
+}
+
+/**
+* @fn     void descartar_respuesta_de_memoria(uint32_t id)
+* @brief  Desentiende a la CPU de la respuesta a un pedido. Con pedidos multiplexados se descarta cuando llegue, sin esperarla; sin ids hay que leerla igual para no desfasar las respuestas siguientes.
+* @param  id Id del pedido.
+* @return Ninguno
+*/
+void descartar_respuesta_de_memoria(uint32_t id) {
+    if (pedidos_memoria->habilitada) {
+        abandonar_pedido(pedidos_memoria, id);
+        return;
+    }
+    t_buffer respuesta;
+    recibir_de_memoria(id, &respuesta);
+}
+
+/**
+* @fn     int fragmento_de_pid(int pid_proceso)
+* @brief  Elige el fragmento de memoria que tiene las tablas de páginas y las instrucciones de un proceso, con el hash consistente de Lamping y Veach (jump consistent hash): sin tabla, y al pasar de n a n+1 fragmentos solo cambian de fragmento los procesos que pasan al nuevo.
+* @param  pid_proceso PID del proceso.
+* @return Índice del fragmento en fragmentos_memoria.
+*/
+int fragmento_de_pid(int pid_proceso) {
+    uint64_t clave = (uint64_t)pid_proceso;
+    int64_t elegido = -1;
+    int64_t siguiente = 0;
+    while (siguiente < cantidad_fragmentos) {
+        elegido = siguiente;
+        clave = clave * 2862933555777941757ULL + 1;
+        siguiente = (int64_t)((elegido + 1) * ((double)(1LL << 31) / (double)((clave >> 33) + 1)));
+    }
+    return (int)elegido;
+}
+
+/**
+* @fn     t_fragmento_memoria* fragmento_de_marco(int marco)
+* @brief  Busca el fragmento de memoria que guarda un marco global, según los rangos acordados en los handshakes.
+* @param  marco Número de marco global.
+* @return Fragmento del marco. Un marco fuera de todos los rangos va al primero, que lo rechaza como lo haría una memoria sola.
+*/
+t_fragmento_memoria* fragmento_de_marco(int marco) {
+    for (int i = 1; i < cantidad_fragmentos; i++) {
+        t_fragmento_memoria* fragmento = &fragmentos_memoria[i];
+        if (marco >= fragmento->primer_marco && marco < fragmento->primer_marco + fragmento->cantidad_marcos) {
+            return fragmento;
+        }
+    }
+    return &fragmentos_memoria[0];
+}
+
+/**
+* @fn     void usar_fragmento_del_proceso(void)
+* @brief  Deja en socket_memoria, lector_memoria y pedidos_memoria la conexión con el fragmento del proceso actual, que es donde van el FETCH y los accesos a la tabla de páginas.
+* @param  Ninguno
+* @return Ninguno
+*/
+void usar_fragmento_del_proceso(void) {
+    t_fragmento_memoria* fragmento = &fragmentos_memoria[fragmento_de_pid(pid)];
+    socket_memoria = fragmento->socket;
+    lector_memoria = fragmento->lector;
+    pedidos_memoria = fragmento->pedidos;
+}
+
+/**
+* @fn     void cerrar_fragmentos_memoria(t_fragmento_memoria* fragmentos)
+* @brief  Cierra las conexiones con los fragmentos de memoria de una CPU y libera el arreglo. Acepta NULL.
+* @param  fragmentos Fragmentos armados por establecer_conexiones().
+* @return Ninguno
+*/
+void cerrar_fragmentos_memoria(t_fragmento_memoria* fragmentos) {
+    if (fragmentos == NULL) {
+        return;
+    }
+    for (int i = 0; i < cantidad_fragmentos; i++) {
+        liberar_conexion(fragmentos[i].socket);
+        destruir_lector_socket(fragmentos[i].lector);
+        destruir_tabla_pedidos(fragmentos[i].pedidos);
+        free(fragmentos[i].direccion);
+    }
+    free(fragmentos);
+}
+
+/**
+* @fn     int enviar_a_fragmento(t_fragmento_memoria* fragmento, t_constructor_paquete* paquete)
+* @brief  Como enviar_a_memoria(), a un fragmento en particular. El canal compartido solo existe con un fragmento.
+* @param  fragmento Fragmento destino.
+* @param  paquete Constructor con el pedido completo. Queda liberado.
+* @return 0 si se envió, -1 si el fragmento se desconectó.
+*/
+int enviar_a_fragmento(t_fragmento_memoria* fragmento, t_constructor_paquete* paquete) {
+    if (canal_memoria != NULL) {
+        return enviar_constructor_por_anillo(paquete, canal_memoria);
+    }
+    return enviar_constructor(paquete, fragmento->socket);
+}
+
+/**
+* @fn     int enviar_lote_a_fragmento(t_fragmento_memoria* fragmento, t_constructor_paquete* paquetes, int cantidad)
+* @brief  Como enviar_a_fragmento(), con varios pedidos ya armados que salen juntos: una sola llamada al sistema por el socket, o una copia detrás de la otra en el anillo. Se usa al vaciar el buffer de escrituras, al escribir las páginas modificadas de un proceso y al pedir su huella.
+* @param  fragmento Fragmento destino.
+* @param  paquetes Constructores con los pedidos completos, en el orden en que se tienen que atender. Quedan liberados.
+* @param  cantidad Cantidad de pedidos.
+* @return 0 si se enviaron, -1 si el fragmento se desconectó.
+*/
+int enviar_lote_a_fragmento(t_fragmento_memoria* fragmento, t_constructor_paquete* paquetes, int cantidad) {
+    if (canal_memoria != NULL) {
+        return enviar_constructores_por_anillo(paquetes, cantidad, canal_memoria);
+    }
+    return enviar_constructores(paquetes, cantidad, fragmento->socket);
+}
+
+/**
+* @fn     uint32_t iniciar_pedido_a_fragmento(t_fragmento_memoria* fragmento, t_constructor_paquete* paquete, op_code_t cod_op, void* almacenamiento, int capacidad)
+* @brief  Como iniciar_pedido_a_memoria(), con un id de la tabla de pedidos del fragmento.
+* @param  fragmento Fragmento destino.
+* @param  paquete Constructor a inicializar.
+* @param  cod_op Código de operación del pedido.
+* @param  almacenamiento Almacenamiento inicial del constructor.
+* @param  capacidad Tamaño de almacenamiento en bytes.
+* @return Id con el que se espera la respuesta, 0 si la conexión no usa ids.
+*/
+uint32_t iniciar_pedido_a_fragmento(t_fragmento_memoria* fragmento, t_constructor_paquete* paquete, op_code_t cod_op, void* almacenamiento, int capacidad) {
+    return iniciar_pedido(paquete, cod_op, almacenamiento, capacidad, fragmento->pedidos);
+}
+
+/**
+* @fn     int recibir_de_fragmento(t_fragmento_memoria* fragmento, uint32_t id, t_buffer* respuesta)
+* @brief  Como recibir_de_memoria(), de la conexión con un fragmento.
+* @param  fragmento Fragmento al que se le hizo el pedido.
+* @param  id Id del pedido.
+* @param  respuesta Vista del contenido del mensaje, sin el id.
+* @return Código de operación recibido, o -1 si el fragmento se desconectó.
+*/
+int recibir_de_fragmento(t_fragmento_memoria* fragmento, uint32_t id, t_buffer* respuesta) {
+    return esperar_respuesta(fragmento->pedidos, fragmento->lector, id, respuesta);
+}
+
+/**
+* @fn     bool respuesta_de_fragmento_disponible(t_fragmento_memoria* fragmento, uint32_t id)
+* @brief  Como respuesta_de_memoria_disponible(), en la conexión con un fragmento.
+* @param  fragmento Fragmento al que se le hizo el pedido.
+* @param  id Id del pedido.
+* @return true si recibir_de_fragmento() no necesita esperar.
+*/
+bool respuesta_de_fragmento_disponible(t_fragmento_memoria* fragmento, uint32_t id) {
+    return respuesta_disponible(fragmento->pedidos, fragmento->lector, id);
+}
+
+/**
+* @fn     void descartar_respuesta_de_fragmento(t_fragmento_memoria* fragmento, uint32_t id)
+* @brief  Como descartar_respuesta_de_memoria(), en la conexión con un fragmento.
+* @param  fragmento Fragmento al que se le hizo el pedido.
+* @param  id Id del pedido.
+* @return Ninguno
+*/
+void descartar_respuesta_de_fragmento(t_fragmento_memoria* fragmento, uint32_t id) {
+    if (fragmento->pedidos->habilitada) {
+        abandonar_pedido(fragmento->pedidos, id);
+        return;
+    }
+    t_buffer respuesta;
+    recibir_de_fragmento(fragmento, id, &respuesta);
+}
+
+/**
+* @fn     void cargar_segmento_al_pedido(t_constructor_paquete* paquete, t_fragmento_memoria* fragmento, t_segmento_fisico* segmento, bool con_tamanio)
+* @brief  Agrega al pedido la cabecera de un segmento: marco relativo al fragmento y desplazamiento, y el tamaño si es una lectura. Usa el esquema fijo si se acordó con memoria.
+* @param  paquete Pedido que se está armando.
+* @param  fragmento Fragmento que guarda el marco del segmento.
+* @param  segmento Segmento a agregar.
+* @param  con_tamanio true para CPU_M_LEER_MEMORIA, false para CPU_M_ESCRIBIR_MEMORIA (el tamaño va con los datos).
+* @return Ninguno
+*/
+void cargar_segmento_al_pedido(t_constructor_paquete* paquete, t_fragmento_memoria* fragmento, t_segmento_fisico* segmento, bool con_tamanio) {
+    int marco = segmento->marco - fragmento->primer_marco;
+    if (mensajes_con_esquema && con_tamanio) {
+        t_mensaje_leer_memoria pedido = { .marco = marco, .desplazamiento = segmento->desplazamiento, .tamanio = segmento->tamanio };
+        empaquetar_leer_memoria(paquete, &pedido);
+    }
+    else if (mensajes_con_esquema) {
+        t_mensaje_escribir_memoria pedido = { .marco = marco, .desplazamiento = segmento->desplazamiento };
+        empaquetar_escribir_memoria(paquete, &pedido);
+    }
+    else {
+        cargar_int_al_constructor(paquete, marco);                    // número de marco
+        cargar_int_al_constructor(paquete, segmento->desplazamiento); // offset dentro de la página
+        if (con_tamanio) {
+            cargar_int_al_constructor(paquete, segmento->tamanio);    // cantidad de bytes a leer
+        }
+    }
+}
+
+/**
+* @fn     int armar_tramos(t_segmento_fisico* segmentos, int cantidad, t_tramo_memoria* tramos)
+* @brief  Reparte los segmentos de un acceso en pedidos: si memoria aceptó accesos vectorizados, uno por cada racha de segmentos del mismo fragmento; si no, uno por segmento.
+* @param  segmentos Segmentos consecutivos del acceso.
+* @param  cantidad Cantidad de segmentos.
+* @param  tramos Donde se dejan los tramos (lugar para cantidad).
+* @return Cantidad de tramos.
+*/
+int armar_tramos(t_segmento_fisico* segmentos, int cantidad, t_tramo_memoria* tramos) {
+    int cantidad_tramos = 0;
+    int posicion = 0;
+    for (int i = 0; i < cantidad; i++) {
+        t_fragmento_memoria* fragmento = fragmento_de_marco(segmentos[i].marco);
+        t_tramo_memoria* anterior = cantidad_tramos > 0 ? &tramos[cantidad_tramos - 1] : NULL;
+        if (accesos_en_lote && anterior != NULL && anterior->fragmento == fragmento) {
+            anterior->cantidad++;
+        }
+        else {
+            tramos[cantidad_tramos++] = (t_tramo_memoria){ .fragmento = fragmento, .primero = i, .cantidad = 1, .posicion = posicion };
+        }
+        posicion += segmentos[i].tamanio;
+    }
+    return cantidad_tramos;
+}
+
+/**
+* @fn     void enviar_lectura(t_tramo_memoria* tramo, t_segmento_fisico* segmentos)
+* @brief  Manda en un CPU_M_LEER_MEMORIA los segmentos del tramo a su fragmento, sin esperar la respuesta. Con un solo segmento el pedido es el mismo que sin accesos vectorizados.
+* @param  tramo Tramo a leer; se le anota el id del pedido.
+* @param  segmentos Segmentos del acceso.
+* @return Ninguno
+*/
+void enviar_lectura(t_tramo_memoria* tramo, t_segmento_fisico* segmentos) {
+    char almacenamiento[CAPACIDAD_CONSTRUCTOR_PILA];
+    t_constructor_paquete paquete;
+    tramo->id_pedido = iniciar_pedido_a_fragmento(tramo->fragmento, &paquete, CPU_M_LEER_MEMORIA, almacenamiento, sizeof(almacenamiento));
+    for (int i = tramo->primero; i < tramo->primero + tramo->cantidad; i++) {
+        cargar_segmento_al_pedido(&paquete, tramo->fragmento, &segmentos[i], true);
+    }
+    enviar_a_fragmento(tramo->fragmento, &paquete);
+}
+
+/**
+* @fn     bool recibir_lectura(t_tramo_memoria* tramo, t_segmento_fisico* segmentos, char* destino, t_log* cpu_logger)
+* @brief  Recibe la respuesta a enviar_lectura(), que trae un campo por segmento en el mismo orden, y la reparte en destino. Cada campo tiene que ser del tamaño de su segmento (o uno más, con el \0 de un string); si falta o sobra un campo o un largo no coincide, no se confía en nada de la respuesta.
+* @param  tramo Tramo leído.
+* @param  segmentos Segmentos del acceso.
+* @param  destino Bytes del acceso completo; el tramo se copia desde su posición.
+* @param  cpu_logger Logger para imprimir información.
+* @return true si memoria contestó con los valores leídos, false si contestó otra cosa o la respuesta no coincide con los segmentos.
+*/
+bool recibir_lectura(t_tramo_memoria* tramo, t_segmento_fisico* segmentos, char* destino, t_log* cpu_logger) {
+    t_buffer buffer;
+    if (recibir_de_fragmento(tramo->fragmento, tramo->id_pedido, &buffer) != M_CPU_VALOR_LEIDO) {
+        log_debug(cpu_logger, "Memoria me contestó otra cosa");
+        return false;
+    }
+
+    t_lector_buffer lector = crear_lector(&buffer);
+    destino += tramo->posicion;
+    for (int i = tramo->primero; i < tramo->primero + tramo->cantidad; i++) {
+        if (!quedan_datos_en_lector(&lector)) {
+            log_error(cpu_logger, "## PID: %d - Memoria contesto %d de %d segmentos leidos", pid, i - tramo->primero, tramo->cantidad);
+            return false;
+        }
+        int largo;
+        char* valor = leer_contenido_del_buffer(&lector, &largo);
+        bool con_terminador = largo == segmentos[i].tamanio + 1 && valor[segmentos[i].tamanio] == '\0'; //el valor puede venir como string
+        if (largo != segmentos[i].tamanio && !con_terminador) {
+            log_error(cpu_logger, "## PID: %d - Memoria contesto %d bytes para un segmento de %d (marco %d, desplazamiento %d)", pid, largo, segmentos[i].tamanio, segmentos[i].marco, segmentos[i].desplazamiento);
+            return false;
+        }
+        memcpy(destino, valor, segmentos[i].tamanio);
+        destino += segmentos[i].tamanio;
+    }
+    if (quedan_datos_en_lector(&lector)) {
+        log_error(cpu_logger, "## PID: %d - Memoria contesto mas campos que los %d segmentos leidos", pid, tramo->cantidad);
+        return false;
+    }
+    return true;
+}
+
+/**
+* @fn     bool leer_de_memoria(int direccion_logica, int tamanio, char* destino, t_log* cpu_logger)
+* @brief  Lee un rango de direcciones lógicas que puede cruzar páginas. La MMU lo parte en segmentos de una página y se arman los pedidos (ver armar_tramos()); salen todos antes de esperar la primera respuesta, así los fragmentos de memoria los atienden en paralelo. Con BUFFER_ESCRITURAS los bytes escritos que todavía no se confirmaron salen del buffer, y si lo cubren entero no se va a memoria.
+* @param  direccion_logica Dirección lógica donde empieza la lectura.
+* @param  tamanio Cantidad de bytes a leer.
+* @param  destino Donde se dejan los bytes leídos terminados en \0 (lugar para tamanio + 1).
+* @param  cpu_logger Logger para imprimir información.
+* @return true si memoria contestó con los valores leídos.
+*/
+bool leer_de_memoria(int direccion_logica, int tamanio, char* destino, t_log* cpu_logger) {
+    t_segmento_fisico* segmentos = reservar_del_pool(MAXIMO_SEGMENTOS(tamanio) * sizeof(t_segmento_fisico), NULL);
+    int cantidad = segmentar_rango_logico(direccion_logica, tamanio, segmentos);
+    int direccion_fisica = segmentos[0].marco * tam_pagina + segmentos[0].desplazamiento;
+    cpu_log_info(cpu_logger, "Dir logica: %d, Dir fisica: %d", direccion_logica, direccion_fisica);
+    anotar_acceso_traza(direccion_logica, direccion_fisica);
+
+    memset(destino, 0, tamanio + 1);
+    bool ok = true;
+    if (escrituras_pendientes != NULL) {
+        retirar_escrituras_confirmadas();
+    }
+    if (escrituras_pendientes != NULL && escrituras_cubren(segmentos, cantidad)) {
+        cpu_log_debug(cpu_logger, "READ resuelto con el buffer de escrituras");
+    }
+    else {
+        t_tramo_memoria* tramos = reservar_del_pool(cantidad * sizeof(t_tramo_memoria), NULL);
+        int cantidad_tramos = armar_tramos(segmentos, cantidad, tramos);
+        for (int t = 0; t < cantidad_tramos; t++) {
+            enviar_lectura(&tramos[t], segmentos);
+        }
+        for (int t = 0; t < cantidad_tramos; t++) {
+            ok = recibir_lectura(&tramos[t], segmentos, destino, cpu_logger) && ok; //se reciben todas para no desfasar las conexiones sin ids
+        }
+        devolver_al_pool(tramos);
+    }
+    if (ok && escrituras_pendientes != NULL) {
+        aplicar_escrituras_pendientes(segmentos, cantidad, destino); //lo que todavía no llegó a memoria
+    }
+    devolver_al_pool(segmentos);
+    return ok;
+}
+
+/**
+* @fn     void enviar_escritura(t_tramo_memoria* tramo, t_segmento_fisico* segmentos, char* datos, bool termina)
+* @brief  Manda en un CPU_M_ESCRIBIR_MEMORIA los segmentos del tramo a su fragmento, cada uno con su parte de los datos, sin esperar la confirmación. Con un solo segmento el pedido es el mismo que sin accesos vectorizados.
+* @param  tramo Tramo a escribir; se le anota el id del pedido.
+* @param  segmentos Segmentos del acceso.
+* @param  datos Bytes del acceso completo; el tramo se toma desde su posición.
+* @param  termina true si el último segmento del tramo es el final de los datos: su campo incluye el \0, como el string de siempre.
+* @return Ninguno
+*/
+void enviar_escritura(t_tramo_memoria* tramo, t_segmento_fisico* segmentos, char* datos, bool termina) {
+    char almacenamiento[CAPACIDAD_CONSTRUCTOR_PILA];
+    t_constructor_paquete paquete;
+    tramo->id_pedido = iniciar_pedido_a_fragmento(tramo->fragmento, &paquete, CPU_M_ESCRIBIR_MEMORIA, almacenamiento, sizeof(almacenamiento));
+    datos += tramo->posicion;
+    int fin = tramo->primero + tramo->cantidad;
+    for (int i = tramo->primero; i < fin; i++) {
+        bool ultimo = termina && i == fin - 1;
+        cargar_segmento_al_pedido(&paquete, tramo->fragmento, &segmentos[i], false);
+        agregar_al_constructor(&paquete, datos, segmentos[i].tamanio + (ultimo ? 1 : 0)); // datos a escribir (si no entran en la pila, van al heap)
+        datos += segmentos[i].tamanio;
+    }
+    enviar_a_fragmento(tramo->fragmento, &paquete);
+}
+
+/**
+* @fn     bool recibir_confirmacion_de_escritura(t_tramo_memoria* tramo, t_log* cpu_logger)
+* @brief  Recibe la confirmación de enviar_escritura().
+* @param  tramo Tramo escrito.
+* @param  cpu_logger Logger para imprimir información.
+* @return true si memoria confirmó la escritura.
+*/
+bool recibir_confirmacion_de_escritura(t_tramo_memoria* tramo, t_log* cpu_logger) {
+    t_buffer buffer;
+    if (recibir_de_fragmento(tramo->fragmento, tramo->id_pedido, &buffer) != M_CPU_CONFIRMACION_ESCRITURA) {
+        log_debug(cpu_logger, "Memoria me contestó otra cosa");
+        return false;
+    }
+    t_lector_buffer lector = crear_lector(&buffer);
+    cpu_log_debug(cpu_logger, "%s", leer_string_del_buffer(&lector));
+    return true;
+}
+
+/**
+* @fn     bool escribir_en_memoria(int direccion_logica, char* datos, t_log* cpu_logger)
+* @brief  Escribe un string en un rango de direcciones lógicas que puede cruzar páginas. La MMU lo parte en segmentos de una página y se arman los pedidos (ver armar_tramos()), que salen todos antes de esperar las confirmaciones. Con BUFFER_ESCRITURAS los segmentos, el \0 incluido, quedan en el buffer de escrituras y el WRITE se retira sin esperar a memoria: sus confirmaciones se controlan cuando se reciben, en este o en otro acceso.
+* @param  direccion_logica Dirección lógica donde empieza la escritura.
+* @param  datos String a escribir.
+* @param  cpu_logger Logger para imprimir información.
+* @return true si memoria confirmó todas las escrituras. Con BUFFER_ESCRITURAS, false si alguna confirmación que se recibió durante este WRITE (suya o de uno anterior) no llegó.
+*/
+bool escribir_en_memoria(int direccion_logica, char* datos, t_log* cpu_logger) {
+    int tamanio = strlen(datos);
+    t_segmento_fisico* segmentos = reservar_del_pool(MAXIMO_SEGMENTOS(tamanio) * sizeof(t_segmento_fisico), NULL);
+    int cantidad = segmentar_rango_logico(direccion_logica, tamanio, segmentos);
+    int direccion_fisica = segmentos[0].marco * tam_pagina + segmentos[0].desplazamiento;
+    cpu_log_info(cpu_logger, "Dir logica: %d, Dir fisica: %d", direccion_logica, direccion_fisica);
+    anotar_acceso_traza(direccion_logica, direccion_fisica);
+
+    bool ok = true;
+    if (escrituras_pendientes != NULL) {
+        ok = retirar_escrituras_confirmadas();
+        int escritos = 0;
+        for (int i = 0; i < cantidad; i++) {
+            t_segmento_fisico segmento = segmentos[i];
+            if (i == cantidad - 1) {
+                segmento.tamanio++; // el \0, como el último tramo de enviar_escritura()
+            }
+            ok = encolar_escritura(&segmento, datos + escritos) && ok;
+            escritos += segmentos[i].tamanio;
+        }
+    }
+    else {
+        t_tramo_memoria* tramos = reservar_del_pool(cantidad * sizeof(t_tramo_memoria), NULL);
+        int cantidad_tramos = armar_tramos(segmentos, cantidad, tramos);
+        for (int t = 0; t < cantidad_tramos; t++) {
+            enviar_escritura(&tramos[t], segmentos, datos, t == cantidad_tramos - 1);
+        }
+        for (int t = 0; t < cantidad_tramos; t++) {
+            ok = recibir_confirmacion_de_escritura(&tramos[t], cpu_logger) && ok;
+        }
+        devolver_al_pool(tramos);
+    }
+    devolver_al_pool(segmentos);
+    return ok;
+}
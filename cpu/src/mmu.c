@@ -1,4 +1,4 @@
-#include "mmu.h"
+#include "cpu.h"
 
 //-------------TLB------------------
 
@@ -11,12 +11,13 @@
 void iniciar_TLB(void){
     lista_tlb = list_create();
 
-    for(int i = 0; i < entradas_tlb(); i++){
+    for(int i = 0; i < configuracion()->entradas_tlb; i++){
         t_entrada_TLB* registro_tlb = malloc(sizeof(t_entrada_TLB)); //realloc
         if (!registro_tlb) {
             perror("No se pudo reservar memoria para la TLB");
             exit(EXIT_FAILURE);
         } 
+        registro_tlb->pid = -1;
         registro_tlb->numero_pagina = -1;
         registro_tlb->marco = -1;
         registro_tlb->time_creado = time(NULL);
@@ -28,7 +29,7 @@ void iniciar_TLB(void){
 
 /**
 * @fn     t_entrada_TLB* buscar_en_TLB(int numero_pagina)
-* @brief  Busca una entrada en la TLB que corresponda al número de página solicitado. Recorre la lista de entradas y retorna un puntero a la entrada si la encuentra, o NULL si no existe.
+* @brief  Busca una entrada en la TLB que corresponda al número de página solicitado del proceso actual. Recorre la lista de entradas y retorna un puntero a la entrada si la encuentra, o NULL si no existe.
 * @param  numero_pagina Número de página a buscar en la TLB.
 * @return Puntero a la entrada encontrada o NULL si no existe.
 */
@@ -36,7 +37,7 @@ t_entrada_TLB* buscar_en_TLB(int numero_pagina){
     t_entrada_TLB* registro_tlb;
     for(int i = 0; i < list_size(lista_tlb); i++){
         registro_tlb = list_get(lista_tlb, i);
-        if(registro_tlb->numero_pagina == numero_pagina)
+        if(registro_tlb->pid == pid && registro_tlb->numero_pagina == numero_pagina)
             return registro_tlb;
     }
     return NULL; // No se encontro la pagina en la t_entrada_TLB
@@ -56,24 +57,72 @@ int traducir_dir_logica(int direccion_logica, t_log* logger) {
     int nro_pagina = direccion_logica / tam_pagina;
     desplazamiento = direccion_logica % tam_pagina;
 
+    cpu_log_info(logger, "Direccion logica: %d", direccion_logica);
+    cpu_log_info(logger, "Numero de pagina: %d | Desplazamiento: %d", nro_pagina, desplazamiento);
+
+    int marco = traducir_pagina(nro_pagina); //obtiene el marco, ya sea desde la tlb o desde memoria
+    direccion_fisica = marco * tam_pagina + desplazamiento;
+
+    return direccion_fisica;
+}
+
+/**
+* @fn     int traducir_pagina(int nro_pagina)
+* @brief  Calcula los índices de tabla de páginas de cada nivel para una página y obtiene su marco, desde la TLB o desde memoria.
+* @param  nro_pagina Número de página a traducir.
+* @return Número de marco de la página.
+*/
+int traducir_pagina(int nro_pagina) {
     int vec[cantidad_niveles];
+    calcular_indices_tabla(nro_pagina, vec);
+    return obtener_marco(nro_pagina, vec);
+}
+
+/**
+* @fn     void calcular_indices_tabla(int nro_pagina, int vec[])
+* @brief  Calcula el índice de la tabla de páginas de cada nivel para una página.
+* @param  nro_pagina Número de página.
+* @param  vec Vector de cantidad_niveles elementos donde se dejan los índices, del primer nivel al último.
+* @return Ninguno
+*/
+void calcular_indices_tabla(int nro_pagina, int vec[]) {
     for (int X = 1; X <= cantidad_niveles; X++) {
         int divisor = (int)pow(entradas_tabla, cantidad_niveles - X); //indices de tabla de paginas
         vec[X-1] = (nro_pagina / divisor) % entradas_tabla;
     }
+}
 
-    log_info(logger, "Direccion logica: %d", direccion_logica);
-    log_info(logger, "Numero de pagina: %d | Desplazamiento: %d", nro_pagina, desplazamiento);
-
-    int marco = obtener_marco(nro_pagina, vec); //obtiene el marco, ya sea desde la tlb o desde memoria
-    direccion_fisica = marco * tam_pagina + desplazamiento;
-
-    return direccion_fisica;
+/**
+* @fn     int segmentar_rango_logico(int direccion_logica, int tamanio, t_segmento_fisico* segmentos)
+* @brief  Parte un rango de direcciones lógicas en segmentos (marco, desplazamiento, tamaño) que no cruzan páginas, traduciendo cada página una sola vez. Un rango de tamaño 0 da un único segmento vacío.
+* @param  direccion_logica Dirección lógica donde empieza el rango.
+* @param  tamanio Cantidad de bytes del rango.
+* @param  segmentos Array de al menos MAXIMO_SEGMENTOS(tamanio) elementos donde se dejan los segmentos, en orden.
+* @return Cantidad de segmentos cargados.
+*/
+int segmentar_rango_logico(int direccion_logica, int tamanio, t_segmento_fisico* segmentos) {
+    int cantidad = 0;
+    int direccion = direccion_logica;
+    int restantes = tamanio;
+    do {
+        int nro_pagina = direccion / tam_pagina;
+        int offset = direccion % tam_pagina;
+        int largo = restantes < tam_pagina - offset ? restantes : tam_pagina - offset;
+
+        segmentos[cantidad].marco = traducir_pagina(nro_pagina);
+        segmentos[cantidad].desplazamiento = offset;
+        segmentos[cantidad].tamanio = largo;
+        cantidad++;
+
+        direccion += largo;
+        restantes -= largo;
+    } while (restantes > 0);
+    return cantidad;
 }
 
 /**
 * @fn     int obtener_marco(int nro_pagina, int vec[])
-* @brief  Obtiene el marco correspondiente a una página. Primero busca en la TLB; si no está, consulta a memoria y actualiza la TLB con la nueva entrada. Devuelve el número de marco obtenido.
+* @brief  Obtiene el marco correspondiente a una página. Primero busca en la TLB; si no está, usa la traducción que se pidió de fondo al volver a despachar el proceso (ver huellas.h) o consulta a memoria, y actualiza la TLB con la nueva entrada. Devuelve el número de marco obtenido.
 * @param  nro_pagina Número de página a buscar.
 * @param  vec Vector de índices de tablas de páginas.
 * @return Número de marco correspondiente.
@@ -81,29 +130,58 @@ int traducir_dir_logica(int direccion_logica, t_log* logger) {
 int obtener_marco (int nro_pagina, int vec[]) {
     t_entrada_TLB* entrada_tlb_aux = buscar_en_TLB(nro_pagina);
     int marco;
+    anotar_tlb_traza(entrada_tlb_aux != NULL);
 
     if(entrada_tlb_aux != NULL){ //Existe la pagina en t_entrada_TLB
+        CONTAR(tlb_hits);
         entrada_tlb_aux->time_usado = time(NULL);
 
         marco = entrada_tlb_aux->marco;
     }
     else { //No esta en la t_entrada_TLB
-        entrada_tlb_aux = malloc(sizeof(t_entrada_TLB));
-        marco = buscar_marco_en_memoria(vec, cpu_logger, nro_pagina);
-
-        entrada_tlb_aux->marco = marco;
-        entrada_tlb_aux->numero_pagina = nro_pagina;
-        entrada_tlb_aux->time_creado = time(NULL);
-        entrada_tlb_aux->time_usado =time(NULL);
-        actualizar_TLB(entrada_tlb_aux);    
+        CONTAR(tlb_misses);
+        if (!tomar_marco_calentado(nro_pagina, &marco)) {
+            marco = buscar_marco_en_memoria(vec, cpu_logger, nro_pagina);
+        }
+        cargar_en_TLB(nro_pagina, marco);
     }
     return marco;
 }
 
+/**
+* @fn     void cargar_en_TLB(int nro_pagina, int marco)
+* @brief  Agrega a la TLB la traducción de una página del proceso actual, reemplazando una entrada si no hay lugar.
+* @param  nro_pagina Número de página.
+* @param  marco Marco de la página.
+* @return Ninguno
+*/
+void cargar_en_TLB(int nro_pagina, int marco) {
+    t_entrada_TLB entrada_tlb = {
+        .pid = pid,
+        .numero_pagina = nro_pagina,
+        .marco = marco,
+        .time_creado = time(NULL),
+        .time_usado = time(NULL)
+    };
+    actualizar_TLB(&entrada_tlb);
+}
+
+/**
+* @fn     void escribir_entrada_TLB(int indice, t_entrada_TLB* registro_tlb_nuevo)
+* @brief  Copia una entrada en un lugar de la TLB. Las entradas se reservan una vez en iniciar_TLB() y después solo se pisan.
+* @param  indice Lugar de la TLB.
+* @param  registro_tlb_nuevo Entrada a copiar.
+* @return Ninguno
+*/
+void escribir_entrada_TLB(int indice, t_entrada_TLB* registro_tlb_nuevo) {
+    t_entrada_TLB* entrada_tlb = list_get(lista_tlb, indice);
+    *entrada_tlb = *registro_tlb_nuevo;
+}
+
 /**
 * @fn     void actualizar_TLB(t_entrada_TLB* registro_tlb_nuevo)
 * @brief  Actualiza la TLB con una nueva entrada. Si ya existe una entrada con el mismo marco, la reemplaza. Si no hay lugar, aplica el algoritmo de reemplazo configurado (FIFO o LRU). Si hay lugar vacío, inserta la nueva entrada.
-* @param  registro_tlb_nuevo Nueva entrada de TLB a insertar.
+* @param  registro_tlb_nuevo Nueva entrada de TLB a insertar; se copia.
 * @return Ninguno
 */
 void actualizar_TLB(t_entrada_TLB* registro_tlb_nuevo){
@@ -111,20 +189,21 @@ void actualizar_TLB(t_entrada_TLB* registro_tlb_nuevo){
 
     int indice = existe_entrada_con_marco(registro_tlb_nuevo);
     if(indice != -1){
-        list_replace_and_destroy_element(lista_tlb, indice, registro_tlb_nuevo, (void*)free);
+        escribir_entrada_TLB(indice, registro_tlb_nuevo);
     }
     else{
         indice = verificar_reemplazo_TLB();
         if(indice == -1){ // No hay lugares vacios
-            if(strcmp(reemplazo_tlb(), "FIFO") == 0){
+            CONTAR(tlb_reemplazos);
+            if(configuracion()->reemplazo_tlb == TLB_FIFO){
                 reemplazar_TLB_FIFO(registro_tlb_nuevo);
             }
-            else if(strcmp(reemplazo_tlb(), "LRU") == 0){
+            else if(configuracion()->reemplazo_tlb == TLB_LRU){
                 reemplazar_TLB_LRU(registro_tlb_nuevo);
             }
         }
         else{ // Hay lugares vacios 
-            list_replace_and_destroy_element(lista_tlb, indice, registro_tlb_nuevo, (void*)free);
+            escribir_entrada_TLB(indice, registro_tlb_nuevo);
         }
     }
 }
@@ -132,7 +211,7 @@ void actualizar_TLB(t_entrada_TLB* registro_tlb_nuevo){
 /**
 * @fn     void reemplazar_TLB_FIFO(t_entrada_TLB* registro_tlb_nuevo)
 * @brief  Reemplaza la entrada más antigua de la TLB utilizando el algoritmo FIFO. Busca la entrada con menor timestamp de creación y la reemplaza por la nueva entrada.
-* @param  registro_tlb_nuevo Nueva entrada de TLB a insertar.
+* @param  registro_tlb_nuevo Nueva entrada de TLB a insertar; se copia.
 * @return Ninguno
 */
 void reemplazar_TLB_FIFO(t_entrada_TLB* registro_tlb_nuevo){
@@ -152,13 +231,13 @@ void reemplazar_TLB_FIFO(t_entrada_TLB* registro_tlb_nuevo){
         }
     }
 
-    list_replace_and_destroy_element(lista_tlb, indice_registro_tlb_mas_viejo, registro_tlb_nuevo, (void*)free);
+    escribir_entrada_TLB(indice_registro_tlb_mas_viejo, registro_tlb_nuevo);
 }
 
 /**
 * @fn     void reemplazar_TLB_LRU(t_entrada_TLB* registro_tlb_nuevo)
 * @brief  Reemplaza la entrada menos recientemente usada de la TLB utilizando el algoritmo LRU. Busca la entrada con menor timestamp de último uso y la reemplaza por la nueva entrada.
-* @param  registro_tlb_nuevo Nueva entrada de TLB a insertar.
+* @param  registro_tlb_nuevo Nueva entrada de TLB a insertar; se copia.
 * @return Ninguno
 */
 void reemplazar_TLB_LRU(t_entrada_TLB* registro_tlb_nuevo){
@@ -178,7 +257,7 @@ void reemplazar_TLB_LRU(t_entrada_TLB* registro_tlb_nuevo){
         }
     }
     
-    list_replace_and_destroy_element(lista_tlb, indice_mas_viejo_tlb, registro_tlb_nuevo, (void*)free);
+    escribir_entrada_TLB(indice_mas_viejo_tlb, registro_tlb_nuevo);
 }
 
 /**
@@ -222,29 +301,80 @@ int existe_entrada_con_marco(t_entrada_TLB* registro_tlb_nuevo){
 
 /**
 * @fn     int buscar_marco_en_memoria(int vec[], t_log* cpu_logger, int nro_pagina)
-* @brief  Solicita a memoria el marco correspondiente a una página. Envía una petición a memoria con los datos necesarios y espera la respuesta. Devuelve el número de marco recibido o -1 en caso de error.
+* @brief  Solicita a memoria el marco correspondiente a una página. Envía una petición al fragmento de memoria del proceso (el marco que devuelve es global) con los datos necesarios y espera la respuesta. Devuelve el número de marco recibido o -1 en caso de error.
 * @param  vec Vector de índices de tablas de páginas.
 * @param  cpu_logger Logger para imprimir información.
 * @param  nro_pagina Número de página.
 * @return Número de marco recibido o -1 en caso de error.
 */
 int buscar_marco_en_memoria(int vec[], t_log* cpu_logger, int nro_pagina) { //MMU
-    int marco;
-    t_buffer* buffer_peticion = crear_buffer();
-    cargar_int_al_buffer(buffer_peticion, pid);
-    cargar_int_al_buffer(buffer_peticion, nro_pagina);
+    uint32_t id_pedido = pedir_marco_a_memoria(vec, nro_pagina);
+    return recibir_marco_de_memoria(id_pedido, cpu_logger);
+}
 
-    for(int j=0 ; j<cantidad_niveles ; j++){
-        cargar_int_al_buffer(buffer_peticion, vec[j]); //indices de tabla de paginas
+/**
+* @fn     uint32_t pedir_marco_a_memoria(int vec[], int nro_pagina)
+* @brief  Envía al fragmento de memoria del proceso el acceso a la tabla de páginas de una página, sin esperar la respuesta.
+* @param  vec Vector de índices de tablas de páginas.
+* @param  nro_pagina Número de página.
+* @return Id con el que se espera la respuesta en recibir_marco_de_memoria().
+*/
+uint32_t pedir_marco_a_memoria(int vec[], int nro_pagina) {
+    char almacenamiento[CAPACIDAD_CONSTRUCTOR_PILA];
+    t_constructor_paquete paquete;
+    uint32_t id_pedido = armar_pedido_de_marco(&paquete, vec, nro_pagina, almacenamiento, sizeof(almacenamiento));
+    enviar_a_memoria(&paquete);
+    return id_pedido;
+}
+
+/**
+* @fn     uint32_t armar_pedido_de_marco(t_constructor_paquete* paquete, int vec[], int nro_pagina, void* almacenamiento, int capacidad)
+* @brief  Arma el acceso a la tabla de páginas de una página para el fragmento de memoria del proceso, sin enviarlo.
+* @param  paquete Constructor a inicializar.
+* @param  vec Vector de índices de tablas de páginas.
+* @param  nro_pagina Número de página.
+* @param  almacenamiento Almacenamiento inicial del constructor, o NULL para tomarlo del pool.
+* @param  capacidad Tamaño de almacenamiento en bytes.
+* @return Id con el que se espera la respuesta en recibir_marco_de_memoria().
+*/
+uint32_t armar_pedido_de_marco(t_constructor_paquete* paquete, int vec[], int nro_pagina, void* almacenamiento, int capacidad) {
+    uint32_t id_pedido = iniciar_pedido_a_memoria(paquete, CPU_M_ACCESO_TABLA_PAGINAS, almacenamiento, capacidad);
+    if (mensajes_con_esquema) {
+        t_mensaje_acceso_tabla_paginas pedido = { .pid = pid, .pagina = nro_pagina };
+        empaquetar_acceso_tabla_paginas(paquete, &pedido);
+        agregar_crudo_al_constructor(paquete, vec, cantidad_niveles * sizeof(int)); //indices de tabla de paginas
     }
-    
-    t_paquete* paquete = crear_paquete(CPU_M_ACCESO_TABLA_PAGINAS, buffer_peticion);
-    enviar_paquete(paquete, socket_memoria);
+    else {
+        cargar_int_al_constructor(paquete, pid);
+        cargar_int_al_constructor(paquete, nro_pagina);
 
-    if(recibir_operacion(socket_memoria) == M_CPU_RESPUESTA_DIRECCION_FISICA) {
-        t_buffer* buffer = recibir_buffer(socket_memoria);
-        marco = extraer_int_del_buffer(buffer);    
-        eliminar_buffer(buffer);
+        for(int j=0 ; j<cantidad_niveles ; j++){
+            cargar_int_al_constructor(paquete, vec[j]); //indices de tabla de paginas
+        }
+    }
+    return id_pedido;
+}
+
+/**
+* @fn     int recibir_marco_de_memoria(uint32_t id_pedido, t_log* cpu_logger)
+* @brief  Espera la respuesta a un pedido de pedir_marco_a_memoria().
+* @param  id_pedido Id del pedido.
+* @param  cpu_logger Logger para imprimir información.
+* @return Número de marco recibido o -1 en caso de error.
+*/
+int recibir_marco_de_memoria(uint32_t id_pedido, t_log* cpu_logger) {
+    int marco;
+    t_buffer buffer;
+    if(recibir_de_memoria(id_pedido, &buffer) == M_CPU_RESPUESTA_DIRECCION_FISICA) {
+        t_lector_buffer lector = crear_lector(&buffer);
+        if (mensajes_con_esquema) {
+            t_mensaje_respuesta_direccion_fisica respuesta;
+            desempaquetar_respuesta_direccion_fisica(&lector, &respuesta);
+            marco = respuesta.marco;
+        }
+        else {
+            marco = leer_int_del_buffer(&lector);
+        }
     } 
     else {
         log_debug(cpu_logger, "Memoria me contestó otra cosa");
@@ -263,8 +393,9 @@ int buscar_marco_en_memoria(int vec[], t_log* cpu_logger, int nro_pagina) { //MM
 */
 void inicializar_cache() {
     lista_cache = list_create();
-    for (int i = 0; i < entradas_cache(); i++) {
+    for (int i = 0; i < configuracion()->entradas_cache; i++) {
         t_entrada_cache* cache = malloc(sizeof(t_entrada_cache));
+        cache->pid = -1;
         cache->marco = -1;
         cache->numero_pagina = -1;
         cache->contenido = NULL;
@@ -282,48 +413,102 @@ void inicializar_cache() {
 * @return true si la caché está habilitada, false en caso contrario.
 */
 bool cache_habilitada() {
-    return (entradas_cache() > 0);
+    return (configuracion()->entradas_cache > 0);
 }
 
 /**
-* @fn     char* obtener_contenido_memoria(int marco, int nro_pagina, t_log* cpu_logger)
-* @brief  Solicita a memoria el contenido de una página. Envía una petición a memoria y retorna el contenido recibido como un puntero a char, o NULL en caso de error.
+* @fn     bool obtener_contenido_memoria(int marco, int nro_pagina, char* destino, t_log* cpu_logger)
+* @brief  Solicita a memoria el contenido de una página. Envía una petición al fragmento de memoria que guarda el marco y deja el contenido recibido en destino. Si en el handshake se acordó el codec de páginas, la página llega codificada (en cero, RLE o cruda) y se reconstruye acá.
 * @param  marco Número de marco.
 * @param  nro_pagina Número de página.
+* @param  destino Donde se deja la página, terminada en \0 (lugar para tam_pagina + 1).
 * @param  cpu_logger Logger para imprimir información.
-* @return Puntero al contenido recibido o NULL en caso de error.
+* @return true si memoria devolvió la página, false en caso de error.
 */
-char* obtener_contenido_memoria(int marco, int nro_pagina, t_log* cpu_logger) {
-    t_buffer* buffer_peticion = crear_buffer();
-    //TODO Verificar que a memoria le sirva el nro_pagina
-    cargar_int_al_buffer(buffer_peticion, nro_pagina); //no se si necesito pasar el nro_pagina xq quiza 
-    cargar_int_al_buffer(buffer_peticion, marco);
+bool obtener_contenido_memoria(int marco, int nro_pagina, char* destino, t_log* cpu_logger) {
+    uint32_t id_pedido = pedir_contenido_a_memoria(marco, nro_pagina);
+    return recibir_contenido_de_memoria(id_pedido, marco, nro_pagina, destino, cpu_logger);
+}
 
-    t_paquete* paquete = crear_paquete(CPU_M_SOLICITAR_PAGINA, buffer_peticion);
-    enviar_paquete(paquete, socket_memoria);
+/**
+* @fn     uint32_t pedir_contenido_a_memoria(int marco, int nro_pagina)
+* @brief  Envía al fragmento de memoria que guarda el marco el pedido del contenido de una página, sin esperar la respuesta.
+* @param  marco Número de marco global.
+* @param  nro_pagina Número de página.
+* @return Id con el que se espera la respuesta en recibir_contenido_de_memoria(), en la tabla del fragmento del marco.
+*/
+uint32_t pedir_contenido_a_memoria(int marco, int nro_pagina) {
+    t_fragmento_memoria* fragmento = fragmento_de_marco(marco);
+    marco -= fragmento->primer_marco; // el fragmento numera sus marcos desde 0
+    char almacenamiento[CAPACIDAD_CONSTRUCTOR_PILA];
+    t_constructor_paquete paquete;
+    uint32_t id_pedido = iniciar_pedido_a_fragmento(fragmento, &paquete, CPU_M_LEER_PAGINA_COMPLETA, almacenamiento, sizeof(almacenamiento));
+    if (mensajes_con_esquema) {
+        t_mensaje_leer_pagina_completa pedido = { .pagina = nro_pagina, .marco = marco };
+        empaquetar_leer_pagina_completa(&paquete, &pedido);
+    }
+    else {
+        //TODO Verificar que a memoria le sirva el nro_pagina
+        cargar_int_al_constructor(&paquete, nro_pagina); //no se si necesito pasar el nro_pagina xq quiza 
+        cargar_int_al_constructor(&paquete, marco);
+    }
+    enviar_a_fragmento(fragmento, &paquete);
+    return id_pedido;
+}
 
-    if (recibir_operacion(socket_memoria) == M_CPU_RECIBIR_CONTENIDO) {
-        t_buffer* buffer = recibir_buffer(socket_memoria);
-        int marco_recibido = extraer_int_del_buffer(buffer);
+/**
+* @fn     bool recibir_contenido_de_memoria(uint32_t id_pedido, int marco, int nro_pagina, char* destino, t_log* cpu_logger)
+* @brief  Espera la respuesta a un pedido de pedir_contenido_a_memoria() y deja la página en destino, reconstruyéndola si llegó codificada.
+* @param  id_pedido Id del pedido.
+* @param  marco Número de marco global que se pidió.
+* @param  nro_pagina Número de página.
+* @param  destino Donde se deja la página, terminada en \0 (lugar para tam_pagina + 1): el resto de la caché la imprime como string.
+* @param  cpu_logger Logger para imprimir información.
+* @return true si memoria devolvió la página, false en caso de error.
+*/
+bool recibir_contenido_de_memoria(uint32_t id_pedido, int marco, int nro_pagina, char* destino, t_log* cpu_logger) {
+    t_fragmento_memoria* fragmento = fragmento_de_marco(marco);
+    marco -= fragmento->primer_marco; // la respuesta trae el marco relativo
+    t_buffer buffer;
+    if (recibir_de_fragmento(fragmento, id_pedido, &buffer) == M_CPU_PAGINA_COMPLETA) {
+        t_lector_buffer lector = crear_lector(&buffer);
+        int marco_recibido;
+        if (mensajes_con_esquema) {
+            t_mensaje_pagina_completa respuesta;
+            desempaquetar_pagina_completa(&lector, &respuesta);
+            marco_recibido = respuesta.marco;
+        }
+        else {
+            marco_recibido = leer_int_del_buffer(&lector);
+        }
         if(marco_recibido != marco) {
             log_error(cpu_logger, "Error: El marco recibido no coincide con el solicitado");
-            eliminar_buffer(buffer); // Error al recibir el marco
+            return false;
         }
-        //TODO Verificar que el char* este bien por que puede romper aca
-        char* contenido = extraer_string_del_buffer(buffer); 
-        printf("Contenido de la página %d recibido desde memoria: %s\n", nro_pagina, contenido);
-        eliminar_buffer(buffer);
-        return contenido;
+        destino[tam_pagina] = '\0';
+        if (paginas_codificadas) {
+            int largo;
+            void* codificada = leer_contenido_del_buffer(&lector, &largo);
+            if (!decodificar_pagina(codificada, largo, destino, tam_pagina)) {
+                log_error(cpu_logger, "Error: la página %d llegó mal codificada", nro_pagina);
+                return false;
+            }
+        }
+        else {
+            strncpy(destino, leer_string_del_buffer(&lector), tam_pagina); //copia propia de la página entera: el buffer es del lector de memoria
+        }
+        cpu_log_debug(cpu_logger, "Contenido de la página %d recibido desde memoria: %s", nro_pagina, destino);
+        return true;
     } 
     else {
         log_error(cpu_logger, "Error al obtener la página desde memoria");
     }
-    return NULL; // Error al obtener la página
+    return false; // Error al obtener la página
 }
 
 /**
 * @fn     void cargar_contenido_cache(t_log* cpu_logger, int direccion_logica, int operacion, char* origen)
-* @brief  Carga el contenido de una página en la caché, leyendo o escribiendo según la operación. Si la página está en caché, la utiliza directamente; si no, la carga desde memoria y la almacena en la caché. Permite operaciones de lectura y escritura.
+* @brief  Carga el contenido de una página en la caché, leyendo o escribiendo según la operación. Si la página está en caché, la utiliza directamente; si no, la carga desde memoria (o toma la que se pidió de fondo al volver a despachar el proceso) y la almacena en la caché. Permite operaciones de lectura y escritura.
 * @param  cpu_logger Logger para imprimir información.
 * @param  direccion_logica Dirección lógica de la operación.
 * @param  operacion Tipo de operación (READ o WRITE).
@@ -332,51 +517,106 @@ char* obtener_contenido_memoria(int marco, int nro_pagina, t_log* cpu_logger) {
 */
 void cargar_contenido_cache(t_log* cpu_logger, int direccion_logica, int operacion, char* origen) { 
     int nro_pagina = direccion_logica / tam_pagina;
+    accesos_cache++; // el bucle de eventos aplica RETARDO_CACHE a la instruccion
     
     t_entrada_cache* entrada_cache = buscar_en_cache(nro_pagina);
+    anotar_cache_traza(entrada_cache != NULL);
     if (entrada_cache != NULL) { // HIT en cache
+        CONTAR(cache_hits);
         entrada_cache -> bit_uso = true; // Para CLOCK/CLOCK-M
-        log_info(cpu_logger,"Cache HIT: Leyendo contenido de la página %d desde la caché\n", nro_pagina);
+        cpu_log_info(cpu_logger,"Cache HIT: Leyendo contenido de la página %d desde la caché\n", nro_pagina);
         
     }
     else { //MISS CHACHE - no esta en la cahe, vamos a buscar la informacion en memmoria
+        CONTAR(cache_misses);
         int vec[cantidad_niveles]; //obtengo el vector de niveles para luego obtener el marco
-        for (int X = 1; X <= cantidad_niveles; X++) {
-            int divisor = (int)pow(entradas_tabla, cantidad_niveles - X); //indices de tabla de paginas
-            vec[X-1] = (nro_pagina / divisor) % entradas_tabla;
-        }     
-        entrada_cache -> marco = obtener_marco(nro_pagina, vec); //obtiene el marco, ya sea desde la tlb o desde memoria
-        entrada_cache -> numero_pagina = nro_pagina;
-        entrada_cache -> bit_uso = true;
-        entrada_cache -> presente = true;
-        entrada_cache -> contenido = obtener_contenido_memoria(entrada_cache->marco, nro_pagina, cpu_logger); // Asignar contenido de la pagina a la entrada de cache
-        //ver si es necesario un free de contenido (lo que devuelve la funcion)
-
+        calcular_indices_tabla(nro_pagina, vec);
+        int marco = obtener_marco(nro_pagina, vec); //obtiene el marco, ya sea desde la tlb o desde memoria
+        entrada_cache = crear_entrada_cache(nro_pagina, marco);
+        if (!tomar_contenido_calentado(nro_pagina, entrada_cache->contenido, cpu_logger)
+            && !obtener_contenido_memoria(marco, nro_pagina, entrada_cache->contenido, cpu_logger)) {
+            devolver_entrada_cache(entrada_cache);
+            return; // memoria no devolvió la página, ya se logueó el error
+        }
+        actualizar_entrada_cache(entrada_cache); // la entrada queda en la lista: se sigue usando abajo
     }
+    anotar_acceso_traza(direccion_logica, entrada_cache -> marco * tam_pagina + direccion_logica % tam_pagina);
     //Leer o escribir
     if (operacion == READ) {
-        log_debug(cpu_logger, "Contenido leido desde cache %s", entrada_cache -> contenido); // Imprimir el contenido de la página
+        cpu_log_debug(cpu_logger, "Contenido leido desde cache %s", entrada_cache -> contenido); // Imprimir el contenido de la página
     } 
     else if (operacion == WRITE) {
         entrada_cache -> bit_modificado = true;
         memcpy(entrada_cache -> contenido, origen , tam_pagina); 
-        log_debug(cpu_logger, "Contenido escrito en cache: %s \n", entrada_cache -> contenido);
+        cpu_log_debug(cpu_logger, "Contenido escrito en cache: %s \n", entrada_cache -> contenido);
         
     }
-    
-    actualizar_entrada_cache(entrada_cache);
+}
+
+/**
+* @fn     t_entrada_cache* crear_entrada_cache(int nro_pagina, int marco)
+* @brief  Arma una entrada de caché presente y sin modificar para una página del proceso actual. Reusa la última entrada que salió de la caché, con su lugar para el contenido: en régimen cada reemplazo devuelve una y cada miss toma una, sin pedir memoria.
+* @param  nro_pagina Número de página.
+* @param  marco Marco de la página.
+* @return Entrada armada, todavía fuera de la caché. Su contenido (tam_pagina + 1 bytes) lo completa el que la pidió; si no la usa, la devuelve con devolver_entrada_cache().
+*/
+t_entrada_cache* crear_entrada_cache(int nro_pagina, int marco) {
+    t_entrada_cache* entrada = entrada_cache_libre;
+    entrada_cache_libre = NULL;
+    if (entrada == NULL) {
+        entrada = malloc(sizeof(t_entrada_cache));
+        entrada->contenido = NULL;
+    }
+    if (entrada->contenido == NULL) {
+        entrada->contenido = malloc(tam_pagina + 1);
+    }
+    entrada->pid = pid;
+    entrada->numero_pagina = nro_pagina;
+    entrada->marco = marco;
+    entrada->bit_uso = true;
+    entrada->bit_modificado = false;
+    entrada->presente = true;
+    return entrada;
+}
+
+/**
+* @fn     void devolver_entrada_cache(t_entrada_cache* entrada)
+* @brief  Recibe una entrada que sale de la caché (o que no se llegó a usar) y la guarda para el próximo crear_entrada_cache(). Si ya hay una guardada, la libera.
+* @param  entrada Entrada que sale de la caché.
+* @return Ninguno
+*/
+void devolver_entrada_cache(t_entrada_cache* entrada) {
+    if (entrada_cache_libre != NULL) {
+        destruir_entrada_cache(entrada);
+        return;
+    }
+    entrada_cache_libre = entrada;
+}
+
+/**
+* @fn     void destruir_entrada_cache(t_entrada_cache* entrada)
+* @brief  Libera una entrada de caché y su contenido. Acepta NULL.
+* @param  entrada Entrada a liberar.
+* @return Ninguno
+*/
+void destruir_entrada_cache(t_entrada_cache* entrada) {
+    if (entrada == NULL) {
+        return;
+    }
+    free(entrada->contenido);
+    free(entrada);
 }
 
 /**
 * @fn     t_entrada_cache* buscar_en_cache(int nro_pagina)
-* @brief  Busca una entrada en la caché por número de página. Recorre la lista de entradas y retorna un puntero a la entrada si la encuentra y está presente, o NULL si no existe.
+* @brief  Busca una entrada en la caché por número de página del proceso actual. Recorre la lista de entradas y retorna un puntero a la entrada si la encuentra y está presente, o NULL si no existe.
 * @param  nro_pagina Número de página a buscar en la caché.
 * @return Puntero a la entrada encontrada o NULL si no existe.
 */
 t_entrada_cache* buscar_en_cache(int nro_pagina) {
     for (int i = 0; i < list_size(lista_cache); i++) {
         t_entrada_cache* entrada = list_get(lista_cache, i);
-        if (entrada->presente && entrada->numero_pagina == nro_pagina) {
+        if (entrada->presente && entrada->pid == pid && entrada->numero_pagina == nro_pagina) {
             return entrada;
         }
     }
@@ -393,15 +633,16 @@ void actualizar_entrada_cache(t_entrada_cache* entrada_cache_aux){
 
     int indice_reemplazo_cache = encontrar_vacio(); // quizas no es necesario, probar de sacarlo, los algoritmos de clock y clock-m por como esta inicializada la lista funcionarian sin esto
     if(indice_reemplazo_cache == ESTA_LLENA){ //Siendo -1 que no hay lugares vacios
-        if(strcmp(reemplazo_cache(), "CLOCK") == 0){ // aca los llamamos SOLO si la lista esta llena 
+        CONTAR(cache_reemplazos);
+        if(configuracion()->reemplazo_cache == CACHE_CLOCK){ // aca los llamamos SOLO si la lista esta llena 
             reemplazar_cache_CLOCK(entrada_cache_aux);
         }
-        else if(strcmp(reemplazo_cache(), "CLOCK-M") == 0){
+        else if(configuracion()->reemplazo_cache == CACHE_CLOCK_M){
             reemplazar_cache_CLOCK_M(entrada_cache_aux);
         }
     }
     else{ // Hay lugares vacios 
-        list_replace_and_destroy_element(lista_cache, indice_reemplazo_cache, entrada_cache_aux, (void*)free);
+        list_replace_and_destroy_element(lista_cache, indice_reemplazo_cache, entrada_cache_aux, (void*)devolver_entrada_cache);
     }
 }
 
@@ -424,7 +665,7 @@ int encontrar_vacio(void){
 }
 
 //Algoritmos de reemplazo de cache
-int clock_pointer = 0;  // Para algoritmo CLOCK
+__thread int clock_pointer = 0;  // Para algoritmo CLOCK, uno por CPU virtual
 
 /**
 * @fn     void avanzar_puntero(void)
@@ -433,7 +674,85 @@ int clock_pointer = 0;  // Para algoritmo CLOCK
 * @return Ninguno
 */
 void avanzar_puntero() {
-    clock_pointer = (clock_pointer + 1) % entradas_cache();
+    clock_pointer = (clock_pointer + 1) % configuracion()->entradas_cache;
+}
+
+/**
+* @fn     void escribir_pagina_en_memoria(t_entrada_cache* entrada)
+* @brief  Escribe en el fragmento de memoria de su marco el contenido de una entrada modificada de la caché que va a ser reemplazada. Con pedidos multiplexados no espera la confirmación: la CPU sigue mientras la escritura viaja y la respuesta se descarta al llegar.
+* @param  entrada Entrada de caché a escribir.
+* @return Ninguno
+*/
+void escribir_pagina_en_memoria(t_entrada_cache* entrada) {
+    t_fragmento_memoria* fragmento = fragmento_de_marco(entrada->marco);
+    char almacenamiento[CAPACIDAD_CONSTRUCTOR_PILA];
+    t_constructor_paquete paquete;
+    uint32_t id_pedido = armar_escritura_de_pagina(&paquete, entrada, almacenamiento, sizeof(almacenamiento));
+    enviar_a_fragmento(fragmento, &paquete);
+
+    descartar_respuesta_de_fragmento(fragmento, id_pedido);
+}
+
+/**
+* @fn     uint32_t armar_escritura_de_pagina(t_constructor_paquete* paquete, t_entrada_cache* entrada, void* almacenamiento, int capacidad)
+* @brief  Arma, sin enviarlo, el pedido que escribe una entrada modificada de la caché en el fragmento de memoria de su marco. Va como CPU_M_ESCRIBIR_PAGINA_MODIFICADA, con la página y el marco, para que memoria no la confunda con los segmentos de un WRITE (CPU_M_ESCRIBIR_MEMORIA). Con el codec de páginas acordado, la página viaja codificada.
+* @param  paquete Constructor a inicializar.
+* @param  entrada Entrada de caché a escribir.
+* @param  almacenamiento Almacenamiento inicial del constructor, o NULL para tomarlo del pool.
+* @param  capacidad Tamaño de almacenamiento en bytes.
+* @return Id del pedido en la tabla del fragmento.
+*/
+uint32_t armar_escritura_de_pagina(t_constructor_paquete* paquete, t_entrada_cache* entrada, void* almacenamiento, int capacidad) {
+    t_fragmento_memoria* fragmento = fragmento_de_marco(entrada->marco);
+    uint32_t id_pedido = iniciar_pedido_a_fragmento(fragmento, paquete, CPU_M_ESCRIBIR_PAGINA_MODIFICADA, almacenamiento, capacidad);
+    if (mensajes_con_esquema) {
+        t_mensaje_escribir_pagina_modificada pedido = { .pagina = entrada->numero_pagina, .marco = entrada->marco - fragmento->primer_marco };
+        empaquetar_escribir_pagina_modificada(paquete, &pedido);
+    }
+    else {
+        cargar_int_al_constructor(paquete, entrada->numero_pagina); // numero de pagina
+        cargar_int_al_constructor(paquete, entrada->marco - fragmento->primer_marco); // marco relativo al fragmento
+    }
+    if (paginas_codificadas) {
+        char* codificada = reservar_del_pool(TAMANIO_MAXIMO_CODIFICADA(tam_pagina), NULL);
+        int largo = codificar_pagina(entrada->contenido, tam_pagina, codificada);
+        agregar_al_constructor(paquete, codificada, largo); // contenido a escribir, codificado
+        devolver_al_pool(codificada);
+    }
+    else {
+        cargar_string_al_constructor(paquete, entrada->contenido); // contenido a escribir
+    }
+    return id_pedido;
+}
+
+/**
+* @fn     void escribir_paginas_modificadas_del_proceso(void)
+* @brief  Escribe en memoria todas las páginas modificadas que el proceso actual tiene en la caché. Los pedidos de cada fragmento salen juntos en un mismo envío y después se descartan las respuestas.
+* @param  Ninguno
+* @return Ninguno
+*/
+void escribir_paginas_modificadas_del_proceso(void) {
+    int entradas = list_size(lista_cache);
+    t_constructor_paquete paquetes[entradas];
+    uint32_t ids[entradas];
+    for (int f = 0; f < cantidad_fragmentos; f++) {
+        t_fragmento_memoria* fragmento = &fragmentos_memoria[f];
+        int cantidad = 0;
+        for (int i = 0; i < entradas; i++) {
+            t_entrada_cache* entrada = list_get(lista_cache, i);
+            if (entrada->pid == pid && entrada->presente && entrada->bit_modificado && fragmento_de_marco(entrada->marco) == fragmento) {
+                ids[cantidad] = armar_escritura_de_pagina(&paquetes[cantidad], entrada, NULL, 0);
+                cantidad++;
+            }
+        }
+        if (cantidad == 0) {
+            continue;
+        }
+        enviar_lote_a_fragmento(fragmento, paquetes, cantidad);
+        for (int i = 0; i < cantidad; i++) {
+            descartar_respuesta_de_fragmento(fragmento, ids[i]);
+        }
+    }
 }
 
 /**
@@ -448,15 +767,11 @@ void reemplazar_cache_CLOCK(t_entrada_cache* nueva_entrada) {
 
         if (!actual->bit_uso) {
              if (actual->bit_modificado) {
-                //TODO: mandar a memoria
-                t_buffer* buffer_escritura = crear_buffer();
-                cargar_int_al_buffer(buffer_escritura, actual->numero_pagina); // numero de pagina
-                cargar_string_al_buffer(buffer_escritura, actual->contenido); // contenido a escribir
-                t_paquete* paquete = crear_paquete(CPU_M_ESCRIBIR_MEMORIA, buffer_escritura);
-                enviar_paquete(paquete, socket_memoria);
+                CONTAR(cache_reemplazos_modificadas);
+                escribir_pagina_en_memoria(actual);
             }
 
-            list_replace_and_destroy_element(lista_cache, clock_pointer, nueva_entrada, (void*)free);
+            list_replace_and_destroy_element(lista_cache, clock_pointer, nueva_entrada, (void*)devolver_entrada_cache);
             avanzar_puntero();  // Mover a la próxima posición
             break;
         } 
@@ -474,7 +789,7 @@ void reemplazar_cache_CLOCK(t_entrada_cache* nueva_entrada) {
 * @return Ninguno
 */
 void reemplazar_cache_CLOCK_M(t_entrada_cache* nueva_entrada) {
-    int entradas = entradas_cache();
+    int entradas = configuracion()->entradas_cache;
     bool reemplazo_realizado = false;
 
     while (!reemplazo_realizado) {
@@ -483,7 +798,7 @@ void reemplazar_cache_CLOCK_M(t_entrada_cache* nueva_entrada) {
             t_entrada_cache* actual = list_get(lista_cache, clock_pointer);
 
             if (!actual->bit_uso && !actual->bit_modificado) {
-                list_replace_and_destroy_element(lista_cache, clock_pointer, nueva_entrada, (void*)free);
+                list_replace_and_destroy_element(lista_cache, clock_pointer, nueva_entrada, (void*)devolver_entrada_cache);
                 avanzar_puntero();
                 reemplazo_realizado = true;
                 return;
@@ -498,13 +813,10 @@ void reemplazar_cache_CLOCK_M(t_entrada_cache* nueva_entrada) {
 
             if (!actual->bit_uso && actual->bit_modificado) {
                 //escribir en memroia el contenido de la pagina
-                t_buffer* buffer_escritura = crear_buffer();
-                cargar_int_al_buffer(buffer_escritura, actual->numero_pagina); // numero de pagina
-                cargar_string_al_buffer(buffer_escritura, actual->contenido); // contenido a escribir
-                t_paquete* paquete = crear_paquete(CPU_M_ESCRIBIR_MEMORIA, buffer_escritura);
-                enviar_paquete(paquete, socket_memoria);
+                CONTAR(cache_reemplazos_modificadas);
+                escribir_pagina_en_memoria(actual);
 
-                list_replace_and_destroy_element(lista_cache, clock_pointer, nueva_entrada, (void*)free);
+                list_replace_and_destroy_element(lista_cache, clock_pointer, nueva_entrada, (void*)devolver_entrada_cache);
                 avanzar_puntero();
                 reemplazo_realizado = true;
                 return;
@@ -516,7 +828,38 @@ void reemplazar_cache_CLOCK_M(t_entrada_cache* nueva_entrada) {
     }
 }
 
+//------------------ CAMBIO DE PROCESO ------------------
 
+/**
+* @fn     void liberar_tlb_y_cache_del_proceso(void)
+* @brief  Libera las entradas de la TLB y de la caché del proceso actual cuando deja la CPU. Las páginas modificadas se escriben antes en memoria: el proceso puede volver en otra CPU, y mientras está suspendido memoria puede moverlo a otros marcos. Las entradas de los demás procesos (otros hilos de hardware) quedan.
+* @param  Ninguno
+* @return Ninguno
+*/
+void liberar_tlb_y_cache_del_proceso(void) {
+    for (int i = 0; i < list_size(lista_tlb); i++) {
+        t_entrada_TLB* entrada_tlb = list_get(lista_tlb, i);
+        if (entrada_tlb->pid == pid) {
+            entrada_tlb->pid = -1;
+            entrada_tlb->numero_pagina = -1;
+            entrada_tlb->marco = -1;
+        }
+    }
 
-
-
+    if (!cache_habilitada()) {
+        return;
+    }
+    escribir_paginas_modificadas_del_proceso();
+    for (int i = 0; i < list_size(lista_cache); i++) {
+        t_entrada_cache* entrada = list_get(lista_cache, i);
+        if (entrada->pid != pid) {
+            continue;
+        }
+        entrada->pid = -1; //el contenido queda reservado para la próxima página
+        entrada->numero_pagina = -1;
+        entrada->marco = -1;
+        entrada->bit_uso = false;
+        entrada->bit_modificado = false;
+        entrada->presente = false;
+    }
+}
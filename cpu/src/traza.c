@@ -0,0 +1,134 @@
+#include "cpu.h"
+#include <fcntl.h>
+#include <unistd.h>
+#include <time.h>
+
+/**
+* @fn     void abrir_traza(char* archivo)
+* @brief  Crea (o vacía) el archivo de traza binaria y le escribe la cabecera. A partir de acá registrar_traza() guarda un registro por instrucción ejecutada.
+* @param  archivo Ruta del archivo de traza.
+* @return Ninguno
+*/
+void abrir_traza(char* archivo) {
+    traza.archivo = open(archivo, O_WRONLY | O_CREAT | O_TRUNC | O_CLOEXEC, 0644);
+    if (traza.archivo == -1) {
+        perror("No se pudo abrir el archivo de traza");
+        exit(EXIT_FAILURE);
+    }
+
+    t_cabecera_traza cabecera = { .version = VERSION_TRAZA, .tamanio_registro = sizeof(t_registro_traza) };
+    memcpy(cabecera.magia, MAGIA_TRAZA, sizeof(cabecera.magia));
+    if (write(traza.archivo, &cabecera, sizeof(cabecera)) != sizeof(cabecera)) {
+        perror("No se pudo escribir la cabecera de la traza");
+        exit(EXIT_FAILURE);
+    }
+}
+
+/**
+* @fn     void iniciar_registro_traza(int operacion)
+* @brief  Empieza el registro de la instrucción que se va a ejecutar, con el PID y el PC actuales y sin accesos a memoria.
+* @param  operacion Operación de la instrucción (t_operacion).
+* @return Ninguno
+*/
+void iniciar_registro_traza(int operacion) {
+    registro_traza = (t_registro_traza) {
+        .pid = pid,
+        .pc = pc,
+        .operacion = operacion,
+        .direccion_logica = -1,
+        .direccion_fisica = -1,
+        .tlb = TRAZA_SIN_ACCESO,
+        .cache = TRAZA_SIN_ACCESO
+    };
+}
+
+/**
+* @fn     void anotar_acceso_traza(int direccion_logica, int direccion_fisica)
+* @brief  Anota en el registro de la instrucción actual las direcciones del acceso a memoria ya traducido.
+* @param  direccion_logica Dirección lógica del primer byte accedido.
+* @param  direccion_fisica Dirección física del primer byte accedido.
+* @return Ninguno
+*/
+void anotar_acceso_traza(int direccion_logica, int direccion_fisica) {
+    registro_traza.direccion_logica = direccion_logica;
+    registro_traza.direccion_fisica = direccion_fisica;
+}
+
+/**
+* @fn     void anotar_tlb_traza(bool hit)
+* @brief  Anota el resultado de una búsqueda en la TLB. Si la instrucción traduce varias páginas, con un miss alcanza para que quede como miss.
+* @param  hit true si la página estaba en la TLB.
+* @return Ninguno
+*/
+void anotar_tlb_traza(bool hit) {
+    if (registro_traza.tlb != TRAZA_MISS) {
+        registro_traza.tlb = hit ? TRAZA_HIT : TRAZA_MISS;
+    }
+}
+
+/**
+* @fn     void anotar_cache_traza(bool hit)
+* @brief  Anota el resultado de una búsqueda en la caché de páginas.
+* @param  hit true si la página estaba en la caché.
+* @return Ninguno
+*/
+void anotar_cache_traza(bool hit) {
+    if (registro_traza.cache != TRAZA_MISS) {
+        registro_traza.cache = hit ? TRAZA_HIT : TRAZA_MISS;
+    }
+}
+
+/**
+* @fn     void escribir_tanda_traza(void)
+* @brief  Escribe en el archivo los registros acumulados. Se llama con el mutex de la traza tomado.
+* @param  Ninguno
+* @return Ninguno
+*/
+void escribir_tanda_traza(void) {
+    size_t bytes = traza.registros_en_tanda * sizeof(t_registro_traza);
+    if (traza.registros_en_tanda > 0 && write(traza.archivo, traza.tanda, bytes) != (ssize_t)bytes) {
+        perror("No se pudo escribir la traza");
+    }
+    traza.registros_en_tanda = 0;
+}
+
+/**
+* @fn     void registrar_traza(void)
+* @brief  Cierra el registro de la instrucción actual y lo agrega a la tanda; la tanda va al archivo cuando se llena. Sin TRAZA_BINARIA no hace nada.
+* @param  Ninguno
+* @return Ninguno
+*/
+void registrar_traza(void) {
+    if (traza.archivo == -1) {
+        return;
+    }
+
+    struct timespec ahora;
+    clock_gettime(CLOCK_MONOTONIC, &ahora);
+    registro_traza.tiempo_ns = (uint64_t)ahora.tv_sec * 1000000000ULL + ahora.tv_nsec;
+
+    pthread_mutex_lock(&traza.mutex);
+    traza.tanda[traza.registros_en_tanda++] = registro_traza;
+    if (traza.registros_en_tanda == REGISTROS_POR_TANDA_TRAZA) {
+        escribir_tanda_traza();
+    }
+    pthread_mutex_unlock(&traza.mutex);
+}
+
+/**
+* @fn     void cerrar_traza(void)
+* @brief  Escribe los registros que quedaron en la tanda y cierra el archivo de traza.
+* @param  Ninguno
+* @return Ninguno
+*/
+void cerrar_traza(void) {
+    if (traza.archivo == -1) {
+        return;
+    }
+
+    pthread_mutex_lock(&traza.mutex);
+    escribir_tanda_traza();
+    close(traza.archivo);
+    traza.archivo = -1;
+    pthread_mutex_unlock(&traza.mutex);
+}
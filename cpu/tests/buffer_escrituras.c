@@ -0,0 +1,98 @@
+#include <cspecs/cspec.h>
+#include "memoria_prueba.h"
+
+/* BUFFER DE ESCRITURAS */
+// Los WRITE que se retiran en el buffer tienen que dejar en memoria los mismos bytes que sin buffer, con el \0
+// al final, y los READ tienen que ver los que todavía no llegaron.
+
+/**
+* @fn     void levantar_buffer_de_prueba(bool en_lote)
+* @brief  Levanta la CPU de prueba sin caché y con buffer de escrituras, sobre una memoria llena de 'x' para que se vean los \0.
+* @param  en_lote true para mandar varios segmentos por pedido (accesos vectorizados).
+* @return Ninguno
+*/
+void levantar_buffer_de_prueba(bool en_lote) {
+    levantar_cpu_de_prueba(0);
+    memset(memoria_prueba, 'x', sizeof(memoria_prueba));
+    accesos_en_lote = en_lote;
+    escrituras_pendientes = crear_buffer_escrituras();
+}
+
+/**
+* @fn     bool escribir_secuencia_de_prueba(void)
+* @brief  Escribe solapando, cruzando una página y terminando justo al final de otra, y vacía el buffer con la barrera.
+* @param  Ninguno
+* @return Resultado de la barrera.
+*/
+bool escribir_secuencia_de_prueba(void) {
+    escribir_en_memoria(10, "hola", cpu_logger);
+    escribir_en_memoria(12, "ab", cpu_logger);   // pisa "la\0" con "ab\0"
+    escribir_en_memoria(62, "mundo", cpu_logger); // "mu" en la página 0, "ndo\0" en la 1
+    escribir_en_memoria(125, "fin", cpu_logger);  // el \0 cae en el primer byte de la página 2, como sin buffer
+    return barrera_escrituras();
+}
+
+context (buffer_escrituras) {
+
+    describe ("Contenido que llega a memoria") {
+
+        it ("deja cada WRITE con su \\0, un segmento por pedido") {
+            levantar_buffer_de_prueba(false);
+            bool ok = escribir_secuencia_de_prueba();
+            int pendientes = escrituras_pendientes->cantidad;
+            bajar_cpu_de_prueba();
+            should_bool(ok) be equal to(true);
+            should_int(pendientes) be equal to(0);
+            should_string(memoria_prueba + 10) be equal to("hoab");
+            should_string(memoria_prueba + 62) be equal to("mundo");
+            should_string(memoria_prueba + 125) be equal to("fin");
+            should_int(memoria_prueba[9]) be equal to('x');
+            should_int(memoria_prueba[15]) be equal to('x');
+        } end
+
+        it ("deja cada WRITE con su \\0, con accesos vectorizados") {
+            levantar_buffer_de_prueba(true);
+            bool ok = escribir_secuencia_de_prueba();
+            bajar_cpu_de_prueba();
+            should_bool(ok) be equal to(true);
+            should_string(memoria_prueba + 10) be equal to("hoab");
+            should_string(memoria_prueba + 62) be equal to("mundo");
+            should_string(memoria_prueba + 125) be equal to("fin");
+        } end
+
+        it ("junta los WRITE contiguos del mismo marco en una escritura") {
+            levantar_buffer_de_prueba(false);
+            escribir_en_memoria(0, "ab", cpu_logger);
+            escribir_en_memoria(2, "cd", cpu_logger);
+            int escrituras = escrituras_pendientes->cantidad;
+            barrera_escrituras();
+            bajar_cpu_de_prueba();
+            should_int(escrituras) be equal to(1);
+            should_string(memoria_prueba) be equal to("abcd");
+        } end
+
+        it ("un READ ve los WRITE que siguen en el buffer") {
+            levantar_buffer_de_prueba(false);
+            escribir_en_memoria(60, "abcdef", cpu_logger);
+            char leido[7];
+            bool ok = leer_de_memoria(61, 6, leido, cpu_logger);
+            char en_memoria = memoria_prueba[61];
+            barrera_escrituras();
+            bajar_cpu_de_prueba();
+            should_bool(ok) be equal to(true);
+            should_int(en_memoria) be equal to('x');
+            should_string(leido) be equal to("bcdef");
+        } end
+
+        it ("la barrera avisa si memoria no confirma una escritura") {
+            levantar_buffer_de_prueba(false);
+            marco_rechazado_prueba = 1;
+            bool ok = escribir_secuencia_de_prueba();
+            bajar_cpu_de_prueba();
+            should_bool(ok) be equal to(false);
+            should_string(memoria_prueba + 10) be equal to("hoab");
+        } end
+
+    } end
+
+}
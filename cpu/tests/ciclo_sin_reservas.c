@@ -0,0 +1,96 @@
+#include <cspecs/cspec.h>
+#include "memoria_prueba.h"
+
+/* CICLO DE INSTRUCCIONES SIN RESERVAS */
+// Corre el ciclo de instrucción contra la memoria de prueba y cuenta las llamadas a malloc, calloc y realloc
+// que hace el hilo de la CPU. Las primeras vueltas llenan el pool, el decodificador y la entrada de caché
+// libre; después un ciclo no tiene que pedir memoria.
+#define VUELTAS_CALENTAMIENTO 50
+#define VUELTAS_MEDIDAS 200
+
+void* __libc_malloc(size_t tamanio);
+void* __libc_calloc(size_t cantidad, size_t tamanio);
+void* __libc_realloc(void* puntero, size_t tamanio);
+
+__thread bool contando_reservas = false;
+__thread int reservas_contadas = 0;
+
+void* malloc(size_t tamanio) {
+    if (contando_reservas) {
+        reservas_contadas++;
+    }
+    return __libc_malloc(tamanio);
+}
+
+void* calloc(size_t cantidad, size_t tamanio) {
+    if (contando_reservas) {
+        reservas_contadas++;
+    }
+    return __libc_calloc(cantidad, tamanio);
+}
+
+void* realloc(void* puntero, size_t tamanio) {
+    if (contando_reservas) {
+        reservas_contadas++;
+    }
+    return __libc_realloc(puntero, tamanio);
+}
+
+// Cruza páginas, reemplaza en la TLB (dos entradas para cuatro páginas) y, con caché, reemplaza páginas modificadas
+t_instruccion_prueba programa_sin_reservas[] = {
+    { WRITE, { "60", "holamundo" } },
+    { READ, { "60", "9" } },
+    { WRITE, { "130", "chau" } },
+    { READ, { "200", "4" } },
+    { NOOP, { NULL, NULL } },
+    { GOTO, { "0", NULL } }
+};
+
+/**
+* @fn     int reservas_de_ciclos(int vueltas)
+* @brief  Ejecuta ciclos de instrucción completos, como fetch(), contando las llamadas a malloc, calloc y realloc del hilo y los bloques que el pool pidió al sistema.
+* @param  vueltas Cantidad de ciclos a ejecutar.
+* @return Reservas hechas durante los ciclos.
+*/
+int reservas_de_ciclos(int vueltas) {
+    int reservas_pool = 0;
+    reservas_contadas = 0;
+    contando_reservas = true;
+    for (int i = 0; i < vueltas; i++) {
+        uint64_t reservas_antes = contadores_pool_del_hilo().reservas_sistema;
+        pedir_instruccion(cpu_logger);
+        ejecutar_instruccion_pedida(cpu_logger);
+        reservas_pool += controlar_reservas_del_ciclo(reservas_antes, cpu_logger);
+    }
+    contando_reservas = false;
+    return reservas_contadas + reservas_pool;
+}
+
+context (ciclo_sin_reservas) {
+
+    describe ("Ciclo de instruccion en regimen") {
+
+        it ("sin cache no reserva memoria despues del calentamiento") {
+            levantar_cpu_de_prueba(0);
+            programa_prueba = programa_sin_reservas;
+            instrucciones_prueba = 6;
+            reservas_de_ciclos(VUELTAS_CALENTAMIENTO);
+            int reservas = reservas_de_ciclos(VUELTAS_MEDIDAS);
+            should_string(memoria_prueba + 60) be equal to("holamundo");
+            bajar_cpu_de_prueba();
+            should_int(reservas) be equal to(0);
+        } end
+
+        it ("con cache y reemplazos no reserva memoria despues del calentamiento") {
+            levantar_cpu_de_prueba(2);
+            programa_prueba = programa_sin_reservas;
+            instrucciones_prueba = 6;
+            reservas_de_ciclos(VUELTAS_CALENTAMIENTO);
+            int reservas = reservas_de_ciclos(VUELTAS_MEDIDAS);
+            bajar_cpu_de_prueba();
+            should_int(reservas) be equal to(0);
+        } end
+
+    } end
+
+}
@@ -0,0 +1,96 @@
+#include <cspecs/cspec.h>
+#include <utils/codec_paginas.h>
+#include <string.h>
+
+/* CODEC DE PÁGINAS */
+// Toda página codificada tiene que volver igual al decodificarla y no pasarse de TAMANIO_MAXIMO_CODIFICADA.
+// El tamaño no es múltiplo de 128 para pasar también por la cola de pagina_en_cero().
+#define TAM_PAGINA_CODEC 200
+
+char pagina_codec[TAM_PAGINA_CODEC];
+char codificada_codec[TAMANIO_MAXIMO_CODIFICADA(TAM_PAGINA_CODEC)];
+char decodificada_codec[TAM_PAGINA_CODEC];
+
+/**
+* @fn     int ida_y_vuelta(void)
+* @brief  Codifica pagina_codec y la decodifica en decodificada_codec (llena antes de basura, para que se note lo que no escribe).
+* @param  Ninguno
+* @return Largo de la página codificada, -1 si no se pudo decodificar o no volvió igual.
+*/
+int ida_y_vuelta(void) {
+    int largo = codificar_pagina(pagina_codec, TAM_PAGINA_CODEC, codificada_codec);
+    memset(decodificada_codec, 0x5a, TAM_PAGINA_CODEC);
+    if (!decodificar_pagina(codificada_codec, largo, decodificada_codec, TAM_PAGINA_CODEC)) {
+        return -1;
+    }
+    return memcmp(pagina_codec, decodificada_codec, TAM_PAGINA_CODEC) == 0 ? largo : -1;
+}
+
+context (codec_paginas) {
+
+    describe ("Ida y vuelta") {
+
+        it ("una página en cero viaja en un byte") {
+            memset(pagina_codec, 0, TAM_PAGINA_CODEC);
+            int largo = ida_y_vuelta();
+            should_int(largo) be equal to(1);
+            should_int(codificada_codec[0]) be equal to(PAGINA_EN_CERO);
+        } end
+
+        it ("un string corto con el resto en cero se achica con RLE") {
+            memset(pagina_codec, 0, TAM_PAGINA_CODEC);
+            strcpy(pagina_codec + 10, "holamundo");
+            int largo = ida_y_vuelta();
+            should_int(codificada_codec[0]) be equal to(PAGINA_RLE);
+            should_bool(largo > 0 && largo < TAM_PAGINA_CODEC / 4) be equal to(true);
+        } end
+
+        it ("un byte distinto de cero al final no se pierde") {
+            memset(pagina_codec, 0, TAM_PAGINA_CODEC);
+            pagina_codec[TAM_PAGINA_CODEC - 1] = 'z';
+            should_bool(ida_y_vuelta() > 1) be equal to(true);
+        } end
+
+        it ("una página sin repeticiones va cruda y no se pasa del máximo") {
+            for (int i = 0; i < TAM_PAGINA_CODEC; i++) {
+                pagina_codec[i] = (char)(i * 7 + 1);
+            }
+            int largo = ida_y_vuelta();
+            should_int(largo) be equal to(TAMANIO_MAXIMO_CODIFICADA(TAM_PAGINA_CODEC));
+            should_int(codificada_codec[0]) be equal to(PAGINA_CRUDA);
+        } end
+
+        it ("tramos repetidos y literales mezclados vuelven iguales") {
+            for (int i = 0; i < TAM_PAGINA_CODEC; i++) {
+                pagina_codec[i] = (i / 16) % 2 == 0 ? 'a' : (char)('0' + i % 10);
+            }
+            should_bool(ida_y_vuelta() > 0) be equal to(true);
+        } end
+
+    } end
+
+    describe ("Codificaciones inválidas") {
+
+        it ("rechaza una codificación cortada") {
+            memset(pagina_codec, 0, TAM_PAGINA_CODEC);
+            strcpy(pagina_codec, "holamundo");
+            int largo = codificar_pagina(pagina_codec, TAM_PAGINA_CODEC, codificada_codec);
+            should_bool(decodificar_pagina(codificada_codec, largo - 1, decodificada_codec, TAM_PAGINA_CODEC)) be equal to(false);
+        } end
+
+        it ("rechaza una página cruda de otro tamaño") {
+            for (int i = 0; i < TAM_PAGINA_CODEC; i++) {
+                pagina_codec[i] = (char)(i * 7 + 1);
+            }
+            int largo = codificar_pagina(pagina_codec, TAM_PAGINA_CODEC, codificada_codec);
+            should_bool(decodificar_pagina(codificada_codec, largo, decodificada_codec, TAM_PAGINA_CODEC - 1)) be equal to(false);
+        } end
+
+        it ("rechaza un formato desconocido") {
+            codificada_codec[0] = PAGINA_CRUDA + 1;
+            should_bool(decodificar_pagina(codificada_codec, 1, decodificada_codec, TAM_PAGINA_CODEC)) be equal to(false);
+        } end
+
+    } end
+
+}
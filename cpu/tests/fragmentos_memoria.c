@@ -0,0 +1,127 @@
+#include <cspecs/cspec.h>
+#include "../include/cpu.h"
+
+/* FRAGMENTOS DE MEMORIA */
+// Ruteo de los pedidos entre fragmentos: los procesos se reparten con fragmento_de_pid() y los marcos van
+// al fragmento que los declaró en su handshake (fragmento_de_marco()).
+#define PIDS_PRUEBA 4000
+#define MAXIMO_FRAGMENTOS_PRUEBA 8
+#define MARCOS_POR_FRAGMENTO 64
+
+t_fragmento_memoria fragmentos_prueba[MAXIMO_FRAGMENTOS_PRUEBA];
+
+/**
+* @fn     void armar_fragmentos_de_prueba(int cantidad)
+* @brief  Deja cantidad fragmentos de MARCOS_POR_FRAGMENTO marcos cada uno, contiguos desde el marco 0, sin conexión.
+* @param  cantidad Cantidad de fragmentos.
+* @return Ninguno
+*/
+void armar_fragmentos_de_prueba(int cantidad) {
+    memset(fragmentos_prueba, 0, sizeof(fragmentos_prueba));
+    for (int i = 0; i < cantidad; i++) {
+        fragmentos_prueba[i].socket = -1;
+        fragmentos_prueba[i].primer_marco = i * MARCOS_POR_FRAGMENTO;
+        fragmentos_prueba[i].cantidad_marcos = MARCOS_POR_FRAGMENTO;
+    }
+    fragmentos_memoria = fragmentos_prueba;
+    cantidad_fragmentos = cantidad;
+}
+
+/**
+* @fn     int indice_de_marco(int marco)
+* @brief  Índice en fragmentos_memoria del fragmento que elige fragmento_de_marco().
+* @param  marco Número de marco global.
+* @return Índice del fragmento.
+*/
+int indice_de_marco(int marco) {
+    return (int)(fragmento_de_marco(marco) - fragmentos_memoria);
+}
+
+context (ruteo_fragmentos) {
+
+    describe ("Procesos por fragmento") {
+
+        it ("con un solo fragmento todos los procesos van al 0") {
+            armar_fragmentos_de_prueba(1);
+            int fuera = 0;
+            for (int pid_prueba = 0; pid_prueba < PIDS_PRUEBA; pid_prueba++) {
+                fuera += fragmento_de_pid(pid_prueba) != 0;
+            }
+            should_int(fuera) be equal to(0);
+        } end
+
+        it ("siempre elige un fragmento que existe") {
+            int fuera = 0;
+            for (int n = 1; n <= MAXIMO_FRAGMENTOS_PRUEBA; n++) {
+                armar_fragmentos_de_prueba(n);
+                for (int pid_prueba = 0; pid_prueba < PIDS_PRUEBA; pid_prueba++) {
+                    int elegido = fragmento_de_pid(pid_prueba);
+                    fuera += elegido < 0 || elegido >= n;
+                }
+            }
+            should_int(fuera) be equal to(0);
+        } end
+
+        it ("al agregar un fragmento solo se mudan procesos al nuevo") {
+            int mal_mudados = 0;
+            int mudados = 0;
+            for (int n = 1; n < MAXIMO_FRAGMENTOS_PRUEBA; n++) {
+                for (int pid_prueba = 0; pid_prueba < PIDS_PRUEBA; pid_prueba++) {
+                    armar_fragmentos_de_prueba(n);
+                    int antes = fragmento_de_pid(pid_prueba);
+                    armar_fragmentos_de_prueba(n + 1);
+                    int despues = fragmento_de_pid(pid_prueba);
+                    if (despues != antes) {
+                        mudados++;
+                        mal_mudados += despues != n;
+                    }
+                }
+            }
+            should_int(mal_mudados) be equal to(0);
+            should_bool(mudados > 0) be equal to(true);
+        } end
+
+        it ("reparte los procesos de forma pareja") {
+            armar_fragmentos_de_prueba(4);
+            int por_fragmento[4] = { 0 };
+            for (int pid_prueba = 0; pid_prueba < PIDS_PRUEBA; pid_prueba++) {
+                por_fragmento[fragmento_de_pid(pid_prueba)]++;
+            }
+            int desparejos = 0;
+            for (int i = 0; i < 4; i++) {
+                desparejos += por_fragmento[i] < PIDS_PRUEBA / 4 * 8 / 10 || por_fragmento[i] > PIDS_PRUEBA / 4 * 12 / 10;
+            }
+            should_int(desparejos) be equal to(0);
+        } end
+
+    } end
+
+    describe ("Marcos por fragmento") {
+
+        it ("cada marco va al fragmento que lo declaró") {
+            armar_fragmentos_de_prueba(3);
+            should_int(indice_de_marco(0)) be equal to(0);
+            should_int(indice_de_marco(MARCOS_POR_FRAGMENTO - 1)) be equal to(0);
+            should_int(indice_de_marco(MARCOS_POR_FRAGMENTO)) be equal to(1);
+            should_int(indice_de_marco(2 * MARCOS_POR_FRAGMENTO - 1)) be equal to(1);
+            should_int(indice_de_marco(2 * MARCOS_POR_FRAGMENTO)) be equal to(2);
+            should_int(indice_de_marco(3 * MARCOS_POR_FRAGMENTO - 1)) be equal to(2);
+        } end
+
+        it ("un marco fuera de todos los rangos va al primero") {
+            armar_fragmentos_de_prueba(3);
+            should_int(indice_de_marco(3 * MARCOS_POR_FRAGMENTO)) be equal to(0);
+            should_int(indice_de_marco(-1)) be equal to(0);
+        } end
+
+        it ("respeta rangos que no empiezan en el marco 0 del fragmento 0") {
+            armar_fragmentos_de_prueba(2);
+            fragmentos_prueba[0].primer_marco = MARCOS_POR_FRAGMENTO;
+            fragmentos_prueba[1].primer_marco = 0;
+            should_int(indice_de_marco(0)) be equal to(1);
+            should_int(indice_de_marco(MARCOS_POR_FRAGMENTO)) be equal to(0);
+        } end
+
+    } end
+
+}
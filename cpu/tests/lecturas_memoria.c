@@ -0,0 +1,53 @@
+#include <cspecs/cspec.h>
+#include "memoria_prueba.h"
+
+/* LECTURAS DE MEMORIA */
+// Un READ que cruza páginas junta un campo por segmento. Si memoria contesta menos campos o un campo de otro
+// largo, el READ falla en vez de devolver los bytes que quedaron de antes.
+
+/**
+* @fn     void levantar_lectura_de_prueba(bool en_lote)
+* @brief  Levanta la CPU de prueba sin caché sobre una memoria con "abcdefgh" desde el byte 60: leerlo cruza de la página 0 a la 1.
+* @param  en_lote true para mandar los dos segmentos en un pedido (accesos vectorizados).
+* @return Ninguno
+*/
+void levantar_lectura_de_prueba(bool en_lote) {
+    levantar_cpu_de_prueba(0);
+    memcpy(memoria_prueba + 60, "abcdefgh", 8);
+    accesos_en_lote = en_lote;
+}
+
+context (lecturas_memoria) {
+
+    describe ("Respuestas de memoria a un READ") {
+
+        it ("junta los segmentos de las dos páginas") {
+            char leido[9];
+            levantar_lectura_de_prueba(false);
+            bool ok = leer_de_memoria(60, 8, leido, cpu_logger);
+            bajar_cpu_de_prueba();
+            should_bool(ok) be equal to(true);
+            should_string(leido) be equal to("abcdefgh");
+        } end
+
+        it ("falla si un segmento vuelve más corto") {
+            char leido[9];
+            levantar_lectura_de_prueba(false);
+            marco_recortado_prueba = 1;
+            bool ok = leer_de_memoria(60, 8, leido, cpu_logger);
+            bajar_cpu_de_prueba();
+            should_bool(ok) be equal to(false);
+        } end
+
+        it ("falla si falta el campo de un segmento, con accesos vectorizados") {
+            char leido[9];
+            levantar_lectura_de_prueba(true);
+            marco_omitido_prueba = 1;
+            bool ok = leer_de_memoria(60, 8, leido, cpu_logger);
+            bajar_cpu_de_prueba();
+            should_bool(ok) be equal to(false);
+        } end
+
+    } end
+
+}
@@ -0,0 +1,191 @@
+#include "memoria_prueba.h"
+
+char memoria_prueba[PAGINAS_PRUEBA * TAM_PAGINA_PRUEBA];
+t_instruccion_prueba* programa_prueba = NULL;
+int instrucciones_prueba = 0;
+int marco_rechazado_prueba = -1;
+int marco_recortado_prueba = -1;
+int marco_omitido_prueba = -1;
+t_config_cpu configuracion_prueba;
+pthread_t hilo_memoria_prueba;
+
+/**
+* @fn     void responder_memoria_prueba(int socket_cpu_prueba, int cod_op, t_buffer* pedido)
+* @brief  Contesta un pedido de la CPU como memoria. Las instrucciones salen de programa_prueba, con el PC módulo instrucciones_prueba.
+* @param  socket_cpu_prueba Socket del lado de memoria.
+* @param  cod_op Código de operación del pedido.
+* @param  pedido Contenido del pedido.
+* @return Ninguno
+*/
+void responder_memoria_prueba(int socket_cpu_prueba, int cod_op, t_buffer* pedido) {
+    t_lector_buffer lector = crear_lector(pedido);
+    t_buffer* respuesta = crear_buffer();
+    op_code_t cod_respuesta;
+
+    switch (cod_op) {
+        case CPU_M_SOLICITAR_INSTRUCCION:
+        {
+            t_instruccion_prueba* instruccion = &programa_prueba[leer_int_del_buffer(&lector) % instrucciones_prueba];
+            int cantidad = 0;
+            while (cantidad < 2 && instruccion->parametros[cantidad] != NULL) {
+                cantidad++;
+            }
+            cargar_int_al_buffer(respuesta, instruccion->operacion);
+            cargar_int_al_buffer(respuesta, cantidad);
+            for (int i = 0; i < cantidad; i++) {
+                cargar_string_al_buffer(respuesta, instruccion->parametros[i]);
+            }
+            cod_respuesta = M_CPU_RESPUESTA_INSTRUCCION;
+        }
+        break;
+
+        case CPU_M_ACCESO_TABLA_PAGINAS:
+            leer_int_del_buffer(&lector); //pid
+            cargar_int_al_buffer(respuesta, leer_int_del_buffer(&lector));
+            cod_respuesta = M_CPU_RESPUESTA_DIRECCION_FISICA;
+        break;
+
+        case CPU_M_LEER_MEMORIA:
+            while (quedan_datos_en_lector(&lector)) {
+                int marco = leer_int_del_buffer(&lector);
+                int offset = leer_int_del_buffer(&lector);
+                int tamanio = leer_int_del_buffer(&lector);
+                if (marco == marco_omitido_prueba) {
+                    continue;
+                }
+                if (marco == marco_recortado_prueba) {
+                    tamanio--;
+                }
+                agregar_a_buffer(respuesta, memoria_prueba + marco * TAM_PAGINA_PRUEBA + offset, tamanio);
+            }
+            cod_respuesta = M_CPU_VALOR_LEIDO;
+        break;
+
+        case CPU_M_LEER_PAGINA_COMPLETA:
+        {
+            leer_int_del_buffer(&lector); //pagina
+            int marco = leer_int_del_buffer(&lector);
+            char pagina[TAM_PAGINA_PRUEBA + 1];
+            memcpy(pagina, memoria_prueba + marco * TAM_PAGINA_PRUEBA, TAM_PAGINA_PRUEBA);
+            pagina[TAM_PAGINA_PRUEBA] = '\0';
+            cargar_int_al_buffer(respuesta, marco);
+            agregar_a_buffer(respuesta, pagina, sizeof(pagina));
+            cod_respuesta = M_CPU_PAGINA_COMPLETA;
+        }
+        break;
+
+        case CPU_M_ESCRIBIR_MEMORIA:
+            cod_respuesta = M_CPU_CONFIRMACION_ESCRITURA;
+            while (quedan_datos_en_lector(&lector)) {
+                int marco = leer_int_del_buffer(&lector);
+                int offset = leer_int_del_buffer(&lector);
+                int tamanio;
+                void* datos = leer_contenido_del_buffer(&lector, &tamanio);
+                if (marco == marco_rechazado_prueba) {
+                    cod_respuesta = M_K_RESPUESTA_ERROR;
+                    continue;
+                }
+                memcpy(memoria_prueba + marco * TAM_PAGINA_PRUEBA + offset, datos, tamanio);
+            }
+            cargar_string_al_buffer(respuesta, "OK");
+        break;
+
+        case CPU_M_ESCRIBIR_PAGINA_MODIFICADA:
+        {
+            leer_int_del_buffer(&lector); //pagina
+            int marco = leer_int_del_buffer(&lector);
+            char* contenido = leer_string_del_buffer(&lector);
+            memcpy(memoria_prueba + marco * TAM_PAGINA_PRUEBA, contenido, strnlen(contenido, TAM_PAGINA_PRUEBA));
+            cargar_string_al_buffer(respuesta, "OK");
+            cod_respuesta = M_CPU_CONFIRMACION_ESCRITURA;
+        }
+        break;
+
+        default:
+            cod_respuesta = M_K_RESPUESTA_ERROR;
+        break;
+    }
+    enviar_paquete(crear_paquete(cod_respuesta, respuesta), socket_cpu_prueba);
+}
+
+/**
+* @fn     void* atender_memoria_prueba(void* arg)
+* @brief  Hilo de la memoria de prueba: contesta los pedidos hasta que la CPU cierra su lado del socket.
+* @param  arg Socket del lado de memoria, casteado a void*.
+* @return NULL
+*/
+void* atender_memoria_prueba(void* arg) {
+    int socket_cpu_prueba = (intptr_t)arg;
+    int cod_op;
+    while ((cod_op = recibir_operacion(socket_cpu_prueba)) != -1) {
+        t_buffer* pedido = recibir_buffer(socket_cpu_prueba);
+        responder_memoria_prueba(socket_cpu_prueba, cod_op, pedido);
+        eliminar_buffer(pedido);
+    }
+    return NULL;
+}
+
+/**
+* @fn     void levantar_cpu_de_prueba(int entradas_cache)
+* @brief  Deja la CPU del hilo lista para ejecutar el proceso 1 desde el PC 0, con un solo fragmento de memoria que es la memoria de prueba, vacía. La TLB tiene dos entradas.
+* @param  entradas_cache Entradas de la caché, 0 sin caché.
+* @return Ninguno
+*/
+void levantar_cpu_de_prueba(int entradas_cache) {
+    configuracion_prueba = (t_config_cpu){
+        .entradas_tlb = 2,
+        .reemplazo_tlb = TLB_LRU,
+        .entradas_cache = entradas_cache,
+        .reemplazo_cache = CACHE_CLOCK,
+        .nivel_log = LOG_LEVEL_ERROR
+    };
+    configuracion_cpu = &configuracion_prueba;
+    cpu_logger = log_create("cpu_tests.log", "CPU", false, LOG_LEVEL_ERROR);
+    tam_pagina = TAM_PAGINA_PRUEBA;
+    entradas_tabla = PAGINAS_PRUEBA;
+    cantidad_niveles = 1;
+    memset(memoria_prueba, 0, sizeof(memoria_prueba));
+    marco_rechazado_prueba = -1;
+    marco_recortado_prueba = -1;
+    marco_omitido_prueba = -1;
+    accesos_en_lote = false;
+
+    int sockets[2];
+    socketpair(AF_UNIX, SOCK_STREAM, 0, sockets);
+    pthread_create(&hilo_memoria_prueba, NULL, atender_memoria_prueba, (void*)(intptr_t)sockets[1]);
+    cantidad_fragmentos = 1;
+    fragmentos_memoria = calloc(1, sizeof(t_fragmento_memoria));
+    fragmentos_memoria[0].socket = sockets[0];
+    fragmentos_memoria[0].lector = crear_lector_socket(sockets[0], 0);
+    fragmentos_memoria[0].pedidos = crear_tabla_pedidos(false);
+    fragmentos_memoria[0].cantidad_marcos = PAGINAS_PRUEBA;
+
+    pid = 1;
+    pc = 0;
+    pc_pedido = -1;
+    usar_fragmento_del_proceso();
+    iniciar_buzon_interrupcion(&buzon_principal, false);
+    buzon_interrupcion = &buzon_principal;
+    iniciar_TLB();
+    inicializar_cache();
+}
+
+/**
+* @fn     void bajar_cpu_de_prueba(void)
+* @brief  Cierra la conexión con la memoria de prueba, espera a su hilo y libera lo que armó levantar_cpu_de_prueba().
+* @param  Ninguno
+* @return Ninguno
+*/
+void bajar_cpu_de_prueba(void) {
+    destruir_buffer_escrituras(escrituras_pendientes);
+    escrituras_pendientes = NULL;
+    cerrar_fragmentos_memoria(fragmentos_memoria);
+    fragmentos_memoria = NULL;
+    pthread_join(hilo_memoria_prueba, NULL);
+    destruir_buzon_interrupcion(&buzon_principal);
+    liberar_decodificador();
+    destruir_entrada_cache(entrada_cache_libre);
+    entrada_cache_libre = NULL;
+    vaciar_pool_del_hilo();
+    log_destroy(cpu_logger);
+}
@@ -0,0 +1,34 @@
+#ifndef MEMORIA_PRUEBA_H_
+#define MEMORIA_PRUEBA_H_
+
+#include <pthread.h>
+#include <sys/socket.h>
+#include "../include/cpu.h"
+
+/* MEMORIA DE PRUEBA */
+// Un hilo del mismo proceso, del otro lado de un socketpair, contesta como memoria con el protocolo sin ids
+// ni esquema. Los marcos son las páginas y sus bytes están en memoria_prueba. Los CPU_M_ESCRIBIR_MEMORIA
+// traen segmentos [marco][desplazamiento][datos], uno o varios por pedido, y los CPU_M_ESCRIBIR_PAGINA_MODIFICADA
+// las páginas que salen de la caché ([página][marco][contenido]).
+#define TAM_PAGINA_PRUEBA 64
+#define PAGINAS_PRUEBA 8
+
+typedef struct {
+    t_operacion operacion;
+    char* parametros[2];     // NULL los que no usa
+} t_instruccion_prueba;
+
+extern char memoria_prueba[PAGINAS_PRUEBA * TAM_PAGINA_PRUEBA];
+extern t_instruccion_prueba* programa_prueba;
+extern int instrucciones_prueba;
+extern int marco_rechazado_prueba;  // las escrituras en este marco no se confirman, -1: ninguno
+extern int marco_recortado_prueba;  // las lecturas de este marco vuelven con un byte menos, -1: ninguno
+extern int marco_omitido_prueba;    // las lecturas de este marco no vuelven en la respuesta, -1: ninguno
+extern t_config_cpu configuracion_prueba;
+
+void responder_memoria_prueba(int socket_cpu_prueba, int cod_op, t_buffer* pedido);
+void* atender_memoria_prueba(void* arg);
+void levantar_cpu_de_prueba(int entradas_cache);
+void bajar_cpu_de_prueba(void);
+
+#endif
@@ -0,0 +1,167 @@
+#include <cspecs/cspec.h>
+#include <sys/socket.h>
+#include "../include/cpu.h"
+
+/* PEDIDOS MULTIPLEXADOS */
+// Del otro lado de un socketpair se contesta a mano, en el orden que elige cada prueba. Las respuestas
+// que se mandan antes de esperar entran en el mismo recv, así que la de otro pedido queda en el lector
+// delante de la que se espera.
+int sockets_pedidos[2];
+t_lector_socket* lector_pedidos;
+t_tabla_pedidos* tabla_pedidos;
+
+// Contadores de malloc, calloc y realloc del hilo (ver ciclo_sin_reservas.c)
+extern __thread bool contando_reservas;
+extern __thread int reservas_contadas;
+
+/**
+* @fn     void abrir_conexion_de_pedidos(void)
+* @brief  Arma el socketpair, el lector del lado de la CPU y una tabla de pedidos con ids.
+* @param  Ninguno
+* @return Ninguno
+*/
+void abrir_conexion_de_pedidos(void) {
+    socketpair(AF_UNIX, SOCK_STREAM, 0, sockets_pedidos);
+    lector_pedidos = crear_lector_socket(sockets_pedidos[0], 0);
+    tabla_pedidos = crear_tabla_pedidos(true);
+}
+
+/**
+* @fn     void cerrar_conexion_de_pedidos(void)
+* @brief  Libera lo que armó abrir_conexion_de_pedidos().
+* @param  Ninguno
+* @return Ninguno
+*/
+void cerrar_conexion_de_pedidos(void) {
+    destruir_tabla_pedidos(tabla_pedidos);
+    destruir_lector_socket(lector_pedidos);
+    close(sockets_pedidos[0]);
+    close(sockets_pedidos[1]);
+}
+
+/**
+* @fn     uint32_t abrir_pedido(void)
+* @brief  Reserva un id en la tabla como si se enviara un pedido (no sale nada por el socket).
+* @param  Ninguno
+* @return Id del pedido.
+*/
+uint32_t abrir_pedido(void) {
+    char almacenamiento[CAPACIDAD_CONSTRUCTOR_PILA];
+    t_constructor_paquete paquete;
+    uint32_t id = iniciar_pedido(&paquete, CPU_M_LEER_MEMORIA, almacenamiento, sizeof(almacenamiento), tabla_pedidos);
+    liberar_constructor(&paquete);
+    return id;
+}
+
+/**
+* @fn     void contestar_pedido(uint32_t id, char* valor)
+* @brief  Manda desde el otro extremo la respuesta al pedido id, con valor como único campo.
+* @param  id Id del pedido.
+* @param  valor String de la respuesta.
+* @return Ninguno
+*/
+void contestar_pedido(uint32_t id, char* valor) {
+    char almacenamiento[CAPACIDAD_CONSTRUCTOR_PILA];
+    t_constructor_paquete paquete;
+    iniciar_constructor(&paquete, M_CPU_VALOR_LEIDO, almacenamiento, sizeof(almacenamiento));
+    cargar_int_al_constructor(&paquete, id);
+    cargar_string_al_constructor(&paquete, valor);
+    enviar_constructor(&paquete, sockets_pedidos[1]);
+}
+
+/**
+* @fn     char* valor_de_respuesta(uint32_t id)
+* @brief  Espera la respuesta al pedido id y devuelve su valor.
+* @param  id Id del pedido.
+* @return Valor de la respuesta (vista del lector o de la tabla), o NULL si llegó otro código.
+*/
+char* valor_de_respuesta(uint32_t id) {
+    t_buffer respuesta;
+    if (esperar_respuesta(tabla_pedidos, lector_pedidos, id, &respuesta) != M_CPU_VALOR_LEIDO) {
+        return NULL;
+    }
+    t_lector_buffer lector = crear_lector(&respuesta);
+    return leer_string_del_buffer(&lector);
+}
+
+context (pedidos_multiplexados) {
+
+    describe ("Respuesta disponible") {
+
+        it ("no da por disponible la respuesta de otro pedido que está primera en el lector") {
+            abrir_conexion_de_pedidos();
+            uint32_t primero = abrir_pedido();
+            uint32_t segundo = abrir_pedido();
+            uint32_t tercero = abrir_pedido();
+            contestar_pedido(primero, "uno");
+            contestar_pedido(segundo, "dos");
+            should_string(valor_de_respuesta(primero)) be equal to("uno");
+            should_bool(hay_mensaje_bufferizado(lector_pedidos)) be equal to(true);
+
+            should_bool(respuesta_disponible(tabla_pedidos, lector_pedidos, tercero)) be equal to(false);
+            should_bool(respuesta_disponible(tabla_pedidos, lector_pedidos, segundo)) be equal to(true);
+            should_string(valor_de_respuesta(segundo)) be equal to("dos");
+            cerrar_conexion_de_pedidos();
+        } end
+
+        it ("encuentra la respuesta esperada detrás de la de otro pedido") {
+            abrir_conexion_de_pedidos();
+            uint32_t primero = abrir_pedido();
+            uint32_t segundo = abrir_pedido();
+            uint32_t tercero = abrir_pedido();
+            contestar_pedido(primero, "uno");
+            contestar_pedido(segundo, "dos");
+            contestar_pedido(tercero, "tres");
+            should_string(valor_de_respuesta(primero)) be equal to("uno");
+
+            should_bool(respuesta_disponible(tabla_pedidos, lector_pedidos, tercero)) be equal to(true);
+            should_string(valor_de_respuesta(tercero)) be equal to("tres");
+            should_string(valor_de_respuesta(segundo)) be equal to("dos");
+            should_bool(hay_mensaje_bufferizado(lector_pedidos)) be equal to(false);
+            cerrar_conexion_de_pedidos();
+        } end
+
+        it ("descarta la respuesta de un pedido abandonado sin taparla") {
+            abrir_conexion_de_pedidos();
+            uint32_t primero = abrir_pedido();
+            uint32_t abandonado = abrir_pedido();
+            uint32_t tercero = abrir_pedido();
+            abandonar_pedido(tabla_pedidos, abandonado);
+            contestar_pedido(primero, "uno");
+            contestar_pedido(abandonado, "dos");
+            should_string(valor_de_respuesta(primero)) be equal to("uno");
+
+            should_bool(respuesta_disponible(tabla_pedidos, lector_pedidos, tercero)) be equal to(false);
+            should_bool(hay_mensaje_bufferizado(lector_pedidos)) be equal to(false);
+            cerrar_conexion_de_pedidos();
+        } end
+
+    } end
+
+    describe ("Respuestas guardadas") {
+
+        it ("reusa el lugar de la tabla sin pedir memoria al sistema") {
+            abrir_conexion_de_pedidos();
+            uint64_t reservas_en_regimen = 0;
+            for (int vuelta = 0; vuelta < 4 * MAX_PEDIDOS_EN_VUELO; vuelta++) {
+                if (vuelta == MAX_PEDIDOS_EN_VUELO) {
+                    reservas_en_regimen = contadores_pool_del_hilo().reservas_sistema;
+                    reservas_contadas = 0;
+                    contando_reservas = true;
+                }
+                uint32_t primero = abrir_pedido();
+                uint32_t segundo = abrir_pedido();
+                contestar_pedido(segundo, "llego antes");
+                contestar_pedido(primero, "uno");
+                valor_de_respuesta(primero);
+                valor_de_respuesta(segundo);
+            }
+            contando_reservas = false;
+            should_int(reservas_contadas) be equal to(0);
+            should_int((int)(contadores_pool_del_hilo().reservas_sistema - reservas_en_regimen)) be equal to(0);
+            cerrar_conexion_de_pedidos();
+        } end
+
+    } end
+
+}
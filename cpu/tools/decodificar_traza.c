@@ -0,0 +1,94 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "../include/traza.h"
+
+// Mismo orden que t_operacion (utils/utils.h)
+static const char* nombres_operacion[] = { "NOOP", "READ", "WRITE", "GOTO", "IO", "EXIT", "INIT_PROC", "DUMP_MEMORY" };
+static const char* nombres_resultado[] = { "-", "HIT", "MISS" };
+
+/**
+* @fn     const char* nombre_operacion(int32_t operacion)
+* @brief  Devuelve el nombre de una operación de la traza.
+* @param  operacion Operación registrada (t_operacion).
+* @return Nombre de la operación, o "?" si no es una conocida.
+*/
+const char* nombre_operacion(int32_t operacion) {
+    int cantidad = sizeof(nombres_operacion) / sizeof(nombres_operacion[0]);
+    return (operacion >= 0 && operacion < cantidad) ? nombres_operacion[operacion] : "?";
+}
+
+/**
+* @fn     const char* nombre_resultado(uint8_t resultado)
+* @brief  Devuelve el nombre de un resultado de TLB o caché de la traza.
+* @param  resultado Resultado registrado (t_resultado_traza).
+* @return "-", "HIT", "MISS", o "?" si no es uno conocido.
+*/
+const char* nombre_resultado(uint8_t resultado) {
+    return resultado <= TRAZA_MISS ? nombres_resultado[resultado] : "?";
+}
+
+/**
+* @fn     main
+* @brief  Decodifica una traza binaria de la CPU: imprime un registro por línea y al final los aciertos de TLB y caché.
+* @param argc Cantidad de argumentos pasados al programa.
+* @param argv Array de argumentos pasados al programa.
+* @return Código de salida del programa.
+*/
+int main(int argc, char* argv[]) {
+    if (argc < 2) {
+        printf("Falta el archivo de traza.\nUso: %s [archivo]\n", argv[0]);
+        exit(EXIT_FAILURE);
+    }
+
+    FILE* archivo = fopen(argv[1], "rb");
+    if (archivo == NULL) {
+        perror("No se pudo abrir la traza");
+        exit(EXIT_FAILURE);
+    }
+
+    t_cabecera_traza cabecera;
+    if (fread(&cabecera, sizeof(cabecera), 1, archivo) != 1 || memcmp(cabecera.magia, MAGIA_TRAZA, sizeof(cabecera.magia)) != 0) {
+        printf("\n[ERROR] %s no es una traza de la CPU\n", argv[1]);
+        exit(EXIT_FAILURE);
+    }
+    if (cabecera.version != VERSION_TRAZA || cabecera.tamanio_registro != sizeof(t_registro_traza)) {
+        printf("\n[ERROR] Traza version %u con registros de %u bytes, se esperaba version %d de %zu\n",
+            cabecera.version, cabecera.tamanio_registro, VERSION_TRAZA, sizeof(t_registro_traza));
+        exit(EXIT_FAILURE);
+    }
+
+    long registros = 0;
+    long accesos_tlb = 0, hits_tlb = 0, accesos_cache = 0, hits_cache = 0;
+    uint64_t inicio = 0;
+    t_registro_traza registro;
+
+    printf("%12s %6s %6s %-12s %10s %10s %5s %5s\n", "TIEMPO_US", "PID", "PC", "OPERACION", "DIR_LOG", "DIR_FIS", "TLB", "CACHE");
+    while (fread(&registro, sizeof(registro), 1, archivo) == 1) {
+        if (registros == 0) {
+            inicio = registro.tiempo_ns;
+        }
+        registros++;
+
+        printf("%12.3f %6d %6d %-12s %10d %10d %5s %5s\n", (registro.tiempo_ns - inicio) / 1000.0,
+            registro.pid, registro.pc, nombre_operacion(registro.operacion),
+            registro.direccion_logica, registro.direccion_fisica,
+            nombre_resultado(registro.tlb), nombre_resultado(registro.cache));
+
+        if (registro.tlb != TRAZA_SIN_ACCESO) {
+            accesos_tlb++;
+            hits_tlb += registro.tlb == TRAZA_HIT;
+        }
+        if (registro.cache != TRAZA_SIN_ACCESO) {
+            accesos_cache++;
+            hits_cache += registro.cache == TRAZA_HIT;
+        }
+    }
+    fclose(archivo);
+
+    printf("\n%ld instrucciones\n", registros);
+    printf("TLB: %ld/%ld hits (%.1f%%)\n", hits_tlb, accesos_tlb, accesos_tlb ? 100.0 * hits_tlb / accesos_tlb : 0.0);
+    printf("Cache: %ld/%ld hits (%.1f%%)\n", hits_cache, accesos_cache, accesos_cache ? 100.0 * hits_cache / accesos_cache : 0.0);
+
+    return EXIT_SUCCESS;
+}
@@ -0,0 +1,358 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <signal.h>
+#include <utils/utils.h>
+#include <utils/servidor.h>
+
+// Memoria de prueba sobre el servidor de eventos de utils: contesta el protocolo CPU-memoria campo por
+// campo (de las capacidades del handshake acepta los ids de pedido, el codec de páginas y los accesos
+// vectorizados), para levantar una o cientos de CPUs sin el módulo memoria. Todos los procesos corren el
+// mismo programa y la página N está en el marco N módulo la cantidad de marcos, sin importar el PID.
+// Como fragmento k de n (FRAGMENTOS_MEMORIA en la CPU) guarda los marcos globales k*CANTIDAD_MARCOS en
+// adelante, lo informa en el handshake, y su tabla de páginas reparte las páginas entre los n fragmentos.
+#define TAM_PAGINA 64
+#define TAM_MEMORIA 4096
+#define ENTRADAS_TABLA 4
+#define CANTIDAD_NIVELES 3
+#define CANTIDAD_MARCOS (TAM_MEMORIA / TAM_PAGINA)
+#define CAPACIDADES_ACEPTADAS (CAPACIDAD_IDS_DE_PEDIDO | CAPACIDAD_CODEC_PAGINAS | CAPACIDAD_ACCESOS_VECTORIZADOS)
+
+typedef struct {
+    char memoria[TAM_MEMORIA];
+    pthread_mutex_t mutex;   // los trabajadores atienden CPUs distintas a la vez
+    char** programa;         // una instrucción por línea: OPERACION [parámetros]
+    int cantidad_instrucciones;
+    int fragmento;           // 0 a cantidad_fragmentos - 1
+    int cantidad_fragmentos;
+} t_memoria_simulada;
+
+// Mismo orden que t_operacion (utils/utils.h)
+char* nombres_operacion[] = { "NOOP", "READ", "WRITE", "GOTO", "IO", "EXIT", "INIT_PROC", "DUMP_MEMORY" };
+char* programa_por_defecto[] = { "NOOP", "WRITE 0 hola", "READ 0 4", "WRITE 120 cruza_de_pagina", "READ 120 16", "EXIT" };
+
+t_servidor* servidor = NULL;
+t_log* logger = NULL;
+
+/**
+* @fn     void responder(t_cliente_servidor* cliente, op_code cod_op, t_buffer* respuesta)
+* @brief  Envía una respuesta a la CPU. Si la CPU se desconectó, el error se ve cuando el servidor lee su conexión.
+* @param  cliente CPU a la que se responde.
+* @param  cod_op Código de operación de la respuesta.
+* @param  respuesta Contenido de la respuesta; queda liberado.
+* @return Ninguno
+*/
+void responder(t_cliente_servidor* cliente, op_code cod_op, t_buffer* respuesta) {
+    enviar_paquete(crear_paquete(cod_op, respuesta), cliente->socket);
+}
+
+/**
+* @fn     int capacidades_del_cliente(t_cliente_servidor* cliente)
+* @brief  Capacidades que se acordaron en el handshake con la CPU (se guardan en el dato del cliente).
+* @param  cliente CPU conectada.
+* @return Máscara de CAPACIDAD_*, 0 antes del handshake.
+*/
+int capacidades_del_cliente(t_cliente_servidor* cliente) {
+    return (int)(intptr_t)cliente->dato;
+}
+
+/**
+* @fn     t_buffer* crear_respuesta(t_cliente_servidor* cliente, uint32_t id)
+* @brief  Crea el buffer de la respuesta a un pedido. Si la CPU aceptó ids de pedido, empieza con el id del pedido.
+* @param  cliente CPU a la que se responde.
+* @param  id Id del pedido, 0 sin ids.
+* @return Buffer de la respuesta.
+*/
+t_buffer* crear_respuesta(t_cliente_servidor* cliente, uint32_t id) {
+    t_buffer* respuesta = crear_buffer();
+    if (capacidades_del_cliente(cliente) & CAPACIDAD_IDS_DE_PEDIDO) {
+        cargar_int_al_buffer(respuesta, (int)id);
+    }
+    return respuesta;
+}
+
+/**
+* @fn     void responder_instruccion(t_memoria_simulada* memoria, t_cliente_servidor* cliente, uint32_t id, t_lector_buffer* lector)
+* @brief  Contesta un FETCH con la instrucción del programa en el PC pedido (EXIT pasado el final).
+* @param  memoria Estado de la memoria simulada.
+* @param  cliente CPU que pidió la instrucción.
+* @param  id Id del pedido, 0 sin ids.
+* @param  lector Pedido: PC y PID.
+* @return Ninguno
+*/
+void responder_instruccion(t_memoria_simulada* memoria, t_cliente_servidor* cliente, uint32_t id, t_lector_buffer* lector) {
+    int pc = leer_int_del_buffer(lector);
+    leer_int_del_buffer(lector); // PID: todos corren el mismo programa
+    char** partes = string_split(pc >= 0 && pc < memoria->cantidad_instrucciones ? memoria->programa[pc] : "EXIT", " ");
+
+    int operacion = EXIT;
+    for (int i = 0; i < (int)(sizeof(nombres_operacion) / sizeof(nombres_operacion[0])); i++) {
+        if (strcmp(partes[0], nombres_operacion[i]) == 0) {
+            operacion = i;
+        }
+    }
+    int cantidad_parametros = string_array_size(partes) - 1;
+
+    t_buffer* respuesta = crear_respuesta(cliente, id);
+    cargar_int_al_buffer(respuesta, operacion);
+    cargar_int_al_buffer(respuesta, cantidad_parametros);
+    for (int i = 1; i <= cantidad_parametros; i++) {
+        cargar_string_al_buffer(respuesta, partes[i]);
+    }
+    string_array_destroy(partes);
+    responder(cliente, M_CPU_RESPUESTA_INSTRUCCION, respuesta);
+}
+
+/**
+* @fn     void leer_segmentos_simulados(t_memoria_simulada* memoria, t_cliente_servidor* cliente, uint32_t id, t_lector_buffer* lector)
+* @brief  Contesta un READ con un campo por segmento (marco, desplazamiento, tamaño) pedido.
+* @param  memoria Estado de la memoria simulada.
+* @param  cliente CPU que pidió la lectura.
+* @param  id Id del pedido, 0 sin ids.
+* @param  lector Pedido con los segmentos.
+* @return Ninguno
+*/
+void leer_segmentos_simulados(t_memoria_simulada* memoria, t_cliente_servidor* cliente, uint32_t id, t_lector_buffer* lector) {
+    t_buffer* respuesta = crear_respuesta(cliente, id);
+    pthread_mutex_lock(&memoria->mutex);
+    while (quedan_datos_en_lector(lector)) {
+        int marco = leer_int_del_buffer(lector);
+        int desplazamiento = leer_int_del_buffer(lector);
+        int tamanio = leer_int_del_buffer(lector);
+        int inicio = (marco % CANTIDAD_MARCOS) * TAM_PAGINA + desplazamiento;
+        if (inicio < 0 || tamanio < 0 || inicio + tamanio > TAM_MEMORIA) {
+            tamanio = 0;
+        }
+        agregar_a_buffer(respuesta, memoria->memoria + (tamanio > 0 ? inicio : 0), tamanio);
+    }
+    pthread_mutex_unlock(&memoria->mutex);
+    responder(cliente, M_CPU_VALOR_LEIDO, respuesta);
+}
+
+/**
+* @fn     void escribir_simulado(t_memoria_simulada* memoria, t_cliente_servidor* cliente, uint32_t id, t_lector_buffer* lector)
+* @brief  Atiende un CPU_M_ESCRIBIR_MEMORIA: uno o varios segmentos (marco, desplazamiento, datos) de un WRITE.
+* @param  memoria Estado de la memoria simulada.
+* @param  cliente CPU que pidió la escritura.
+* @param  id Id del pedido, 0 sin ids.
+* @param  lector Pedido con los segmentos.
+* @return Ninguno
+*/
+void escribir_simulado(t_memoria_simulada* memoria, t_cliente_servidor* cliente, uint32_t id, t_lector_buffer* lector) {
+    pthread_mutex_lock(&memoria->mutex);
+    while (quedan_datos_en_lector(lector)) {
+        int marco = leer_int_del_buffer(lector);
+        int desplazamiento = leer_int_del_buffer(lector);
+        int largo;
+        void* datos = leer_contenido_del_buffer(lector, &largo);
+        int inicio = (marco % CANTIDAD_MARCOS) * TAM_PAGINA + desplazamiento;
+        if (inicio >= 0 && largo >= 0 && inicio + largo <= TAM_MEMORIA) {
+            memcpy(memoria->memoria + inicio, datos, largo);
+        }
+    }
+    pthread_mutex_unlock(&memoria->mutex);
+
+    t_buffer* respuesta = crear_respuesta(cliente, id);
+    cargar_string_al_buffer(respuesta, "OK");
+    responder(cliente, M_CPU_CONFIRMACION_ESCRITURA, respuesta);
+}
+
+/**
+* @fn     void escribir_pagina_simulada(t_memoria_simulada* memoria, t_cliente_servidor* cliente, uint32_t id, t_lector_buffer* lector)
+* @brief  Atiende un CPU_M_ESCRIBIR_PAGINA_MODIFICADA: página, marco y contenido de una entrada desalojada de la caché, codificado si se acordó el codec.
+* @param  memoria Estado de la memoria simulada.
+* @param  cliente CPU que pidió la escritura.
+* @param  id Id del pedido, 0 sin ids.
+* @param  lector Pedido.
+* @return Ninguno
+*/
+void escribir_pagina_simulada(t_memoria_simulada* memoria, t_cliente_servidor* cliente, uint32_t id, t_lector_buffer* lector) {
+    leer_int_del_buffer(lector); // página
+    int marco = leer_int_del_buffer(lector);
+    int largo;
+    void* contenido = leer_contenido_del_buffer(lector, &largo);
+    char pagina[TAM_PAGINA];
+    bool ok;
+    if (capacidades_del_cliente(cliente) & CAPACIDAD_CODEC_PAGINAS) {
+        ok = decodificar_pagina(contenido, largo, pagina, TAM_PAGINA);
+    }
+    else { // string con su \0
+        memset(pagina, 0, TAM_PAGINA);
+        memcpy(pagina, contenido, largo > TAM_PAGINA ? TAM_PAGINA : largo);
+        ok = true;
+    }
+
+    t_buffer* respuesta = crear_respuesta(cliente, id);
+    if (!ok) {
+        log_warning(logger, "La página del marco %d llegó mal codificada de la CPU del socket %d", marco, cliente->socket);
+        cargar_string_al_buffer(respuesta, "ERROR");
+        responder(cliente, M_K_RESPUESTA_ERROR, respuesta);
+        return;
+    }
+    pthread_mutex_lock(&memoria->mutex);
+    memcpy(memoria->memoria + (marco % CANTIDAD_MARCOS) * TAM_PAGINA, pagina, TAM_PAGINA);
+    pthread_mutex_unlock(&memoria->mutex);
+    cargar_string_al_buffer(respuesta, "OK");
+    responder(cliente, M_CPU_CONFIRMACION_ESCRITURA, respuesta);
+}
+
+/**
+* @fn     void atender_cpu(t_cliente_servidor* cliente, int cod_op, t_buffer* buffer)
+* @brief  Manejador del servidor: atiende un pedido de una CPU en un trabajador.
+* @param  cliente CPU que envió el pedido.
+* @param  cod_op Código de operación, -1 si la CPU se desconectó.
+* @param  buffer Contenido del pedido.
+* @return Ninguno
+*/
+void atender_cpu(t_cliente_servidor* cliente, int cod_op, t_buffer* buffer) {
+    t_memoria_simulada* memoria = cliente->servidor->dato;
+    if (cod_op == -1) {
+        log_info(logger, "Se desconecto la CPU del socket %d", cliente->socket);
+        return;
+    }
+
+    t_lector_buffer lector = crear_lector(buffer);
+    bool con_id = cod_op != CPU_M_HANDSHAKE && (capacidades_del_cliente(cliente) & CAPACIDAD_IDS_DE_PEDIDO);
+    uint32_t id = con_id ? (uint32_t)leer_int_del_buffer(&lector) : 0;
+    switch (cod_op) {
+        case CPU_M_HANDSHAKE: {
+            leer_int_del_buffer(&lector); // RESULT_OK
+            int ofrecidas = quedan_datos_en_lector(&lector) ? leer_int_del_buffer(&lector) : 0;
+            int aceptadas = ofrecidas & CAPACIDADES_ACEPTADAS; // sin esquema ni memoria compartida: campo por campo
+            cliente->dato = (void*)(intptr_t)aceptadas; // con ids, los pedidos siguientes traen id (el handshake no)
+            t_buffer* respuesta = crear_buffer();
+            cargar_int_al_buffer(respuesta, TAM_PAGINA);
+            cargar_int_al_buffer(respuesta, TAM_MEMORIA);
+            cargar_int_al_buffer(respuesta, ENTRADAS_TABLA);
+            cargar_int_al_buffer(respuesta, CANTIDAD_NIVELES);
+            cargar_int_al_buffer(respuesta, aceptadas);
+            if (memoria->cantidad_fragmentos > 1) {
+                cargar_int_al_buffer(respuesta, memoria->fragmento * CANTIDAD_MARCOS); // primer marco global que guarda
+            }
+            responder(cliente, M_CPU_HANDSHAKE, respuesta);
+            log_info(logger, "Handshake con la CPU del socket %d (capacidades 0x%x)", cliente->socket, aceptadas);
+            break;
+        }
+        case CPU_M_SOLICITAR_INSTRUCCION:
+            responder_instruccion(memoria, cliente, id, &lector);
+            break;
+        case CPU_M_ACCESO_TABLA_PAGINAS: {
+            leer_int_del_buffer(&lector); // PID
+            int pagina = leer_int_del_buffer(&lector);
+            t_buffer* respuesta = crear_respuesta(cliente, id);
+            cargar_int_al_buffer(respuesta, pagina % (CANTIDAD_MARCOS * memoria->cantidad_fragmentos)); // marco global
+            responder(cliente, M_CPU_RESPUESTA_DIRECCION_FISICA, respuesta);
+            break;
+        }
+        case CPU_M_LEER_MEMORIA:
+            leer_segmentos_simulados(memoria, cliente, id, &lector);
+            break;
+        case CPU_M_ESCRIBIR_MEMORIA:
+            escribir_simulado(memoria, cliente, id, &lector);
+            break;
+        case CPU_M_ESCRIBIR_PAGINA_MODIFICADA:
+            escribir_pagina_simulada(memoria, cliente, id, &lector);
+            break;
+        case CPU_M_LEER_PAGINA_COMPLETA: {
+            leer_int_del_buffer(&lector); // página
+            int marco = leer_int_del_buffer(&lector);
+            char contenido[TAM_PAGINA + 1] = { 0 };
+            pthread_mutex_lock(&memoria->mutex);
+            memcpy(contenido, memoria->memoria + (marco % CANTIDAD_MARCOS) * TAM_PAGINA, TAM_PAGINA);
+            pthread_mutex_unlock(&memoria->mutex);
+            t_buffer* respuesta = crear_respuesta(cliente, id);
+            cargar_int_al_buffer(respuesta, marco);
+            if (capacidades_del_cliente(cliente) & CAPACIDAD_CODEC_PAGINAS) {
+                char codificada[TAMANIO_MAXIMO_CODIFICADA(TAM_PAGINA)];
+                agregar_a_buffer(respuesta, codificada, codificar_pagina(contenido, TAM_PAGINA, codificada));
+            }
+            else {
+                cargar_string_al_buffer(respuesta, contenido);
+            }
+            responder(cliente, M_CPU_PAGINA_COMPLETA, respuesta);
+            break;
+        }
+        default:
+            log_warning(logger, "Pedido desconocido (%d) de la CPU del socket %d", cod_op, cliente->socket);
+            break;
+    }
+    eliminar_buffer(buffer);
+}
+
+/**
+* @fn     void terminar(int senial)
+* @brief  Detiene el servidor con SIGINT o SIGTERM.
+* @param  senial Señal recibida.
+* @return Ninguno
+*/
+void terminar(int senial) {
+    detener_servidor(servidor);
+}
+
+/**
+* @fn     main
+* @brief  Levanta la memoria simulada hasta recibir SIGINT o SIGTERM.
+* @param argc Cantidad de argumentos pasados al programa.
+* @param argv [dirección] [trabajadores] [archivo de programa] [fragmento k/n]. Por defecto tcp:*:8002, uno por procesador, un programa fijo de WRITE y READ (también con "-") y una memoria sin fragmentar.
+* @return Código de salida del programa.
+*/
+int main(int argc, char* argv[]) {
+    char* direccion = argc > 1 ? argv[1] : "tcp:*:8002";
+    int trabajadores = argc > 2 ? atoi(argv[2]) : 0;
+
+    t_memoria_simulada* memoria = calloc(1, sizeof(t_memoria_simulada));
+    pthread_mutex_init(&memoria->mutex, NULL);
+    memoria->cantidad_fragmentos = 1;
+    if (argc > 4 && (sscanf(argv[4], "%d/%d", &memoria->fragmento, &memoria->cantidad_fragmentos) != 2
+        || memoria->cantidad_fragmentos < 1 || memoria->fragmento < 0 || memoria->fragmento >= memoria->cantidad_fragmentos)) {
+        printf("\n[ERROR] El fragmento tiene que ser k/n, con 0 <= k < n\n");
+        exit(EXIT_FAILURE);
+    }
+    if (argc > 3 && strcmp(argv[3], "-") != 0) {
+        FILE* archivo = fopen(argv[3], "r");
+        if (archivo == NULL) {
+            perror("No se pudo abrir el programa");
+            exit(EXIT_FAILURE);
+        }
+        char* linea = NULL;
+        size_t capacidad = 0;
+        while (getline(&linea, &capacidad, archivo) != -1) {
+            linea[strcspn(linea, "\r\n")] = '\0';
+            if (linea[0] == '\0') {
+                continue;
+            }
+            memoria->programa = realloc(memoria->programa, (memoria->cantidad_instrucciones + 1) * sizeof(char*));
+            memoria->programa[memoria->cantidad_instrucciones++] = strdup(linea);
+        }
+        free(linea);
+        fclose(archivo);
+    }
+    else {
+        memoria->cantidad_instrucciones = sizeof(programa_por_defecto) / sizeof(programa_por_defecto[0]);
+        memoria->programa = malloc(sizeof(programa_por_defecto));
+        for (int i = 0; i < memoria->cantidad_instrucciones; i++) {
+            memoria->programa[i] = strdup(programa_por_defecto[i]);
+        }
+    }
+
+    logger = log_create("memoria_simulada.log", "MEMORIA_SIMULADA", true, LOG_LEVEL_INFO);
+    servidor = crear_servidor(direccion, trabajadores, atender_cpu, memoria, logger);
+    if (servidor == NULL) {
+        printf("\n[ERROR] No se pudo escuchar en %s\n", direccion);
+        exit(EXIT_FAILURE);
+    }
+    signal(SIGINT, terminar);
+    signal(SIGTERM, terminar);
+
+    esperar_servidor(servidor);
+    destruir_servidor(servidor);
+
+    for (int i = 0; i < memoria->cantidad_instrucciones; i++) {
+        free(memoria->programa[i]);
+    }
+    free(memoria->programa);
+    pthread_mutex_destroy(&memoria->mutex);
+    free(memoria);
+    log_destroy(logger);
+    return EXIT_SUCCESS;
+}
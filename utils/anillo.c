@@ -0,0 +1,285 @@
+#include <utils/anillo.h>
+#include <string.h>
+#include <errno.h>
+#include <fcntl.h>
+#include <sys/socket.h>
+#include <time.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <sys/syscall.h>
+#include <linux/futex.h>
+
+//-----------------------------FUTEX---------------------------------------
+
+//Duerme mientras *direccion valga esperado, como mucho MS_ENTRE_CHEQUEOS_DEL_SOCKET.
+//Sin FUTEX_PRIVATE_FLAG: la palabra esta en memoria compartida entre procesos
+static void dormir_en_futex(_Atomic uint32_t* direccion, uint32_t esperado)
+{
+	struct timespec espera = { .tv_sec = 0, .tv_nsec = MS_ENTRE_CHEQUEOS_DEL_SOCKET * 1000000L };
+	syscall(SYS_futex, (uint32_t*)direccion, FUTEX_WAIT, esperado, &espera, NULL, 0);
+}
+
+static void despertar_futex(_Atomic uint32_t* direccion)
+{
+	syscall(SYS_futex, (uint32_t*)direccion, FUTEX_WAKE, 1, NULL, NULL, 0);
+}
+
+static bool otro_extremo_vivo(t_anillo* anillo, int socket_control)
+{
+	if (atomic_load_explicit(&anillo->cerrado, memory_order_acquire)) return false;
+	if (socket_control == -1) return true;
+
+	//recv devuelve 0 solo si el otro extremo cerro la conexion
+	char byte;
+	return recv(socket_control, &byte, 1, MSG_PEEK | MSG_DONTWAIT) != 0;
+}
+
+//Espera a que *indice deje de valer visto. Primero gira y despues duerme avisando por durmiendo.
+//Devuelve false si el otro extremo cerro el canal
+static bool esperar_cambio(t_anillo* anillo, _Atomic uint32_t* indice, uint32_t visto, _Atomic uint32_t* durmiendo, int socket_control)
+{
+	for (int i = 0; i < VUELTAS_ANTES_DE_DORMIR; i++)
+	{
+		if (atomic_load_explicit(indice, memory_order_acquire) != visto) return true;
+	}
+
+	while (true)
+	{
+		//seq_cst de los dos lados: o el otro ve durmiendo en 1, o aca se ve el indice nuevo
+		atomic_store(durmiendo, 1);
+		if (atomic_load(indice) != visto)
+		{
+			atomic_store(durmiendo, 0);
+			return true;
+		}
+		dormir_en_futex(indice, visto);
+		atomic_store(durmiendo, 0);
+
+		if (atomic_load_explicit(indice, memory_order_acquire) != visto) return true;
+		if (!otro_extremo_vivo(anillo, socket_control)) return false;
+	}
+}
+
+static void avisar_cambio(_Atomic uint32_t* indice, _Atomic uint32_t* durmiendo)
+{
+	if (atomic_load(durmiendo))
+		despertar_futex(indice);
+}
+
+//-----------------------------CANAL---------------------------------------
+
+static size_t tamanio_anillo(uint32_t capacidad)
+{
+	return sizeof(t_anillo) + capacidad;
+}
+
+static char* datos_del_anillo(t_anillo* anillo)
+{
+	return (char*)(anillo + 1);
+}
+
+static void armar_canal(t_canal_compartido* canal, bool es_creador)
+{
+	t_anillo* primero = canal->region;
+	t_anillo* segundo = (t_anillo*)((char*)canal->region + tamanio_anillo(primero->capacidad));
+
+	//El que crea el canal escribe en el primero; el que lo abre, en el segundo
+	canal->salida = es_creador ? primero : segundo;
+	canal->entrada = es_creador ? segundo : primero;
+}
+
+//Crea el memfd con los dos anillos. capacidad_anillo se redondea a potencia de 2
+t_canal_compartido* crear_canal_compartido(uint32_t capacidad_anillo, int socket_control)
+{
+	uint32_t capacidad = 4096;
+	while (capacidad < capacidad_anillo)
+		capacidad <<= 1;
+
+	t_canal_compartido* canal = malloc(sizeof(t_canal_compartido));
+	canal->socket_control = socket_control;
+	canal->tamanio = 2 * tamanio_anillo(capacidad);
+	canal->memfd = syscall(SYS_memfd_create, "cpu_memoria", 0);
+	if (canal->memfd == -1 || ftruncate(canal->memfd, canal->tamanio) == -1)
+	{
+		perror("Error al crear el memfd del canal compartido");
+		if (canal->memfd != -1) close(canal->memfd);
+		free(canal);
+		return NULL;
+	}
+
+	canal->region = mmap(NULL, canal->tamanio, PROT_READ | PROT_WRITE, MAP_SHARED, canal->memfd, 0);
+	if (canal->region == MAP_FAILED)
+	{
+		perror("Error al mapear el canal compartido");
+		close(canal->memfd);
+		free(canal);
+		return NULL;
+	}
+
+	//ftruncate deja todo en 0: solo falta la capacidad de cada anillo
+	t_anillo* primero = canal->region;
+	t_anillo* segundo = (t_anillo*)((char*)canal->region + tamanio_anillo(capacidad));
+	primero->capacidad = capacidad;
+	segundo->capacidad = capacidad;
+	armar_canal(canal, true);
+	return canal;
+}
+
+//Los dos anillos tienen que ocupar justo lo que se anuncio en el handshake, con la misma capacidad potencia de 2:
+//si no, los indices del otro proceso caerian fuera de la region
+static bool canal_valido(void* region, size_t tamanio)
+{
+	t_anillo* primero = region;
+	uint32_t capacidad = primero->capacidad;
+	if (capacidad == 0 || (capacidad & (capacidad - 1)) != 0 || 2 * tamanio_anillo(capacidad) != tamanio) return false;
+
+	t_anillo* segundo = (t_anillo*)((char*)region + tamanio_anillo(capacidad));
+	return segundo->capacidad == capacidad;
+}
+
+//Lado del servidor: abre el memfd que anuncio el proceso pid en el handshake.
+//Devuelve NULL si no se puede abrir o si no es un canal armado por crear_canal_compartido()
+t_canal_compartido* abrir_canal_compartido(int pid, int memfd, size_t tamanio, int socket_control)
+{
+	char ruta[64];
+	snprintf(ruta, sizeof(ruta), "/proc/%d/fd/%d", pid, memfd);
+
+	t_canal_compartido* canal = malloc(sizeof(t_canal_compartido));
+	canal->socket_control = socket_control;
+	canal->tamanio = tamanio;
+	canal->memfd = open(ruta, O_RDWR | O_CLOEXEC);
+	if (canal->memfd == -1)
+	{
+		perror("Error al abrir el memfd del canal compartido");
+		free(canal);
+		return NULL;
+	}
+
+	//Mapear mas de lo que mide el memfd daria SIGBUS al tocar la parte que sobra
+	struct stat estado;
+	if (tamanio < 2 * sizeof(t_anillo) || fstat(canal->memfd, &estado) == -1 || (size_t)estado.st_size != tamanio)
+	{
+		printf("\n[ERROR] El memfd del canal compartido del proceso %d no mide los %zu bytes anunciados \n\n", pid, tamanio);
+		close(canal->memfd);
+		free(canal);
+		return NULL;
+	}
+
+	canal->region = mmap(NULL, tamanio, PROT_READ | PROT_WRITE, MAP_SHARED, canal->memfd, 0);
+	if (canal->region == MAP_FAILED)
+	{
+		perror("Error al mapear el canal compartido");
+		close(canal->memfd);
+		free(canal);
+		return NULL;
+	}
+
+	if (!canal_valido(canal->region, tamanio))
+	{
+		printf("\n[ERROR] El canal compartido del proceso %d no tiene dos anillos de %zu bytes en total \n\n", pid, tamanio);
+		munmap(canal->region, tamanio);
+		close(canal->memfd);
+		free(canal);
+		return NULL;
+	}
+
+	armar_canal(canal, false);
+	return canal;
+}
+
+//Escribe todos los bytes de iov en el anillo, esperando lugar si hace falta (un mensaje puede ser mas
+//grande que el anillo: el consumidor lo va leyendo por partes). Devuelve 0 o -1 si el otro extremo cerro
+int escribir_en_anillo(t_anillo* anillo, struct iovec* iov, int cantidad, int socket_control)
+{
+	char* datos = datos_del_anillo(anillo);
+	uint32_t mascara = anillo->capacidad - 1;
+	uint32_t cabeza = atomic_load_explicit(&anillo->cabeza, memory_order_relaxed);
+
+	for (int i = 0; i < cantidad; i++)
+	{
+		char* origen = iov[i].iov_base;
+		size_t pendientes = iov[i].iov_len;
+
+		while (pendientes > 0)
+		{
+			uint32_t cola = atomic_load_explicit(&anillo->cola, memory_order_acquire);
+			uint32_t libres = anillo->capacidad - (cabeza - cola);
+			if (libres == 0)
+			{
+				if (!esperar_cambio(anillo, &anillo->cola, cola, &anillo->productor_durmiendo, socket_control))
+					return -1;
+				continue;
+			}
+
+			uint32_t desde = cabeza & mascara;
+			uint32_t copiar = pendientes < libres ? pendientes : libres;
+			uint32_t hasta_el_final = anillo->capacidad - desde;
+			if (copiar <= hasta_el_final)
+			{
+				memcpy(datos + desde, origen, copiar);
+			}
+			else
+			{
+				memcpy(datos + desde, origen, hasta_el_final);
+				memcpy(datos, origen + hasta_el_final, copiar - hasta_el_final);
+			}
+
+			cabeza += copiar;
+			origen += copiar;
+			pendientes -= copiar;
+			atomic_store(&anillo->cabeza, cabeza);
+			avisar_cambio(&anillo->cabeza, &anillo->consumidor_durmiendo);
+		}
+	}
+	return 0;
+}
+
+//Como recv(): espera a que haya algo y copia hasta maximo bytes. Devuelve lo leido, o 0 si el otro extremo cerro
+int leer_de_anillo(t_anillo* anillo, void* destino, int maximo, int socket_control)
+{
+	char* datos = datos_del_anillo(anillo);
+	uint32_t mascara = anillo->capacidad - 1;
+	uint32_t cola = atomic_load_explicit(&anillo->cola, memory_order_relaxed);
+	uint32_t cabeza = atomic_load_explicit(&anillo->cabeza, memory_order_acquire);
+
+	while (cabeza == cola)
+	{
+		if (!esperar_cambio(anillo, &anillo->cabeza, cabeza, &anillo->consumidor_durmiendo, socket_control))
+			return 0;
+		cabeza = atomic_load_explicit(&anillo->cabeza, memory_order_acquire);
+	}
+
+	uint32_t disponibles = cabeza - cola;
+	uint32_t copiar = (uint32_t)maximo < disponibles ? (uint32_t)maximo : disponibles;
+	uint32_t desde = cola & mascara;
+	uint32_t hasta_el_final = anillo->capacidad - desde;
+	if (copiar <= hasta_el_final)
+	{
+		memcpy(destino, datos + desde, copiar);
+	}
+	else
+	{
+		memcpy(destino, datos + desde, hasta_el_final);
+		memcpy((char*)destino + hasta_el_final, datos, copiar - hasta_el_final);
+	}
+
+	atomic_store(&anillo->cola, cola + copiar);
+	avisar_cambio(&anillo->cola, &anillo->productor_durmiendo);
+	return copiar;
+}
+
+//Marca los dos anillos como cerrados, despierta a quien este esperando y libera el mapeo
+void cerrar_canal_compartido(t_canal_compartido* canal)
+{
+	if (canal == NULL) return;
+
+	atomic_store(&canal->salida->cerrado, 1);
+	atomic_store(&canal->entrada->cerrado, 1);
+	despertar_futex(&canal->salida->cola);
+	despertar_futex(&canal->entrada->cabeza);
+
+	munmap(canal->region, canal->tamanio);
+	close(canal->memfd);
+	free(canal);
+}
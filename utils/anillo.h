@@ -0,0 +1,45 @@
+#ifndef ANILLO_H_
+#define ANILLO_H_
+
+#include <stdlib.h>
+#include <stdio.h>
+#include <stdint.h>
+#include <stdbool.h>
+#include <stdatomic.h>
+#include <sys/uio.h>
+
+//-------------Anillos en memoria compartida--------------------
+// Un canal son dos anillos de un solo productor y un solo consumidor (uno por sentido)
+// dentro de un memfd. Por cada anillo viajan los mismos bytes que por el socket
+// ([op_code][size][stream]); el que espera datos o lugar gira un rato y despues
+// duerme en un futex sobre el indice que mueve el otro extremo.
+// El otro proceso abre el memfd por /proc/<pid>/fd/<fd>, asi no hace falta pasar fds.
+#define TAMANIO_LINEA_CACHE 64
+#define VUELTAS_ANTES_DE_DORMIR 2000
+#define MS_ENTRE_CHEQUEOS_DEL_SOCKET 500 //cada cuanto el que duerme revisa que el otro extremo siga vivo
+
+typedef struct {
+	_Alignas(TAMANIO_LINEA_CACHE) _Atomic uint32_t cabeza;  //bytes escritos (solo lo mueve el productor)
+	_Atomic uint32_t consumidor_durmiendo;
+	_Alignas(TAMANIO_LINEA_CACHE) _Atomic uint32_t cola;    //bytes leidos (solo lo mueve el consumidor)
+	_Atomic uint32_t productor_durmiendo;
+	_Alignas(TAMANIO_LINEA_CACHE) uint32_t capacidad;       //potencia de 2
+	_Atomic uint32_t cerrado;
+} t_anillo; //los datos van a continuacion de la cabecera
+
+typedef struct {
+	int memfd;
+	void* region;
+	size_t tamanio;
+	int socket_control; //conexion por la que se negocio el canal, para detectar que el otro extremo murio
+	t_anillo* salida;
+	t_anillo* entrada;
+} t_canal_compartido;
+
+t_canal_compartido* crear_canal_compartido(uint32_t capacidad_anillo, int socket_control);
+t_canal_compartido* abrir_canal_compartido(int pid, int memfd, size_t tamanio, int socket_control);
+int escribir_en_anillo(t_anillo* anillo, struct iovec* iov, int cantidad, int socket_control);
+int leer_de_anillo(t_anillo* anillo, void* destino, int maximo, int socket_control);
+void cerrar_canal_compartido(t_canal_compartido* canal);
+
+#endif
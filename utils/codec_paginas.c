@@ -0,0 +1,148 @@
+#include <utils/codec_paginas.h>
+#include <string.h>
+
+//Vector de 32 bytes con las extensiones de GCC: compila a SSE2/AVX2/NEON segun la arquitectura
+typedef uint64_t t_bloque_vectorial __attribute__((vector_size(32)));
+
+//OR de bloques de 128 bytes, mirando el resultado una vez por bloque
+bool pagina_en_cero(const void* pagina, int tamanio)
+{
+	const char* bytes = pagina;
+	int i = 0;
+
+	for (; i + 128 <= tamanio; i += 128)
+	{
+		t_bloque_vectorial a, b, c, d;
+		memcpy(&a, bytes + i, 32);
+		memcpy(&b, bytes + i + 32, 32);
+		memcpy(&c, bytes + i + 64, 32);
+		memcpy(&d, bytes + i + 96, 32);
+		t_bloque_vectorial acumulado = (a | b) | (c | d);
+		if ((acumulado[0] | acumulado[1] | acumulado[2] | acumulado[3]) != 0)
+			return false;
+	}
+
+	for (; i < tamanio; i++)
+	{
+		if (bytes[i] != 0) return false;
+	}
+	return true;
+}
+
+int largo_del_tramo(const unsigned char* bytes, int desde, int tamanio)
+{
+	int hasta = desde + 1;
+	while (hasta < tamanio && bytes[hasta] == bytes[desde] && hasta - desde < MAXIMO_TRAMO)
+		hasta++;
+	return hasta - desde;
+}
+
+//Escribe la pagina codificada en destino (de al menos TAMANIO_MAXIMO_CODIFICADA bytes) y devuelve su largo
+int codificar_pagina(const void* pagina, int tamanio, void* destino)
+{
+	const unsigned char* bytes = pagina;
+	unsigned char* salida = destino;
+
+	if (pagina_en_cero(pagina, tamanio))
+	{
+		salida[0] = PAGINA_EN_CERO;
+		return 1;
+	}
+
+	salida[0] = PAGINA_RLE;
+	int escritos = 1;
+	int i = 0;
+	bool achica = true;
+	while (achica && i < tamanio)
+	{
+		int repetidos = largo_del_tramo(bytes, i, tamanio);
+		if (repetidos >= MINIMO_TRAMO_REPETIDO)
+		{
+			if (escritos + 3 > tamanio)
+			{
+				achica = false;
+				break;
+			}
+			int16_t n = -repetidos;
+			memcpy(salida + escritos, &n, sizeof(n));
+			salida[escritos + 2] = bytes[i];
+			escritos += 3;
+			i += repetidos;
+			continue;
+		}
+
+		//Literales hasta el proximo tramo que valga la pena repetir
+		int inicio = i;
+		while (i < tamanio && i - inicio < MAXIMO_TRAMO && largo_del_tramo(bytes, i, tamanio) < MINIMO_TRAMO_REPETIDO)
+			i++;
+		int16_t n = i - inicio;
+		if (escritos + 2 + n > tamanio)
+		{
+			achica = false;
+			break;
+		}
+		memcpy(salida + escritos, &n, sizeof(n));
+		memcpy(salida + escritos + 2, bytes + inicio, n);
+		escritos += 2 + n;
+	}
+
+	if (!achica) //RLE no achica: va cruda
+	{
+		salida[0] = PAGINA_CRUDA;
+		memcpy(salida + 1, pagina, tamanio);
+		return tamanio + 1;
+	}
+	return escritos;
+}
+
+//Reconstruye en pagina los tamanio bytes codificados. Devuelve false si la codificacion no es valida
+bool decodificar_pagina(const void* codificada, int largo, void* pagina, int tamanio)
+{
+	const unsigned char* entrada = codificada;
+	unsigned char* bytes = pagina;
+	if (largo < 1) return false;
+
+	switch (entrada[0])
+	{
+		case PAGINA_EN_CERO:
+		memset(pagina, 0, tamanio);
+		return largo == 1;
+
+		case PAGINA_CRUDA:
+		if (largo != tamanio + 1) return false;
+		memcpy(pagina, entrada + 1, tamanio);
+		return true;
+
+		case PAGINA_RLE:
+		{
+			int leidos = 1;
+			int escritos = 0;
+			while (leidos < largo)
+			{
+				int16_t n;
+				if (leidos + 2 > largo) return false;
+				memcpy(&n, entrada + leidos, sizeof(n));
+				leidos += 2;
+
+				if (n < 0)
+				{
+					if (leidos + 1 > largo || escritos - n > tamanio) return false;
+					memset(bytes + escritos, entrada[leidos], -n);
+					escritos -= n;
+					leidos += 1;
+				}
+				else
+				{
+					if (leidos + n > largo || escritos + n > tamanio) return false;
+					memcpy(bytes + escritos, entrada + leidos, n);
+					escritos += n;
+					leidos += n;
+				}
+			}
+			return escritos == tamanio;
+		}
+
+		default:
+		return false;
+	}
+}
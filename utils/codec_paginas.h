@@ -0,0 +1,29 @@
+#ifndef CODEC_PAGINAS_H_
+#define CODEC_PAGINAS_H_
+
+#include <stdlib.h>
+#include <stdint.h>
+#include <stdbool.h>
+
+//-------------Codec de paginas--------------------
+// Una pagina codificada empieza con un byte de formato:
+//   PAGINA_EN_CERO  sin datos: la pagina entera son ceros
+//   PAGINA_RLE      tramos [int16 n]: n > 0 son n bytes literales a continuacion,
+//                   n < 0 es el byte siguiente repetido -n veces
+//   PAGINA_CRUDA    los bytes de la pagina tal cual (cuando RLE no achica)
+// Se usa solo si las dos puntas lo acordaron en el handshake (CAPACIDAD_CODEC_PAGINAS).
+typedef enum {
+	PAGINA_EN_CERO,
+	PAGINA_RLE,
+	PAGINA_CRUDA
+} t_formato_pagina;
+
+#define MINIMO_TRAMO_REPETIDO 4 //tramos mas cortos van como literales
+#define MAXIMO_TRAMO 32767
+#define TAMANIO_MAXIMO_CODIFICADA(tamanio_pagina) ((tamanio_pagina) + 1)
+
+bool pagina_en_cero(const void* pagina, int tamanio);
+int codificar_pagina(const void* pagina, int tamanio, void* destino);
+bool decodificar_pagina(const void* codificada, int largo, void* pagina, int tamanio);
+
+#endif
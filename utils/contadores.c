@@ -0,0 +1,82 @@
+#include <utils/contadores.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <pthread.h>
+
+static __thread t_contadores_protocolo* contadores_hilo = NULL;
+
+static t_contadores_protocolo* _Atomic primeros_contadores = NULL;
+static pthread_mutex_t mutex_contadores = PTHREAD_MUTEX_INITIALIZER;
+
+//Crea el bloque del hilo y lo agrega adelante de la lista; el que lee la recorre sin lock desde la cabeza
+static t_contadores_protocolo* contadores_del_hilo(void)
+{
+	if (contadores_hilo != NULL) return contadores_hilo;
+
+	t_contadores_protocolo* contadores = calloc(1, sizeof(t_contadores_protocolo));
+	if (contadores == NULL)
+	{
+		perror("Error al reservar los contadores del protocolo");
+		exit(EXIT_FAILURE);
+	}
+	pthread_mutex_lock(&mutex_contadores);
+	contadores->siguiente = atomic_load_explicit(&primeros_contadores, memory_order_relaxed);
+	atomic_store_explicit(&primeros_contadores, contadores, memory_order_release);
+	pthread_mutex_unlock(&mutex_contadores);
+
+	contadores_hilo = contadores;
+	return contadores;
+}
+
+static int indice_de_codigo(int cod_op)
+{
+	return (unsigned)cod_op < CODIGOS_CONTADOS ? cod_op : CODIGOS_CONTADOS - 1;
+}
+
+void contar_envio(int cod_op, int bytes)
+{
+	t_contadores_protocolo* contadores = contadores_del_hilo();
+	int i = indice_de_codigo(cod_op);
+	SUMAR_CONTADOR(contadores->mensajes_enviados[i], 1);
+	SUMAR_CONTADOR(contadores->bytes_enviados[i], bytes);
+}
+
+void contar_recepcion(int cod_op, int bytes)
+{
+	t_contadores_protocolo* contadores = contadores_del_hilo();
+	int i = indice_de_codigo(cod_op);
+	SUMAR_CONTADOR(contadores->mensajes_recibidos[i], 1);
+	SUMAR_CONTADOR(contadores->bytes_recibidos[i], bytes);
+}
+
+//Suma los contadores de todos los hilos. Lo que sigue sumando otro hilo mientras tanto puede quedar afuera
+void sumar_contadores_protocolo(t_totales_protocolo* totales)
+{
+	memset(totales, 0, sizeof(t_totales_protocolo));
+	for (t_contadores_protocolo* contadores = atomic_load_explicit(&primeros_contadores, memory_order_acquire); contadores != NULL; contadores = contadores->siguiente)
+	{
+		for (int i = 0; i < CODIGOS_CONTADOS; i++)
+		{
+			totales->mensajes_enviados[i] += LEER_CONTADOR(contadores->mensajes_enviados[i]);
+			totales->bytes_enviados[i] += LEER_CONTADOR(contadores->bytes_enviados[i]);
+			totales->mensajes_recibidos[i] += LEER_CONTADOR(contadores->mensajes_recibidos[i]);
+			totales->bytes_recibidos[i] += LEER_CONTADOR(contadores->bytes_recibidos[i]);
+		}
+	}
+}
+
+//Se llama al cerrar el proceso, cuando ya no queda ningun hilo que envie o reciba
+void destruir_contadores_protocolo(void)
+{
+	pthread_mutex_lock(&mutex_contadores);
+	t_contadores_protocolo* contadores = atomic_exchange(&primeros_contadores, NULL);
+	pthread_mutex_unlock(&mutex_contadores);
+	while (contadores != NULL)
+	{
+		t_contadores_protocolo* siguiente = contadores->siguiente;
+		free(contadores);
+		contadores = siguiente;
+	}
+	contadores_hilo = NULL;
+}
@@ -0,0 +1,44 @@
+#ifndef CONTADORES_H_
+#define CONTADORES_H_
+
+#include <stdint.h>
+#include <stdatomic.h>
+
+//-------------Contadores del protocolo por hilo--------------------
+// Mensajes y bytes (cabecera incluida) enviados y recibidos por codigo de operacion.
+// Cada hilo suma en su propio bloque, que se anota en una lista global la primera vez:
+// solo lo escribe su hilo, asi que sumar es un load y un store sin lock ni instruccion atomica.
+// Otro hilo puede leerlos en cualquier momento con sumar_contadores_protocolo().
+// Los bloques de los hilos que terminaron siguen en la lista hasta destruir_contadores_protocolo().
+#define CODIGOS_CONTADOS 64 //los codigos de mas van al ultimo
+
+typedef _Atomic uint64_t t_contador;
+
+//Un solo hilo escribe cada contador: no hace falta fetch_add
+#define SUMAR_CONTADOR(contador, valor) \
+	atomic_store_explicit(&(contador), atomic_load_explicit(&(contador), memory_order_relaxed) + (valor), memory_order_relaxed)
+#define LEER_CONTADOR(contador) atomic_load_explicit(&(contador), memory_order_relaxed)
+
+typedef struct t_contadores_protocolo
+{
+	t_contador mensajes_enviados[CODIGOS_CONTADOS];
+	t_contador bytes_enviados[CODIGOS_CONTADOS];
+	t_contador mensajes_recibidos[CODIGOS_CONTADOS];
+	t_contador bytes_recibidos[CODIGOS_CONTADOS];
+	struct t_contadores_protocolo* siguiente;
+} t_contadores_protocolo;
+
+typedef struct
+{
+	uint64_t mensajes_enviados[CODIGOS_CONTADOS];
+	uint64_t bytes_enviados[CODIGOS_CONTADOS];
+	uint64_t mensajes_recibidos[CODIGOS_CONTADOS];
+	uint64_t bytes_recibidos[CODIGOS_CONTADOS];
+} t_totales_protocolo;
+
+void contar_envio(int cod_op, int bytes);
+void contar_recepcion(int cod_op, int bytes);
+void sumar_contadores_protocolo(t_totales_protocolo* totales);
+void destruir_contadores_protocolo(void);
+
+#endif
@@ -0,0 +1,329 @@
+#include <utils/eventos.h>
+#include <sys/timerfd.h>
+#include <errno.h>
+
+#define MAX_EVENTOS_POR_VUELTA 64
+
+//-----------------------------BUCLE DE EVENTOS---------------------------------------
+
+t_bucle_eventos* crear_bucle_eventos(void)
+{
+	t_bucle_eventos* bucle = malloc(sizeof(t_bucle_eventos));
+	if (bucle == NULL)
+	{
+		perror("Error al reservar el bucle de eventos");
+		exit(EXIT_FAILURE);
+	}
+	bucle->epoll_fd = epoll_create1(EPOLL_CLOEXEC);
+	if (bucle->epoll_fd == -1)
+	{
+		perror("Error al crear el epoll del bucle de eventos");
+		exit(EXIT_FAILURE);
+	}
+	bucle->corriendo = false;
+	bucle->registros = list_create();
+	bucle->descartados = 0;
+	return bucle;
+}
+
+//Registra un fd para que el bucle llame al manejador cuando tenga alguno de los eventos pedidos.
+//Con eventos en 0 queda registrado pero sin avisar, hasta un cambiar_eventos()
+t_registro_evento* registrar_en_bucle(t_bucle_eventos* bucle, int fd, uint32_t eventos, t_manejador_evento manejador, void* dato)
+{
+	t_registro_evento* registro = malloc(sizeof(t_registro_evento));
+	if (registro == NULL)
+	{
+		perror("Error al reservar un registro del bucle de eventos");
+		return NULL;
+	}
+	registro->fd = fd;
+	registro->eventos = eventos;
+	registro->es_temporizador = false;
+	registro->activo = true;
+	registro->descartado = false;
+	registro->manejador = manejador;
+	registro->dato = dato;
+
+	struct epoll_event evento = { .events = eventos, .data.ptr = registro };
+	if (eventos != 0 && epoll_ctl(bucle->epoll_fd, EPOLL_CTL_ADD, fd, &evento) == -1)
+	{
+		perror("Error al registrar un fd en el bucle de eventos");
+		free(registro);
+		return NULL;
+	}
+
+	list_add(bucle->registros, registro);
+	return registro;
+}
+
+void cambiar_eventos(t_bucle_eventos* bucle, t_registro_evento* registro, uint32_t eventos)
+{
+	if (!registro->activo || registro->eventos == eventos) return;
+
+	//Sin eventos se saca del epoll: si no, EPOLLHUP/EPOLLERR se siguen reportando igual
+	int operacion = EPOLL_CTL_MOD;
+	if (eventos == 0)
+		operacion = EPOLL_CTL_DEL;
+	else if (registro->eventos == 0)
+		operacion = EPOLL_CTL_ADD;
+
+	registro->eventos = eventos;
+	struct epoll_event evento = { .events = eventos, .data.ptr = registro };
+	epoll_ctl(bucle->epoll_fd, operacion, registro->fd, &evento);
+}
+
+//El registro se libera recien al destruir el bucle: puede haber eventos suyos ya leidos en esta vuelta
+void quitar_del_bucle(t_bucle_eventos* bucle, t_registro_evento* registro)
+{
+	if (!registro->activo) return;
+
+	if (registro->eventos != 0)
+		epoll_ctl(bucle->epoll_fd, EPOLL_CTL_DEL, registro->fd, NULL);
+	registro->activo = false;
+	if (registro->es_temporizador)
+	{
+		close(registro->fd);
+	}
+}
+
+//Como quitar_del_bucle(), pero el registro se libera al terminar la vuelta en curso y no se puede volver a usar.
+//Es para los fd que van y vienen con el bucle corriendo (los clientes de un servidor), que si no se acumulan
+void descartar_del_bucle(t_bucle_eventos* bucle, t_registro_evento* registro)
+{
+	quitar_del_bucle(bucle, registro);
+	if (registro->descartado) return;
+	registro->descartado = true;
+	bucle->descartados++;
+}
+
+void liberar_descartados(t_bucle_eventos* bucle)
+{
+	for (int i = list_size(bucle->registros) - 1; i >= 0 && bucle->descartados > 0; i--)
+	{
+		t_registro_evento* registro = list_get(bucle->registros, i);
+		if (!registro->descartado) continue;
+		list_remove(bucle->registros, i);
+		free(registro);
+		bucle->descartados--;
+	}
+}
+
+t_registro_evento* crear_temporizador(t_bucle_eventos* bucle, t_manejador_evento manejador, void* dato)
+{
+	int fd = timerfd_create(CLOCK_MONOTONIC, TFD_NONBLOCK | TFD_CLOEXEC);
+	if (fd == -1)
+	{
+		perror("Error al crear el temporizador");
+		return NULL;
+	}
+
+	t_registro_evento* temporizador = registrar_en_bucle(bucle, fd, EPOLLIN, manejador, dato);
+	if (temporizador == NULL)
+	{
+		close(fd);
+		return NULL;
+	}
+	temporizador->es_temporizador = true;
+	return temporizador;
+}
+
+//Arma el temporizador para que dispare una sola vez dentro de los milisegundos indicados (0 lo desarma)
+void armar_temporizador(t_registro_evento* temporizador, int milisegundos)
+{
+	struct itimerspec tiempo = { 0 };
+	tiempo.it_value.tv_sec = milisegundos / 1000;
+	tiempo.it_value.tv_nsec = (long)(milisegundos % 1000) * 1000000L;
+	timerfd_settime(temporizador->fd, 0, &tiempo, NULL);
+}
+
+void correr_bucle_eventos(t_bucle_eventos* bucle)
+{
+	struct epoll_event eventos[MAX_EVENTOS_POR_VUELTA];
+	bucle->corriendo = true;
+
+	while (bucle->corriendo)
+	{
+		int cantidad = epoll_wait(bucle->epoll_fd, eventos, MAX_EVENTOS_POR_VUELTA, -1);
+		if (cantidad == -1)
+		{
+			if (errno == EINTR) continue;
+			perror("Error en epoll_wait del bucle de eventos");
+			break;
+		}
+
+		for (int i = 0; i < cantidad && bucle->corriendo; i++)
+		{
+			t_registro_evento* registro = eventos[i].data.ptr;
+			if (!registro->activo) continue;
+
+			if (registro->es_temporizador)
+			{
+				uint64_t vencimientos;
+				if (read(registro->fd, &vencimientos, sizeof(vencimientos)) <= 0) continue;
+			}
+			registro->manejador(registro->dato);
+		}
+
+		if (bucle->descartados > 0)
+			liberar_descartados(bucle);
+	}
+}
+
+void detener_bucle_eventos(t_bucle_eventos* bucle)
+{
+	bucle->corriendo = false;
+}
+
+void destruir_bucle_eventos(t_bucle_eventos* bucle)
+{
+	for (int i = 0; i < list_size(bucle->registros); i++)
+	{
+		quitar_del_bucle(bucle, list_get(bucle->registros, i));
+	}
+	list_destroy_and_destroy_elements(bucle->registros, free);
+	close(bucle->epoll_fd);
+	free(bucle);
+}
+
+//-----------------------------CONEXIONES ENMARCADAS---------------------------------------
+
+void cerrar_conexion_eventos(t_conexion_eventos* conexion)
+{
+	conexion->cerrada = true;
+	quitar_del_bucle(conexion->bucle, conexion->registro);
+	eliminar_buffer(conexion->buffer);
+	conexion->buffer = NULL;
+	close(conexion->socket);
+	conexion->al_recibir(conexion->dato, -1, NULL);
+}
+
+//Lee todo lo disponible en el socket, entregando cada mensaje apenas se completa
+void leer_conexion_eventos(void* dato)
+{
+	t_conexion_eventos* conexion = dato;
+
+	while (!conexion->cerrada && (conexion->registro->eventos & EPOLLIN))
+	{
+		void* destino;
+		int faltan;
+
+		if (conexion->leidos_cabecera < (int)sizeof(conexion->cabecera))
+		{
+			destino = (char*)conexion->cabecera + conexion->leidos_cabecera;
+			faltan = sizeof(conexion->cabecera) - conexion->leidos_cabecera;
+		}
+		else
+		{
+			destino = conexion->buffer->stream + conexion->leidos_payload;
+			faltan = conexion->buffer->size - conexion->leidos_payload;
+		}
+
+		if (faltan > 0)
+		{
+			ssize_t leidos = recv(conexion->socket, destino, faltan, MSG_DONTWAIT);
+			if (leidos == -1 && errno == EINTR) continue;
+			if (leidos == -1 && (errno == EAGAIN || errno == EWOULDBLOCK)) return;
+			if (leidos <= 0)
+			{
+				cerrar_conexion_eventos(conexion);
+				return;
+			}
+
+			if (conexion->leidos_cabecera < (int)sizeof(conexion->cabecera))
+				conexion->leidos_cabecera += leidos;
+			else
+				conexion->leidos_payload += leidos;
+		}
+
+		if (conexion->leidos_cabecera == (int)sizeof(conexion->cabecera) && conexion->buffer == NULL)
+		{
+			if (conexion->cabecera[1] < 0)
+			{
+				printf("\n[ERROR] Mensaje con size negativo en el socket %d \n\n", conexion->socket);
+				cerrar_conexion_eventos(conexion);
+				return;
+			}
+			conexion->buffer = crear_buffer();
+			conexion->buffer->size = conexion->cabecera[1];
+			if (conexion->cabecera[1] > 0)
+			{
+				conexion->buffer->stream = malloc(conexion->cabecera[1]);
+				conexion->buffer->capacidad = conexion->cabecera[1];
+			}
+			conexion->leidos_payload = 0;
+		}
+
+		if (conexion->buffer != NULL && conexion->leidos_payload == conexion->buffer->size)
+		{
+			int cod_op = conexion->cabecera[0];
+			t_buffer* buffer = conexion->buffer;
+
+			conexion->buffer = NULL;
+			conexion->leidos_cabecera = 0;
+			conexion->leidos_payload = 0;
+			contar_recepcion(cod_op, TAMANIO_CABECERA_PAQUETE + buffer->size);
+			conexion->al_recibir(conexion->dato, cod_op, buffer);
+		}
+	}
+}
+
+//Devuelve NULL si no se pudo reservar o registrar en el bucle; el socket queda abierto y es del que llama
+t_conexion_eventos* crear_conexion_eventos(t_bucle_eventos* bucle, int socket, t_manejador_mensaje al_recibir, void* dato)
+{
+	t_conexion_eventos* conexion = malloc(sizeof(t_conexion_eventos));
+	if (conexion == NULL)
+	{
+		perror("Error al reservar una conexion del bucle de eventos");
+		return NULL;
+	}
+	conexion->socket = socket;
+	conexion->leidos_cabecera = 0;
+	conexion->buffer = NULL;
+	conexion->leidos_payload = 0;
+	conexion->cerrada = false;
+	conexion->bucle = bucle;
+	conexion->al_recibir = al_recibir;
+	conexion->dato = dato;
+	conexion->registro = registrar_en_bucle(bucle, socket, EPOLLIN, leer_conexion_eventos, conexion);
+	if (conexion->registro == NULL)
+	{
+		free(conexion);
+		return NULL;
+	}
+	return conexion;
+}
+
+//Deja de leer mensajes de la conexion; los que lleguen quedan esperando en el socket
+void pausar_conexion_eventos(t_conexion_eventos* conexion)
+{
+	if (!conexion->cerrada)
+		cambiar_eventos(conexion->bucle, conexion->registro, 0);
+}
+
+void reanudar_conexion_eventos(t_conexion_eventos* conexion)
+{
+	if (!conexion->cerrada)
+		cambiar_eventos(conexion->bucle, conexion->registro, EPOLLIN);
+}
+
+void destruir_conexion_eventos(t_conexion_eventos* conexion)
+{
+	if (!conexion->cerrada)
+	{
+		quitar_del_bucle(conexion->bucle, conexion->registro);
+		close(conexion->socket);
+	}
+	eliminar_buffer(conexion->buffer);
+	free(conexion);
+}
+
+//Como destruir_conexion_eventos(), para una conexion que se termina con el bucle corriendo: su registro
+//se libera al terminar la vuelta
+void descartar_conexion_eventos(t_conexion_eventos* conexion)
+{
+	descartar_del_bucle(conexion->bucle, conexion->registro);
+	if (!conexion->cerrada)
+		close(conexion->socket);
+	eliminar_buffer(conexion->buffer);
+	free(conexion);
+}
@@ -0,0 +1,66 @@
+#ifndef EVENTOS_H_
+#define EVENTOS_H_
+
+#include <stdlib.h>
+#include <stdio.h>
+#include <stdint.h>
+#include <sys/epoll.h>
+#include <utils/utils.h>
+
+//-------------Bucle de eventos (epoll)--------------------
+typedef void (*t_manejador_evento)(void* dato);
+
+typedef struct {
+	int fd;
+	uint32_t eventos;
+	bool es_temporizador;
+	bool activo;
+	bool descartado;
+	t_manejador_evento manejador;
+	void* dato;
+} t_registro_evento;
+
+typedef struct {
+	int epoll_fd;
+	bool corriendo;
+	t_list* registros;
+	int descartados; //registros a liberar al terminar la vuelta
+} t_bucle_eventos;
+
+t_bucle_eventos* crear_bucle_eventos(void);
+t_registro_evento* registrar_en_bucle(t_bucle_eventos* bucle, int fd, uint32_t eventos, t_manejador_evento manejador, void* dato);
+void cambiar_eventos(t_bucle_eventos* bucle, t_registro_evento* registro, uint32_t eventos);
+void quitar_del_bucle(t_bucle_eventos* bucle, t_registro_evento* registro);
+void descartar_del_bucle(t_bucle_eventos* bucle, t_registro_evento* registro);
+t_registro_evento* crear_temporizador(t_bucle_eventos* bucle, t_manejador_evento manejador, void* dato);
+void armar_temporizador(t_registro_evento* temporizador, int milisegundos);
+void correr_bucle_eventos(t_bucle_eventos* bucle);
+void detener_bucle_eventos(t_bucle_eventos* bucle);
+void destruir_bucle_eventos(t_bucle_eventos* bucle);
+
+//-------------Conexiones con mensajes enmarcados--------------------
+// Lee [op_code][size][stream] sin bloquear y entrega cada mensaje completo.
+// El manejador recibe cod_op -1 y buffer NULL cuando el otro extremo se desconecta,
+// y es dueño del buffer que recibe.
+typedef void (*t_manejador_mensaje)(void* dato, int cod_op, t_buffer* buffer);
+
+typedef struct {
+	int socket;
+	int cabecera[2];
+	int leidos_cabecera;
+	t_buffer* buffer;
+	int leidos_payload;
+	bool cerrada;
+	t_bucle_eventos* bucle;
+	t_registro_evento* registro;
+	t_manejador_mensaje al_recibir;
+	void* dato;
+} t_conexion_eventos;
+
+t_conexion_eventos* crear_conexion_eventos(t_bucle_eventos* bucle, int socket, t_manejador_mensaje al_recibir, void* dato);
+void pausar_conexion_eventos(t_conexion_eventos* conexion);
+void reanudar_conexion_eventos(t_conexion_eventos* conexion);
+void destruir_conexion_eventos(t_conexion_eventos* conexion);
+void descartar_conexion_eventos(t_conexion_eventos* conexion);
+
+#endif
@@ -0,0 +1,444 @@
+#include <utils/log_diferido.h>
+#include <stdio.h>
+#include <string.h>
+#include <stdarg.h>
+#include <time.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/syscall.h>
+
+#define TAMANIO_TANDA_LOG 65536
+#define LARGO_MAXIMO_LINEA 4096
+#define ALINEAR_A_8(bytes) (((bytes) + 7) & ~7u)
+
+//Cada registro del anillo: la cabecera y despues un slot de 8 bytes por argumento
+//(los strings van como [uint32 largo][bytes] redondeado a 8). Nunca da la vuelta al anillo:
+//si no entra hasta el final se deja un relleno y se escribe desde el principio
+typedef struct
+{
+	t_formato_log* formato; //NULL: relleno hasta el final del anillo
+	uint32_t tamanio;       //bytes del registro, multiplo de 8
+	uint32_t hilo;
+	int64_t tiempo_ns;      //CLOCK_REALTIME, para la hora de la linea
+} t_cabecera_log;
+
+static __thread t_anillo_log* anillo_del_hilo = NULL;
+static __thread t_log_diferido* duenio_del_anillo = NULL;
+static __thread uint32_t id_del_hilo = 0;
+
+//-----------------------------LADO DEL HILO QUE LOGUEA---------------------------------------
+
+//Devuelve la cantidad de argumentos del formato, o -2 si usa algo que no se puede diferir (*, %n, long double...)
+static int analizar_formato_log(t_formato_log* formato)
+{
+	int cantidad = 0;
+	for (const char* p = formato->formato; *p != '\0'; p++)
+	{
+		if (*p != '%') continue;
+		p++;
+		if (*p == '%') continue;
+
+		while (*p != '\0' && strchr("-+ #0123456789.", *p) != NULL) p++;
+		bool largo = false;
+		while (*p != '\0' && strchr("hlzjt", *p) != NULL)
+		{
+			if (*p != 'h') largo = true;
+			p++;
+		}
+		if (cantidad == MAX_ARGUMENTOS_LOG) return -2;
+
+		switch (*p)
+		{
+			case 'd': case 'i': case 'u': case 'x': case 'X': case 'o': case 'c':
+			formato->tipos[cantidad++] = largo ? ARGUMENTO_LOG_LONG : ARGUMENTO_LOG_INT;
+			break;
+			case 'f': case 'F': case 'e': case 'E': case 'g': case 'G': case 'a': case 'A':
+			formato->tipos[cantidad++] = ARGUMENTO_LOG_DOUBLE;
+			break;
+			case 's':
+			formato->tipos[cantidad++] = ARGUMENTO_LOG_STRING;
+			break;
+			case 'p':
+			formato->tipos[cantidad++] = ARGUMENTO_LOG_PUNTERO;
+			break;
+			default:
+			return -2;
+		}
+	}
+	return cantidad;
+}
+
+static t_anillo_log* anillo_del_hilo_para(t_log_diferido* diferido)
+{
+	if (duenio_del_anillo == diferido) return anillo_del_hilo;
+
+	duenio_del_anillo = diferido;
+	anillo_del_hilo = NULL;
+	id_del_hilo = syscall(SYS_gettid);
+
+	int indice = atomic_fetch_add(&diferido->cantidad_anillos, 1);
+	if (indice >= MAX_ANILLOS_LOG) return NULL; //este hilo loguea en el momento
+
+	t_anillo_log* anillo = malloc(sizeof(t_anillo_log));
+	atomic_init(&anillo->escritos, 0);
+	atomic_init(&anillo->leidos, 0);
+	atomic_store_explicit(&diferido->anillos[indice], anillo, memory_order_release);
+	anillo_del_hilo = anillo;
+	return anillo;
+}
+
+//Arma la linea como commons y la escribe en el archivo y la consola del t_log, sin pasar por el filtro de logger->detail
+static void loguear_en_el_momento(t_log* logger, t_log_level nivel, const char* formato, va_list argumentos)
+{
+	struct timespec ahora;
+	clock_gettime(CLOCK_REALTIME, &ahora);
+	struct tm hora;
+	localtime_r(&ahora.tv_sec, &hora);
+
+	char linea[LARGO_MAXIMO_LINEA];
+	int escritos = snprintf(linea, sizeof(linea), "[%s] %02d:%02d:%02d:%03d %s/(%d:%d): ",
+		log_level_as_string(nivel), hora.tm_hour, hora.tm_min, hora.tm_sec, (int)(ahora.tv_nsec / 1000000),
+		logger->program_name, (int)logger->pid, (int)syscall(SYS_gettid));
+	if (escritos >= (int)sizeof(linea) - 2) escritos = sizeof(linea) - 2;
+	escritos += vsnprintf(linea + escritos, sizeof(linea) - escritos - 1, formato, argumentos);
+	if (escritos >= (int)sizeof(linea) - 1) escritos = sizeof(linea) - 2;
+	linea[escritos++] = '\n';
+	linea[escritos] = '\0';
+
+	if (logger->file != NULL)
+	{
+		fputs(linea, logger->file);
+		fflush(logger->file);
+	}
+	if (logger->is_active_console)
+	{
+		fputs(linea, stdout);
+		fflush(stdout);
+	}
+}
+
+//Copia el formato y los argumentos al anillo del hilo. No formatea, no toma locks ni hace syscalls.
+//Filtra con nivel_minimo y no con logger->detail, asi quien loguea puede cambiar el nivel sin tocar el t_log compartido
+void registrar_en_log(t_log_diferido* diferido, t_log* logger, t_log_level nivel_minimo, t_formato_log* formato, ...)
+{
+	if (logger == NULL || formato->nivel < nivel_minimo) return;
+
+	int cantidad = atomic_load_explicit(&formato->cantidad_argumentos, memory_order_acquire);
+	if (cantidad == -1)
+	{
+		cantidad = analizar_formato_log(formato);
+		atomic_store_explicit(&formato->cantidad_argumentos, cantidad, memory_order_release);
+	}
+
+	va_list argumentos;
+	va_start(argumentos, formato);
+	t_anillo_log* anillo = (diferido != NULL && cantidad >= 0) ? anillo_del_hilo_para(diferido) : NULL;
+	if (anillo == NULL)
+	{
+		loguear_en_el_momento(logger, formato->nivel, formato->formato, argumentos);
+		va_end(argumentos);
+		return;
+	}
+
+	//Primera pasada: cuanto ocupa el registro
+	va_list copia;
+	va_copy(copia, argumentos);
+	uint32_t tamanio = sizeof(t_cabecera_log);
+	for (int i = 0; i < cantidad; i++)
+	{
+		switch (formato->tipos[i])
+		{
+			case ARGUMENTO_LOG_INT: va_arg(copia, int); tamanio += 8; break;
+			case ARGUMENTO_LOG_LONG: va_arg(copia, long); tamanio += 8; break;
+			case ARGUMENTO_LOG_DOUBLE: va_arg(copia, double); tamanio += 8; break;
+			case ARGUMENTO_LOG_PUNTERO: va_arg(copia, void*); tamanio += 8; break;
+			case ARGUMENTO_LOG_STRING:
+			{
+				const char* texto = va_arg(copia, const char*);
+				tamanio += ALINEAR_A_8(sizeof(uint32_t) + (texto != NULL ? strnlen(texto, MAX_STRING_LOG) : strlen("(null)")));
+				break;
+			}
+		}
+	}
+	va_end(copia);
+
+	//Lugar en el anillo: si no entra hasta el final, relleno y desde el principio
+	uint64_t escritos = atomic_load_explicit(&anillo->escritos, memory_order_relaxed);
+	uint64_t leidos = atomic_load_explicit(&anillo->leidos, memory_order_acquire);
+	uint64_t hasta_el_final = CAPACIDAD_ANILLO_LOG - escritos % CAPACIDAD_ANILLO_LOG;
+	uint64_t relleno = hasta_el_final < tamanio ? hasta_el_final : 0;
+	if (escritos + relleno + tamanio - leidos > CAPACIDAD_ANILLO_LOG)
+	{
+		atomic_fetch_add_explicit(&diferido->descartados, 1, memory_order_relaxed);
+		va_end(argumentos);
+		return;
+	}
+	if (relleno >= sizeof(t_cabecera_log))
+	{
+		t_cabecera_log cabecera_relleno = { .formato = NULL, .tamanio = relleno };
+		memcpy(anillo->datos + escritos % CAPACIDAD_ANILLO_LOG, &cabecera_relleno, sizeof(t_cabecera_log));
+	}
+	escritos += relleno;
+
+	struct timespec ahora;
+	clock_gettime(CLOCK_REALTIME, &ahora);
+	t_cabecera_log cabecera = {
+		.formato = formato,
+		.tamanio = tamanio,
+		.hilo = id_del_hilo,
+		.tiempo_ns = (int64_t)ahora.tv_sec * 1000000000LL + ahora.tv_nsec
+	};
+	char* destino = anillo->datos + escritos % CAPACIDAD_ANILLO_LOG;
+	memcpy(destino, &cabecera, sizeof(t_cabecera_log));
+	destino += sizeof(t_cabecera_log);
+
+	for (int i = 0; i < cantidad; i++)
+	{
+		int64_t valor = 0;
+		switch (formato->tipos[i])
+		{
+			case ARGUMENTO_LOG_INT: valor = va_arg(argumentos, int); break;
+			case ARGUMENTO_LOG_LONG: valor = va_arg(argumentos, long); break;
+			case ARGUMENTO_LOG_PUNTERO: valor = (int64_t)(uintptr_t)va_arg(argumentos, void*); break;
+			case ARGUMENTO_LOG_DOUBLE:
+			{
+				double decimal = va_arg(argumentos, double);
+				memcpy(&valor, &decimal, sizeof(double));
+				break;
+			}
+			case ARGUMENTO_LOG_STRING:
+			{
+				const char* texto = va_arg(argumentos, const char*);
+				if (texto == NULL) texto = "(null)";
+				uint32_t largo = strnlen(texto, MAX_STRING_LOG);
+				memcpy(destino, &largo, sizeof(uint32_t));
+				memcpy(destino + sizeof(uint32_t), texto, largo);
+				destino += ALINEAR_A_8(sizeof(uint32_t) + largo);
+				continue;
+			}
+		}
+		memcpy(destino, &valor, sizeof(int64_t));
+		destino += 8;
+	}
+	va_end(argumentos);
+
+	atomic_store_explicit(&anillo->escritos, escritos + tamanio, memory_order_release);
+}
+
+//-----------------------------HILO DE FONDO---------------------------------------
+
+//Formatea un registro como lo haria commons: "[NIVEL] HH:MM:SS:mmm PROGRAMA/(pid:tid): mensaje"
+static int formatear_registro_log(t_log_diferido* diferido, t_cabecera_log* cabecera, const char* argumentos, char* destino, int capacidad)
+{
+	t_formato_log* formato = cabecera->formato;
+	time_t segundos = cabecera->tiempo_ns / 1000000000LL;
+	struct tm hora;
+	localtime_r(&segundos, &hora);
+
+	int escritos = snprintf(destino, capacidad, "[%s] %02d:%02d:%02d:%03d %s/(%d:%u): ",
+		log_level_as_string(formato->nivel), hora.tm_hour, hora.tm_min, hora.tm_sec,
+		(int)(cabecera->tiempo_ns / 1000000 % 1000), diferido->logger->program_name, (int)diferido->logger->pid, cabecera->hilo);
+	if (escritos >= capacidad) escritos = capacidad - 1;
+
+	const char* p = formato->formato;
+	int argumento = 0;
+	while (*p != '\0' && escritos < capacidad - 2)
+	{
+		if (*p != '%')
+		{
+			destino[escritos++] = *p++;
+			continue;
+		}
+		if (p[1] == '%')
+		{
+			destino[escritos++] = '%';
+			p += 2;
+			continue;
+		}
+
+		//Especificador sin los modificadores de largo: el valor se pasa con el tipo que corresponde
+		char especificador[32];
+		int largo = 0;
+		especificador[largo++] = *p++;
+		while (*p != '\0' && strchr("-+ #0123456789.", *p) != NULL && largo < 24)
+			especificador[largo++] = *p++;
+		while (*p != '\0' && strchr("hlzjt", *p) != NULL)
+			p++;
+		char conversion = *p++;
+
+		t_tipo_argumento_log tipo = formato->tipos[argumento++];
+		int64_t valor;
+		memcpy(&valor, argumentos, sizeof(int64_t));
+		int restante = capacidad - escritos - 1;
+		int agregados;
+
+		if (tipo == ARGUMENTO_LOG_STRING)
+		{
+			uint32_t largo_texto;
+			memcpy(&largo_texto, argumentos, sizeof(uint32_t));
+			char texto[MAX_STRING_LOG + 1];
+			memcpy(texto, argumentos + sizeof(uint32_t), largo_texto);
+			texto[largo_texto] = '\0';
+			argumentos += ALINEAR_A_8(sizeof(uint32_t) + largo_texto);
+			especificador[largo++] = 's';
+			especificador[largo] = '\0';
+			agregados = snprintf(destino + escritos, restante, especificador, texto);
+		}
+		else if (tipo == ARGUMENTO_LOG_DOUBLE)
+		{
+			double decimal;
+			memcpy(&decimal, &valor, sizeof(double));
+			argumentos += 8;
+			especificador[largo++] = conversion;
+			especificador[largo] = '\0';
+			agregados = snprintf(destino + escritos, restante, especificador, decimal);
+		}
+		else if (tipo == ARGUMENTO_LOG_PUNTERO)
+		{
+			argumentos += 8;
+			especificador[largo++] = 'p';
+			especificador[largo] = '\0';
+			agregados = snprintf(destino + escritos, restante, especificador, (void*)(uintptr_t)valor);
+		}
+		else if (conversion == 'c')
+		{
+			argumentos += 8;
+			especificador[largo++] = 'c';
+			especificador[largo] = '\0';
+			agregados = snprintf(destino + escritos, restante, especificador, (int)valor);
+		}
+		else
+		{
+			argumentos += 8;
+			especificador[largo++] = 'l';
+			especificador[largo++] = 'l';
+			especificador[largo++] = conversion;
+			especificador[largo] = '\0';
+			if (conversion == 'd' || conversion == 'i')
+				agregados = snprintf(destino + escritos, restante, especificador, (long long)valor);
+			else if (tipo == ARGUMENTO_LOG_INT) //un int negativo con %u se ve como unsigned int, no como 64 bits
+				agregados = snprintf(destino + escritos, restante, especificador, (unsigned long long)(unsigned int)valor);
+			else
+				agregados = snprintf(destino + escritos, restante, especificador, (unsigned long long)(unsigned long)valor);
+		}
+		escritos += agregados < restante ? agregados : restante - 1;
+	}
+
+	destino[escritos++] = '\n';
+	return escritos;
+}
+
+static void escribir_todo(int fd, const char* datos, int tamanio)
+{
+	while (tamanio > 0)
+	{
+		ssize_t escritos = write(fd, datos, tamanio);
+		if (escritos <= 0) return;
+		datos += escritos;
+		tamanio -= escritos;
+	}
+}
+
+static void escribir_tanda_log(t_log_diferido* diferido, const char* tanda, int tamanio)
+{
+	if (diferido->archivo != -1)
+		escribir_todo(diferido->archivo, tanda, tamanio);
+	if (diferido->logger->is_active_console)
+		escribir_todo(STDOUT_FILENO, tanda, tamanio);
+}
+
+//Vacia los anillos cada INTERVALO_LOG_DIFERIDO_US; la ultima vuelta (ya detenido) vacia lo que quede
+static void* vaciar_logs_diferidos(void* dato)
+{
+	t_log_diferido* diferido = dato;
+	char* tanda = malloc(TAMANIO_TANDA_LOG);
+	bool seguir = true;
+
+	while (seguir)
+	{
+		seguir = atomic_load(&diferido->corriendo);
+		int usados = 0;
+		int cantidad = atomic_load(&diferido->cantidad_anillos);
+		if (cantidad > MAX_ANILLOS_LOG) cantidad = MAX_ANILLOS_LOG;
+
+		for (int i = 0; i < cantidad; i++)
+		{
+			t_anillo_log* anillo = atomic_load_explicit(&diferido->anillos[i], memory_order_acquire);
+			if (anillo == NULL) continue;
+
+			uint64_t leidos = atomic_load_explicit(&anillo->leidos, memory_order_relaxed);
+			uint64_t escritos = atomic_load_explicit(&anillo->escritos, memory_order_acquire);
+			while (leidos < escritos)
+			{
+				uint64_t posicion = leidos % CAPACIDAD_ANILLO_LOG;
+				if (CAPACIDAD_ANILLO_LOG - posicion < sizeof(t_cabecera_log))
+				{
+					leidos += CAPACIDAD_ANILLO_LOG - posicion;
+					continue;
+				}
+
+				t_cabecera_log cabecera;
+				memcpy(&cabecera, anillo->datos + posicion, sizeof(t_cabecera_log));
+				if (cabecera.formato != NULL)
+				{
+					if (usados > TAMANIO_TANDA_LOG - LARGO_MAXIMO_LINEA)
+					{
+						escribir_tanda_log(diferido, tanda, usados);
+						usados = 0;
+					}
+					usados += formatear_registro_log(diferido, &cabecera, anillo->datos + posicion + sizeof(t_cabecera_log), tanda + usados, LARGO_MAXIMO_LINEA);
+				}
+				leidos += cabecera.tamanio;
+			}
+			atomic_store_explicit(&anillo->leidos, leidos, memory_order_release);
+		}
+
+		if (usados > 0)
+			escribir_tanda_log(diferido, tanda, usados);
+		if (seguir)
+			usleep(INTERVALO_LOG_DIFERIDO_US);
+	}
+
+	free(tanda);
+	return NULL;
+}
+
+//-----------------------------CREAR Y DESTRUIR---------------------------------------
+
+//Escribe en el mismo archivo que el t_log (abierto aparte, en modo append) y en la consola si el t_log la usa
+t_log_diferido* crear_log_diferido(t_log* logger, char* archivo)
+{
+	t_log_diferido* diferido = calloc(1, sizeof(t_log_diferido));
+	diferido->logger = logger;
+	diferido->archivo = archivo != NULL ? open(archivo, O_WRONLY | O_CREAT | O_APPEND | O_CLOEXEC, 0644) : -1;
+	atomic_init(&diferido->corriendo, true);
+	atomic_init(&diferido->cantidad_anillos, 0);
+	atomic_init(&diferido->descartados, 0);
+
+	if (pthread_create(&diferido->hilo, NULL, vaciar_logs_diferidos, diferido) != 0)
+	{
+		perror("Error al crear el hilo del log diferido");
+		exit(EXIT_FAILURE);
+	}
+	return diferido;
+}
+
+//Escribe todo lo pendiente antes de liberar. Los hilos que loguean ya tienen que haber terminado
+void destruir_log_diferido(t_log_diferido* diferido)
+{
+	if (diferido == NULL) return;
+
+	atomic_store(&diferido->corriendo, false);
+	pthread_join(diferido->hilo, NULL);
+
+	uint64_t descartados = atomic_load(&diferido->descartados);
+	if (descartados > 0)
+		log_warning(diferido->logger, "Log diferido: se descartaron %llu registros con el anillo lleno", (unsigned long long)descartados);
+
+	int cantidad = atomic_load(&diferido->cantidad_anillos);
+	for (int i = 0; i < cantidad && i < MAX_ANILLOS_LOG; i++)
+		free(atomic_load(&diferido->anillos[i]));
+	if (diferido->archivo != -1)
+		close(diferido->archivo);
+	free(diferido);
+}
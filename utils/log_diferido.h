@@ -0,0 +1,68 @@
+#ifndef LOG_DIFERIDO_H_
+#define LOG_DIFERIDO_H_
+
+#include <stdlib.h>
+#include <stdint.h>
+#include <stdbool.h>
+#include <stdatomic.h>
+#include <pthread.h>
+#include <commons/log.h>
+
+//-------------Log diferido--------------------
+// El hilo que loguea solo copia el formato (un puntero fijo por sitio) y los argumentos crudos
+// a un anillo propio, sin locks ni formateo. Un hilo de fondo formatea los registros de todos
+// los anillos y los escribe de a tandas en el archivo y la consola, con el mismo formato que commons.
+// Si el anillo del hilo esta lleno el registro se descarta (se cuentan y se avisa al cerrar).
+#define CAPACIDAD_ANILLO_LOG 65536  //bytes por hilo, potencia de 2
+#define MAX_ANILLOS_LOG 64          //hilos que pueden loguear diferido
+#define MAX_ARGUMENTOS_LOG 8
+#define MAX_STRING_LOG 256          //los %s mas largos se recortan
+#define INTERVALO_LOG_DIFERIDO_US 1000
+
+typedef enum {
+	ARGUMENTO_LOG_INT,
+	ARGUMENTO_LOG_LONG,
+	ARGUMENTO_LOG_DOUBLE,
+	ARGUMENTO_LOG_STRING,
+	ARGUMENTO_LOG_PUNTERO
+} t_tipo_argumento_log;
+
+//Uno por sitio de llamada (static dentro de log_diferido()): su direccion es el id del formato
+typedef struct {
+	const char* formato;
+	t_log_level nivel;
+	_Atomic int cantidad_argumentos; //-1 sin analizar, -2 si no se puede diferir (se loguea en el momento)
+	t_tipo_argumento_log tipos[MAX_ARGUMENTOS_LOG];
+} t_formato_log;
+
+typedef struct
+{
+	_Atomic uint64_t escritos; //bytes publicados por el hilo dueño
+	_Atomic uint64_t leidos;   //bytes consumidos por el hilo de fondo
+	char datos[CAPACIDAD_ANILLO_LOG];
+} t_anillo_log;
+
+typedef struct
+{
+	t_log* logger;
+	int archivo;
+	pthread_t hilo;
+	_Atomic bool corriendo;
+	_Atomic int cantidad_anillos;
+	t_anillo_log* _Atomic anillos[MAX_ANILLOS_LOG];
+	_Atomic uint64_t descartados;
+} t_log_diferido;
+
+t_log_diferido* crear_log_diferido(t_log* logger, char* archivo);
+void destruir_log_diferido(t_log_diferido* diferido);
+void registrar_en_log(t_log_diferido* diferido, t_log* logger, t_log_level nivel_minimo, t_formato_log* formato, ...);
+
+//Con diferido en NULL loguea en el momento. Se registra si nivel_log >= nivel_minimo (se evalua en cada llamada)
+#define log_diferido(diferido, logger, nivel_minimo, nivel_log, texto, ...) \
+	do \
+	{ \
+		static t_formato_log formato_del_sitio = { .formato = texto, .nivel = nivel_log, .cantidad_argumentos = -1 }; \
+		registrar_en_log(diferido, logger, nivel_minimo, &formato_del_sitio, ##__VA_ARGS__); \
+	} while (0)
+
+#endif
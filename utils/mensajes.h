@@ -0,0 +1,91 @@
+#ifndef MENSAJES_H_
+#define MENSAJES_H_
+
+#include <utils/utils.h>
+
+//-------------Esquemas de mensajes de tamanio fijo--------------------
+// Solo los mensajes del camino caliente entre CPU y memoria (FETCH, traduccion, READ/WRITE y paginas
+// de la cache); los handshakes y los mensajes con kernel e IO siguen con campos [tamanio][valor].
+// Cada mensaje tiene una cabecera de campos int32 sin prefijo de tamanio, en el orden del esquema,
+// seguida (segun el mensaje) de una cola variable: strings con su [tamanio] o ints crudos.
+// De cada MENSAJE(codigo, nombre, CAMPOS) se genera:
+//   t_mensaje_<nombre>                  struct con los campos, sin padding
+//   TAMANIO_<codigo>                    bytes de la cabecera fija
+//   empaquetar_<nombre>(constructor, m) agrega la cabecera al constructor
+//   desempaquetar_<nombre>(lector, m)   la lee de una sola vez (sale si el mensaje es mas corto)
+// y nombre_del_mensaje(codigo) devuelve "<codigo>" (tambien para los de MENSAJES_SIN_ESQUEMA).
+// Se usa solo si las dos puntas lo acordaron en el handshake (CAPACIDAD_MENSAJES_FIJOS).
+
+#define CAMPOS_SOLICITAR_INSTRUCCION(CAMPO) CAMPO(pc) CAMPO(pid)
+#define CAMPOS_RESPUESTA_INSTRUCCION(CAMPO) CAMPO(operacion) CAMPO(cantidad_parametros) //+ parametros (strings)
+#define CAMPOS_ACCESO_TABLA_PAGINAS(CAMPO) CAMPO(pid) CAMPO(pagina) //+ un indice crudo por nivel
+#define CAMPOS_RESPUESTA_DIRECCION_FISICA(CAMPO) CAMPO(marco)
+#define CAMPOS_LEER_MEMORIA(CAMPO) CAMPO(marco) CAMPO(desplazamiento) CAMPO(tamanio) //repetido por segmento
+#define CAMPOS_ESCRIBIR_MEMORIA(CAMPO) CAMPO(marco) CAMPO(desplazamiento) //+ datos; repetido por segmento
+#define CAMPOS_LEER_PAGINA_COMPLETA(CAMPO) CAMPO(pagina) CAMPO(marco)
+#define CAMPOS_PAGINA_COMPLETA(CAMPO) CAMPO(marco) //+ contenido (string o pagina codificada)
+#define CAMPOS_ESCRIBIR_PAGINA_MODIFICADA(CAMPO) CAMPO(pagina) CAMPO(marco) //+ contenido (string o pagina codificada)
+
+#define MENSAJES_FIJOS(MENSAJE) \
+	MENSAJE(CPU_M_SOLICITAR_INSTRUCCION, solicitar_instruccion, CAMPOS_SOLICITAR_INSTRUCCION) \
+	MENSAJE(M_CPU_RESPUESTA_INSTRUCCION, respuesta_instruccion, CAMPOS_RESPUESTA_INSTRUCCION) \
+	MENSAJE(CPU_M_ACCESO_TABLA_PAGINAS, acceso_tabla_paginas, CAMPOS_ACCESO_TABLA_PAGINAS) \
+	MENSAJE(M_CPU_RESPUESTA_DIRECCION_FISICA, respuesta_direccion_fisica, CAMPOS_RESPUESTA_DIRECCION_FISICA) \
+	MENSAJE(CPU_M_LEER_MEMORIA, leer_memoria, CAMPOS_LEER_MEMORIA) \
+	MENSAJE(CPU_M_ESCRIBIR_MEMORIA, escribir_memoria, CAMPOS_ESCRIBIR_MEMORIA) \
+	MENSAJE(CPU_M_LEER_PAGINA_COMPLETA, leer_pagina_completa, CAMPOS_LEER_PAGINA_COMPLETA) \
+	MENSAJE(M_CPU_PAGINA_COMPLETA, pagina_completa, CAMPOS_PAGINA_COMPLETA) \
+	MENSAJE(CPU_M_ESCRIBIR_PAGINA_MODIFICADA, escribir_pagina_modificada, CAMPOS_ESCRIBIR_PAGINA_MODIFICADA)
+
+#define DECLARAR_CAMPO(campo) int32_t campo;
+#define SUMAR_CAMPO(campo) + (int)sizeof(int32_t)
+
+#define DECLARAR_MENSAJE(codigo, nombre, CAMPOS) \
+	typedef struct { CAMPOS(DECLARAR_CAMPO) } t_mensaje_##nombre; \
+	enum { TAMANIO_##codigo = 0 CAMPOS(SUMAR_CAMPO) }; \
+	_Static_assert(sizeof(t_mensaje_##nombre) == TAMANIO_##codigo, "t_mensaje_" #nombre " tiene padding"); \
+	static inline void empaquetar_##nombre(t_constructor_paquete* constructor, const t_mensaje_##nombre* mensaje) \
+	{ \
+		agregar_crudo_al_constructor(constructor, mensaje, TAMANIO_##codigo); \
+	} \
+	static inline void desempaquetar_##nombre(t_lector_buffer* lector, t_mensaje_##nombre* mensaje) \
+	{ \
+		memcpy(mensaje, leer_crudo_del_buffer(lector, TAMANIO_##codigo), TAMANIO_##codigo); \
+	}
+
+MENSAJES_FIJOS(DECLARAR_MENSAJE)
+
+//Los demas codigos que usa la CPU, que siguen campo por campo: solo para nombrarlos. El handshake con
+//kernel usa HANDSHAKE de op_code, que vale lo mismo que K_M_REANUDAR_PROCESO (la CPU no lo usa)
+#define MENSAJES_SIN_ESQUEMA(CODIGO) \
+	CODIGO(HANDSHAKE) \
+	CODIGO(CPU_M_HANDSHAKE) \
+	CODIGO(M_CPU_HANDSHAKE) \
+	CODIGO(M_CPU_VALOR_LEIDO) \
+	CODIGO(M_CPU_CONFIRMACION_ESCRITURA) \
+	CODIGO(M_K_RESPUESTA_ERROR) \
+	CODIGO(K_CPU_EXEC_PROCESO) \
+	CODIGO(K_CPU_INTERRUPT_PROCESO) \
+	CODIGO(CPU_K_HANDSHAKE) \
+	CODIGO(CPU_K_REPLANIFICAR) \
+	CODIGO(CPU_K_SOLICITAR_IO) \
+	CODIGO(CPU_K_INIT_PROC) \
+	CODIGO(CPU_K_DUMP_MEMORY) \
+	CODIGO(CPU_K_EXIT) \
+	CODIGO(CPU_K_SYSCALL_ERROR)
+
+#define CASO_NOMBRE_MENSAJE(codigo, nombre, CAMPOS) case codigo: return #codigo;
+#define CASO_NOMBRE_CODIGO(codigo) case codigo: return #codigo;
+
+//Nombre del codigo de operacion (para estadisticas y logs), NULL si no esta en ninguna de las dos tablas
+static inline const char* nombre_del_mensaje(int codigo)
+{
+	switch (codigo)
+	{
+		MENSAJES_FIJOS(CASO_NOMBRE_MENSAJE)
+		MENSAJES_SIN_ESQUEMA(CASO_NOMBRE_CODIGO)
+		default: return NULL;
+	}
+}
+
+#endif
@@ -28,9 +28,9 @@ void enviar_pc_pid(t_PCB *pcb, int socket, op_code cod_op)
 
 void deserializar_pc_pid(t_buffer *buffer, int* pc, int* pid) // OJO, recibe direcciones de memoria deserializar_pc_pid(buffer, &pc, &pid)
 {   
-    //Asigno memoria dinamica para el contexto
-    *pc = extraer_int_del_buffer(buffer);
-    *pid = extraer_int_del_buffer(buffer);
+    t_lector_buffer lector = crear_lector(buffer);
+    *pc = leer_int_del_buffer(&lector);
+    *pid = leer_int_del_buffer(&lector);
 }
 
 void serializar_pc_pid(t_paquete *paquete,t_PCB *pcb)
@@ -0,0 +1,159 @@
+#include <utils/pool.h>
+#include <string.h>
+#include <stdio.h>
+#include <stddef.h>
+#include <stdatomic.h>
+
+//Cabecera delante de cada bloque, alineada como lo que devuelve malloc
+typedef union t_cabecera_pool {
+	struct {
+		int clase; //-1 si el bloque es mas grande que la ultima clase
+		union t_cabecera_pool* siguiente;
+	};
+	max_align_t alineacion;
+} t_cabecera_pool;
+
+static __thread t_cabecera_pool* libres[CLASES_POOL];
+static __thread int cantidad_libres[CLASES_POOL];
+static __thread t_contadores_pool contadores_hilo;
+
+static _Atomic uint64_t reservas_sistema_totales;
+static _Atomic uint64_t liberaciones_sistema_totales;
+
+static int clase_para(int bytes)
+{
+	int clase = 0;
+	int tamanio = TAMANIO_MINIMO_POOL;
+	while (tamanio < bytes)
+	{
+		if (clase == CLASES_POOL - 1) return -1;
+		tamanio <<= 1;
+		clase++;
+	}
+	return clase;
+}
+
+static int tamanio_de_clase(int clase)
+{
+	return TAMANIO_MINIMO_POOL << clase;
+}
+
+static t_cabecera_pool* pedir_al_sistema(size_t bytes)
+{
+	t_cabecera_pool* cabecera = malloc(sizeof(t_cabecera_pool) + bytes);
+	if (cabecera == NULL)
+	{
+		perror("Error al reservar memoria para el pool");
+		exit(EXIT_FAILURE);
+	}
+	contadores_hilo.reservas_sistema++;
+	atomic_fetch_add_explicit(&reservas_sistema_totales, 1, memory_order_relaxed);
+	return cabecera;
+}
+
+static void devolver_al_sistema(t_cabecera_pool* cabecera)
+{
+	contadores_hilo.liberaciones_sistema++;
+	atomic_fetch_add_explicit(&liberaciones_sistema_totales, 1, memory_order_relaxed);
+	free(cabecera);
+}
+
+//Devuelve un bloque de al menos bytes; en capacidad (si no es NULL) deja lo que realmente entra
+void* reservar_del_pool(int bytes, int* capacidad)
+{
+	int clase = clase_para(bytes);
+	t_cabecera_pool* cabecera;
+
+	contadores_hilo.reservas++;
+	if (clase == -1)
+	{
+		cabecera = pedir_al_sistema(bytes);
+		if (capacidad != NULL) *capacidad = bytes;
+	}
+	else
+	{
+		cabecera = libres[clase];
+		if (cabecera != NULL)
+		{
+			libres[clase] = cabecera->siguiente;
+			cantidad_libres[clase]--;
+		}
+		else
+		{
+			cabecera = pedir_al_sistema(tamanio_de_clase(clase));
+		}
+		if (capacidad != NULL) *capacidad = tamanio_de_clase(clase);
+	}
+
+	cabecera->clase = clase;
+	return cabecera + 1;
+}
+
+//Como realloc: conserva los primeros usados bytes. Si el bloque ya tiene lugar para bytes, no se mueve
+void* agrandar_del_pool(void* bloque, int usados, int bytes, int* capacidad)
+{
+	if (bloque != NULL)
+	{
+		t_cabecera_pool* cabecera = (t_cabecera_pool*)bloque - 1;
+		if (cabecera->clase != -1 && tamanio_de_clase(cabecera->clase) >= bytes)
+		{
+			if (capacidad != NULL) *capacidad = tamanio_de_clase(cabecera->clase);
+			return bloque;
+		}
+	}
+
+	void* nuevo = reservar_del_pool(bytes, capacidad);
+	if (bloque != NULL)
+	{
+		memcpy(nuevo, bloque, usados);
+		devolver_al_pool(bloque);
+	}
+	return nuevo;
+}
+
+void devolver_al_pool(void* bloque)
+{
+	if (bloque == NULL) return;
+
+	t_cabecera_pool* cabecera = (t_cabecera_pool*)bloque - 1;
+	int clase = cabecera->clase;
+
+	contadores_hilo.liberaciones++;
+	if (clase == -1 || cantidad_libres[clase] >= LIBRES_POR_CLASE_POOL)
+	{
+		devolver_al_sistema(cabecera);
+		return;
+	}
+	cabecera->siguiente = libres[clase];
+	libres[clase] = cabecera;
+	cantidad_libres[clase]++;
+}
+
+//Libera los bloques guardados por el hilo actual. Llamarlo antes de que el hilo termine
+void vaciar_pool_del_hilo(void)
+{
+	for (int clase = 0; clase < CLASES_POOL; clase++)
+	{
+		while (libres[clase] != NULL)
+		{
+			t_cabecera_pool* cabecera = libres[clase];
+			libres[clase] = cabecera->siguiente;
+			devolver_al_sistema(cabecera);
+		}
+		cantidad_libres[clase] = 0;
+	}
+}
+
+t_contadores_pool contadores_pool_del_hilo(void)
+{
+	return contadores_hilo;
+}
+
+//Solo los contadores de malloc/free se suman entre hilos
+t_contadores_pool contadores_pool_totales(void)
+{
+	t_contadores_pool totales = { 0 };
+	totales.reservas_sistema = atomic_load_explicit(&reservas_sistema_totales, memory_order_relaxed);
+	totales.liberaciones_sistema = atomic_load_explicit(&liberaciones_sistema_totales, memory_order_relaxed);
+	return totales;
+}
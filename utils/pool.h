@@ -0,0 +1,31 @@
+#ifndef POOL_H_
+#define POOL_H_
+
+#include <stdlib.h>
+#include <stdint.h>
+#include <stdbool.h>
+
+//-------------Pool de bloques por hilo--------------------
+// Cada hilo guarda los bloques devueltos en listas libres por clase de tamanio
+// (32, 64, ... 8192 bytes) y los reusa sin pasar por malloc/free.
+// Un bloque puede devolverse desde otro hilo: queda en las listas de ese hilo.
+#define CLASES_POOL 9
+#define TAMANIO_MINIMO_POOL 32
+#define TAMANIO_MAXIMO_POOL (TAMANIO_MINIMO_POOL << (CLASES_POOL - 1))
+#define LIBRES_POR_CLASE_POOL 64 //Mas alla de esto los bloques se devuelven al sistema
+
+typedef struct {
+	uint64_t reservas;             //pedidos al pool
+	uint64_t liberaciones;         //devoluciones al pool
+	uint64_t reservas_sistema;     //pedidos que terminaron en malloc
+	uint64_t liberaciones_sistema; //devoluciones que terminaron en free
+} t_contadores_pool;
+
+void* reservar_del_pool(int bytes, int* capacidad);
+void* agrandar_del_pool(void* bloque, int usados, int bytes, int* capacidad);
+void devolver_al_pool(void* bloque);
+void vaciar_pool_del_hilo(void);
+t_contadores_pool contadores_pool_del_hilo(void);
+t_contadores_pool contadores_pool_totales(void);
+
+#endif
@@ -0,0 +1,286 @@
+#define _GNU_SOURCE //accept4
+#include <utils/servidor.h>
+#include <errno.h>
+#include <fcntl.h>
+#include <sys/eventfd.h>
+
+//-----------------------------TRABAJADORES---------------------------------------
+
+void encolar_trabajo(t_servidor* servidor, t_cliente_servidor* cliente, int cod_op, t_buffer* buffer)
+{
+	t_trabajo_servidor* trabajo = malloc(sizeof(t_trabajo_servidor));
+	trabajo->cliente = cliente;
+	trabajo->cod_op = cod_op;
+	trabajo->buffer = buffer;
+	trabajo->siguiente = NULL;
+
+	pthread_mutex_lock(&servidor->mutex_trabajos);
+	if (servidor->ultimo_trabajo == NULL)
+		servidor->primer_trabajo = trabajo;
+	else
+		servidor->ultimo_trabajo->siguiente = trabajo;
+	servidor->ultimo_trabajo = trabajo;
+	pthread_cond_signal(&servidor->hay_trabajo);
+	pthread_mutex_unlock(&servidor->mutex_trabajos);
+}
+
+//Le devuelve el cliente al hilo del bucle, que vuelve a leer su conexion (o la libera si se cerro)
+void devolver_cliente(t_servidor* servidor, t_cliente_servidor* cliente)
+{
+	pthread_mutex_lock(&servidor->mutex_devueltos);
+	cliente->siguiente = servidor->devueltos;
+	servidor->devueltos = cliente;
+	pthread_mutex_unlock(&servidor->mutex_devueltos);
+
+	uint64_t uno = 1;
+	if (write(servidor->aviso_devueltos, &uno, sizeof(uno)) == -1 && errno != EAGAIN)
+		perror("No se pudo avisar al bucle del servidor");
+}
+
+//Antes de terminar, los trabajadores vacian la cola: todo mensaje leido se atiende
+void* trabajar_en_servidor(void* dato)
+{
+	t_servidor* servidor = dato;
+	while (true)
+	{
+		pthread_mutex_lock(&servidor->mutex_trabajos);
+		while (servidor->primer_trabajo == NULL && !servidor->terminando)
+			pthread_cond_wait(&servidor->hay_trabajo, &servidor->mutex_trabajos);
+		t_trabajo_servidor* trabajo = servidor->primer_trabajo;
+		if (trabajo != NULL)
+		{
+			servidor->primer_trabajo = trabajo->siguiente;
+			if (servidor->primer_trabajo == NULL)
+				servidor->ultimo_trabajo = NULL;
+		}
+		pthread_mutex_unlock(&servidor->mutex_trabajos);
+
+		if (trabajo == NULL)
+			break;
+
+		servidor->manejador(trabajo->cliente, trabajo->cod_op, trabajo->buffer);
+		if (trabajo->cod_op != -1)
+			atomic_fetch_add_explicit(&servidor->mensajes_atendidos, 1, memory_order_relaxed);
+		devolver_cliente(servidor, trabajo->cliente);
+		free(trabajo);
+	}
+	vaciar_pool_del_hilo();
+	return NULL;
+}
+
+//-----------------------------BUCLE DEL SERVIDOR---------------------------------------
+
+//Cada mensaje completo pasa a un trabajador; la conexion se pausa hasta que se lo devuelva
+void recibir_de_cliente(void* dato, int cod_op, t_buffer* buffer)
+{
+	t_cliente_servidor* cliente = dato;
+	if (cod_op != -1)
+		pausar_conexion_eventos(cliente->conexion);
+	else
+		log_debug(cliente->servidor->logger, "Se desconecto el cliente del socket %d", cliente->socket);
+	encolar_trabajo(cliente->servidor, cliente, cod_op, buffer);
+}
+
+void aceptar_clientes(void* dato)
+{
+	t_servidor* servidor = dato;
+	while (true)
+	{
+		int socket_cliente = accept4(servidor->socket_escucha, NULL, NULL, SOCK_CLOEXEC);
+		if (socket_cliente == -1)
+		{
+			if (errno == EINTR || errno == ECONNABORTED) continue;
+			if (errno != EAGAIN && errno != EWOULDBLOCK)
+				log_error(servidor->logger, "Fallo al aceptar un cliente: %s", strerror(errno));
+			return;
+		}
+
+		t_cliente_servidor* cliente = calloc(1, sizeof(t_cliente_servidor));
+		if (cliente == NULL)
+		{
+			log_error(servidor->logger, "No hay memoria para el cliente del socket %d", socket_cliente);
+			close(socket_cliente);
+			continue;
+		}
+		cliente->socket = socket_cliente;
+		cliente->servidor = servidor;
+		cliente->conexion = crear_conexion_eventos(servidor->bucle, socket_cliente, recibir_de_cliente, cliente);
+		if (cliente->conexion == NULL)
+		{
+			close(socket_cliente);
+			free(cliente);
+			continue;
+		}
+		list_add(servidor->clientes, cliente);
+		atomic_fetch_add_explicit(&servidor->clientes_aceptados, 1, memory_order_relaxed);
+		atomic_fetch_add_explicit(&servidor->clientes_conectados, 1, memory_order_relaxed);
+		log_debug(servidor->logger, "Se conecto un cliente en el socket %d", socket_cliente);
+	}
+}
+
+void quitar_cliente(t_servidor* servidor, t_cliente_servidor* cliente)
+{
+	for (int i = 0; i < list_size(servidor->clientes); i++)
+	{
+		if (list_get(servidor->clientes, i) == cliente)
+		{
+			list_remove(servidor->clientes, i);
+			break;
+		}
+	}
+	descartar_conexion_eventos(cliente->conexion);
+	free(cliente);
+	atomic_fetch_sub_explicit(&servidor->clientes_conectados, 1, memory_order_relaxed);
+}
+
+void recibir_clientes_devueltos(void* dato)
+{
+	t_servidor* servidor = dato;
+	uint64_t avisos;
+	if (read(servidor->aviso_devueltos, &avisos, sizeof(avisos)) <= 0) return;
+
+	pthread_mutex_lock(&servidor->mutex_devueltos);
+	t_cliente_servidor* cliente = servidor->devueltos;
+	servidor->devueltos = NULL;
+	pthread_mutex_unlock(&servidor->mutex_devueltos);
+
+	while (cliente != NULL)
+	{
+		t_cliente_servidor* siguiente = cliente->siguiente;
+		if (cliente->conexion->cerrada)
+			quitar_cliente(servidor, cliente); //ya se atendio su desconexion
+		else
+			reanudar_conexion_eventos(cliente->conexion);
+		cliente = siguiente;
+	}
+}
+
+void terminar_bucle_servidor(void* dato)
+{
+	t_servidor* servidor = dato;
+	detener_bucle_eventos(servidor->bucle);
+}
+
+void* correr_servidor(void* dato)
+{
+	t_servidor* servidor = dato;
+	correr_bucle_eventos(servidor->bucle);
+	return NULL;
+}
+
+//-----------------------------SERVIDOR---------------------------------------
+
+//Escucha en la direccion (ver transporte.h) y arranca el hilo del bucle y los trabajadores (con 0, uno
+//por procesador). Devuelve NULL si no pudo escuchar
+t_servidor* crear_servidor(char* direccion, int trabajadores, t_manejador_cliente manejador, void* dato, t_log* logger)
+{
+	int socket_escucha = escuchar_direccion(direccion, logger, "servidor");
+	if (socket_escucha == -1)
+		return NULL;
+	int flags = fcntl(socket_escucha, F_GETFL);
+	fcntl(socket_escucha, F_SETFL, flags | O_NONBLOCK); //se acepta hasta EAGAIN
+
+	t_servidor* servidor = calloc(1, sizeof(t_servidor));
+	if (servidor == NULL)
+	{
+		perror("Error al reservar el servidor");
+		exit(EXIT_FAILURE);
+	}
+	servidor->socket_escucha = socket_escucha;
+	servidor->logger = logger;
+	servidor->manejador = manejador;
+	servidor->dato = dato;
+	servidor->clientes = list_create();
+	servidor->aviso_fin = eventfd(0, EFD_CLOEXEC | EFD_NONBLOCK);
+	servidor->aviso_devueltos = eventfd(0, EFD_CLOEXEC | EFD_NONBLOCK);
+	if (servidor->aviso_fin == -1 || servidor->aviso_devueltos == -1)
+	{
+		perror("Error al crear los eventfd del servidor");
+		exit(EXIT_FAILURE);
+	}
+	pthread_mutex_init(&servidor->mutex_devueltos, NULL);
+	pthread_mutex_init(&servidor->mutex_trabajos, NULL);
+	pthread_cond_init(&servidor->hay_trabajo, NULL);
+
+	servidor->bucle = crear_bucle_eventos();
+	if (registrar_en_bucle(servidor->bucle, socket_escucha, EPOLLIN, aceptar_clientes, servidor) == NULL
+		|| registrar_en_bucle(servidor->bucle, servidor->aviso_devueltos, EPOLLIN, recibir_clientes_devueltos, servidor) == NULL
+		|| registrar_en_bucle(servidor->bucle, servidor->aviso_fin, EPOLLIN, terminar_bucle_servidor, servidor) == NULL)
+	{
+		log_error(logger, "No se pudo registrar el servidor de %s en su bucle de eventos", direccion);
+		exit(EXIT_FAILURE);
+	}
+
+	servidor->cantidad_trabajadores = trabajadores > 0 ? trabajadores : (int)sysconf(_SC_NPROCESSORS_ONLN);
+	servidor->trabajadores = malloc(servidor->cantidad_trabajadores * sizeof(pthread_t));
+	for (int i = 0; i < servidor->cantidad_trabajadores; i++)
+	{
+		if (pthread_create(&servidor->trabajadores[i], NULL, trabajar_en_servidor, servidor) != 0)
+		{
+			perror("Error al crear un trabajador del servidor");
+			exit(EXIT_FAILURE);
+		}
+	}
+	if (pthread_create(&servidor->hilo_bucle, NULL, correr_servidor, servidor) != 0)
+	{
+		perror("Error al crear el hilo del servidor");
+		exit(EXIT_FAILURE);
+	}
+
+	log_info(logger, "Servidor escuchando en %s con %d trabajadores", direccion, servidor->cantidad_trabajadores);
+	return servidor;
+}
+
+//Bloquea hasta que el servidor se detenga
+void esperar_servidor(t_servidor* servidor)
+{
+	if (servidor->bucle_terminado) return;
+	pthread_join(servidor->hilo_bucle, NULL);
+	servidor->bucle_terminado = true;
+}
+
+//Deja de aceptar y de leer clientes. Solo escribe un eventfd: se puede llamar desde un manejador de señal
+void detener_servidor(t_servidor* servidor)
+{
+	uint64_t uno = 1;
+	if (write(servidor->aviso_fin, &uno, sizeof(uno)) == -1 && errno != EAGAIN)
+		perror("No se pudo detener el servidor");
+}
+
+//Detiene el servidor, espera que los trabajadores atiendan lo que ya se leyo y cierra todos los clientes.
+//Los que seguian conectados reciben su cod_op -1 en este hilo
+void destruir_servidor(t_servidor* servidor)
+{
+	detener_servidor(servidor);
+	esperar_servidor(servidor);
+
+	pthread_mutex_lock(&servidor->mutex_trabajos);
+	servidor->terminando = true;
+	pthread_cond_broadcast(&servidor->hay_trabajo);
+	pthread_mutex_unlock(&servidor->mutex_trabajos);
+	for (int i = 0; i < servidor->cantidad_trabajadores; i++)
+		pthread_join(servidor->trabajadores[i], NULL);
+	free(servidor->trabajadores);
+
+	for (int i = 0; i < list_size(servidor->clientes); i++)
+	{
+		t_cliente_servidor* cliente = list_get(servidor->clientes, i);
+		if (!cliente->conexion->cerrada)
+			servidor->manejador(cliente, -1, NULL);
+		destruir_conexion_eventos(cliente->conexion);
+		free(cliente);
+	}
+	list_destroy(servidor->clientes);
+
+	log_info(servidor->logger, "Servidor cerrado: %llu clientes aceptados, %llu mensajes atendidos",
+		(unsigned long long)servidor->clientes_aceptados, (unsigned long long)servidor->mensajes_atendidos);
+
+	destruir_bucle_eventos(servidor->bucle);
+	close(servidor->aviso_fin);
+	close(servidor->aviso_devueltos);
+	close(servidor->socket_escucha);
+	pthread_mutex_destroy(&servidor->mutex_devueltos);
+	pthread_mutex_destroy(&servidor->mutex_trabajos);
+	pthread_cond_destroy(&servidor->hay_trabajo);
+	free(servidor);
+}
@@ -0,0 +1,79 @@
+#ifndef SERVIDOR_H_
+#define SERVIDOR_H_
+
+#include <stdlib.h>
+#include <stdint.h>
+#include <stdbool.h>
+#include <stdatomic.h>
+#include <pthread.h>
+#include <commons/log.h>
+#include <utils/utils.h>
+#include <utils/eventos.h>
+
+//-------------Servidor de muchos clientes--------------------
+// Reemplaza al esquema iniciar_servidor() + esperar_cliente() + un hilo por cliente bloqueado en
+// recibir_operacion(). Un hilo corre un bucle de eventos que acepta clientes y lee sus mensajes
+// [op_code][size][stream] sin bloquear (t_conexion_eventos); cada mensaje completo se atiende en un
+// pool de hilos trabajadores. Mientras un trabajador atiende un mensaje la conexion de ese cliente no
+// se lee: los mensajes de un cliente se atienden de a uno y en orden, los de clientes distintos en paralelo.
+// Los manejadores responden con enviar_paquete() sobre cliente->socket (la escritura es bloqueante).
+typedef struct t_servidor t_servidor;
+
+typedef struct t_cliente_servidor
+{
+	int socket;
+	t_servidor* servidor;
+	t_conexion_eventos* conexion;
+	void* dato;                           //estado del cliente, lo arman y lo liberan los manejadores
+	struct t_cliente_servidor* siguiente; //en la cola de clientes que los trabajadores devuelven al bucle
+} t_cliente_servidor;
+
+//Atiende un mensaje de un cliente en un trabajador y es duenio del buffer. Con cod_op -1 y buffer NULL
+//el cliente se desconecto (o el servidor se esta destruyendo): es el ultimo llamado para ese cliente
+typedef void (*t_manejador_cliente)(t_cliente_servidor* cliente, int cod_op, t_buffer* buffer);
+
+typedef struct t_trabajo_servidor
+{
+	t_cliente_servidor* cliente;
+	int cod_op;
+	t_buffer* buffer;
+	struct t_trabajo_servidor* siguiente;
+} t_trabajo_servidor;
+
+struct t_servidor
+{
+	int socket_escucha;
+	t_log* logger;
+	t_manejador_cliente manejador;
+	void* dato; //estado compartido de la aplicacion, para los manejadores
+
+	//Hilo del bucle: es el unico que toca las conexiones y la lista de clientes
+	t_bucle_eventos* bucle;
+	pthread_t hilo_bucle;
+	bool bucle_terminado;
+	t_list* clientes;
+	int aviso_fin;      //eventfd de detener_servidor()
+	int aviso_devueltos; //eventfd: un trabajador termino con un cliente
+	pthread_mutex_t mutex_devueltos;
+	t_cliente_servidor* devueltos;
+
+	//Trabajadores
+	pthread_t* trabajadores;
+	int cantidad_trabajadores;
+	pthread_mutex_t mutex_trabajos;
+	pthread_cond_t hay_trabajo;
+	t_trabajo_servidor* primer_trabajo;
+	t_trabajo_servidor* ultimo_trabajo;
+	bool terminando;
+
+	_Atomic uint64_t clientes_aceptados;
+	_Atomic uint64_t mensajes_atendidos;
+	_Atomic int clientes_conectados;
+};
+
+t_servidor* crear_servidor(char* direccion, int trabajadores, t_manejador_cliente manejador, void* dato, t_log* logger);
+void esperar_servidor(t_servidor* servidor);
+void detener_servidor(t_servidor* servidor);
+void destruir_servidor(t_servidor* servidor);
+
+#endif
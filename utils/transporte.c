@@ -0,0 +1,272 @@
+#include <utils/transporte.h>
+#include <string.h>
+#include <stddef.h>
+#include <unistd.h>
+#include <errno.h>
+#include <fcntl.h>
+#include <netdb.h>
+#include <sys/socket.h>
+#include <sys/stat.h>
+#include <sys/un.h>
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+
+#ifndef SO_BUSY_POLL
+#define SO_BUSY_POLL 46 //Linux, falta en headers viejos
+#endif
+
+static bool parsear_opcion_tcp(char* opcion, t_direccion* direccion)
+{
+	char* igual = strchr(opcion, '=');
+	if (igual == NULL) return false;
+	*igual = '\0';
+	int valor = atoi(igual + 1);
+
+	if (strcmp(opcion, "nodelay") == 0)
+		direccion->nodelay = valor != 0;
+	else if (strcmp(opcion, "sndbuf") == 0)
+		direccion->buffer_envio = valor;
+	else if (strcmp(opcion, "rcvbuf") == 0)
+		direccion->buffer_recepcion = valor;
+	else if (strcmp(opcion, "busy_poll") == 0)
+		direccion->busy_poll_us = valor;
+	else
+		return false;
+	return true;
+}
+
+//Devuelve false si el texto no es una direccion valida
+bool parsear_direccion(char* texto, t_direccion* direccion)
+{
+	memset(direccion, 0, sizeof(t_direccion));
+
+	if (strncmp(texto, "unix:", 5) == 0)
+	{
+		direccion->tipo = TRANSPORTE_UNIX;
+		direccion->ruta = strdup(texto + 5);
+		return direccion->ruta[0] != '\0' && strlen(direccion->ruta) < sizeof(((struct sockaddr_un*)0)->sun_path);
+	}
+
+	direccion->tipo = TRANSPORTE_TCP;
+	char* copia = strdup(strncmp(texto, "tcp:", 4) == 0 ? texto + 4 : texto);
+	char* opciones = strchr(copia, '?');
+	if (opciones != NULL)
+		*opciones++ = '\0';
+
+	char* dos_puntos = strrchr(copia, ':');
+	bool valida = dos_puntos != NULL && dos_puntos != copia && dos_puntos[1] != '\0';
+	if (valida)
+	{
+		*dos_puntos = '\0';
+		direccion->host = strdup(copia);
+		direccion->puerto = strdup(dos_puntos + 1);
+	}
+
+	char* resto = NULL;
+	for (char* opcion = opciones ? strtok_r(opciones, "&", &resto) : NULL; valida && opcion != NULL; opcion = strtok_r(NULL, "&", &resto))
+	{
+		valida = parsear_opcion_tcp(opcion, direccion);
+	}
+
+	free(copia);
+	return valida;
+}
+
+void liberar_direccion(t_direccion* direccion)
+{
+	free(direccion->host);
+	free(direccion->puerto);
+	free(direccion->ruta);
+}
+
+//Arma la sockaddr de un socket unix; una ruta que empieza con @ va al espacio abstracto (sin archivo)
+static socklen_t armar_direccion_unix(t_direccion* direccion, struct sockaddr_un* destino)
+{
+	memset(destino, 0, sizeof(struct sockaddr_un));
+	destino->sun_family = AF_UNIX;
+	size_t largo = strlen(direccion->ruta);
+	memcpy(destino->sun_path, direccion->ruta, largo);
+	if (direccion->ruta[0] == '@')
+		destino->sun_path[0] = '\0';
+	return offsetof(struct sockaddr_un, sun_path) + largo + (direccion->ruta[0] == '@' ? 0 : 1);
+}
+
+static void aplicar_opciones_tcp(int socket, t_direccion* direccion)
+{
+	int uno = 1;
+	if (direccion->nodelay && setsockopt(socket, IPPROTO_TCP, TCP_NODELAY, &uno, sizeof(uno)) == -1)
+		perror("No se pudo activar TCP_NODELAY");
+	if (direccion->buffer_envio > 0 && setsockopt(socket, SOL_SOCKET, SO_SNDBUF, &direccion->buffer_envio, sizeof(int)) == -1)
+		perror("No se pudo cambiar SO_SNDBUF");
+	if (direccion->buffer_recepcion > 0 && setsockopt(socket, SOL_SOCKET, SO_RCVBUF, &direccion->buffer_recepcion, sizeof(int)) == -1)
+		perror("No se pudo cambiar SO_RCVBUF");
+	if (direccion->busy_poll_us > 0 && setsockopt(socket, SOL_SOCKET, SO_BUSY_POLL, &direccion->busy_poll_us, sizeof(int)) == -1)
+		perror("No se pudo activar SO_BUSY_POLL");
+}
+
+//Hace el connect; sin_bloquear deja el socket no bloqueante y acepta un connect en curso (EINPROGRESS).
+//Si falla devuelve -1 con errno del ultimo intento (EINVAL si la direccion no es valida)
+static int conectar_con_modo(char* texto, bool sin_bloquear)
+{
+	t_direccion direccion;
+	if (!parsear_direccion(texto, &direccion))
+	{
+		printf("\n[ERROR] Direccion invalida: %s \n\n", texto);
+		liberar_direccion(&direccion);
+		errno = EINVAL;
+		return -1;
+	}
+
+	int flags = SOCK_CLOEXEC | (sin_bloquear ? SOCK_NONBLOCK : 0);
+	int socket_cliente = -1;
+	int error = 0;
+	if (direccion.tipo == TRANSPORTE_UNIX)
+	{
+		struct sockaddr_un destino;
+		socklen_t largo = armar_direccion_unix(&direccion, &destino);
+		socket_cliente = socket(AF_UNIX, SOCK_STREAM | flags, 0);
+		if (socket_cliente == -1)
+			error = errno;
+		else if (connect(socket_cliente, (struct sockaddr*)&destino, largo) == -1)
+		{
+			error = errno;
+			close(socket_cliente);
+			socket_cliente = -1;
+		}
+	}
+	else
+	{
+		struct addrinfo hints, *server_info;
+		memset(&hints, 0, sizeof(hints));
+		hints.ai_family = AF_UNSPEC;
+		hints.ai_socktype = SOCK_STREAM;
+
+		int resultado = getaddrinfo(direccion.host, direccion.puerto, &hints, &server_info);
+		if (resultado != 0)
+			error = resultado == EAI_NONAME ? EINVAL : EAGAIN; //un nombre que no existe no se arregla reintentando
+		else
+		{
+			for (struct addrinfo* actual = server_info; actual != NULL && socket_cliente == -1; actual = actual->ai_next)
+			{
+				socket_cliente = socket(actual->ai_family, actual->ai_socktype | flags, actual->ai_protocol);
+				if (socket_cliente == -1)
+				{
+					error = errno;
+					continue;
+				}
+
+				//Los buffers se fijan antes del connect para que entren en la ventana que se negocia
+				aplicar_opciones_tcp(socket_cliente, &direccion);
+				if (connect(socket_cliente, actual->ai_addr, actual->ai_addrlen) == -1 && !(sin_bloquear && errno == EINPROGRESS))
+				{
+					error = errno;
+					close(socket_cliente);
+					socket_cliente = -1;
+				}
+			}
+			freeaddrinfo(server_info);
+		}
+	}
+
+	liberar_direccion(&direccion);
+	errno = error;
+	return socket_cliente;
+}
+
+//Se conecta a la direccion (ver transporte.h). Devuelve el socket, o -1 si no pudo
+int conectar_direccion(char* texto)
+{
+	int socket_cliente = conectar_con_modo(texto, false);
+	if (socket_cliente == -1)
+		printf("No fue exitosa la conexion con %s.\n", texto);
+	return socket_cliente;
+}
+
+//Empieza a conectarse sin bloquear. Devuelve un socket no bloqueante conectado o con el connect en curso:
+//cuando poll() lo marca escribible, resultado_conexion() dice si conecto. Devuelve -1 si fallo enseguida,
+//con errno en EINVAL si la direccion no es valida (no tiene sentido reintentar)
+int iniciar_conexion_direccion(char* texto)
+{
+	return conectar_con_modo(texto, true);
+}
+
+//0 si el connect de un socket de iniciar_conexion_direccion() termino bien, o su errno
+int resultado_conexion(int socket)
+{
+	int error = 0;
+	socklen_t largo = sizeof(error);
+	if (getsockopt(socket, SOL_SOCKET, SO_ERROR, &error, &largo) == -1)
+		return errno;
+	return error;
+}
+
+//Vuelve a dejar bloqueante un socket conectado con iniciar_conexion_direccion()
+void dejar_bloqueante(int socket)
+{
+	int flags = fcntl(socket, F_GETFL);
+	if (flags == -1 || fcntl(socket, F_SETFL, flags & ~O_NONBLOCK) == -1)
+		perror("No se pudo dejar bloqueante el socket");
+}
+
+//Como iniciar_servidor(), pero sobre una direccion (ver transporte.h). Los sockets aceptados
+//heredan del de escucha las opciones TCP (en Linux). Devuelve -1 si no pudo escuchar
+int escuchar_direccion(char* texto, t_log* un_logger, char* mensaje_server)
+{
+	t_direccion direccion;
+	if (!parsear_direccion(texto, &direccion))
+	{
+		log_error(un_logger, "Direccion invalida: %s", texto);
+		liberar_direccion(&direccion);
+		return -1;
+	}
+
+	int socket_servidor = -1;
+	if (direccion.tipo == TRANSPORTE_UNIX)
+	{
+		struct sockaddr_un origen;
+		socklen_t largo = armar_direccion_unix(&direccion, &origen);
+		struct stat existente;
+		if (direccion.ruta[0] != '@' && lstat(direccion.ruta, &existente) == 0 && S_ISSOCK(existente.st_mode))
+			unlink(direccion.ruta); //un socket viejo de una corrida anterior; otro archivo en la ruta no se toca y el bind falla
+
+		socket_servidor = socket(AF_UNIX, SOCK_STREAM | SOCK_CLOEXEC, 0);
+		if (socket_servidor != -1 && (bind(socket_servidor, (struct sockaddr*)&origen, largo) == -1 || listen(socket_servidor, SOMAXCONN) == -1))
+		{
+			close(socket_servidor);
+			socket_servidor = -1;
+		}
+	}
+	else
+	{
+		struct addrinfo hints, *servinfo;
+		memset(&hints, 0, sizeof(hints));
+		hints.ai_family = AF_INET;
+		hints.ai_socktype = SOCK_STREAM;
+		hints.ai_flags = AI_PASSIVE;
+
+		char* host = strcmp(direccion.host, "*") == 0 ? NULL : direccion.host;
+		if (getaddrinfo(host, direccion.puerto, &hints, &servinfo) == 0)
+		{
+			socket_servidor = socket(servinfo->ai_family, servinfo->ai_socktype | SOCK_CLOEXEC, servinfo->ai_protocol);
+			if (socket_servidor != -1)
+			{
+				int uno = 1;
+				setsockopt(socket_servidor, SOL_SOCKET, SO_REUSEADDR, &uno, sizeof(uno));
+				aplicar_opciones_tcp(socket_servidor, &direccion);
+				if (bind(socket_servidor, servinfo->ai_addr, servinfo->ai_addrlen) == -1 || listen(socket_servidor, SOMAXCONN) == -1)
+				{
+					close(socket_servidor);
+					socket_servidor = -1;
+				}
+			}
+			freeaddrinfo(servinfo);
+		}
+	}
+
+	if (socket_servidor == -1)
+		log_error(un_logger, "No se pudo escuchar en %s", texto);
+	else
+		log_info(un_logger, "Server: %s (%s)", mensaje_server, texto);
+	liberar_direccion(&direccion);
+	return socket_servidor;
+}
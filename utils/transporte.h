@@ -0,0 +1,41 @@
+#ifndef TRANSPORTE_H_
+#define TRANSPORTE_H_
+
+#include <stdlib.h>
+#include <stdio.h>
+#include <stdbool.h>
+#include <commons/log.h>
+
+//-------------Direcciones de transporte--------------------
+// unix:/ruta/al/socket        socket de dominio unix (unix:@nombre para el espacio abstracto)
+// tcp:host:puerto[?opciones]  TCP, con opciones separadas por &:
+//     nodelay=1       desactiva Nagle (TCP_NODELAY)
+//     sndbuf=<bytes>  tamanio del buffer de envio (SO_SNDBUF)
+//     rcvbuf=<bytes>  tamanio del buffer de recepcion (SO_RCVBUF)
+//     busy_poll=<us>  microsegundos de busy polling en la placa al recibir (SO_BUSY_POLL)
+// host:puerto sin prefijo se toma como tcp.
+typedef enum {
+	TRANSPORTE_TCP,
+	TRANSPORTE_UNIX
+} t_tipo_transporte;
+
+typedef struct {
+	t_tipo_transporte tipo;
+	char* host;
+	char* puerto;
+	char* ruta;
+	bool nodelay;
+	int buffer_envio;     //0: el del sistema
+	int buffer_recepcion; //0: el del sistema
+	int busy_poll_us;     //0: sin busy polling
+} t_direccion;
+
+bool parsear_direccion(char* texto, t_direccion* direccion);
+void liberar_direccion(t_direccion* direccion);
+int conectar_direccion(char* texto);
+int iniciar_conexion_direccion(char* texto);
+int resultado_conexion(int socket);
+void dejar_bloqueante(int socket);
+int escuchar_direccion(char* texto, t_log* un_logger, char* mensaje_server);
+
+#endif
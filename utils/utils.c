@@ -1,4 +1,8 @@
 #include <utils/utils.h>
+#include <errno.h>
+#include <poll.h>
+
+#define MAX_IOV_POR_ENVIO 1024 //IOV_MAX de Linux
 
 
 void destruir_instruccion(t_instruccion* instruccion) {
@@ -14,7 +18,7 @@ void destruir_instruccion(t_instruccion* instruccion) {
 
 void agregar_a_paquete(t_paquete* paquete, void* valor, int bytes) {
 	t_buffer *buffer = paquete->buffer;
-	buffer->stream = realloc(buffer->stream, buffer->size + bytes);
+	reservar_en_buffer(buffer, bytes);
 	memcpy(buffer->stream + buffer->size, valor, bytes);
 	buffer->size += bytes;
 }
@@ -48,7 +52,11 @@ int crear_conexion(char *ip, char* puerto)
 	hints.ai_socktype = SOCK_STREAM;
 	hints.ai_flags = AI_PASSIVE;
 
-	getaddrinfo(ip, puerto, &hints, &server_info);
+	if (getaddrinfo(ip, puerto, &hints, &server_info) != 0)
+	{
+		printf("No se pudo resolver %s:%s.\n", ip, puerto);
+		return -1;
+	}
 
 	// Ahora vamos a crear el socket.
 	//int socket_cliente = 0;
@@ -56,10 +64,12 @@ int crear_conexion(char *ip, char* puerto)
                          server_info->ai_socktype,
                          server_info->ai_protocol);
 
-	// Ahora que tenemos el socket, vamos a conectarlo
-	if(connect(socket_cliente,server_info->ai_addr,server_info->ai_addrlen) == -1){
-        printf("No fue exitosa la conexion con el cliente %d.", socket_cliente);
-        abort();
+	// Ahora que tenemos el socket, vamos a conectarlo. Si el otro modulo todavia no levanto, se devuelve -1
+	// para que quien llama pueda reintentar
+	if(socket_cliente != -1 && connect(socket_cliente,server_info->ai_addr,server_info->ai_addrlen) == -1){
+        printf("No fue exitosa la conexion con el cliente %d.\n", socket_cliente);
+        close(socket_cliente);
+        socket_cliente = -1;
     }
 
 	freeaddrinfo(server_info);
@@ -71,37 +81,44 @@ int crear_conexion(char *ip, char* puerto)
 
 void enviar_mensaje(char* mensaje, int socket_cliente)
 {
-	t_paquete* paquete = malloc(sizeof(t_paquete));
+	t_paquete* paquete = crear_paquete(MENSAJE, crear_buffer());
 
-	paquete->codigo_operacion = MENSAJE;
-	paquete->buffer = malloc(sizeof(t_buffer));
 	paquete->buffer->size = strlen(mensaje) + 1;
 	paquete->buffer->stream = malloc(paquete->buffer->size);
+	paquete->buffer->capacidad = paquete->buffer->size;
 	memcpy(paquete->buffer->stream, mensaje, paquete->buffer->size);
 
-	int bytes = paquete->buffer->size + 2*sizeof(int);
-
-	void* a_enviar = serializar_paquete(paquete, bytes);
-
-	send(socket_cliente, a_enviar, bytes, 0);
-
-	free(a_enviar);
-	eliminar_paquete(paquete);
+	enviar_paquete(paquete, socket_cliente);
 }
 
 
 
 t_buffer* crear_buffer()
 {
-	//Reserbamos memoria para el buffer
+	//Reserbamos memoria para el buffer. Con malloc, como su stream: los modulos lo liberan con free
 	t_buffer* un_buffer = malloc(sizeof(t_buffer));
 	//iniciamos su size en 0 y su stream vacio
 	un_buffer->size = 0;
+	un_buffer->capacidad = 0;
 	un_buffer->stream = NULL;
 
 	return un_buffer;
 }
 
+//Se asegura de que entren bytes mas al final del stream, duplicando la capacidad para no hacer un realloc por campo
+void reservar_en_buffer(t_buffer* un_buffer, int bytes)
+{
+	int necesario = un_buffer->size + bytes;
+	if (necesario <= un_buffer->capacidad) return;
+
+	int nueva_capacidad = un_buffer->capacidad > 0 ? un_buffer->capacidad : 32;
+	while (nueva_capacidad < necesario)
+		nueva_capacidad *= 2;
+
+	un_buffer->stream = realloc(un_buffer->stream, nueva_capacidad);
+	un_buffer->capacidad = nueva_capacidad;
+}
+
 t_paquete* crear_paquete(op_code cod_op, t_buffer* un_buffer)
 {
 	t_paquete* paquete = malloc(sizeof(t_paquete));
@@ -115,30 +132,16 @@ t_paquete* crear_paquete(op_code cod_op, t_buffer* un_buffer)
 //recibe un buffer creado, algo y su tamanio para agregar al buffer
 void agregar_a_buffer(t_buffer* un_buffer, void* valor, int tamanio)
 {
-	//si el buffer esta vacio
-	if (un_buffer->size == 0)
-	{
-		//reservamos memoria para su size y el int
-		un_buffer->stream = malloc(sizeof(int) + tamanio);
-		//copiamos en el buffer lo que ingreso
-		memcpy(un_buffer->stream, &tamanio, sizeof(int));
-		//nos desplazamos y copiamos en el buffer el tamanio de lo que ingreso
-		memcpy(un_buffer->stream + sizeof(int), valor, tamanio);
-	}
-	else{ //sino estaba vacio
-		//agreandamos el espacio en memoria a lo que necesitemos
-		un_buffer->stream = realloc(un_buffer->stream, un_buffer->size + tamanio + sizeof(int));
-		//copiamos en el buffer lo que ingreso
-		memcpy(un_buffer->stream + un_buffer->size, &tamanio, sizeof(int));
-		//nos desplazamos y copiamos en el buffer el tamanio de lo que ingreso
-		memcpy(un_buffer->stream + un_buffer->size + sizeof(int), valor, tamanio);
-	}
-	
+	//nos aseguramos lugar para el tamanio y el contenido
+	reservar_en_buffer(un_buffer, sizeof(int) + tamanio);
+	//copiamos en el buffer el tamanio de lo que ingreso
+	memcpy(un_buffer->stream + un_buffer->size, &tamanio, sizeof(int));
+	//nos desplazamos y copiamos en el buffer lo que ingreso
+	memcpy(un_buffer->stream + un_buffer->size + sizeof(int), valor, tamanio);
 
 	//actualizamos el buffer
 	un_buffer->size += sizeof(int);
 	un_buffer->size += tamanio;
-	//un_buffer->size += tamanio + sizeof(int);
 }
 
 //Agrega una variable de tipo int al buffer
@@ -159,22 +162,207 @@ void cargar_string_al_buffer(t_buffer* un_buffer, char* tamanio_string)
 	agregar_a_buffer(un_buffer, tamanio_string, strlen(tamanio_string) + 1);
 }
 
-void enviar_paquete(t_paquete* paquete, int socket_cliente)
+//Manda la cabecera y el stream como dos iovec, sin serializarlos en otra copia.
+//Devuelve 0 si se envio completo y -1 si fallo el socket; el paquete se elimina igual
+int enviar_paquete(t_paquete* paquete, int socket_cliente)
 {
-	int bytes = paquete->buffer->size + 2*sizeof(int);
-	void* a_enviar = serializar_paquete(paquete, bytes);
+	int cabecera[2] = { paquete->codigo_operacion, paquete->buffer->size };
+	struct iovec iov[2] = {
+		{ .iov_base = cabecera, .iov_len = sizeof(cabecera) },
+		{ .iov_base = paquete->buffer->stream, .iov_len = paquete->buffer->size }
+	};
 
-	send(socket_cliente, a_enviar, bytes, 0);
+	int resultado = enviar_iovecs(socket_cliente, iov, paquete->buffer->size > 0 ? 2 : 1);
+	if (resultado == 0)
+		contar_envio(cabecera[0], TAMANIO_CABECERA_PAQUETE + cabecera[1]);
 
-	free(a_enviar);
 	eliminar_paquete(paquete);
+	return resultado;
+}
+
+//Manda todos los iovec, reintentando los envios parciales. Devuelve 0 si se envio todo y -1 si fallo el socket
+int enviar_iovecs(int socket_cliente, struct iovec* iov, int cantidad)
+{
+	while (cantidad > 0)
+	{
+		struct msghdr mensaje = { 0 };
+		mensaje.msg_iov = iov;
+		mensaje.msg_iovlen = cantidad < MAX_IOV_POR_ENVIO ? cantidad : MAX_IOV_POR_ENVIO;
+
+		ssize_t enviados = sendmsg(socket_cliente, &mensaje, MSG_NOSIGNAL);
+		if (enviados == -1)
+		{
+			if (errno == EINTR) continue;
+			if (errno == EAGAIN || errno == EWOULDBLOCK)
+			{
+				struct pollfd escritura = { .fd = socket_cliente, .events = POLLOUT };
+				poll(&escritura, 1, -1);
+				continue;
+			}
+			perror("Error al enviar por el socket");
+			return -1;
+		}
+
+		//Salteamos lo que ya salio y ajustamos el iovec que quedo a medias
+		while (cantidad > 0 && (size_t)enviados >= iov->iov_len)
+		{
+			enviados -= iov->iov_len;
+			iov++;
+			cantidad--;
+		}
+		if (cantidad > 0)
+		{
+			iov->iov_base = (char*)iov->iov_base + enviados;
+			iov->iov_len -= enviados;
+		}
+	}
+	return 0;
+}
+
+
+//-----------------------------CONSTRUCTOR DE PAQUETES---------------------------------------
+
+void iniciar_constructor(t_constructor_paquete* constructor, op_code_t cod_op, void* almacenamiento, int capacidad)
+{
+	if (almacenamiento == NULL || capacidad < TAMANIO_CABECERA_PAQUETE)
+	{
+		almacenamiento = reservar_del_pool(CAPACIDAD_CONSTRUCTOR_PILA, &capacidad);
+		constructor->en_heap = true;
+	}
+	else
+	{
+		constructor->en_heap = false;
+	}
+
+	constructor->datos = almacenamiento;
+	constructor->capacidad = capacidad;
+	constructor->tamanio = TAMANIO_CABECERA_PAQUETE;
+
+	int codigo = cod_op;
+	memcpy(constructor->datos, &codigo, sizeof(int));
+}
+
+//Si no entran los bytes pedidos, pasa los datos al heap duplicando la capacidad
+void asegurar_lugar_en_constructor(t_constructor_paquete* constructor, int bytes)
+{
+	int necesario = constructor->tamanio + bytes;
+	if (necesario > constructor->capacidad)
+	{
+		int nueva_capacidad = constructor->capacidad * 2;
+		while (nueva_capacidad < necesario)
+			nueva_capacidad *= 2;
+
+		if (constructor->en_heap)
+		{
+			constructor->datos = agrandar_del_pool(constructor->datos, constructor->tamanio, nueva_capacidad, &constructor->capacidad);
+		}
+		else
+		{
+			char* datos_heap = reservar_del_pool(nueva_capacidad, &constructor->capacidad);
+			memcpy(datos_heap, constructor->datos, constructor->tamanio);
+			constructor->datos = datos_heap;
+			constructor->en_heap = true;
+		}
+	}
+}
+
+//Agrega [tamanio][valor], igual que agregar_a_buffer()
+void agregar_al_constructor(t_constructor_paquete* constructor, void* valor, int tamanio)
+{
+	asegurar_lugar_en_constructor(constructor, sizeof(int) + tamanio);
+	memcpy(constructor->datos + constructor->tamanio, &tamanio, sizeof(int));
+	memcpy(constructor->datos + constructor->tamanio + sizeof(int), valor, tamanio);
+	constructor->tamanio += sizeof(int) + tamanio;
+}
+
+//Agrega los bytes sin prefijo de tamanio (cabeceras de mensajes.h): el que lee tiene que saber cuantos son
+void agregar_crudo_al_constructor(t_constructor_paquete* constructor, const void* valor, int tamanio)
+{
+	asegurar_lugar_en_constructor(constructor, tamanio);
+	memcpy(constructor->datos + constructor->tamanio, valor, tamanio);
+	constructor->tamanio += tamanio;
+}
+
+void cargar_int_al_constructor(t_constructor_paquete* constructor, int valor)
+{
+	agregar_al_constructor(constructor, &valor, sizeof(int));
+}
+
+void cargar_string_al_constructor(t_constructor_paquete* constructor, char* valor)
+{
+	agregar_al_constructor(constructor, valor, strlen(valor) + 1);
+}
+
+//Completa el size de la cabecera de cada constructor y arma un iovec por paquete
+static void preparar_iovecs_de_constructores(t_constructor_paquete* constructores, int cantidad, struct iovec* iov)
+{
+	for (int i = 0; i < cantidad; i++)
+	{
+		int size = constructores[i].tamanio - TAMANIO_CABECERA_PAQUETE;
+		memcpy(constructores[i].datos + sizeof(int), &size, sizeof(int));
+		iov[i].iov_base = constructores[i].datos;
+		iov[i].iov_len = constructores[i].tamanio;
+	}
+}
+
+static void terminar_envio_de_constructores(t_constructor_paquete* constructores, int cantidad, int resultado)
+{
+	for (int i = 0; i < cantidad; i++)
+	{
+		if (resultado == 0)
+			contar_envio(*(int*)constructores[i].datos, constructores[i].tamanio);
+		liberar_constructor(&constructores[i]);
+	}
+}
+
+//Completa el size de la cabecera y manda el paquete tal cual esta armado, sin serializar otra copia.
+//Devuelve 0 si se envio completo y -1 si fallo el socket
+int enviar_constructor(t_constructor_paquete* constructor, int socket_cliente)
+{
+	return enviar_constructores(constructor, 1, socket_cliente);
+}
+
+//Manda varios paquetes ya armados con una sola llamada al sistema (o las menos posibles, de a MAX_IOV_POR_ENVIO).
+//Los libera a todos; devuelve 0 si se enviaron completos y -1 si fallo el socket
+int enviar_constructores(t_constructor_paquete* constructores, int cantidad, int socket_cliente)
+{
+	struct iovec iov[cantidad];
+	preparar_iovecs_de_constructores(constructores, cantidad, iov);
+	int resultado = enviar_iovecs(socket_cliente, iov, cantidad);
+	terminar_envio_de_constructores(constructores, cantidad, resultado);
+	return resultado;
+}
+
+//Igual que enviar_constructor(), pero copia el paquete al anillo de salida del canal compartido
+int enviar_constructor_por_anillo(t_constructor_paquete* constructor, t_canal_compartido* canal)
+{
+	return enviar_constructores_por_anillo(constructor, 1, canal);
+}
+
+//Igual que enviar_constructores(), pero copia los paquetes al anillo de salida uno detras del otro
+int enviar_constructores_por_anillo(t_constructor_paquete* constructores, int cantidad, t_canal_compartido* canal)
+{
+	struct iovec iov[cantidad];
+	preparar_iovecs_de_constructores(constructores, cantidad, iov);
+	int resultado = escribir_en_anillo(canal->salida, iov, cantidad, canal->socket_control);
+	terminar_envio_de_constructores(constructores, cantidad, resultado);
+	return resultado;
+}
+
+void liberar_constructor(t_constructor_paquete* constructor)
+{
+	if (constructor->en_heap)
+	{
+		devolver_al_pool(constructor->datos);
+	}
+	constructor->datos = NULL;
+	constructor->en_heap = false;
 }
 
 
 void eliminar_paquete(t_paquete* paquete)
 {
-	free(paquete->buffer->stream);
-	free(paquete->buffer);
+	eliminar_buffer(paquete->buffer);
 	free(paquete);
 }
 
@@ -240,11 +428,17 @@ int esperar_cliente(int socket_servidor, t_log* un_logger, char* mensaje) {
     return socket_cliente;
 }
 
+//El codigo que leyo recibir_operacion(), para contar el mensaje cuando recibir_buffer() lo completa
+static __thread int cod_op_en_curso = -1;
+
 int recibir_operacion(int socket_cliente)
 {
 	int cod_op;
 	if(recv(socket_cliente, &cod_op, sizeof(int), MSG_WAITALL) > 0)
+	{
+		cod_op_en_curso = cod_op;
 		return cod_op;
+	}
 	else
 	{
 		close(socket_cliente);
@@ -255,14 +449,16 @@ int recibir_operacion(int socket_cliente)
 
 t_buffer* recibir_buffer(int socket_cliente)
 {
-	t_buffer * buffer =malloc(sizeof(t_buffer));
+	t_buffer * buffer = crear_buffer();
 
 	if (recv(socket_cliente, &(buffer->size), sizeof(int), MSG_WAITALL) > 0)
 	{
 		buffer->stream = malloc(buffer->size);
+		buffer->capacidad = buffer->size;
 
 		if (recv(socket_cliente, buffer->stream, buffer->size, MSG_WAITALL) > 0)
 		{
+			contar_recepcion(cod_op_en_curso, TAMANIO_CABECERA_PAQUETE + buffer->size);
 			return buffer;
 		}
 		else{
@@ -322,6 +518,7 @@ void* extraer_contenido_del_buffer(t_buffer* un_buffer)
 	if (nuevo_tamanio == 0)
 	{
 		un_buffer->size = 0;
+		un_buffer->capacidad = 0;
 		free(un_buffer->stream);
 		un_buffer->stream = NULL;
 		return contenido;
@@ -337,6 +534,7 @@ void* extraer_contenido_del_buffer(t_buffer* un_buffer)
 	memcpy(nuevo_stream, un_buffer->stream + sizeof(int) + tamanio_contenido, nuevo_tamanio);
 	free(un_buffer->stream);
 	un_buffer->size = nuevo_tamanio;
+	un_buffer->capacidad = nuevo_tamanio;
 	un_buffer->stream = nuevo_stream;
 
 	return contenido;
@@ -370,13 +568,386 @@ uint32_t extraer_uint32_del_buffer(t_buffer* un_buffer)
 }
 
 
+//-----------------------------LECTOR DE SOCKET---------------------------------------
+
+t_lector_socket* crear_lector_socket(int socket_cliente, int capacidad)
+{
+	t_lector_socket* lector = malloc(sizeof(t_lector_socket));
+	lector->socket = socket_cliente;
+	lector->capacidad = capacidad > TAMANIO_CABECERA_PAQUETE ? capacidad : CAPACIDAD_LECTOR_SOCKET;
+	lector->datos = malloc(lector->capacidad);
+	lector->inicio = 0;
+	lector->fin = 0;
+	lector->anillo = NULL;
+	return lector;
+}
+
+//Deja al menos bytes sin consumir en el buffer, haciendo recv solo si faltan.
+//Cada recv trae todo lo que el socket tenga, asi una rafaga de respuestas cuesta una sola llamada
+bool asegurar_bytes_en_lector(t_lector_socket* lector, int bytes)
+{
+	while (lector->fin - lector->inicio < bytes)
+	{
+		if (lector->capacidad - lector->inicio < bytes)
+		{
+			//Corremos lo pendiente al principio y, si igual no entra, agrandamos
+			int pendientes = lector->fin - lector->inicio;
+			memmove(lector->datos, lector->datos + lector->inicio, pendientes);
+			lector->inicio = 0;
+			lector->fin = pendientes;
+
+			if (lector->capacidad < bytes)
+			{
+				lector->datos = realloc(lector->datos, bytes);
+				lector->capacidad = bytes;
+			}
+		}
+
+		ssize_t recibidos;
+		if (lector->anillo != NULL)
+			recibidos = leer_de_anillo(lector->anillo, lector->datos + lector->fin, lector->capacidad - lector->fin, lector->socket);
+		else
+			recibidos = recv(lector->socket, lector->datos + lector->fin, lector->capacidad - lector->fin, 0);
+		if (recibidos == -1 && errno == EINTR) continue;
+		if (recibidos <= 0) return false;
+		lector->fin += recibidos;
+	}
+	return true;
+}
+
+//Devuelve el op_code del proximo mensaje y deja en vista su stream, que apunta al buffer del lector:
+//vale hasta la proxima llamada y no hay que eliminarlo. Devuelve -1 y cierra el socket si se desconecto
+int recibir_mensaje_bufferizado(t_lector_socket* lector, t_buffer* vista)
+{
+	int cabecera[2];
+	if (!asegurar_bytes_en_lector(lector, TAMANIO_CABECERA_PAQUETE))
+	{
+		close(lector->socket);
+		return -1;
+	}
+	memcpy(cabecera, lector->datos + lector->inicio, TAMANIO_CABECERA_PAQUETE);
+
+	if (cabecera[1] < 0)
+	{
+		printf("\n[ERROR] Mensaje con size negativo en el socket %d \n\n", lector->socket);
+		exit(EXIT_FAILURE);
+	}
+	if (!asegurar_bytes_en_lector(lector, TAMANIO_CABECERA_PAQUETE + cabecera[1]))
+	{
+		close(lector->socket);
+		return -1;
+	}
+
+	vista->size = cabecera[1];
+	vista->capacidad = 0;
+	vista->stream = lector->datos + lector->inicio + TAMANIO_CABECERA_PAQUETE;
+	lector->inicio += TAMANIO_CABECERA_PAQUETE + cabecera[1];
+	contar_recepcion(cabecera[0], TAMANIO_CABECERA_PAQUETE + cabecera[1]);
+
+	if (lector->inicio == lector->fin)
+	{
+		lector->inicio = 0;
+		lector->fin = 0;
+	}
+	return cabecera[0];
+}
+
+//Indica si ya hay un mensaje completo en el buffer (el socket puede no estar listo para leer aunque lo haya)
+bool hay_mensaje_bufferizado(t_lector_socket* lector)
+{
+	int pendientes = lector->fin - lector->inicio;
+	if (pendientes < TAMANIO_CABECERA_PAQUETE) return false;
+
+	int size;
+	memcpy(&size, lector->datos + lector->inicio + sizeof(int), sizeof(int));
+	return pendientes >= TAMANIO_CABECERA_PAQUETE + size;
+}
+
+void destruir_lector_socket(t_lector_socket* lector)
+{
+	if (lector == NULL) return;
+	free(lector->datos);
+	free(lector);
+}
+
+//-----------------------------PEDIDOS MULTIPLEXADOS---------------------------------------
+
+t_tabla_pedidos* crear_tabla_pedidos(bool habilitada)
+{
+	t_tabla_pedidos* tabla = calloc(1, sizeof(t_tabla_pedidos));
+	tabla->habilitada = habilitada;
+	tabla->proximo_id = 1;
+	return tabla;
+}
+
+t_pedido* pedido_de_tabla(t_tabla_pedidos* tabla, uint32_t id)
+{
+	return &tabla->pedidos[id % MAX_PEDIDOS_EN_VUELO];
+}
+
+//Como iniciar_constructor(), pero si la tabla esta habilitada reserva un id y lo carga como primer campo.
+//Devuelve el id con el que hay que esperar la respuesta (0 si la tabla no usa ids)
+uint32_t iniciar_pedido(t_constructor_paquete* constructor, op_code_t cod_op, void* almacenamiento, int capacidad, t_tabla_pedidos* tabla)
+{
+	iniciar_constructor(constructor, cod_op, almacenamiento, capacidad);
+	if (!tabla->habilitada) return 0;
+
+	uint32_t id = tabla->proximo_id++;
+	if (tabla->proximo_id == 0)
+		tabla->proximo_id = 1; //el 0 queda para "sin id"
+
+	t_pedido* pedido = pedido_de_tabla(tabla, id);
+	if (pedido->en_vuelo)
+	{
+		printf("\n[ERROR] Hay mas de %d pedidos en vuelo en la misma conexion \n\n", MAX_PEDIDOS_EN_VUELO);
+		exit(EXIT_FAILURE);
+	}
+	pedido->id = id;
+	pedido->en_vuelo = true;
+	pedido->abandonado = false;
+	pedido->guardada = false;
+
+	int id_en_campo = id;
+	cargar_int_al_constructor(constructor, id_en_campo);
+	return id;
+}
+
+//Saca el campo del id del principio de la vista de una respuesta y lo devuelve
+uint32_t separar_id_de_respuesta(t_buffer* vista)
+{
+	t_lector_buffer lector_id = crear_lector(vista);
+	uint32_t id = leer_int_del_buffer(&lector_id);
+	vista->stream += lector_id.desplazamiento;
+	vista->size -= lector_id.desplazamiento;
+	return id;
+}
+
+//Id de la respuesta que esta primera en el lector, que tiene que estar completa (ver hay_mensaje_bufferizado())
+uint32_t id_de_mensaje_bufferizado(t_lector_socket* lector)
+{
+	int size;
+	memcpy(&size, lector->datos + lector->inicio + sizeof(int), sizeof(int));
+	t_buffer vista = { .size = size, .capacidad = 0, .stream = lector->datos + lector->inicio + TAMANIO_CABECERA_PAQUETE };
+	return separar_id_de_respuesta(&vista);
+}
+
+//Deja en el lugar de su pedido una respuesta que llego mientras se esperaba otra. Se copia porque la
+//vista se pisa con el proximo recv; el almacenamiento del lugar se agranda del pool solo si no alcanza.
+//Las respuestas a pedidos que no hicimos o que se abandonaron se descartan
+void guardar_respuesta(t_tabla_pedidos* tabla, uint32_t id, int cod_op, t_buffer* vista)
+{
+	t_pedido* dueno = pedido_de_tabla(tabla, id);
+	if (!dueno->en_vuelo || dueno->id != id)
+		return; //respuesta a un pedido que no hicimos
+
+	if (dueno->abandonado)
+	{
+		dueno->en_vuelo = false;
+		return;
+	}
+
+	if (vista->size > dueno->capacidad)
+		dueno->contenido = agrandar_del_pool(dueno->contenido, 0, vista->size, &dueno->capacidad);
+	if (vista->size > 0)
+		memcpy(dueno->contenido, vista->stream, vista->size);
+	dueno->tamanio = vista->size;
+	dueno->cod_op = cod_op;
+	dueno->guardada = true;
+}
+
+//Devuelve el op_code de la respuesta al pedido id y deja en respuesta su stream (sin el campo del id).
+//Las respuestas de otros pedidos que lleguen antes se guardan en la tabla. La vista vale hasta
+//la proxima llamada y no hay que eliminarla. Devuelve -1 si se cerro la conexion
+int esperar_respuesta(t_tabla_pedidos* tabla, t_lector_socket* lector, uint32_t id, t_buffer* respuesta)
+{
+	if (!tabla->habilitada)
+		return recibir_mensaje_bufferizado(lector, respuesta);
+
+	t_pedido* pedido = pedido_de_tabla(tabla, id);
+	if (pedido->id == id && pedido->guardada)
+	{
+		//La vista apunta al almacenamiento del lugar, que no se vuelve a usar hasta que se guarde otra respuesta
+		respuesta->size = pedido->tamanio;
+		respuesta->capacidad = 0;
+		respuesta->stream = pedido->contenido;
+		pedido->guardada = false;
+		pedido->en_vuelo = false;
+		return pedido->cod_op;
+	}
+
+	while (true)
+	{
+		t_buffer vista;
+		int cod_op = recibir_mensaje_bufferizado(lector, &vista);
+		if (cod_op == -1) return -1;
+
+		uint32_t id_recibido = separar_id_de_respuesta(&vista);
+		if (id_recibido == id && pedido->en_vuelo && pedido->id == id)
+		{
+			pedido->en_vuelo = false;
+			*respuesta = vista;
+			return cod_op;
+		}
+		guardar_respuesta(tabla, id_recibido, cod_op, &vista);
+	}
+}
+
+//Indica si esperar_respuesta() puede devolver la respuesta al pedido id sin bloquearse. Las respuestas
+//completas de otros pedidos que esten antes en el lector se pasan a sus lugares de la tabla, asi no la tapan.
+//Sin ids no se puede saber de quien es: alcanza con que haya un mensaje completo
+bool respuesta_disponible(t_tabla_pedidos* tabla, t_lector_socket* lector, uint32_t id)
+{
+	if (!tabla->habilitada)
+		return hay_mensaje_bufferizado(lector);
+
+	t_pedido* pedido = pedido_de_tabla(tabla, id);
+	while (!(pedido->id == id && pedido->guardada) && hay_mensaje_bufferizado(lector))
+	{
+		if (id_de_mensaje_bufferizado(lector) == id)
+			return true;
+
+		t_buffer vista;
+		int cod_op = recibir_mensaje_bufferizado(lector, &vista); //esta completo: no se bloquea
+		uint32_t id_recibido = separar_id_de_respuesta(&vista);
+		guardar_respuesta(tabla, id_recibido, cod_op, &vista);
+	}
+	return pedido->id == id && pedido->guardada;
+}
+
+//La respuesta del pedido se va a descartar cuando llegue
+void abandonar_pedido(t_tabla_pedidos* tabla, uint32_t id)
+{
+	if (!tabla->habilitada) return;
+
+	t_pedido* pedido = pedido_de_tabla(tabla, id);
+	if (pedido->id != id || !pedido->en_vuelo) return;
+
+	if (pedido->guardada)
+	{
+		pedido->guardada = false;
+		pedido->en_vuelo = false;
+		return;
+	}
+	pedido->abandonado = true;
+}
+
+void destruir_tabla_pedidos(t_tabla_pedidos* tabla)
+{
+	if (tabla == NULL) return;
+
+	for (int i = 0; i < MAX_PEDIDOS_EN_VUELO; i++)
+	{
+		devolver_al_pool(tabla->pedidos[i].contenido);
+	}
+	free(tabla);
+}
+
+//-----------------------------LECTOR DE BUFFER---------------------------------------
+//Lee los campos [tamanio][contenido] en orden, moviendo un desplazamiento sobre el stream.
+//Los strings y contenidos que devuelve apuntan al stream: valen mientras no se elimine el buffer.
+
+t_lector_buffer crear_lector(t_buffer* un_buffer)
+{
+	t_lector_buffer lector = { .buffer = un_buffer, .desplazamiento = 0 };
+	return lector;
+}
+
+bool quedan_datos_en_lector(t_lector_buffer* lector)
+{
+	return lector->desplazamiento < lector->buffer->size;
+}
+
+//Devuelve un puntero al contenido del proximo campo y deja su tamanio en *tamanio
+void* leer_contenido_del_buffer(t_lector_buffer* lector, int* tamanio)
+{
+	int restante = lector->buffer->size - lector->desplazamiento;
+	if (restante < (int)sizeof(int))
+	{
+		printf("\n[ERROR] Al intentar leer un campo mas alla del final del t_buffer \n\n");
+		exit(EXIT_FAILURE);
+	}
+
+	int tamanio_contenido;
+	memcpy(&tamanio_contenido, lector->buffer->stream + lector->desplazamiento, sizeof(int));
+	if (tamanio_contenido < 0 || tamanio_contenido > restante - (int)sizeof(int))
+	{
+		printf("\n[ERROR] El t_buffer contiene un campo de tamanio invalido (%d) \n\n", tamanio_contenido);
+		exit(EXIT_FAILURE);
+	}
+
+	void* contenido = lector->buffer->stream + lector->desplazamiento + sizeof(int);
+	lector->desplazamiento += sizeof(int) + tamanio_contenido;
+	*tamanio = tamanio_contenido;
+	return contenido;
+}
+
+//Devuelve un puntero a los proximos tamanio bytes, que no llevan prefijo (ver agregar_crudo_al_constructor())
+void* leer_crudo_del_buffer(t_lector_buffer* lector, int tamanio)
+{
+	if (tamanio > lector->buffer->size - lector->desplazamiento)
+	{
+		printf("\n[ERROR] Al intentar leer %d bytes mas alla del final del t_buffer \n\n", tamanio);
+		exit(EXIT_FAILURE);
+	}
+
+	void* contenido = lector->buffer->stream + lector->desplazamiento;
+	lector->desplazamiento += tamanio;
+	return contenido;
+}
+
+//Lee un campo de tipo int por valor
+int leer_int_del_buffer(t_lector_buffer* lector)
+{
+	int tamanio;
+	void* contenido = leer_contenido_del_buffer(lector, &tamanio);
+	if (tamanio != sizeof(int))
+	{
+		printf("\n[ERROR] Se esperaba un int y el campo tiene %d bytes \n\n", tamanio);
+		exit(EXIT_FAILURE);
+	}
+
+	int valor;
+	memcpy(&valor, contenido, sizeof(int));
+	return valor;
+}
+
+//Lee un campo de tipo uint32 por valor
+uint32_t leer_uint32_del_buffer(t_lector_buffer* lector)
+{
+	int tamanio;
+	void* contenido = leer_contenido_del_buffer(lector, &tamanio);
+	if (tamanio != sizeof(uint32_t))
+	{
+		printf("\n[ERROR] Se esperaba un uint32 y el campo tiene %d bytes \n\n", tamanio);
+		exit(EXIT_FAILURE);
+	}
+
+	uint32_t valor;
+	memcpy(&valor, contenido, sizeof(uint32_t));
+	return valor;
+}
+
+//Lee un campo de tipo string sin copiarlo
+char* leer_string_del_buffer(t_lector_buffer* lector)
+{
+	int tamanio;
+	char* contenido = leer_contenido_del_buffer(lector, &tamanio);
+	if (tamanio == 0 || contenido[tamanio - 1] != '\0')
+	{
+		printf("\n[ERROR] Se esperaba un string terminado en \\0 \n\n");
+		exit(EXIT_FAILURE);
+	}
+	return contenido;
+}
+
+
 char* recibir_mensaje(int socket_cliente)
 {
 	t_buffer* buffer = recibir_buffer(socket_cliente);
 	if (!buffer) return NULL;
 
 	char* mensaje = strdup(buffer->stream);
-	free(buffer);
+	eliminar_buffer(buffer);
 	
 	return mensaje;
 }
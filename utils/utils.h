@@ -9,6 +9,12 @@
 #include<unistd.h>
 #include<sys/socket.h>
 #include<netdb.h>
+#include<sys/uio.h>
+#include<utils/pool.h>
+#include<utils/anillo.h>
+#include<utils/transporte.h>
+#include<utils/codec_paginas.h>
+#include<utils/contadores.h>
 #include<string.h>
 
 #include<commons/log.h>
@@ -155,6 +161,7 @@ typedef struct{
 typedef struct
 {
 	int size;
+	int capacidad; //bytes reservados en stream, crece de a potencias de 2
 	void* stream;
 } t_buffer;
 
@@ -164,6 +171,69 @@ typedef struct
 	t_buffer* buffer;
 } t_paquete;
 
+//Arma un paquete [op_code][size][stream] en un solo bloque, con la cabecera reservada al principio.
+//Arranca sobre el almacenamiento que pase el llamador (p. ej. un array en la pila) y solo pasa al heap si no le alcanza.
+#define TAMANIO_CABECERA_PAQUETE (2 * (int)sizeof(int))
+#define CAPACIDAD_CONSTRUCTOR_PILA 128
+
+typedef struct
+{
+	char* datos;
+	int tamanio; //bytes usados, incluida la cabecera
+	int capacidad;
+	bool en_heap;
+} t_constructor_paquete;
+
+//Buffer de lectura por conexion: trae del socket todo lo que haya con un solo recv
+//y va entregando los mensajes [op_code][size][stream] completos desde ahi
+#define CAPACIDAD_LECTOR_SOCKET 65536
+
+typedef struct
+{
+	int socket;
+	char* datos;
+	int capacidad;
+	int inicio; //primer byte sin consumir
+	int fin;    //uno despues del ultimo byte recibido
+	t_anillo* anillo; //si no es NULL se lee de este anillo en vez del socket
+} t_lector_socket;
+
+//Pedidos multiplexados sobre una conexion: cada pedido lleva un id como primer campo
+//del stream ([4][id]) y la respuesta lo devuelve igual, asi pueden llegar en cualquier orden.
+//Se habilita solo si el otro extremo lo acepta en el handshake
+#define CAPACIDAD_IDS_DE_PEDIDO 0x1 //Capacidades que se negocian en el handshake con memoria
+#define CAPACIDAD_MEMORIA_COMPARTIDA 0x2 //el handshake agrega [pid][memfd][tamanio] del canal (ver anillo.h)
+#define CAPACIDAD_CODEC_PAGINAS 0x4 //las paginas completas viajan codificadas (ver codec_paginas.h)
+#define CAPACIDAD_MENSAJES_FIJOS 0x8 //los mensajes con esquema usan cabecera fija sin prefijos (ver mensajes.h)
+#define CAPACIDAD_ACCESOS_VECTORIZADOS 0x10 //un READ/WRITE puede traer varios segmentos (marco, desplazamiento, tamanio)
+#define MAX_PEDIDOS_EN_VUELO 64
+
+typedef struct
+{
+	uint32_t id;
+	bool en_vuelo;       //enviado y sin respuesta entregada
+	bool abandonado;     //nadie la espera: se descarta al llegar
+	int cod_op;
+	bool guardada;       //la respuesta llego mientras se esperaba otra y esta en contenido
+	char* contenido;     //del pool; queda en el lugar de la tabla y se reusa en los pedidos siguientes
+	int tamanio;
+	int capacidad;
+} t_pedido;
+
+typedef struct
+{
+	bool habilitada; //sin ids, cada respuesta es la del pedido mas viejo
+	uint32_t proximo_id;
+	t_pedido pedidos[MAX_PEDIDOS_EN_VUELO]; //indexados por id % MAX_PEDIDOS_EN_VUELO
+} t_tabla_pedidos;
+
+//Cursor para leer un t_buffer sin copiarlo ni achicarlo
+typedef struct
+{
+	t_buffer* buffer;
+	int desplazamiento;
+} t_lector_buffer;
+
 extern t_log* logger;
 
 
@@ -177,10 +247,23 @@ void agregar_a_buffer(t_buffer* un_buffer, void* valor, int tamanio);
 void cargar_int_al_buffer(t_buffer* un_buffer, int tamanio_int);
 void cargar_uint32_al_buffer(t_buffer* un_buffer, uint32_t tamanio_uint32);
 void cargar_string_al_buffer(t_buffer* un_buffer, char* tamanio_string);
-void enviar_paquete(t_paquete* paquete, int socket_cliente);
+int enviar_paquete(t_paquete* paquete, int socket_cliente);
+int enviar_iovecs(int socket_cliente, struct iovec* iov, int cantidad);
 void eliminar_paquete(t_paquete* paquete);
 void eliminar_buffer(t_buffer* un_buffer);
 void liberar_conexion(int socket_cliente);
+void reservar_en_buffer(t_buffer* un_buffer, int bytes);
+
+void iniciar_constructor(t_constructor_paquete* constructor, op_code_t cod_op, void* almacenamiento, int capacidad);
+void agregar_al_constructor(t_constructor_paquete* constructor, void* valor, int tamanio);
+void agregar_crudo_al_constructor(t_constructor_paquete* constructor, const void* valor, int tamanio);
+void cargar_int_al_constructor(t_constructor_paquete* constructor, int valor);
+void cargar_string_al_constructor(t_constructor_paquete* constructor, char* valor);
+int enviar_constructor(t_constructor_paquete* constructor, int socket_cliente);
+int enviar_constructores(t_constructor_paquete* constructores, int cantidad, int socket_cliente);
+int enviar_constructor_por_anillo(t_constructor_paquete* constructor, t_canal_compartido* canal);
+int enviar_constructores_por_anillo(t_constructor_paquete* constructores, int cantidad, t_canal_compartido* canal);
+void liberar_constructor(t_constructor_paquete* constructor);
 
 //-------------Funciones de Server--------------------
 int iniciar_servidor(char* puerto, t_log* un_logger, char* mensaje_server);
@@ -195,6 +278,26 @@ char* extraer_string_del_buffer(t_buffer* un_buffer);
 uint32_t extraer_uint32_del_buffer(t_buffer* un_buffer);
 char* recibir_mensaje(int socket_cliente);
 
+t_lector_buffer crear_lector(t_buffer* un_buffer);
+bool quedan_datos_en_lector(t_lector_buffer* lector);
+void* leer_contenido_del_buffer(t_lector_buffer* lector, int* tamanio);
+void* leer_crudo_del_buffer(t_lector_buffer* lector, int tamanio);
+int leer_int_del_buffer(t_lector_buffer* lector);
+uint32_t leer_uint32_del_buffer(t_lector_buffer* lector);
+char* leer_string_del_buffer(t_lector_buffer* lector);
+
+t_lector_socket* crear_lector_socket(int socket_cliente, int capacidad);
+int recibir_mensaje_bufferizado(t_lector_socket* lector, t_buffer* vista);
+bool hay_mensaje_bufferizado(t_lector_socket* lector);
+void destruir_lector_socket(t_lector_socket* lector);
+
+t_tabla_pedidos* crear_tabla_pedidos(bool habilitada);
+uint32_t iniciar_pedido(t_constructor_paquete* constructor, op_code_t cod_op, void* almacenamiento, int capacidad, t_tabla_pedidos* tabla);
+int esperar_respuesta(t_tabla_pedidos* tabla, t_lector_socket* lector, uint32_t id, t_buffer* respuesta);
+bool respuesta_disponible(t_tabla_pedidos* tabla, t_lector_socket* lector, uint32_t id);
+void abandonar_pedido(t_tabla_pedidos* tabla, uint32_t id);
+void destruir_tabla_pedidos(t_tabla_pedidos* tabla);
+
 t_list* recibir_paquete(int socket_cliente);
 t_buffer* recibir_buffer2(int*, int);
 